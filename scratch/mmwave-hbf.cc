@@ -135,6 +135,7 @@ main (int argc, char *argv[])
 	//bool useIdealRrc = true;
 	bool fixedTti = false;
         bool tcpApp = false;
+        uint32_t bfGainSampling = 0;
 //	bool smallScale = false;
 //	double speed = 3;
 
@@ -163,6 +164,8 @@ main (int argc, char *argv[])
         cmd.AddValue ("bfmod", "The type of beamformer algorithm", beamformerType);
         cmd.AddValue ("nLayers", "The number of HBF layers per eNB", numEnbLayers);
         cmd.AddValue ("useTCP", "Use TCP BulkSendApplication instead of UDPClient", tcpApp);
+        cmd.AddValue ("bfGainSampling", "Save one every bfGainSampling beamforming gains in BfGainTrace.txt, "
+                      "which can be parsed by TBLERstats.py (0 disables the trace)", bfGainSampling);
 	//cmd.AddValue ("useIdealRrc", "whether to use ideal RRC layer or not", useIdealRrc);
 	cmd.Parse (argc, argv);
 
@@ -398,6 +401,10 @@ main (int argc, char *argv[])
 	serverApps.Start (Seconds (startTime));
 	clientApps.Start (Seconds (startTime));
 	mmwaveHelper->EnableTraces ();
+	if (bfGainSampling > 0)
+	  {
+	    mmwaveHelper->EnableBeamformingGainTrace (bfGainSampling);
+	  }
 	//Uncomment to enable PCAP tracing
 	//p2ph.EnablePcapAll ("mmwave-epc-simple");
 
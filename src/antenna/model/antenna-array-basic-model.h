@@ -169,6 +169,13 @@ public:
    */
   virtual double GetRadiationPattern (double vangle, double hangle) = 0;
 
+  /**
+   * This function returns the maximum of the radiation pattern over all the
+   * directions.
+   * \return returns the maximum of the radiation pattern
+   */
+  virtual double GetMaxRadiationPattern () const = 0;
+
   /**
    * This function returns the location of the antenna element inside of the
    * sector assuming the left bottom corner is (0,0,0).
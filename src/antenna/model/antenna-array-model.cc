@@ -39,6 +39,7 @@ AntennaArrayModel::AntennaArrayModel () : AntennaArrayBasicModel ()
 {
   m_omniTx = false;
   m_activeDigitalCombining = false;
+  m_configurationId = 0;
 }
 
 AntennaArrayModel::~AntennaArrayModel ()
@@ -98,6 +99,7 @@ void
 AntennaArrayModel::SetCurrNumLayers (uint8_t currNumLayers)
 {
   m_currNumLayers = currNumLayers;
+  m_configurationId++;
 }
 
 uint8_t
@@ -110,6 +112,7 @@ void
 AntennaArrayModel::ClearBeamformingVectorList ()
 {
   m_currentBeamformingVectorList.clear();
+  m_configurationId++;
 }
 
 void
@@ -123,11 +126,11 @@ void
 AntennaArrayModel::SetBeamformingVectorMultilayers (complexVector_t antennaWeights, BeamId beamId,
                                          Ptr<NetDevice> device, uint8_t layerInd)
 {
-  NS_LOG_INFO ("SetBeamformingVector for node id: "<<device->GetNode()->GetId()<<
-                 " at:"<<Simulator::Now().GetSeconds());
   m_omniTx = false;
   if (device != nullptr)
     {
+      NS_LOG_INFO ("SetBeamformingVector for node id: "<<device->GetNode()->GetId()<<
+                   " at:"<<Simulator::Now().GetSeconds());
       BeamformingStorage::iterator iter = m_beamformingVectorMap.find (device);
       if (iter != m_beamformingVectorMap.end ())
         {
@@ -141,6 +144,7 @@ AntennaArrayModel::SetBeamformingVectorMultilayers (complexVector_t antennaWeigh
       m_beamformingVectorUpdateTimes [device] = Simulator::Now();
     }
   m_currentBeamformingVectorList[layerInd] = std::make_pair (antennaWeights, beamId);
+  m_configurationId++;
 }
 
 void
@@ -156,6 +160,7 @@ AntennaArrayModel::ChangeBeamformingVectorMultilayers (Ptr<NetDevice> device, ui
   BeamformingStorage::iterator it = m_beamformingVectorMap.find (device);
   NS_ASSERT_MSG (it != m_beamformingVectorMap.end (), "could not find the beamforming vector for the provided device");
   m_currentBeamformingVectorList[layerInd] = it->second;
+  m_configurationId++;
 }
 
 
@@ -163,6 +168,7 @@ void
 AntennaArrayModel::ToggleDigitalCombining (bool bActive)
 {
   m_activeDigitalCombining = bActive;
+  m_configurationId++;
 }
 bool
 AntennaArrayModel::isDigitalCombiningOn ()
@@ -171,12 +177,13 @@ AntennaArrayModel::isDigitalCombiningOn ()
 }
 
 void
-AntennaArrayModel::SetDigitalCombining (complex3DVector_t spectrumWDCmatrix)
+AntennaArrayModel::SetDigitalCombining (const complex3DVector_t &spectrumWDCmatrix)
 {
   m_currDigitalCombining = spectrumWDCmatrix;
+  m_configurationId++;
 }
 
-AntennaArrayModel::complex3DVector_t
+const AntennaArrayModel::complex3DVector_t&
 AntennaArrayModel::GetDigitalCombining ()
 {
   return m_currDigitalCombining;
@@ -195,10 +202,29 @@ AntennaArrayModel::GetCurrentBeamformingVectorMultilayers (uint8_t layerInd)
   return m_currentBeamformingVectorList[layerInd];
 }
 
+std::vector<uint8_t>
+AntennaArrayModel::GetBeamformingLayers () const
+{
+  std::vector<uint8_t> layers;
+  for (BeamformingVectorList::const_iterator it = m_currentBeamformingVectorList.begin ();
+       it != m_currentBeamformingVectorList.end (); ++it)
+    {
+      layers.push_back (it->first);
+    }
+  return layers;
+}
+
 void
 AntennaArrayModel::ChangeToOmniTx ()
 {
   m_omniTx = true;
+  m_configurationId++;
+}
+
+uint64_t
+AntennaArrayModel::GetConfigurationId () const
+{
+  return m_configurationId;
 }
 
 bool
@@ -241,6 +267,13 @@ AntennaArrayModel::GetRadiationPattern (double vAngle, double hAngle)
   return 1;
 }
 
+double
+AntennaArrayModel::GetMaxRadiationPattern () const
+{
+  // isotropic elements, see GetRadiationPattern
+  return 1;
+}
+
 Vector
 AntennaArrayModel::GetAntennaLocation (uint8_t index)
 {
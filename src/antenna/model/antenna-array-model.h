@@ -143,6 +143,13 @@ public:
   virtual BeamformingVector GetCurrentBeamformingVector ();
   virtual BeamformingVector GetCurrentBeamformingVectorMultilayers (uint8_t layerInd);
 
+  /**
+   * Returns the RF chains / spatial mux layers which have a current
+   * beamforming vector, in increasing order.
+   * \return the indices of the layers
+   */
+  std::vector<uint8_t> GetBeamformingLayers () const;
+
   /**
    * This function that returns the beamforming vector weights that is used to
    * communicated with a specified device
@@ -173,6 +180,13 @@ public:
    */
   virtual double GetRadiationPattern (double vangle, double hangle = 0);
 
+  /**
+   * This function returns the maximum of the radiation pattern over all the
+   * directions.
+   * \return returns the maximum of the radiation pattern
+   */
+  virtual double GetMaxRadiationPattern () const override;
+
   /**
    * This function returns the location of the antenna element inside of the
    * sector assuming the left bottom corner is (0,0,0).
@@ -230,12 +244,21 @@ virtual bool isDigitalCombiningOn ();
   * Set a frequency-selective digital combining matrix
   * \param spectrumWDCmatrix a 3D complex vector with indexes [subcarrier, digital layerInd, analog layerInd]
   */
-virtual void SetDigitalCombining (complex3DVector_t spectrumWDCmatrix);
+virtual void SetDigitalCombining (const complex3DVector_t &spectrumWDCmatrix);
 /**
  * Get the current frequency-selective digital combining matrix
  * \return spectrumWDCmatrix a 3D complex vector with indexes [subcarrier, digital layerInd, analog layerInd]
  */
-virtual complex3DVector_t GetDigitalCombining ();
+virtual const complex3DVector_t& GetDigitalCombining ();
+
+  /**
+   * Returns an identifier of the current configuration of the array, which
+   * changes whenever the beamforming vectors, the number of layers, the omni
+   * mode or the digital combining are modified. It can be used to check if
+   * a quantity computed with a previous configuration is still valid.
+   * \return the identifier of the configuration
+   */
+  uint64_t GetConfigurationId () const;
 
 
 private:
@@ -273,6 +296,8 @@ protected:
 
   bool m_activeDigitalCombining;
   complex3DVector_t m_currDigitalCombining;
+
+  uint64_t m_configurationId; //!< incremented at each change of the beamforming configuration
 };
 
 } /* namespace ns3 */
@@ -22,13 +22,17 @@
 #include "default-simulator-impl.h"
 #include "scheduler.h"
 #include "event-impl.h"
+#include "parallel-event-impl.h"
 
 #include "ptr.h"
 #include "pointer.h"
+#include "uinteger.h"
 #include "assert.h"
 #include "log.h"
 
+#include <algorithm>
 #include <cmath>
+#include <vector>
 
 
 /**
@@ -46,6 +50,31 @@ NS_LOG_COMPONENT_DEFINE ("DefaultSimulatorImpl");
 
 NS_OBJECT_ENSURE_REGISTERED (DefaultSimulatorImpl);
 
+namespace {
+
+/**
+ * \ingroup simulator
+ * A thread running the prepare steps of the parallel events with indices
+ * m_first, m_first + m_step, m_first + 2 * m_step, ...
+ */
+struct ParallelEventWorker
+{
+  /** Run the prepare steps of the events of this worker. */
+  void Run (void)
+  {
+    for (std::size_t i = m_first; i < m_events->size (); i += m_step)
+      {
+        (*m_events)[i]->Prepare ();
+      }
+  }
+
+  const std::vector<ParallelEventImpl *> *m_events; //!< the events of the batch
+  std::size_t m_first; //!< the index of the first event of this worker
+  std::size_t m_step; //!< the distance between the indices of the events
+};
+
+} // unnamed namespace
+
 TypeId
 DefaultSimulatorImpl::GetTypeId (void)
 {
@@ -53,6 +82,16 @@ DefaultSimulatorImpl::GetTypeId (void)
     .SetParent<SimulatorImpl> ()
     .SetGroupName ("Core")
     .AddConstructor<DefaultSimulatorImpl> ()
+    .AddAttribute ("ParallelThreads",
+                   "The number of threads, including the simulation thread, which run the "
+                   "prepare steps of the ParallelEventImpl events following each other with "
+                   "the same timestamp, before these events are invoked in order. 0 means that "
+                   "the parallel events are executed as the other events. The results do not "
+                   "depend on the number of threads, but they may differ from the ones obtained "
+                   "with 0, if the parallel events do not discard the stale prepare steps.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&DefaultSimulatorImpl::m_parallelThreads),
+                   MakeUintegerChecker<uint32_t> ())
   ;
   return tid;
 }
@@ -74,6 +113,7 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_eventCount = 0;
   m_eventsWithContextEmpty = true;
   m_main = SystemThread::Self();
+  m_parallelThreads = 0;
 }
 
 DefaultSimulatorImpl::~DefaultSimulatorImpl ()
@@ -87,6 +127,11 @@ DefaultSimulatorImpl::DoDispose (void)
   NS_LOG_FUNCTION (this);
   ProcessEventsWithContext ();
 
+  while (!m_parallelEvents.empty ())
+    {
+      m_parallelEvents.front ().impl->Unref ();
+      m_parallelEvents.pop_front ();
+    }
   while (!m_events->IsEmpty ())
     {
       Scheduler::Event next = m_events->RemoveNext ();
@@ -138,7 +183,21 @@ DefaultSimulatorImpl::GetSystemId (void) const
 void
 DefaultSimulatorImpl::ProcessOneEvent (void)
 {
-  Scheduler::Event next = m_events->RemoveNext ();
+  Scheduler::Event next;
+  if (!m_parallelEvents.empty ())
+    {
+      // the parallel events already prepared precede the ones in the list
+      next = m_parallelEvents.front ();
+      m_parallelEvents.pop_front ();
+    }
+  else
+    {
+      next = m_events->RemoveNext ();
+      if (m_parallelThreads != 0 && dynamic_cast<ParallelEventImpl *> (next.impl) != 0)
+        {
+          PrepareParallelEvents (next);
+        }
+    }
 
   NS_ASSERT (next.key.m_ts >= m_currentTs);
   m_unscheduledEvents--;
@@ -154,10 +213,59 @@ DefaultSimulatorImpl::ProcessOneEvent (void)
   ProcessEventsWithContext ();
 }
 
+void
+DefaultSimulatorImpl::PrepareParallelEvents (const Scheduler::Event &first)
+{
+  NS_ASSERT (first.key.m_ts >= m_currentTs);
+  // the prepare steps may read the current time
+  m_currentTs = first.key.m_ts;
+
+  // all the events of the batch are prepared before the first one is
+  // invoked, hence the prepare steps do not depend on the number of threads
+  std::vector<ParallelEventImpl *> events;
+  events.push_back (static_cast<ParallelEventImpl *> (first.impl));
+  while (!m_events->IsEmpty ())
+    {
+      Scheduler::Event next = m_events->PeekNext ();
+      ParallelEventImpl *event = dynamic_cast<ParallelEventImpl *> (next.impl);
+      if (next.key.m_ts != first.key.m_ts || event == 0)
+        {
+          break;
+        }
+      m_events->RemoveNext ();
+      m_parallelEvents.push_back (next);
+      events.push_back (event);
+    }
+  events.erase (std::remove_if (events.begin (), events.end (),
+                                [] (ParallelEventImpl *event) { return event->IsCancelled (); }),
+                events.end ());
+
+  std::size_t numThreads = std::min<std::size_t> (m_parallelThreads, events.size ());
+  std::vector<ParallelEventWorker> workers (std::max<std::size_t> (numThreads, 1));
+  for (std::size_t i = 0; i < workers.size (); i++)
+    {
+      workers[i].m_events = &events;
+      workers[i].m_first = i;
+      workers[i].m_step = workers.size ();
+    }
+  // the simulation thread runs the first worker and waits for the others
+  std::vector<Ptr<SystemThread> > threads;
+  for (std::size_t i = 1; i < workers.size (); i++)
+    {
+      threads.push_back (Create<SystemThread> (MakeCallback (&ParallelEventWorker::Run, &workers[i])));
+      threads.back ()->Start ();
+    }
+  workers[0].Run ();
+  for (Ptr<SystemThread> thread : threads)
+    {
+      thread->Join ();
+    }
+}
+
 bool 
 DefaultSimulatorImpl::IsFinished (void) const
 {
-  return m_events->IsEmpty () || m_stop;
+  return (m_events->IsEmpty () && m_parallelEvents.empty ()) || m_stop;
 }
 
 void
@@ -199,14 +307,14 @@ DefaultSimulatorImpl::Run (void)
   ProcessEventsWithContext ();
   m_stop = false;
 
-  while (!m_events->IsEmpty () && !m_stop) 
+  while ((!m_events->IsEmpty () || !m_parallelEvents.empty ()) && !m_stop) 
     {
       ProcessOneEvent ();
     }
 
   // If the simulator stopped naturally by lack of events, make a
   // consistency test to check that we didn't lose any events along the way.
-  NS_ASSERT (!m_events->IsEmpty () || m_unscheduledEvents == 0);
+  NS_ASSERT (!m_events->IsEmpty () || !m_parallelEvents.empty () || m_unscheduledEvents == 0);
 }
 
 void 
@@ -345,6 +453,21 @@ DefaultSimulatorImpl::Remove (const EventId &id)
     {
       return;
     }
+  if (id.GetTs () == m_currentTs)
+    {
+      // the event may have been removed from the list by a parallel batch
+      for (std::deque<Scheduler::Event>::iterator i = m_parallelEvents.begin (); i != m_parallelEvents.end (); i++)
+        {
+          if (i->key.m_uid == id.GetUid ())
+            {
+              i->impl->Cancel ();
+              i->impl->Unref ();
+              m_parallelEvents.erase (i);
+              m_unscheduledEvents--;
+              return;
+            }
+        }
+    }
   Scheduler::Event event;
   event.impl = id.PeekEventImpl ();
   event.key.m_ts = id.GetTs ();
@@ -29,6 +29,7 @@
 
 #include "ptr.h"
 
+#include <deque>
 #include <list>
 
 /**
@@ -84,6 +85,13 @@ private:
 
   /** Process the next event. */
   void ProcessOneEvent (void);
+  /**
+   * Move to m_parallelEvents the parallel events with the same timestamp
+   * which follow a parallel event removed from the event list, and run the
+   * prepare steps of all these events on the worker threads.
+   * \param [in] first The parallel event removed from the event list.
+   */
+  void PrepareParallelEvents (const Scheduler::Event &first);
   /** Move events from a different context into the main event queue. */
   void ProcessEventsWithContext (void);
  
@@ -135,6 +143,18 @@ private:
 
   /** Main execution thread. */
   SystemThread::ThreadId m_main;
+
+  /**
+   * The number of threads running the prepare steps of the parallel
+   * events, including the simulation thread, 0 if the parallel events are
+   * executed as the other events.
+   */
+  uint32_t m_parallelThreads;
+  /**
+   * The parallel events removed from the event list whose prepare step has
+   * been run, to be processed before the events of the event list.
+   */
+  std::deque<Scheduler::Event> m_parallelEvents;
 };
 
 } // namespace ns3
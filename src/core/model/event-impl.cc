@@ -20,6 +20,9 @@
 
 #include "event-impl.h"
 #include "log.h"
+#include "valgrind.h"
+#include "ns3/core-config.h"
+#include <new>
 
 /**
  * \file
@@ -31,6 +34,120 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("EventImpl");
 
+namespace {
+
+/**
+ * \ingroup events
+ * The free lists of the memory of the released events of a thread, one
+ * per size class.
+ */
+class EventImplPool
+{
+public:
+  /** Constructor. */
+  EventImplPool ();
+  /** Destructor, release the memory of the free lists. */
+  ~EventImplPool ();
+  /**
+   * Allocate the memory of an event.
+   * \param [in] size The size of the event.
+   * \returns The memory of the event.
+   */
+  void * Allocate (std::size_t size);
+  /**
+   * Release the memory of an event.
+   * \param [in] p The memory of the event.
+   * \param [in] size The size of the event.
+   */
+  void Deallocate (void *p, std::size_t size);
+
+private:
+  /** The granularity of the size classes, in bytes. */
+  static const std::size_t GRANULARITY = 16;
+  /** The number of size classes, the larger events are not pooled. */
+  static const std::size_t N_CLASSES = 16;
+
+  /** A released block, linked to the next one of its size class. */
+  struct Block
+  {
+    Block *m_next; //!< the next block of the free list
+  };
+
+  Block *m_free[N_CLASSES]; //!< the free lists, by size class
+  bool m_enabled; //!< whether the memory is pooled
+};
+
+EventImplPool::EventImplPool ()
+{
+  for (std::size_t i = 0; i < N_CLASSES; i++)
+    {
+      m_free[i] = 0;
+    }
+#ifdef ENABLE_EVENT_POOL
+  // let valgrind track the events
+  m_enabled = (RUNNING_ON_VALGRIND == 0);
+#else
+  m_enabled = false;
+#endif
+}
+
+EventImplPool::~EventImplPool ()
+{
+  for (std::size_t i = 0; i < N_CLASSES; i++)
+    {
+      while (m_free[i] != 0)
+        {
+          Block *block = m_free[i];
+          m_free[i] = block->m_next;
+          ::operator delete (block);
+        }
+    }
+  // the events released after the end of the thread are freed
+  m_enabled = false;
+}
+
+void *
+EventImplPool::Allocate (std::size_t size)
+{
+  if (size > GRANULARITY * N_CLASSES)
+    {
+      return ::operator new (size);
+    }
+  // the size is rounded up also when the pool is disabled, since the
+  // event can be released to the pool of another thread
+  std::size_t sizeClass = (size - 1) / GRANULARITY;
+  Block *block = m_free[sizeClass];
+  if (!m_enabled || block == 0)
+    {
+      return ::operator new ((sizeClass + 1) * GRANULARITY);
+    }
+  m_free[sizeClass] = block->m_next;
+  return block;
+}
+
+void
+EventImplPool::Deallocate (void *p, std::size_t size)
+{
+  if (!m_enabled || size > GRANULARITY * N_CLASSES)
+    {
+      ::operator delete (p);
+      return;
+    }
+  std::size_t sizeClass = (size - 1) / GRANULARITY;
+  Block *block = static_cast<Block *> (p);
+  block->m_next = m_free[sizeClass];
+  m_free[sizeClass] = block;
+}
+
+/**
+ * \ingroup events
+ * The pool of the current thread, since the events of the realtime and
+ * threaded simulators can be created and released by other threads.
+ */
+thread_local EventImplPool g_eventImplPool;
+
+} // unnamed namespace
+
 EventImpl::~EventImpl ()
 {
   NS_LOG_FUNCTION (this);
@@ -66,4 +183,16 @@ EventImpl::IsCancelled (void)
   return m_cancel;
 }
 
+void *
+EventImpl::operator new (std::size_t size)
+{
+  return g_eventImplPool.Allocate (size);
+}
+
+void
+EventImpl::operator delete (void *p, std::size_t size)
+{
+  g_eventImplPool.Deallocate (p, size);
+}
+
 } // namespace ns3
@@ -21,6 +21,7 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <cstddef>
 #include "simple-ref-count.h"
 
 /**
@@ -40,6 +41,11 @@ namespace ns3 {
  * when it reaches the time associated to this event. Most subclasses
  * are usually created by one of the many Simulator::Schedule
  * methods.
+ *
+ * The memory of the released events is kept in per-thread free lists,
+ * one per size class, and reused by the next events of the same size,
+ * unless the pool is disabled with --disable-event-pool at configuration
+ * time or the program runs under valgrind.
  */
 class EventImpl : public SimpleRefCount<EventImpl>
 {
@@ -66,6 +72,19 @@ public:
    */
   bool IsCancelled (void);
 
+  /**
+   * Allocate the memory of an event from the pool of the current thread.
+   * \param [in] size The size of the event.
+   * \returns The memory of the event.
+   */
+  static void * operator new (std::size_t size);
+  /**
+   * Release the memory of an event to the pool of the current thread.
+   * \param [in] p The memory of the event.
+   * \param [in] size The size of the event.
+   */
+  static void operator delete (void *p, std::size_t size);
+
 protected:
   /**
    * Implementation for Invoke().
@@ -0,0 +1,57 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 SIGNET Lab, Department of Information Engineering,
+ * University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "parallel-event-impl.h"
+
+/**
+ * \file
+ * \ingroup events
+ * ns3::ParallelEventImpl definitions.
+ */
+
+namespace ns3 {
+
+ParallelEventImpl::ParallelEventImpl ()
+  : m_prepared (false)
+{
+}
+
+ParallelEventImpl::~ParallelEventImpl ()
+{
+}
+
+void
+ParallelEventImpl::Prepare (void)
+{
+  // no logging, this may run on a worker thread
+  if (!m_prepared)
+    {
+      DoPrepare ();
+      m_prepared = true;
+    }
+}
+
+void
+ParallelEventImpl::Notify (void)
+{
+  Prepare ();
+  DoCommit ();
+}
+
+} // namespace ns3
@@ -0,0 +1,88 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 SIGNET Lab, Department of Information Engineering,
+ * University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PARALLEL_EVENT_IMPL_H
+#define PARALLEL_EVENT_IMPL_H
+
+#include "event-impl.h"
+
+/**
+ * \file
+ * \ingroup events
+ * ns3::ParallelEventImpl declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup events
+ * \brief A simulation event whose execution is split in a prepare step,
+ * which can run concurrently with the prepare steps of other events, and a
+ * commit step, which runs on the simulation thread.
+ *
+ * When the DefaultSimulatorImpl::ParallelThreads attribute is not 0, the
+ * simulator removes from the event list the parallel events which follow
+ * each other with the same timestamp, runs their prepare steps on a pool of
+ * threads and then invokes them one by one, in the order of the event
+ * list. Otherwise, and with the other simulator implementations, the
+ * prepare step runs when the event is invoked.
+ *
+ * The prepare step runs while the simulation thread is blocked, but it may
+ * run concurrently with the prepare steps of the other events of the batch.
+ * Hence it must only modify the state of the event and must not schedule
+ * events, copy or release Ptr to objects shared with other events, or query
+ * objects which update their state when read, e.g., the mobility models.
+ * These operations belong to the commit step, which must also check that
+ * the result of the prepare step is still valid, since the events of the
+ * batch which precede it may have changed the state of the simulation.
+ */
+class ParallelEventImpl : public EventImpl
+{
+public:
+  /** Default constructor. */
+  ParallelEventImpl ();
+  /** Destructor. */
+  virtual ~ParallelEventImpl ();
+  /**
+   * Run the prepare step of the event, if it has not been run yet.
+   * Called by the simulation engine, possibly on a worker thread.
+   */
+  void Prepare (void);
+
+protected:
+  /**
+   * Implementation of the prepare step of the event.
+   */
+  virtual void DoPrepare (void) = 0;
+  /**
+   * Implementation of the commit step of the event, called on the
+   * simulation thread after the prepare step.
+   */
+  virtual void DoCommit (void) = 0;
+
+private:
+  /** Run the prepare step, if needed, and the commit step. */
+  virtual void Notify (void);
+
+  bool m_prepared; //!< true if the prepare step has been run
+};
+
+} // namespace ns3
+
+#endif /* PARALLEL_EVENT_IMPL_H */
@@ -0,0 +1,413 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 SIGNET Lab, Department of Information Engineering,
+ * University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "timing-wheel-scheduler.h"
+#include "event-impl.h"
+#include "assert.h"
+#include "log.h"
+#include "uinteger.h"
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::TimingWheelScheduler implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TimingWheelScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (TimingWheelScheduler);
+
+namespace {
+
+/**
+ * \ingroup scheduler
+ * Compare the keys of two events.
+ * \param [in] a The first event.
+ * \param [in] b The second event.
+ * \returns \c true if \p a is before \p b.
+ */
+bool
+EventLess (const Scheduler::Event &a, const Scheduler::Event &b)
+{
+  return a.key < b.key;
+}
+
+} // unnamed namespace
+
+TypeId
+TimingWheelScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TimingWheelScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<TimingWheelScheduler> ()
+    .AddAttribute ("Tick",
+                   "The duration of the ticks of the wheel, the events of a tick "
+                   "are stored in the same bucket.",
+                   TimeValue (MicroSeconds (1)),
+                   MakeTimeAccessor (&TimingWheelScheduler::SetTick,
+                                     &TimingWheelScheduler::GetTick),
+                   MakeTimeChecker (TimeStep (1)))
+    .AddAttribute ("Slots",
+                   "The number of buckets of the wheel, rounded up to a power of 2. "
+                   "The events farther than Slots ticks are stored in a std::map.",
+                   UintegerValue (8192),
+                   MakeUintegerAccessor (&TimingWheelScheduler::SetSlots,
+                                         &TimingWheelScheduler::GetSlots),
+                   MakeUintegerChecker<uint32_t> (64, 1U << 24))
+  ;
+  return tid;
+}
+
+TimingWheelScheduler::TimingWheelScheduler ()
+  : m_tick (1),
+    m_slots (0),
+    m_currentTick (0),
+    m_wheelSize (0)
+{
+  NS_LOG_FUNCTION (this);
+  SetTick (MicroSeconds (1));
+  SetSlots (8192);
+}
+
+TimingWheelScheduler::~TimingWheelScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+TimingWheelScheduler::SetTick (Time tick)
+{
+  NS_LOG_FUNCTION (this << tick);
+  NS_ASSERT_MSG (m_wheelSize == 0 && m_overflow.empty (), "The tick cannot be changed while events are stored");
+  NS_ASSERT_MSG (tick.IsStrictlyPositive (), "The tick must be positive");
+  m_tick = tick.GetTimeStep ();
+  m_currentTick = 0;
+}
+
+Time
+TimingWheelScheduler::GetTick (void) const
+{
+  return TimeStep (m_tick);
+}
+
+void
+TimingWheelScheduler::SetSlots (uint32_t slots)
+{
+  NS_LOG_FUNCTION (this << slots);
+  NS_ASSERT_MSG (m_wheelSize == 0 && m_overflow.empty (), "The number of slots cannot be changed while events are stored");
+  // a multiple of 64 is needed by the bitmap, a power of 2 by the bucket
+  // lookup
+  m_slots = 64;
+  while (m_slots < slots)
+    {
+      m_slots <<= 1;
+    }
+  m_wheel.clear ();
+  m_wheel.resize (m_slots);
+  m_occupied.assign (m_slots / 64, 0);
+}
+
+uint32_t
+TimingWheelScheduler::GetSlots (void) const
+{
+  return m_slots;
+}
+
+uint64_t
+TimingWheelScheduler::GetTickIndex (uint64_t ts) const
+{
+  return ts / m_tick;
+}
+
+void
+TimingWheelScheduler::InsertInWheel (const Event &ev, uint64_t tick)
+{
+  uint32_t index = tick & (m_slots - 1);
+  Bucket &bucket = m_wheel[index];
+  std::vector<Event> &events = bucket.m_events;
+  m_wheelSize++;
+  if (IsSorted (bucket) && (events.empty () || EventLess (events.back (), ev)))
+    {
+      events.push_back (ev);
+      bucket.m_sortedEnd++;
+    }
+  else if (tick == m_currentTick && IsSorted (bucket))
+    {
+      // the bucket being consumed is not sorted again
+      std::pair<EventMap::iterator,bool> result = m_late.insert (std::make_pair (ev.key, ev.impl));
+      NS_ASSERT (result.second);
+      return;
+    }
+  else
+    {
+      events.push_back (ev);
+    }
+  bucket.m_size++;
+  m_occupied[index / 64] |= (1ULL << (index % 64));
+}
+
+void
+TimingWheelScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  uint64_t tick = GetTickIndex (ev.key.m_ts);
+  NS_ASSERT_MSG (tick >= m_currentTick, "The event is scheduled before the current tick");
+  if (tick - m_currentTick < m_slots)
+    {
+      InsertInWheel (ev, tick);
+    }
+  else
+    {
+      std::pair<EventMap::iterator,bool> result = m_overflow.insert (std::make_pair (ev.key, ev.impl));
+      NS_ASSERT (result.second);
+    }
+}
+
+bool
+TimingWheelScheduler::IsEmpty (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_wheelSize == 0 && m_overflow.empty ();
+}
+
+uint32_t
+TimingWheelScheduler::FindNextBucket (void) const
+{
+  NS_ASSERT (m_wheelSize > 0);
+  uint32_t start = m_currentTick & (m_slots - 1);
+  uint32_t numWords = m_occupied.size ();
+  uint32_t word = start / 64;
+  // the buckets of the first word before the current one hold the ticks
+  // of the next rotation, they are checked after a full round
+  uint64_t bits = m_occupied[word] & (~0ULL << (start % 64));
+  for (uint32_t i = 0; i <= numWords; i++)
+    {
+      if (bits != 0)
+        {
+          return word * 64 + __builtin_ctzll (bits);
+        }
+      word = (word + 1) % numWords;
+      bits = m_occupied[word];
+    }
+  NS_FATAL_ERROR ("The wheel has no non-empty bucket");
+  return 0;
+}
+
+bool
+TimingWheelScheduler::IsSorted (const Bucket &bucket)
+{
+  return bucket.m_sortedEnd == bucket.m_events.size ();
+}
+
+TimingWheelScheduler::Bucket &
+TimingWheelScheduler::GetSortedBucket (uint32_t index) const
+{
+  Bucket &bucket = m_wheel[index];
+  if (!IsSorted (bucket))
+    {
+      std::vector<Event>::iterator sortedEnd = bucket.m_events.begin () + bucket.m_sortedEnd;
+      std::sort (sortedEnd, bucket.m_events.end (), &EventLess);
+      std::inplace_merge (bucket.m_events.begin () + bucket.m_head, sortedEnd, bucket.m_events.end (), &EventLess);
+      bucket.m_sortedEnd = bucket.m_events.size ();
+      UpdateBucket (index);
+    }
+  return bucket;
+}
+
+bool
+TimingWheelScheduler::IsCurrentBucketFirst (void) const
+{
+  NS_ASSERT (!m_late.empty ());
+  uint32_t index = m_currentTick & (m_slots - 1);
+  if ((m_occupied[index / 64] & (1ULL << (index % 64))) == 0)
+    {
+      return false;
+    }
+  const Bucket &bucket = GetSortedBucket (index);
+  return bucket.m_events[bucket.m_head].key < m_late.begin ()->first;
+}
+
+Scheduler::Event
+TimingWheelScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  // the late events belong to the current tick, hence they are before the
+  // events of the other buckets
+  if (!m_late.empty ())
+    {
+      if (IsCurrentBucketFirst ())
+        {
+          const Bucket &bucket = m_wheel[m_currentTick & (m_slots - 1)];
+          return bucket.m_events[bucket.m_head];
+        }
+      Event ev;
+      ev.impl = m_late.begin ()->second;
+      ev.key = m_late.begin ()->first;
+      return ev;
+    }
+  // the overflow events are all after the horizon of the wheel, hence
+  // after the events of the wheel
+  if (m_wheelSize > 0)
+    {
+      const Bucket &bucket = GetSortedBucket (FindNextBucket ());
+      return bucket.m_events[bucket.m_head];
+    }
+  NS_ASSERT (!m_overflow.empty ());
+  Event ev;
+  ev.impl = m_overflow.begin ()->second;
+  ev.key = m_overflow.begin ()->first;
+  return ev;
+}
+
+void
+TimingWheelScheduler::MigrateOverflow (void)
+{
+  while (!m_overflow.empty ())
+    {
+      EventMap::iterator it = m_overflow.begin ();
+      uint64_t tick = GetTickIndex (it->first.m_ts);
+      if (tick - m_currentTick >= m_slots)
+        {
+          break;
+        }
+      Event ev;
+      ev.impl = it->second;
+      ev.key = it->first;
+      InsertInWheel (ev, tick);
+      m_overflow.erase (it);
+    }
+}
+
+void
+TimingWheelScheduler::UpdateBucket (uint32_t index) const
+{
+  Bucket &bucket = m_wheel[index];
+  if (bucket.m_size == 0)
+    {
+      // keep the capacity of the bucket for the next rotations
+      bucket.m_events.clear ();
+      bucket.m_head = 0;
+      bucket.m_sortedEnd = 0;
+      m_occupied[index / 64] &= ~(1ULL << (index % 64));
+    }
+  else
+    {
+      while (bucket.m_head < bucket.m_sortedEnd && bucket.m_events[bucket.m_head].impl == 0)
+        {
+          bucket.m_head++;
+        }
+    }
+}
+
+Scheduler::Event
+TimingWheelScheduler::PopBucket (uint32_t index)
+{
+  Bucket &bucket = m_wheel[index];
+  Event ev = bucket.m_events[bucket.m_head++];
+  bucket.m_size--;
+  m_wheelSize--;
+  UpdateBucket (index);
+  return ev;
+}
+
+Scheduler::Event
+TimingWheelScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_late.empty ())
+    {
+      // the current tick does not change
+      if (IsCurrentBucketFirst ())
+        {
+          return PopBucket (m_currentTick & (m_slots - 1));
+        }
+      Event ev;
+      ev.impl = m_late.begin ()->second;
+      ev.key = m_late.begin ()->first;
+      m_late.erase (m_late.begin ());
+      m_wheelSize--;
+      return ev;
+    }
+  if (m_wheelSize == 0)
+    {
+      // jump to the first overflow event, which is then in the wheel
+      NS_ASSERT (!m_overflow.empty ());
+      m_currentTick = GetTickIndex (m_overflow.begin ()->first.m_ts);
+      MigrateOverflow ();
+    }
+  uint32_t index = FindNextBucket ();
+  GetSortedBucket (index);
+  Event ev = PopBucket (index);
+  uint64_t tick = GetTickIndex (ev.key.m_ts);
+  if (tick != m_currentTick)
+    {
+      m_currentTick = tick;
+      MigrateOverflow ();
+    }
+  NS_LOG_DEBUG (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  return ev;
+}
+
+void
+TimingWheelScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  uint64_t tick = GetTickIndex (ev.key.m_ts);
+  if (tick - m_currentTick >= m_slots)
+    {
+      EventMap::iterator it = m_overflow.find (ev.key);
+      NS_ASSERT (it != m_overflow.end () && it->second == ev.impl);
+      m_overflow.erase (it);
+      return;
+    }
+  if (tick == m_currentTick && m_late.erase (ev.key) > 0)
+    {
+      m_wheelSize--;
+      return;
+    }
+  uint32_t index = tick & (m_slots - 1);
+  Bucket &bucket = m_wheel[index];
+  if (bucket.m_events.size () - bucket.m_sortedEnd > 64)
+    {
+      // bound the linear search of the unsorted events
+      GetSortedBucket (index);
+    }
+  std::vector<Event>::iterator sortedEnd = bucket.m_events.begin () + bucket.m_sortedEnd;
+  std::vector<Event>::iterator it = std::lower_bound (bucket.m_events.begin () + bucket.m_head, sortedEnd, ev, &EventLess);
+  if (it == sortedEnd || it->impl != ev.impl)
+    {
+      it = sortedEnd;
+      while (it != bucket.m_events.end () && it->impl != ev.impl)
+        {
+          ++it;
+        }
+    }
+  NS_ASSERT (it != bucket.m_events.end () && it->impl == ev.impl);
+  // the event is not erased, to avoid moving the following ones
+  it->impl = 0;
+  bucket.m_size--;
+  m_wheelSize--;
+  UpdateBucket (index);
+}
+
+} // namespace ns3
@@ -0,0 +1,186 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 SIGNET Lab, Department of Information Engineering,
+ * University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TIMING_WHEEL_SCHEDULER_H
+#define TIMING_WHEEL_SCHEDULER_H
+
+#include "scheduler.h"
+#include "nstime.h"
+#include <stdint.h>
+#include <map>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::TimingWheelScheduler declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief a timing wheel event scheduler
+ *
+ * The time is divided in ticks of fixed duration and the events of the
+ * next Slots ticks are stored in a circular array of buckets, one per tick,
+ * while the farther events are stored in an overflow std::map and moved to
+ * the wheel when the current time gets close to them.
+ *
+ * As in a ladder queue, the events are appended to their bucket and a
+ * bucket is sorted by key only when its first event is needed, or when too
+ * many unsorted events would have to be searched by Remove. Since the events
+ * with the same timestamp are inserted with increasing uids, the buckets are
+ * usually already sorted and the insertion and removal of the events of the
+ * wheel take constant time. The events inserted out of order in the bucket
+ * being consumed, e.g., the ones scheduled with zero delay while later
+ * events of the same tick are pending, are kept in a std::map instead.
+ *
+ * This suits the simulations where most events are scheduled a few slots
+ * ahead on the boundaries of a TDMA frame structure, e.g., on the OFDM
+ * symbols of the mmWave phy, if the Tick is not larger than the symbol
+ * period. A Remove costs up to the number of events of the tick.
+ *
+ * The empty buckets are skipped by scanning a bitmap of the non-empty ones.
+ */
+class TimingWheelScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  TimingWheelScheduler ();
+  /** Destructor. */
+  virtual ~TimingWheelScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+private:
+  /**
+   * The events of a tick, starting from m_head. The removed events are
+   * left in place with a null impl until the bucket is emptied.
+   */
+  struct Bucket
+  {
+    std::vector<Scheduler::Event> m_events; //!< the events, the ones before m_head are already removed
+    uint32_t m_head = 0; //!< the index of the first event of the bucket
+    uint32_t m_size = 0; //!< the number of events of the bucket which are not removed
+    uint32_t m_sortedEnd = 0; //!< the end of the events sorted by key, the following ones are unsorted
+  };
+
+  /**
+   * Set the duration of the ticks of the wheel. It cannot be changed
+   * while events are stored.
+   * \param [in] tick The duration of a tick.
+   */
+  void SetTick (Time tick);
+  /**
+   * Get the duration of the ticks of the wheel.
+   * \returns The duration of a tick.
+   */
+  Time GetTick (void) const;
+  /**
+   * Set the number of buckets of the wheel. It cannot be changed while
+   * events are stored.
+   * \param [in] slots The number of buckets, rounded up to a power of 2.
+   */
+  void SetSlots (uint32_t slots);
+  /**
+   * Get the number of buckets of the wheel.
+   * \returns The number of buckets.
+   */
+  uint32_t GetSlots (void) const;
+  /**
+   * Get the tick of a timestamp.
+   * \param [in] ts The timestamp, in dimensionless time units.
+   * \returns The index of the tick, counted from time 0.
+   */
+  inline uint64_t GetTickIndex (uint64_t ts) const;
+  /**
+   * Insert an event in the bucket of its tick, which must be within the
+   * horizon of the wheel.
+   * \param [in] ev The event.
+   * \param [in] tick The tick of the event.
+   */
+  void InsertInWheel (const Scheduler::Event &ev, uint64_t tick);
+  /**
+   * Find the first non-empty bucket, starting from the current tick. The
+   * wheel must not be empty.
+   * \returns The index of the bucket.
+   */
+  uint32_t FindNextBucket (void) const;
+  /**
+   * Check whether all the events of a bucket are sorted.
+   * \param [in] bucket The bucket.
+   * \returns \c true if the bucket is sorted.
+   */
+  static bool IsSorted (const Bucket &bucket);
+  /**
+   * Get a bucket, sorting its events if needed.
+   * \param [in] index The index of the bucket.
+   * \returns The sorted bucket.
+   */
+  Bucket & GetSortedBucket (uint32_t index) const;
+  /**
+   * Clear a bucket whose events are all removed, or move the head of a
+   * sorted bucket past its removed events.
+   * \param [in] index The index of the bucket.
+   */
+  void UpdateBucket (uint32_t index) const;
+  /**
+   * Remove the first event of a non-empty sorted bucket.
+   * \param [in] index The index of the bucket.
+   * \returns The event.
+   */
+  Scheduler::Event PopBucket (uint32_t index);
+  /**
+   * Check whether the next event is the first one of the bucket of the
+   * current tick, rather than the first late event. There must be late
+   * events.
+   * \returns \c true if the next event is in the bucket of the current tick.
+   */
+  bool IsCurrentBucketFirst (void) const;
+  /** Move the overflow events within the horizon of the wheel to the wheel. */
+  void MigrateOverflow (void);
+
+  /** Overflow list type: a Map from EventKey to EventImpl. */
+  typedef std::map<Scheduler::EventKey, EventImpl*> EventMap;
+
+  uint64_t m_tick; //!< the duration of a tick, in dimensionless time units
+  uint32_t m_slots; //!< the number of buckets, a power of 2
+  mutable std::vector<Bucket> m_wheel; //!< the buckets, the one of tick t is at t & (m_slots - 1)
+  mutable std::vector<uint64_t> m_occupied; //!< the bitmap of the non-empty buckets
+  uint64_t m_currentTick; //!< the tick of the last event removed
+  uint32_t m_wheelSize; //!< the number of events in the wheel, including the late events
+  EventMap m_late; //!< the events inserted out of order in the bucket of the current tick
+  EventMap m_overflow; //!< the events after the horizon of the wheel
+};
+
+} // namespace ns3
+
+#endif /* TIMING_WHEEL_SCHEDULER_H */
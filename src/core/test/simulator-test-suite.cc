@@ -23,6 +23,11 @@
 #include "ns3/heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/timing-wheel-scheduler.h"
+#include "ns3/uinteger.h"
+#include "ns3/parallel-event-impl.h"
+#include "ns3/config.h"
+#include <vector>
 
 using namespace ns3;
 
@@ -461,6 +466,117 @@ SimulatorTemplateTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class SimulatorParallelEventsTestCase : public TestCase
+{
+public:
+  SimulatorParallelEventsTestCase (uint32_t threads);
+  virtual void DoRun (void);
+  void EventN (void);
+  void EventX (void);
+
+  class ParallelEvent : public ParallelEventImpl
+  {
+  public:
+    ParallelEvent (SimulatorParallelEventsTestCase *test, int id);
+    virtual void DoPrepare (void);
+    virtual void DoCommit (void);
+    SimulatorParallelEventsTestCase *m_test;
+    int m_id;
+    int m_value;
+    uint32_t m_commitsBeforePrepare;
+  };
+
+  uint32_t m_threads;
+  uint32_t m_commits;
+  std::vector<int> m_order;
+  std::vector<uint32_t> m_commitsBeforePrepare;
+  EventId m_idRemoved;
+};
+
+SimulatorParallelEventsTestCase::ParallelEvent::ParallelEvent (SimulatorParallelEventsTestCase *test, int id)
+  : m_test (test),
+    m_id (id),
+    m_value (0),
+    m_commitsBeforePrepare (0)
+{
+}
+
+void
+SimulatorParallelEventsTestCase::ParallelEvent::DoPrepare (void)
+{
+  // only the state of the event is modified
+  m_value = m_id * 2;
+  m_commitsBeforePrepare = m_test->m_commits;
+}
+
+void
+SimulatorParallelEventsTestCase::ParallelEvent::DoCommit (void)
+{
+  m_test->m_commits++;
+  m_test->m_order.push_back (m_value / 2);
+  m_test->m_commitsBeforePrepare.push_back (m_commitsBeforePrepare);
+  if (m_id == 1)
+    {
+      Simulator::Remove (m_test->m_idRemoved);
+      Simulator::ScheduleNow (&SimulatorParallelEventsTestCase::EventX, m_test);
+    }
+}
+
+SimulatorParallelEventsTestCase::SimulatorParallelEventsTestCase (uint32_t threads)
+  : TestCase ("Check the order of the parallel events with " + std::to_string (threads) + " threads"),
+    m_threads (threads),
+    m_commits (0)
+{
+}
+
+void
+SimulatorParallelEventsTestCase::EventN (void)
+{
+  m_order.push_back (-1);
+}
+
+void
+SimulatorParallelEventsTestCase::EventX (void)
+{
+  m_order.push_back (-2);
+}
+
+void
+SimulatorParallelEventsTestCase::DoRun (void)
+{
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::ParallelThreads", UintegerValue (m_threads));
+  // the simulator implementation is created with the new default
+  Simulator::Destroy ();
+
+  Simulator::Schedule (Seconds (1), Ptr<EventImpl> (new ParallelEvent (this, 0), false));
+  Simulator::Schedule (Seconds (1), Ptr<EventImpl> (new ParallelEvent (this, 1), false));
+  m_idRemoved = Simulator::Schedule (Seconds (1), Ptr<EventImpl> (new ParallelEvent (this, 2), false));
+  Simulator::Schedule (Seconds (1), &SimulatorParallelEventsTestCase::EventN, this);
+  Simulator::Schedule (Seconds (1), Ptr<EventImpl> (new ParallelEvent (this, 3), false));
+  Simulator::Schedule (Seconds (1), Ptr<EventImpl> (new ParallelEvent (this, 4), false));
+  Simulator::Schedule (Seconds (2), Ptr<EventImpl> (new ParallelEvent (this, 5), false));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::ParallelThreads", UintegerValue (0));
+
+  std::vector<int> order = {0, 1, -1, 3, 4, -2, 5};
+  NS_TEST_ASSERT_MSG_EQ (m_order.size (), order.size (), "Wrong number of events");
+  for (std::size_t i = 0; i < order.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_order[i], order[i], "Wrong order of the events");
+    }
+  // the events of a batch are prepared before the first one is committed
+  std::vector<uint32_t> commitsBeforePrepare = {0, 0, 2, 2, 4};
+  if (m_threads == 0)
+    {
+      commitsBeforePrepare = {0, 1, 2, 3, 4};
+    }
+  for (std::size_t i = 0; i < commitsBeforePrepare.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_commitsBeforePrepare[i], commitsBeforePrepare[i], "Wrong prepare step of event " << i);
+    }
+}
+
 class SimulatorTestSuite : public TestSuite
 {
 public:
@@ -477,5 +593,14 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (CalendarScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (TimingWheelScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    // a short wheel, so that the events are moved from the overflow map
+    factory.Set ("Slots", UintegerValue (64));
+    factory.Set ("Tick", TimeValue (NanoSeconds (1)));
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    AddTestCase (new SimulatorParallelEventsTestCase (0), TestCase::QUICK);
+    AddTestCase (new SimulatorParallelEventsTestCase (1), TestCase::QUICK);
+    AddTestCase (new SimulatorParallelEventsTestCase (4), TestCase::QUICK);
   }
 } g_simulatorTestSuite;
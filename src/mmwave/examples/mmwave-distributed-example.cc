@@ -0,0 +1,166 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2020 SIGNET Lab, Department of Information Engineering,
+ *   University of Padova
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Multi-cell HBF scenario distributed across MPI ranks, e.g.,
+ *
+ *   mpirun -np 2 ./waf --run "mmwave-distributed-example --numEnb=4"
+ *
+ * The eNBs are placed on a line and assigned to the ranks in round robin,
+ * each with its UEs, and share a MmWaveDistributedSpectrumChannel. Every
+ * rank creates the whole scenario, but only attaches and activates the
+ * bearers of its own UEs, and reports the downlink receptions of its UEs.
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/mmwave-helper.h"
+#include "ns3/mpi-interface.h"
+
+#ifdef NS3_MPI
+#include <mpi.h>
+#endif
+
+using namespace ns3;
+using namespace mmwave;
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveDistributedExample");
+
+#ifdef NS3_MPI
+static uint32_t g_rxTb = 0;        // transport blocks received by the local UEs
+static uint32_t g_corruptTb = 0;   // transport blocks received with errors
+static double g_sinrSumDb = 0;     // sum of the SINRs of the transport blocks
+
+static void
+RxPacketTraceUe (RxPacketTraceParams params)
+{
+  g_rxTb++;
+  g_corruptTb += params.m_corrupt;
+  g_sinrSumDb += 10 * std::log10 (params.m_sinr);
+}
+#endif
+
+int
+main (int argc, char *argv[])
+{
+#ifdef NS3_MPI
+  uint16_t numEnb = 2;
+  uint16_t numUe = 3;
+  uint16_t numEnbLayers = 4;
+  double interSiteDistance = 200;
+  double simTime = 0.2;
+
+  CommandLine cmd;
+  cmd.AddValue ("numEnb", "Number of eNBs, assigned to the ranks in round robin", numEnb);
+  cmd.AddValue ("numUe", "Number of UEs per eNB", numUe);
+  cmd.AddValue ("nLayers", "The number of HBF layers per eNB", numEnbLayers);
+  cmd.AddValue ("isd", "Distance between neighboring eNBs [m]", interSiteDistance);
+  cmd.AddValue ("simTime", "Total duration of the simulation [s]", simTime);
+  cmd.Parse (argc, argv);
+
+  GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::DistributedSimulatorImpl"));
+  MpiInterface::Enable (&argc, &argv);
+  uint32_t systemId = MpiInterface::GetSystemId ();
+  uint32_t systemCount = MpiInterface::GetSize ();
+
+  // NR numerology 2, as in scratch/mmwave-hbf.cc
+  Config::SetDefault ("ns3::MmWavePhyMacCommon::SubcarriersPerChunk", UintegerValue (12));
+  Config::SetDefault ("ns3::MmWavePhyMacCommon::ChunkWidth", DoubleValue (12 * 60.0e3));
+  Config::SetDefault ("ns3::MmWavePhyMacCommon::ChunkPerRB", UintegerValue (275));
+  Config::SetDefault ("ns3::MmWavePhyMacCommon::SymbolsPerSubframe", UintegerValue (14));
+  Config::SetDefault ("ns3::MmWavePhyMacCommon::NumRefSCPerSym", UintegerValue (275 / 2));
+  Config::SetDefault ("ns3::MmWavePhyMacCommon::SubframePeriod", DoubleValue (250.0));
+  Config::SetDefault ("ns3::MmWavePhyMacCommon::SymbolPeriod", DoubleValue (250.0 / 14));
+  Config::SetDefault ("ns3::MmWavePhyMacCommon::TbDecodeLatency", UintegerValue (200.0));
+  Config::SetDefault ("ns3::MmWavePhyMacCommon::NumEnbLayers", UintegerValue (numEnbLayers));
+  Config::SetDefault ("ns3::MmWaveAsyncHbfMacScheduler::CqiTimerThreshold", UintegerValue (100));
+
+  Ptr<MmWaveHelper> mmwaveHelper = CreateObject<MmWaveHelper> ();
+  mmwaveHelper->SetSpectrumChannelType ("ns3::MmWaveDistributedSpectrumChannel");
+  mmwaveHelper->SetSchedulerType ("ns3::MmWaveAsyncHbfMacScheduler");
+  mmwaveHelper->SetBeamformerType ("ns3::MmWaveMMSESpectrumBeamforming");
+  mmwaveHelper->SetPathlossModelType ("ns3::ThreeGppUmaPropagationLossModel");
+  mmwaveHelper->SetChannelConditionModelType ("ns3::ThreeGppUmaChannelConditionModel");
+  mmwaveHelper->SetChannelModelType ("ns3::ThreeGppSpectrumPropagationLossModel");
+  mmwaveHelper->SetChannelModelAttribute ("Scenario", StringValue ("UMa"));
+
+  // all the ranks create all the nodes, in the same order
+  NodeContainer enbNodes;
+  std::vector<NodeContainer> ueNodes (numEnb);
+  for (uint16_t i = 0; i < numEnb; i++)
+    {
+      enbNodes.Add (CreateObject<Node> (i % systemCount));
+    }
+  for (uint16_t i = 0; i < numEnb; i++)
+    {
+      ueNodes[i].Create (numUe, i % systemCount);
+    }
+
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  for (uint16_t i = 0; i < numEnb; i++)
+    {
+      Ptr<ListPositionAllocator> enbPositionAlloc = CreateObject<ListPositionAllocator> ();
+      enbPositionAlloc->Add (Vector (i * interSiteDistance, 0.0, 25.0));
+      mobility.SetPositionAllocator (enbPositionAlloc);
+      mobility.Install (enbNodes.Get (i));
+
+      Ptr<UniformDiscPositionAllocator> uePositionAlloc = CreateObject<UniformDiscPositionAllocator> ();
+      uePositionAlloc->SetX (i * interSiteDistance);
+      uePositionAlloc->SetRho (interSiteDistance / 4);
+      uePositionAlloc->SetZ (1.6);
+      mobility.SetPositionAllocator (uePositionAlloc);
+      mobility.Install (ueNodes[i]);
+    }
+
+  NetDeviceContainer enbDevs = mmwaveHelper->InstallEnbDevice (enbNodes);
+  NetDeviceContainer localEnbDevs;
+  NetDeviceContainer localUeDevs;
+  for (uint16_t i = 0; i < numEnb; i++)
+    {
+      NetDeviceContainer ueDevs = mmwaveHelper->InstallUeDevice (ueNodes[i]);
+      if (i % systemCount == systemId)
+        {
+          localEnbDevs.Add (enbDevs.Get (i));
+          localUeDevs.Add (ueDevs);
+        }
+    }
+
+  // the UEs must be on the rank of their eNB
+  mmwaveHelper->AttachToClosestEnb (localUeDevs, localEnbDevs);
+  mmwaveHelper->ActivateDataRadioBearer (localUeDevs, EpsBearer (EpsBearer::GBR_CONV_VOICE));
+
+  Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/ComponentCarrierMapUe/*/MmWaveUePhy/DlSpectrumPhy/RxPacketTraceUe",
+                                 MakeCallback (&RxPacketTraceUe));
+
+  Simulator::Stop (Seconds (simTime));
+  Simulator::Run ();
+
+  std::cout << "Rank " << systemId << ": " << localUeDevs.GetN () << " UEs received " << g_rxTb
+            << " DL transport blocks, " << g_corruptTb << " corrupted, mean SINR "
+            << (g_rxTb > 0 ? g_sinrSumDb / g_rxTb : 0) << " dB" << std::endl;
+
+  Simulator::Destroy ();
+  MpiInterface::Disable ();
+  return 0;
+#else
+  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
+#endif
+}
@@ -130,6 +130,14 @@ MmWaveHelper::GetTypeId (void)
                    StringValue ("ns3::ThreeGppSpectrumPropagationLossModel"),
                    MakeStringAccessor (&MmWaveHelper::SetChannelModelType),
                    MakeStringChecker ())
+    .AddAttribute ("SpectrumChannelType",
+                   "The type of the spectrum channel of the mmWave devices. "
+                   "The allowed values for this attributes are the type names "
+                   "of any class inheriting from ns3::SpectrumChannel, e.g., "
+                   "ns3::MmWaveDistributedSpectrumChannel for MPI simulations.",
+                   StringValue ("ns3::MultiModelSpectrumChannel"),
+                   MakeStringAccessor (&MmWaveHelper::SetSpectrumChannelType),
+                   MakeStringChecker ())
     .AddAttribute ("Scheduler",
                    "The type of scheduler to be used for MmWave eNBs. "
                    "The allowed values for this attributes are the type names "
@@ -342,6 +350,8 @@ MmWaveHelper::MmWaveChannelModelInitialization (void)
     {
       Ptr<SpectrumChannel> channel = m_channelFactory.Create<SpectrumChannel> ();
       Ptr<MmWavePhyMacCommon> phyMacCommon = m_componentCarrierPhyParams.at (it->first).GetConfigurationParameters ();
+      // the signals forwarded to the other MPI ranks are received in the next slot
+      channel->SetAttributeFailSafe ("Lookahead", TimeValue (Seconds (phyMacCommon->GetTti ())));
 
       // create the channel condition model (if needed)
       Ptr<ChannelConditionModel> ccm;
@@ -453,6 +463,14 @@ MmWaveHelper::SetLtePathlossModelType (std::string type)
   m_ulPathlossModelFactory.SetTypeId (type);
 }
 
+void
+MmWaveHelper::SetSpectrumChannelType (std::string type)
+{
+  NS_LOG_FUNCTION (this << type);
+  m_channelFactory = ObjectFactory ();
+  m_channelFactory.SetTypeId (type);
+}
+
 void
 MmWaveHelper::SetChannelConditionModelType (std::string type)
 {
@@ -2679,6 +2697,26 @@ MmWaveHelper::EnableTraces (void)
   EnableMcTraces ();
 }
 
+void
+MmWaveHelper::EnableBeamformingGainTrace (uint32_t samplingPeriod)
+{
+  NS_LOG_FUNCTION (this << samplingPeriod);
+  NS_ASSERT_MSG (!m_channel.empty (), "EnableBeamformingGainTrace must be called after the installation of the devices");
+  for (std::map< uint8_t, Ptr<SpectrumChannel> >::iterator it = m_channel.begin (); it != m_channel.end (); ++it)
+    {
+      Ptr<ThreeGppSpectrumPropagationLossModel> threeGppSplm =
+        DynamicCast<ThreeGppSpectrumPropagationLossModel> (it->second->GetSpectrumPropagationLossModel ());
+      if (threeGppSplm == 0)
+        {
+          NS_LOG_WARN ("The channel of CC " << (unsigned)it->first << " has no ThreeGppSpectrumPropagationLossModel");
+          continue;
+        }
+      threeGppSplm->SetAttribute ("BeamformingGainSamplingPeriod", UintegerValue (samplingPeriod));
+      threeGppSplm->TraceConnectWithoutContext ("BeamformingGain",
+                                                MakeBoundCallback (&MmWavePhyRxTrace::BeamformingGainCallback, m_phyStats));
+    }
+}
+
 
 // TODO traces for MC
 void
@@ -109,6 +109,11 @@ public:
   NetDeviceContainer InstallInterRatHoCapableUeDevice (NodeContainer c);
   NetDeviceContainer InstallEnbDevice (NodeContainer c);
   NetDeviceContainer InstallLteEnbDevice (NodeContainer c);
+  /**
+   * Set the type of the spectrum channel of the mmWave devices
+   * \param type the type name of a class inheriting from SpectrumChannel
+   */
+  void SetSpectrumChannelType (std::string type);
   void SetChannelConditionModelType (std::string type);
   void SetPathlossModelType (std::string type);
   void SetChannelModelType (std::string type);
@@ -166,6 +171,16 @@ public:
 
   void EnableTraces ();
 
+  /**
+   * Connect the BeamformingGain trace source of the 3GPP spectrum propagation
+   * loss models of the mmWave channels to the beamforming gain trace file of
+   * MmWavePhyRxTrace. It must be called after the installation of the
+   * devices, and it is not enabled by EnableTraces since the gains are
+   * reported for every received PSD.
+   * \param samplingPeriod report one every samplingPeriod gains
+   */
+  void EnableBeamformingGainTrace (uint32_t samplingPeriod = 1);
+
   void SetSchedulerType (std::string type);
   std::string GetSchedulerType () const;
 
@@ -38,6 +38,7 @@
 #include <ns3/log.h>
 #include "mmwave-phy-rx-trace.h"
 #include <ns3/simulator.h>
+#include <ns3/boolean.h>
 #include <stdio.h>
 
 namespace ns3 {
@@ -50,6 +51,9 @@ NS_OBJECT_ENSURE_REGISTERED (MmWavePhyRxTrace);
 
 std::ofstream MmWavePhyRxTrace::m_rxPacketTraceFile;
 std::string MmWavePhyRxTrace::m_rxPacketTraceFilename;
+std::ofstream MmWavePhyRxTrace::m_bfGainTraceFile;
+std::string MmWavePhyRxTrace::m_bfGainTraceFilename;
+bool MmWavePhyRxTrace::m_bfGainTraceBinary = false;
 
 MmWavePhyRxTrace::MmWavePhyRxTrace ()
 {
@@ -61,6 +65,10 @@ MmWavePhyRxTrace::~MmWavePhyRxTrace ()
     {
       m_rxPacketTraceFile.close ();
     }
+  if (m_bfGainTraceFile.is_open ())
+    {
+      m_bfGainTraceFile.close ();
+    }
 }
 
 TypeId
@@ -74,6 +82,16 @@ MmWavePhyRxTrace::GetTypeId (void)
                    StringValue ("RxPacketTrace.txt"),
                    MakeStringAccessor (&MmWavePhyRxTrace::SetOutputFilename),
                    MakeStringChecker ())
+    .AddAttribute ("BeamformingGainFilename",
+                   "Name of the file where the beamforming gains will be saved.",
+                   StringValue ("BfGainTrace.txt"),
+                   MakeStringAccessor (&MmWavePhyRxTrace::SetBeamformingGainFilename),
+                   MakeStringChecker ())
+    .AddAttribute ("BeamformingGainBinary",
+                   "Save the beamforming gains in binary format instead of text.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MmWavePhyRxTrace::SetBeamformingGainBinary),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
@@ -85,6 +103,19 @@ MmWavePhyRxTrace::SetOutputFilename ( std::string fileName)
   m_rxPacketTraceFilename = fileName;
 }
 
+void
+MmWavePhyRxTrace::SetBeamformingGainFilename (std::string fileName)
+{
+  NS_LOG_INFO ("Filename: " << fileName);
+  m_bfGainTraceFilename = fileName;
+}
+
+void
+MmWavePhyRxTrace::SetBeamformingGainBinary (bool binary)
+{
+  m_bfGainTraceBinary = binary;
+}
+
 void
 MmWavePhyRxTrace::ReportCurrentCellRsrpSinrCallback (Ptr<MmWavePhyRxTrace> phyStats, std::string path,
                                                      uint64_t imsi, SpectrumValue& sinr, SpectrumValue& power)
@@ -246,6 +277,45 @@ MmWavePhyRxTrace::RxPacketTraceEnbCallback (Ptr<MmWavePhyRxTrace> phyStats, std:
     }
 }
 
+void
+MmWavePhyRxTrace::BeamformingGainCallback (Ptr<MmWavePhyRxTrace> phyStats, const ThreeGppBeamformingGainParams &params)
+{
+  if (!m_bfGainTraceFile.is_open ())
+    {
+      if (m_bfGainTraceBinary)
+        {
+          m_bfGainTraceFile.open (m_bfGainTraceFilename.c_str (), std::ios::out | std::ios::binary);
+        }
+      else
+        {
+          m_bfGainTraceFile.open (m_bfGainTraceFilename.c_str ());
+        }
+      if (!m_bfGainTraceFile.is_open ())
+        {
+          NS_FATAL_ERROR ("Could not open tracefile");
+        }
+    }
+  if (m_bfGainTraceBinary)
+    {
+      double time = Simulator::Now ().GetSeconds ();
+      m_bfGainTraceFile.write (reinterpret_cast<const char *> (&time), sizeof (time));
+      m_bfGainTraceFile.write (reinterpret_cast<const char *> (&params.m_txNodeId), sizeof (params.m_txNodeId));
+      m_bfGainTraceFile.write (reinterpret_cast<const char *> (&params.m_rxNodeId), sizeof (params.m_rxNodeId));
+      m_bfGainTraceFile.write (reinterpret_cast<const char *> (&params.m_txBeamId), sizeof (params.m_txBeamId));
+      m_bfGainTraceFile.write (reinterpret_cast<const char *> (&params.m_rxBeamId), sizeof (params.m_rxBeamId));
+      m_bfGainTraceFile.write (reinterpret_cast<const char *> (&params.m_txLayerInd), sizeof (params.m_txLayerInd));
+      m_bfGainTraceFile.write (reinterpret_cast<const char *> (&params.m_rxLayerInd), sizeof (params.m_rxLayerInd));
+      m_bfGainTraceFile.write (reinterpret_cast<const char *> (&params.m_gain), sizeof (params.m_gain));
+    }
+  else
+    {
+      m_bfGainTraceFile << Simulator::Now ().GetSeconds () << "\tBF Gain TxId " << params.m_txNodeId << " RxId " << params.m_rxNodeId
+                        << " TxBeam " << params.m_txBeamId << " RxBeam " << params.m_rxBeamId
+                        << " TxLayer " << (unsigned)params.m_txLayerInd << " RxLayer " << (unsigned)params.m_rxLayerInd
+                        << " g= " << params.m_gain << "\n";
+    }
+}
+
 } // namespace mmwave
 
 } /* namespace ns3 */
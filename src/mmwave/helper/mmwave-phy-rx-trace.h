@@ -36,6 +36,7 @@
 #include <ns3/object.h>
 #include <ns3/spectrum-value.h>
 #include <ns3/mmwave-phy-mac-common.h>
+#include <ns3/three-gpp-spectrum-propagation-loss-model.h>
 #include <fstream>
 #include <iostream>
 
@@ -59,7 +60,20 @@ public:
                                     uint64_t imsi, uint64_t tbSize);
   static void RxPacketTraceUeCallback (Ptr<MmWavePhyRxTrace> phyStats, std::string path, RxPacketTraceParams param);
   static void RxPacketTraceEnbCallback (Ptr<MmWavePhyRxTrace> phyStats, std::string path, RxPacketTraceParams param);
+  /**
+   * Write a beamforming gain to the beamforming gain trace file. In text
+   * mode, each line has the format parsed by TBLERstats.py:
+   * time BF Gain TxId t RxId r TxBeam tb RxBeam rb TxLayer tl RxLayer rl g= gain
+   * In binary mode, each record is made of the time in s (double), the tx
+   * and rx node ids, the tx and rx beam ids (uint32_t), the tx and rx
+   * layers (uint8_t) and the gain (double), in the host byte order.
+   * \param phyStats the trace object
+   * \param params the beamforming gain
+   */
+  static void BeamformingGainCallback (Ptr<MmWavePhyRxTrace> phyStats, const ThreeGppBeamformingGainParams &params);
   void SetOutputFilename ( std::string fileName);
+  void SetBeamformingGainFilename (std::string fileName);
+  void SetBeamformingGainBinary (bool binary);
 
 private:
   //void ReportInterferenceTrace (uint64_t imsi, SpectrumValue& sinr);
@@ -69,6 +83,10 @@ private:
 
   static std::ofstream m_rxPacketTraceFile;
   static std::string m_rxPacketTraceFilename;
+
+  static std::ofstream m_bfGainTraceFile;
+  static std::string m_bfGainTraceFilename;
+  static bool m_bfGainTraceBinary; //!< whether the beamforming gains are written in binary format
 };
 
 } // namespace mmwave
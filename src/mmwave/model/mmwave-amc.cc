@@ -481,28 +481,50 @@ MmWaveAmc::CreateCqiFeedbackWbTdma (const SpectrumValue& sinr, uint8_t numSym, u
         }
       sinrAvg /= chunkId;
 
-      mcs = 0;
-      MmWaveTbStats_t tbStats;
-      while (mcs <= 28)
+      // the MI only depends on the modulation, and the code block
+      // segmentation on the TB size, hence they are computed at most once for
+      // each modulation and once for all the MCSs
+      MmWaveCbSegmentation_t segmentation = MmWaveMiErrorModel::GetCodeBlockSegmentation (tbSize);
+      const uint8_t modulationMaxMcs[3] = {MMWAVE_MI_QPSK_MAX_ID, MMWAVE_MI_16QAM_MAX_ID, MMWAVE_MI_64QAM_MAX_ID};
+      double modulationMi[3];
+      bool modulationMiComputed[3] = {false, false, false};
+      MmWaveHarqProcessInfoList_t harqInfoList;
+
+      // the TBLER increases with the MCS, hence the first MCS whose TBLER
+      // exceeds 10% is found with a bisection search, where 29 means that
+      // all the MCSs are below the threshold
+      int firstFailingMcs = 29;
+      int minMcs = 0;
+      while (minMcs < firstFailingMcs)
         {
-          MmWaveHarqProcessInfoList_t harqInfoList;
-          tbStats = MmWaveMiErrorModel::GetTbDecodificationStats (sinr, chunkMap, tbSize, mcs, harqInfoList);
+          int midMcs = (minMcs + firstFailingMcs) / 2;
+          uint8_t modulation = 0;
+          while (midMcs > modulationMaxMcs[modulation])
+            {
+              modulation++;
+            }
+          if (!modulationMiComputed[modulation])
+            {
+              modulationMi[modulation] = MmWaveMiErrorModel::Mib (sinr, chunkMap, midMcs);
+              modulationMiComputed[modulation] = true;
+            }
+          MmWaveTbStats_t tbStats = MmWaveMiErrorModel::GetTbDecodificationStats (modulationMi[modulation], segmentation, tbSize, midMcs, harqInfoList);
           if (tbStats.tbler > 0.1)
             {
-              break;
+              firstFailingMcs = midMcs;
+            }
+          else
+            {
+              minMcs = midMcs + 1;
             }
-          mcs++;
-        }
-      if (mcs > 0)
-        {
-          mcs--;
         }
+      mcs = (firstFailingMcs > 0) ? firstFailingMcs - 1 : 0;
 //		MmWaveHarqProcessInfoList_t harqInfoList;
 //		MmWaveTbStats_t tbStatsFinal = MmWaveMiErrorModel::GetTbDecodificationStats (sinr, chunkMap, tbSize, mcs, harqInfoList);
 //		NS_LOG_UNCOND ("TBLER " << tbStatsFinal.tbler << " for chunks " << chunkMap.size () << " numSym "
 //		               << (unsigned)numSym << " tbSize " << tbSize << " mcs " << (unsigned)mcs << " sinr " << sinrAvg);
 //		NS_LOG_UNCOND (sinr);
-      if ((tbStats.tbler > 0.1)&&(mcs == 0))
+      if ((firstFailingMcs <= 28)&&(mcs == 0))
         {
           cqi = 0;
         }
@@ -21,6 +21,9 @@
 #include "ns3/antenna-array-model.h"
 #include "ns3/mobility-model.h"
 #include "ns3/pointer.h"
+#include "ns3/uinteger.h"
+#include "ns3/enum.h"
+#include "ns3/nstime.h"
 #include "ns3/net-device.h"
 #include "ns3/node.h"
 #include "ns3/log.h"
@@ -31,6 +34,7 @@
 #include "mmwave-spectrum-value-helper.h"
 
 #include <complex>
+#include <algorithm>
 
 #include <iostream>
 #include <fstream>
@@ -136,13 +140,99 @@ MmWaveDftBeamforming::GetTypeId ()
                    PointerValue (),
                    MakePointerAccessor (&MmWaveDftBeamforming::m_mobility),
                    MakePointerChecker<MobilityModel> ())
+    .AddAttribute ("VectorCacheCapacity",
+                   "The maximum number of beamforming vectors stored in the cache, "
+                   "0 means unbounded. When full, the least recently used vector is evicted.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&MmWaveDftBeamforming::SetVectorCacheCapacity,
+                                         &MmWaveDftBeamforming::GetVectorCacheCapacity),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("VectorCacheEvictionPolicy",
+                   "The eviction policy of the beamforming vector cache. With Generation, "
+                   "the vectors not used during the current or the previous VectorCacheGenerationPeriod "
+                   "are evicted.",
+                   EnumValue (BoundedCacheBase::LRU),
+                   MakeEnumAccessor (&MmWaveDftBeamforming::SetVectorCacheEvictionPolicy,
+                                     &MmWaveDftBeamforming::GetVectorCacheEvictionPolicy),
+                   MakeEnumChecker (BoundedCacheBase::LRU, "Lru",
+                                    BoundedCacheBase::GENERATION, "Generation"))
+    .AddAttribute ("VectorCacheGenerationPeriod",
+                   "The duration of a generation of the beamforming vector cache, "
+                   "it should match the channel update period",
+                   TimeValue (MilliSeconds (1)),
+                   MakeTimeAccessor (&MmWaveDftBeamforming::m_vectorCacheGenerationPeriod),
+                   MakeTimeChecker ())
+    .AddAttribute ("VectorCacheStatistics",
+                   "The counters of the beamforming vector cache",
+                   TypeId::ATTR_GET,
+                   PointerValue (),
+                   MakePointerAccessor (&MmWaveDftBeamforming::GetVectorCacheStatistics),
+                   MakePointerChecker<BoundedCacheStatistics> ())
   ;
   return tid;
 }
 
+/**
+ * Estimates the memory owned by a beamforming vector cache entry
+ * \param entry the cache entry
+ * \return the size in bytes
+ */
+static uint64_t
+GetBfVectorCacheEntrySize (const Ptr<BFVectorCacheEntry> &entry)
+{
+  uint64_t size = sizeof (BFVectorCacheEntry) + entry->m_antennaWeights.capacity () * sizeof (std::complex<double>);
+  Ptr<CodebookBFVectorCacheEntry> codebookEntry = DynamicCast<CodebookBFVectorCacheEntry> (entry);
+  if (codebookEntry != 0)
+    {
+      size += sizeof (CodebookBFVectorCacheEntry) - sizeof (BFVectorCacheEntry);
+      for (const complexVector_t &row : codebookEntry->m_equivalentChanCoefs)
+        {
+          size += row.capacity () * sizeof (std::complex<double>);
+        }
+    }
+  return size;
+}
+
 MmWaveDftBeamforming::MmWaveDftBeamforming ()
 {
   NS_LOG_FUNCTION (this);
+  m_vectorCache.SetSizeFunction (&GetBfVectorCacheEntrySize);
+}
+
+void
+MmWaveDftBeamforming::SetVectorCacheCapacity (uint32_t capacity)
+{
+  m_vectorCache.SetCapacity (capacity);
+}
+
+uint32_t
+MmWaveDftBeamforming::GetVectorCacheCapacity () const
+{
+  return m_vectorCache.GetCapacity ();
+}
+
+void
+MmWaveDftBeamforming::SetVectorCacheEvictionPolicy (BoundedCacheBase::EvictionPolicy policy)
+{
+  m_vectorCache.SetEvictionPolicy (policy);
+}
+
+BoundedCacheBase::EvictionPolicy
+MmWaveDftBeamforming::GetVectorCacheEvictionPolicy () const
+{
+  return m_vectorCache.GetEvictionPolicy ();
+}
+
+Ptr<BoundedCacheStatistics>
+MmWaveDftBeamforming::GetVectorCacheStatistics () const
+{
+  return m_vectorCache.GetStatistics ();
+}
+
+void
+MmWaveDftBeamforming::UpdateVectorCacheGeneration ()
+{
+  m_vectorCache.SetGeneration (BoundedCacheBase::GetGenerationAt (m_vectorCacheGenerationPeriod));
 }
 
 MmWaveDftBeamforming::~MmWaveDftBeamforming ()
@@ -215,7 +305,7 @@ MmWaveDftBeamforming::DoDesignBeamformingVectorForDevice (Ptr<NetDevice> otherDe
   pCacheValue->m_beamId = newBfParam.second;
   pCacheValue->m_antennaWeights =newBfParam.first;
 
-  m_vectorCache[beamKey] = pCacheValue;
+  m_vectorCache.Insert (beamKey, pCacheValue);
 
   return( newBfParam );
 }
@@ -252,12 +342,13 @@ MmWaveDftBeamforming::SetBeamformingVectorForDevice (Ptr<NetDevice> otherDevice
   // we can make modifications in beamID below without changing map key here
   uint32_t beamKey = GetKey(m_mobility->GetObject<Node> ()->GetId (),otherDevice->GetNode ()->GetId ());
 
-  std::map< uint32_t, Ptr<BFVectorCacheEntry> >::iterator itVectorCache = m_vectorCache.find(beamKey);
+  UpdateVectorCacheGeneration ();
+  Ptr<BFVectorCacheEntry> *itVectorCache = m_vectorCache.Find (beamKey);
   Ptr<BFVectorCacheEntry> pCacheValue;
-  if ( itVectorCache != m_vectorCache.end() )
+  if ( itVectorCache != 0 )
     {
       NS_LOG_DEBUG ("found a beam in the map");
-      pCacheValue = itVectorCache->second;
+      pCacheValue = *itVectorCache;
       update = CheckBfCacheExpiration( otherDevice,  pCacheValue);
     }
   else
@@ -321,44 +412,112 @@ MmWaveFFTCodebookBeamforming::~MmWaveFFTCodebookBeamforming ()
 
 }
 
-void
-MmWaveFFTCodebookBeamforming::InPlaceArrayFFT (ComplexArray_t& x, bool inv)
+const FftPlan&
+MmWaveFFTCodebookBeamforming::GetFftPlan (uint16_t n)
 {
-  //This method is a direct transposition of the fft examples provided in https://rosettacode.org/wiki/Fast_Fourier_transform#C.2B.2B
-  //The code in this method implementation is under the GNU Free Documentation License 1.2  https://www.gnu.org/licenses/old-licenses/fdl-1.2.html
-  //------------------------------------------------------------------------
-  const  uint16_t N = x.size();
-  if (N <= 1) return;
-
-  if ( inv )
-    {//the IFFT uses the FFT internally, only conjugate at the beginning and end
-      x=x.apply(std::conj);
+  std::map<uint16_t, FftPlan>::iterator it = m_fftPlans.find (n);
+  if (it != m_fftPlans.end ())
+    {
+      return it->second;
     }
 
-  // divide
-  ComplexArray_t even = x[std::slice(0, N/2, 2)];
-  ComplexArray_t  odd = x[std::slice(1, N/2, 2)];
-
-  // conquer
-  InPlaceArrayFFT(even,false);
-  InPlaceArrayFFT(odd,false);
+  FftPlan &plan = m_fftPlans[n];
+  if ((n & (n - 1)) == 0)
+    {
+      uint16_t numBits = 0;
+      while ((1 << numBits) < n)
+        {
+          numBits++;
+        }
+      plan.m_bitReverse.resize (n);
+      for (uint16_t i = 0; i < n; i++)
+        {
+          uint16_t reversed = 0;
+          for (uint16_t bit = 0; bit < numBits; bit++)
+            {
+              reversed |= ((i >> bit) & 1) << (numBits - 1 - bit);
+            }
+          plan.m_bitReverse[i] = reversed;
+        }
+      // the twiddles of each stage are computed as in the recursive
+      // formulation, exp(-j2*pi*k/M) with M the size of the stage
+      for (uint16_t stageSize = 2; stageSize <= n; stageSize *= 2)
+        {
+          for (uint16_t k = 0; k < stageSize / 2; k++)
+            {
+              plan.m_twiddles.push_back (std::polar (1.0, -2 * PI * k / stageSize));
+            }
+        }
+    }
+  else
+    {
+      for (uint16_t k = 0; k < n; k++)
+        {
+          plan.m_twiddles.push_back (std::polar (1.0, -2 * PI * k / n));
+        }
+    }
+  return plan;
+}
 
-  // combine
-  for ( uint16_t k = 0; k < N/2; ++k)
+void
+MmWaveFFTCodebookBeamforming::InPlaceStridedFFT (std::complex<double> *x, uint16_t n, uint32_t stride)
+{
+  if (n <= 1)
     {
-      std::complex<double> t = std::polar(1.0, -2 * PI * k / N) * odd[k];
-      x[k    ] = even[k] + t;
-      x[k+N/2] = even[k] - t;
+      return;
+    }
+  const FftPlan &plan = GetFftPlan (n);
+  if (!plan.m_bitReverse.empty ())
+    {
+      for (uint16_t i = 0; i < n; i++)
+        {
+          uint16_t j = plan.m_bitReverse[i];
+          if (i < j)
+            {
+              std::swap (x[i * stride], x[j * stride]);
+            }
+        }
+      for (uint16_t half = 1; half < n; half *= 2)
+        {
+          const std::complex<double> *twiddles = &plan.m_twiddles[half - 1];
+          for (uint32_t start = 0; start < n; start += 2 * half)
+            {
+              std::complex<double> *even = x + start * stride;
+              std::complex<double> *odd = x + (start + half) * stride;
+              for (uint16_t k = 0; k < half; k++)
+                {
+                  std::complex<double> t = twiddles[k] * odd[k * stride];
+                  odd[k * stride] = even[k * stride] - t;
+                  even[k * stride] += t;
+                }
+            }
+        }
+    }
+  else
+    {
+      m_fftScratch.resize (std::max<std::size_t> (m_fftScratch.size (), n));
+      for (uint16_t k = 0; k < n; k++)
+        {
+          std::complex<double> sum = 0;
+          for (uint16_t i = 0; i < n; i++)
+            {
+              sum += plan.m_twiddles[(static_cast<uint32_t> (i) * k) % n] * x[i * stride];
+            }
+          m_fftScratch[k] = sum;
+        }
+      for (uint16_t k = 0; k < n; k++)
+        {
+          x[k * stride] = m_fftScratch[k];
+        }
     }
-  //--------------------------------------------------------------------------
 
-  if ( inv )
+  double norm = sqrt ((double ) n);
+  for (uint16_t k = 0; k < n; k++)
     {
-      x=x.apply(std::conj);
+      x[k * stride] /= norm;
     }
 }
 
-
 void
 MmWaveFFTCodebookBeamforming::Channel4DFFT (complex2DVector_t& matrix,Ptr<NetDevice> otherDevice)
 {
@@ -371,77 +530,55 @@ MmWaveFFTCodebookBeamforming::Channel4DFFT (complex2DVector_t& matrix,Ptr<NetDev
   uint16_t otherAntennaNum [2];
   otherAntennaNum[0] = sqrt(matrix.size());//TODO find a way to read dim1 and dim2 from otherDevice to support non-square arrays
   otherAntennaNum[1] = sqrt(matrix.size());
-  //step 1; FFT of dim 1 of tx planar array
-  for ( uint16_t row = 0; row < matrix.size(); row++)
+
+  // the matrix is copied in a flat buffer, row by row, and the FFTs along
+  // each dimension access it with the corresponding stride
+  uint32_t numRows = matrix.size ();
+  uint32_t numCols = totNoArrayElements;
+  m_fftBuffer.resize (numRows * numCols);
+  for (uint32_t row = 0; row < numRows; row++)
     {
-      complexVector_t::iterator rowItemIterator1 = matrix.at(row).begin();
-      complexVector_t::iterator rowItemIterator2 = matrix.at(row).begin() + antennaNum[0];
-      for ( uint16_t colSegment = 0; colSegment < antennaNum[1]; colSegment++)
-	{
-	  complexVector_t subvector(rowItemIterator1,rowItemIterator2);//take a segment from the row we are considering |s1.s1.s1.s1|s2.s2.s2.s2|...
-	  ComplexArray_t x (subvector.data(),antennaNum[0]);//convert to valarray for convenient slicing
-	  InPlaceArrayFFT(x,false); //in-place FFT of the segment
-	  for ( uint16_t colItem = 0; colItem < antennaNum[0]; colItem++)//TODO can we replace this for with native stl subvector methods?
-	    {
-	      matrix.at(row).at ( colItem +  antennaNum[0]*colSegment ) = x[colItem] / sqrt( (double )antennaNum[0] ); // replace the segment with its energy-normalized FFT
-	    }
-	  rowItemIterator1 = rowItemIterator2;
-	  rowItemIterator2 += antennaNum[0];//move iterators to next segment
-	}
+      std::copy (matrix[row].begin (), matrix[row].end (), m_fftBuffer.begin () + row * numCols);
+    }
+  std::complex<double> *buffer = m_fftBuffer.data ();
+
+  //step 1; FFT of dim 1 of tx planar array, i.e., of the segments |s1.s1.s1.s1|s2.s2.s2.s2|... of each row
+  for (uint32_t row = 0; row < numRows; row++)
+    {
+      for (uint16_t colSegment = 0; colSegment < antennaNum[1]; colSegment++)
+        {
+          InPlaceStridedFFT (buffer + row * numCols + antennaNum[0] * colSegment, antennaNum[0], 1);
+        }
+    }
+  //step 2; FFT of dim 2 of tx planar array, i.e., of the combs .c1|c2|c3|c4.c1|c2|c3|c4.... of each row
+  for (uint32_t row = 0; row < numRows; row++)
+    {
+      for (uint16_t colComb = 0; colComb < antennaNum[0]; colComb++)
+        {
+          InPlaceStridedFFT (buffer + row * numCols + colComb, antennaNum[1], antennaNum[0]);
+        }
     }
-  //step 2; FFT of dim 2 of tx planar array
-    for ( uint16_t row = 0; row < matrix.size(); row++)
-      {
-	for ( uint16_t colComb = 0; colComb < antennaNum[0]; colComb++)
-	  {
-	    ComplexArray_t x (antennaNum[1]);//convert to valarray for convenient slicing
-	    //take a comb-sample from the row we are considering .c1|c2|c3|c4.c1|c2|c3|c4....
-	    for ( uint16_t colItem = 0; colItem < antennaNum[1]; colItem++)//TODO can we replace this for with native stl subvector methods?
-	      {
-		x[colItem] = matrix.at(row).at ( colComb +  antennaNum[0]*colItem );// read the segment into the subarray
-	      }
-	    InPlaceArrayFFT(x,false); //in-place FFT of the segment
-	    for ( uint16_t colItem = 0; colItem < antennaNum[1]; colItem++)//TODO can we replace this for with native stl subvector methods?
-	      {
-		matrix.at(row).at ( colComb +  antennaNum[0]*colItem ) = x[colItem] / sqrt( (double )antennaNum[1] ); // replace the segment with its energy-normalized FFT
-	      }
-	  }
-      }
   //step 3; FFT of dim 1 of rx array
-    for ( uint16_t col = 0; col < matrix.at(0).size(); col++)
-      {
-	for ( uint16_t rowSegment = 0; rowSegment < otherAntennaNum[1]; rowSegment++)
-	  {
-	    ComplexArray_t x (otherAntennaNum[0]);//convert to valarray for convenient slicing
-	    for ( uint16_t rowItem = 0; rowItem < otherAntennaNum[0]; rowItem++)//TODO can we replace this for with native stl subvector methods?
-	      {
-		x[rowItem] = matrix.at(rowItem + otherAntennaNum[0] * rowSegment).at (col); // read the segment into the subarray
-	      }
-	    InPlaceArrayFFT(x,false); //in-place FFT of the segment
-	    for ( uint16_t rowItem = 0; rowItem < otherAntennaNum[0]; rowItem++)//TODO can we replace this for with native stl subvector methods?
-	      {
-		matrix.at(rowItem + otherAntennaNum[0] * rowSegment).at (col) = x[rowItem] / sqrt( (double )otherAntennaNum[0] ); // replace the segment with its energy-normalized FFT
-	      }
-	  }
-      }
+  for (uint32_t col = 0; col < numCols; col++)
+    {
+      for (uint16_t rowSegment = 0; rowSegment < otherAntennaNum[1]; rowSegment++)
+        {
+          InPlaceStridedFFT (buffer + otherAntennaNum[0] * rowSegment * numCols + col, otherAntennaNum[0], numCols);
+        }
+    }
   //step 4; FFT of dim 2 of rx array
-    for ( uint16_t col = 0; col < matrix.at(0).size(); col++)
-      {
-	for ( uint16_t rowComb = 0; rowComb < otherAntennaNum[0]; rowComb++)
-	  {
-	    ComplexArray_t x (otherAntennaNum[1]);//convert to valarray for convenient slicing
-	    //take a comb-sample from the row we are considering .c1|c2|c3|c4.c1|c2|c3|c4....
-	    for ( uint16_t rowItem = 0; rowItem < otherAntennaNum[1]; rowItem++)//TODO can we replace this for with native stl subvector methods?
-	      {
-		x[rowItem] = matrix.at ( rowComb +  otherAntennaNum[0]*rowItem ).at(col); // read the segment into the subarray
-	      }
-	    InPlaceArrayFFT(x,false); //in-place FFT of the segment
-	    for ( uint16_t rowItem = 0; rowItem < otherAntennaNum[1]; rowItem++)//TODO can we replace this for with native stl subvector methods?
-	      {
-		matrix.at ( rowComb +  otherAntennaNum[0]*rowItem ).at(col) = x[rowItem]  / sqrt( (double )otherAntennaNum[1] ); // replace the segment with its energy-normalized FFT
-	      }
-	  }
-      }
+  for (uint32_t col = 0; col < numCols; col++)
+    {
+      for (uint16_t rowComb = 0; rowComb < otherAntennaNum[0]; rowComb++)
+        {
+          InPlaceStridedFFT (buffer + rowComb * numCols + col, otherAntennaNum[1], otherAntennaNum[0] * numCols);
+        }
+    }
+
+  for (uint32_t row = 0; row < numRows; row++)
+    {
+      std::copy (m_fftBuffer.begin () + row * numCols, m_fftBuffer.begin () + (row + 1) * numCols, matrix[row].begin ());
+    }
 }
 
 bool
@@ -568,7 +705,7 @@ MmWaveFFTCodebookBeamforming::DoDesignBeamformingVectorForDevice (Ptr<NetDevice>
   pCacheValue->txBeamInd=bestColumn;
   pCacheValue->rxBeamInd=bestRow;
   pCacheValue->m_equivalentChanCoefs=channelInfo;//chan info is 4DFFT'd, and therefore its matrix coefficients correspond to equivalent channel values
-  m_vectorCache[beamKey] = pCacheValue;//
+  m_vectorCache.Insert (beamKey, pCacheValue);
 
 
   return( newBfParam );
@@ -608,90 +745,6 @@ MmWaveMMSEBeamforming::SetNoisePowerSpectralDensity( double noisePSD )
   m_noisePowerSpectralDensity = noisePSD;
 }
 
-complex2DVector_t
-MmWaveMMSEBeamforming::MmseCholesky (complex2DVector_t matrixH)
-{
-  //This method obtains the cholesky decomposition of the positive definite hermitian matrix M=(H'H+NoI),
-  //where we have left the input matrixH in the format H
-  //This method is a C++ adaptation of the cholesky decompositoin examples provided in https://rosettacode.org/wiki/Cholesky_decomposition#C
-  //The code in this section is NOT a direct copy of the site
-
-  complex2DVector_t Llower;
-  uint16_t Msize = matrixH.at(0).size();
-  for ( uint16_t krow = 0 ; krow < Msize ; krow ++)
-    {//initialize the result matrix
-      complexVector_t newLRow(Msize,0.0);
-      Llower.push_back(newLRow);
-    }
-
-  for ( uint16_t kcol = 0 ; kcol < Msize ; kcol ++)
-    {
-      for ( uint16_t kdiag = 0 ; kdiag < (kcol + 1) ; kdiag ++) //equality reached in loop end
-        {
-	  //first we build the necessary coefficient of Hermitian matrix M(kcol,kdiag) = H'H+I
-	  std::complex<double> sum = ( kcol == kdiag )? m_noisePowerSpectralDensity : 0;
-	  for ( uint16_t sumiter = 0 ; sumiter <  matrixH.size() ; sumiter ++)
-	    {
-	      sum += std::conj( matrixH.at(sumiter).at(kcol) ) * matrixH.at(sumiter).at(kdiag) ;
-	    }
-	  //second we apply the negative sumatorium of the normal Cholesky algorithm in the accumulator variable 'sum'
-	  for ( uint16_t ksum = 0 ; ksum <  kdiag ; ksum ++) //equality not reached in loop end
-	    {
-	      sum -= Llower.at(kcol).at(ksum) * std::conj( Llower.at(kdiag).at(ksum) );
-	    }
-	  //finally we update the matrix
-	  Llower.at(kcol).at(kdiag) = ( kcol == kdiag )? sqrt( sum ) : ( sum / Llower.at(kdiag).at(kdiag) );
-        }
-    }
-
-  return( Llower );
-}
-
-complexVector_t
-MmWaveMMSEBeamforming::MmseSolve (complex2DVector_t matrixH, complexVector_t v)
-{
-  //Cholesky linear solver for x of linear system (H'*H+No*I)x=H'v, returning x=(H'*H+No*I)^-1H'v
-  //note: a linear solver is N times faster than a matrix inversion,in fact
-  //      the Cholesky matrix inversion algorithm consists in N linear solvers
-
-  complexVector_t aux1;//aux1=H'v
-  for (uint16_t col = 0; col < matrixH.at(0).size() ; col ++)
-    {
-      std::complex<double> sum=0;
-      for (uint16_t row = 0; row < matrixH.size() ; row ++)//col-row indexes inverted here for Hermitian matrix
-	{
-	  sum += std::conj( matrixH.at(row).at(col) ) * v.at(row);
-	}
-      aux1.push_back(sum);
-    }
-  complex2DVector_t matrixL=MmseCholesky(matrixH);//define M = H'H+I, factorization M=L*L' with lower-triangular L
-
-  complexVector_t aux2;// define L'x=aux2, solve L*aux2 = aux1,
-  for (uint16_t row = 0; row < matrixL.size() ; row ++)
-    {
-      std::complex<double> sum=aux1.at(row);
-      for (uint16_t col = 0; col < row ; col ++)
-	{
-	  sum -= aux2.at(col)*matrixL.at(row).at(col);
-	}
-      aux2.push_back( sum /  matrixL.at(row).at(row) );
-    }
-
-  complexVector_t x ( matrixL.size() , 0.0 );// solve L'*x=aux2. We preallocate initialized with zeros because we start writing at the end of the vector
-  for (uint16_t revRow = 0; revRow < matrixL.size(); revRow ++ )
-    {
-      uint16_t row = matrixL.size() -1 - revRow;//we start by the LAST coefficient because L' is upper triangular
-      std::complex<double> sum = aux2.at(row);
-      for (uint16_t col = row + 1 ; col < matrixL.size() ; col ++)
-	{
-	  sum -= x.at(col) * std::conj(matrixL.at(col).at(row));//col-row indexes inverted for Hermitian matrix L'
-	}
-      x[row] = ( sum /  matrixL.at(row).at(row) );
-    }
-
-  return( x );
-}
-
 std::vector< Ptr<CodebookBFVectorCacheEntry>>
 MmWaveMMSEBeamforming::GetBfCachesInSlotBundle(std::vector< Ptr<NetDevice> > vOtherDevs)
 {
@@ -702,12 +755,13 @@ MmWaveMMSEBeamforming::GetBfCachesInSlotBundle(std::vector< Ptr<NetDevice> > vOt
       bool update = false;
       bool notFound = false;
       uint32_t beamKey = GetKey(m_mobility->GetObject<Node> ()->GetId (), (*itDev )->GetNode ()->GetId ());
-      std::map< uint32_t, Ptr<BFVectorCacheEntry> >::iterator itVectorCache = m_vectorCache.find(beamKey);
+      UpdateVectorCacheGeneration ();
+      Ptr<BFVectorCacheEntry> *itVectorCache = m_vectorCache.Find (beamKey);
       Ptr<CodebookBFVectorCacheEntry> bCacheEntry;
-      if ( itVectorCache != m_vectorCache.end() )
+      if ( itVectorCache != 0 )
         {
           NS_LOG_DEBUG ("MMSE retrieved a beam from the map");
-          bCacheEntry = DynamicCast<CodebookBFVectorCacheEntry>(itVectorCache->second);
+          bCacheEntry = DynamicCast<CodebookBFVectorCacheEntry>(*itVectorCache);
           update = CheckBfCacheExpiration( (*itDev ),  bCacheEntry);
         }
       else
@@ -717,7 +771,7 @@ MmWaveMMSEBeamforming::GetBfCachesInSlotBundle(std::vector< Ptr<NetDevice> > vOt
       if ( notFound | update ){
           NS_LOG_DEBUG ("MMSE could not retreive beam from map or it has expired, generating new analog beam");
           DoDesignBeamformingVectorForDevice ( (*itDev ) ); //we do not use the output value directly in this call
-          bCacheEntry=DynamicCast<CodebookBFVectorCacheEntry>( m_vectorCache[beamKey] );
+          bCacheEntry=DynamicCast<CodebookBFVectorCacheEntry>( *m_vectorCache.Peek (beamKey) );
       }
       if (txBeamsCollection.find(bCacheEntry->txBeamInd)!=txBeamsCollection.end())
         {//if two users employ the same tx beam we have a matrix rank problem and the SINR suffers a lot, hence we adopt an alternative second-best beam
@@ -829,11 +883,31 @@ MmWaveMMSEBeamforming::SetBeamformingVectorForSlotBundle(std::vector< Ptr<NetDev
   rowctr=0;
   matrixline.str("");
   matrixline << "[";
+  // the matrix H'H+NoI is the same for all the columns, hence it is factorized once
+  uint16_t numLayers = equivalentH.size();
+  m_mmseSolver.Resize (1, numLayers);
+  std::complex<double> *solverH = m_mmseSolver.GetChannel (0);
+  for (uint16_t row = 0; row < numLayers; row++)
+    {
+      std::copy (equivalentH.at(row).begin(), equivalentH.at(row).end(), solverH + row * numLayers);
+    }
+  m_mmseSolver.Factorize (0, m_noisePowerSpectralDensity);
   for ( complex2DVector_t::iterator columnIt = analogWtransposed.begin();  columnIt != analogWtransposed.end(); columnIt++ )
     {
       // hybrid beamforming option
-      AntennaArrayBasicModel::complexVector_t mmseAntennaWeights =  MmseSolve( equivalentH , (*columnIt) );
-      for ( uint8_t i = 0; i < mmseAntennaWeights.size(); i++ )
+      //Cholesky linear solver for x of linear system (H'*H+No*I)x=H'v, returning x=(H'*H+No*I)^-1H'v
+      std::complex<double> mmseAntennaWeights[MmWaveMmseBatchSolver::MAX_LAYERS];
+      for (uint16_t col = 0; col < numLayers ; col ++)
+        {
+          std::complex<double> sum=0;
+          for (uint16_t row = 0; row < numLayers ; row ++)//col-row indexes inverted here for Hermitian matrix
+            {
+              sum += std::conj( solverH[row * numLayers + col] ) * columnIt->at(row);
+            }
+          mmseAntennaWeights[col] = sum;
+        }
+      m_mmseSolver.SolveFactorized (0, mmseAntennaWeights);
+      for ( uint8_t i = 0; i < numLayers; i++ )
         {
           if ( rowctr == 0 )
             {
@@ -899,11 +973,19 @@ MmWaveMMSESpectrumBeamforming::GetTypeId ()
     TypeId ("ns3::MmWaveMMSESpectrumBeamforming")
     .SetParent<MmWaveMMSEBeamforming> ()
     .AddConstructor<MmWaveMMSESpectrumBeamforming> ()
+    .AddAttribute ("CombinerSubbandStep",
+                   "The spacing of the subbands in which the MMSE digital combiner is computed. "
+                   "The combiner is computed in the subbands 0, step, 2*step, ... and in the last one, "
+                   "and linearly interpolated in the others. With 1 it is computed in all the subbands",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&MmWaveMMSESpectrumBeamforming::m_combinerSubbandStep),
+                   MakeUintegerChecker<uint32_t> (1))
   ;
   return tid;
 }
 
 MmWaveMMSESpectrumBeamforming::MmWaveMMSESpectrumBeamforming ()
+  : m_combinerSubbandStep (1)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -914,59 +996,6 @@ MmWaveMMSESpectrumBeamforming::~MmWaveMMSESpectrumBeamforming ()
 }
 
 
-complex2DVector_t
-MmWaveMMSESpectrumBeamforming::MmseSolveSimplified (complex2DVector_t matrixH)
-{
-  //Cholesky linear solver for x of set of linear systems (H'*H+No*I)X=H', returning X=(H'*H+No*I)^-1H'
-  //note: a linear solver is N times faster than a matrix inversion,in fact
-  //      the Cholesky matrix inversion algorithm consists in N linear solvers
-
-  complex2DVector_t matrixX;
-  complex2DVector_t matrixL=MmseCholesky(matrixH);//define M = H'H+I, factorization M=L*L' with lower-triangular L
-
-  for (uint16_t xRowCtr = 0; xRowCtr < matrixH.at(0).size() ; xRowCtr ++)
-    {
-      matrixX.push_back(complexVector_t());
-    }
-
-  for (uint16_t xColCtr = 0; xColCtr < matrixH.at(0).size() ; xColCtr ++)
-    {
-      complexVector_t aux1;
-      for (uint16_t col = 0; col < matrixH.at(0).size() ; col ++)
-         {
-           aux1.push_back(std::conj( matrixH.at(xColCtr).at(col) ) );
-         }
-      complexVector_t aux2;// define L'x=aux2, solve L*aux2 = aux1,
-      for (uint16_t row = 0; row < matrixL.size() ; row ++)
-        {
-          std::complex<double> sum=aux1.at(row);
-          for (uint16_t col = 0; col < row ; col ++)
-            {
-              sum -= aux2.at(col)*matrixL.at(row).at(col);
-            }
-          aux2.push_back( sum /  matrixL.at(row).at(row) );
-        }
-
-      complexVector_t xCol ( matrixL.size() , 0.0 );// solve L'*x=aux2. We preallocate initialized with zeros because we start writing at the end of the vector
-      for (uint16_t revRow = 0; revRow < matrixL.size(); revRow ++ )
-        {
-          uint16_t row = matrixL.size() -1 - revRow;//we start by the LAST coefficient because L' is upper triangular
-          std::complex<double> sum = aux2.at(row);
-          for (uint16_t col = row + 1 ; col < matrixL.size() ; col ++)
-            {
-              sum -= xCol.at(col) * std::conj(matrixL.at(col).at(row));//col-row indexes inverted for Hermitian matrix L'
-            }
-          xCol[row] = ( sum /  matrixL.at(row).at(row) );
-        }
-      for (uint16_t xRowCtr = 0; xRowCtr < matrixH.at(0).size() ; xRowCtr ++)
-        {
-          matrixX.at(xRowCtr).push_back( xCol.at(xRowCtr) );
-        }
-    }
-  return( matrixX );
-}
-
-
 void
 MmWaveMMSESpectrumBeamforming::SetBeamformingVectorForSlotBundle(std::vector< Ptr<NetDevice> > vOtherDevs , std::vector<uint16_t> vLayerInds)
 {
@@ -988,14 +1017,14 @@ MmWaveMMSESpectrumBeamforming::SetBeamformingVectorForSlotBundle(std::vector< Pt
   //  the diagonal Heq[ii,ii] is the complex gain for beam ii,
   //  and Heq[ii][jj] is the side-lobe cross-interference between beam ii-receiver and beam jj-transmitter
   //  this matrix coefficients are obtained as the conjugates of the matrix stored in the analog beam design, which was implemented in transmission mode
-  std::vector<complex2DVector_t> spectrumEquivH; // [ subband, rxlayer, txlayer], accessing 1 element by subband returns a complex2D vector equivalent MIMO frequency flat channel
-  for (size_t sBandCtr = 0 ; sBandCtr < spectrumModel->GetNumBands(); sBandCtr++ ){
-      spectrumEquivH.push_back(complex2DVector_t());
-      for (uint8_t antCtr = 0 ; antCtr < bfCachesInSlot.size() ; antCtr++ )
-        {
-          spectrumEquivH.back().push_back(complexVector_t());
-        }
-  }
+  // the combiner is computed only in the subbands 0, step, 2*step, ... and in the last one,
+  // the channel matrix of the i-th of these subbands is stored in the batch i of the MMSE solver
+  uint32_t numBands = spectrumModel->GetNumBands();
+  uint16_t numLayers = bfCachesInSlot.size();
+  uint32_t step = m_combinerSubbandStep;
+  uint32_t numSolvedBands = (numBands + step - 2) / step + 1;
+  m_mmseSolver.Resize (numSolvedBands, numLayers);
+
   double propagationGainAmplitude = 0;
   std::stringstream matrixline;
   matrixline << "[";
@@ -1003,6 +1032,7 @@ MmWaveMMSESpectrumBeamforming::SetBeamformingVectorForSlotBundle(std::vector< Pt
   for (std::vector< Ptr<CodebookBFVectorCacheEntry>>::iterator itBfThisDev = bfCachesInSlot.begin() ; itBfThisDev != bfCachesInSlot.end() ; itBfThisDev++ )
     {
       std::vector< Ptr<NetDevice> >::iterator itOtherDev = vOtherDevs.begin();
+      uint8_t colCtr = 0;
       for (std::vector< Ptr<CodebookBFVectorCacheEntry>>::iterator itBfOtherDev = bfCachesInSlot.begin() ; itBfOtherDev != bfCachesInSlot.end() ; itBfOtherDev++ )
         {
           AntennaArrayBasicModel::BeamformingVector txW ( (*itBfThisDev)->m_antennaWeights , (*itBfThisDev)->txBeamInd );
@@ -1012,57 +1042,88 @@ MmWaveMMSESpectrumBeamforming::SetBeamformingVectorForSlotBundle(std::vector< Pt
           AntennaArrayBasicModel::BeamformingVector rxW ( bfVector2DFFT((*itBfOtherDev)->rxBeamInd,otherAntennaNum) , (*itBfOtherDev)->rxBeamInd );//we did not cache this vector anywhere so we have to retrieve it here
           complexVector_t bfComplexSpectrum = casted3GPPchan->DoCalcRxComplexSpectrum( dummyPsd, m_mobility, (*itOtherDev)->GetNode ()->GetObject<MobilityModel> (), txW, rxW);
           propagationGainAmplitude = sqrt( pow( 10.0, 0.1 * m_propagationLossModel->CalcRxPower (0, m_mobility, (*itOtherDev)->GetNode ()->GetObject<MobilityModel> ()) ) );
-          for (size_t sBandCtr = 0 ; sBandCtr < spectrumModel->GetNumBands(); sBandCtr++ ){
-              spectrumEquivH.at(sBandCtr).at(rowCtr).push_back( ( propagationGainAmplitude * bfComplexSpectrum.at(sBandCtr) ) );
+          for (uint32_t solvedCtr = 0 ; solvedCtr < numSolvedBands; solvedCtr++ ){
+              uint32_t sBandCtr = std::min (solvedCtr * step, numBands - 1);
+              m_mmseSolver.GetChannel (solvedCtr)[rowCtr * numLayers + colCtr] = propagationGainAmplitude * bfComplexSpectrum.at(sBandCtr);
           }
-          matrixline << (itBfOtherDev == bfCachesInSlot.begin() ? "" : ",") << std::real(spectrumEquivH.at(0).at(rowCtr).back())<< "+1i*"<<std::imag(spectrumEquivH.at(0).at(rowCtr).back());
+          std::complex<double> firstBandH = m_mmseSolver.GetChannel (0)[rowCtr * numLayers + colCtr];
+          matrixline << (itBfOtherDev == bfCachesInSlot.begin() ? "" : ",") << std::real(firstBandH)<< "+1i*"<<std::imag(firstBandH);
           itOtherDev++;
+          colCtr++;
          }
       rowCtr++;
       matrixline<<";";
     }
   matrixline<<"]";
-  NS_LOG_DEBUG("Built the equivalent channel matrix Heq with size " << spectrumEquivH.at(0).size() << " x " << spectrumEquivH.at(0).at(0).size()<<" : "<<matrixline.str());
+  NS_LOG_DEBUG("Built the equivalent channel matrix Heq with size " << numLayers << " x " << numLayers <<" : "<<matrixline.str());
+
+  m_mmseSolver.SolveAll (m_noisePowerSpectralDensity);
 
-  std::vector<complex2DVector_t> mmseWDCmatrix;
-  for (size_t sBandCtr = 0 ; sBandCtr < spectrumModel->GetNumBands(); sBandCtr++ )
+  m_digitalCombiner.resize (numBands);
+  for (uint32_t solvedCtr = 0 ; solvedCtr < numSolvedBands; solvedCtr++ )
     {
-      mmseWDCmatrix.push_back( MmseSolveSimplified( spectrumEquivH.at(sBandCtr) ));
-//      matrixline.str("");
-//      matrixline << "[";
-      for (uint16_t rowCtr=0; rowCtr < mmseWDCmatrix.at(sBandCtr).size(); rowCtr++)
+      uint32_t sBandCtr = std::min (solvedCtr * step, numBands - 1);
+      complex2DVector_t &combiner = m_digitalCombiner.at(sBandCtr);
+      const std::complex<double> *solvedCombiner = m_mmseSolver.GetCombiner (solvedCtr);
+      combiner.resize (numLayers);
+      for (uint16_t rowCtr=0; rowCtr < numLayers; rowCtr++)
         {//normalize the digital combining so that noise PSD remains No and received power is scaled accordingly for a correct SINR model
+        combiner.at(rowCtr).assign (solvedCombiner + rowCtr * numLayers, solvedCombiner + (rowCtr + 1) * numLayers);
         double normSq =0;
-        for (uint16_t colCtr=0; colCtr < mmseWDCmatrix.at(sBandCtr).at(rowCtr).size(); colCtr++)
+        for (uint16_t colCtr=0; colCtr < numLayers; colCtr++)
           {
-            normSq+=std::norm( mmseWDCmatrix.at(sBandCtr).at(rowCtr).at(colCtr) );
+            normSq+=std::norm( combiner.at(rowCtr).at(colCtr) );
           }
-        for (uint16_t colCtr=0; colCtr < mmseWDCmatrix.at(sBandCtr).at(rowCtr).size(); colCtr++)
+        for (uint16_t colCtr=0; colCtr < numLayers; colCtr++)
           {
-           mmseWDCmatrix.at(sBandCtr).at(rowCtr).at(colCtr) *= 1.0/std::sqrt( normSq );
-//           matrixline<<(colCtr == 0 ? "" : ",") << std::real( mmseWDCmatrix.at(sBandCtr).at(rowCtr).at(colCtr) )<< "+1i*"<<std::imag( mmseWDCmatrix.at(sBandCtr).at(rowCtr).at(colCtr) );
+           combiner.at(rowCtr).at(colCtr) *= 1.0/std::sqrt( normSq );
           }
-//        matrixline<<(rowCtr == mmseWDCmatrix.at(sBandCtr).size() -1 ? "]" : ";");
         }
-//      NS_LOG_DEBUG("Built the digital combining matrix W in subband " << (int) sBandCtr << " with size " << mmseWDCmatrix.at(sBandCtr).size() << " x " << mmseWDCmatrix.at(sBandCtr).at(0).size()<<" : "<<matrixline.str());
     }
-  NS_LOG_DEBUG("Built spectrum frequency selective matrices with dimensions "<<mmseWDCmatrix.size()<<" x "<<mmseWDCmatrix.at(0).size()<<" x "<<mmseWDCmatrix.at(0).at(0).size());
+  for (uint32_t solvedCtr = 0 ; solvedCtr + 1 < numSolvedBands; solvedCtr++ )
+    {//the combiner of the subbands between two computed ones is linearly interpolated, and normalized again
+      uint32_t lowBand = solvedCtr * step;
+      uint32_t highBand = std::min (lowBand + step, numBands - 1);
+      const complex2DVector_t &lowCombiner = m_digitalCombiner.at(lowBand);
+      const complex2DVector_t &highCombiner = m_digitalCombiner.at(highBand);
+      for (uint32_t sBandCtr = lowBand + 1; sBandCtr < highBand; sBandCtr++)
+        {
+          double weight = (double)(sBandCtr - lowBand) / (highBand - lowBand);
+          complex2DVector_t &combiner = m_digitalCombiner.at(sBandCtr);
+          combiner.resize (numLayers);
+          for (uint16_t rowCtr=0; rowCtr < numLayers; rowCtr++)
+            {
+              combiner.at(rowCtr).resize (numLayers);
+              double normSq =0;
+              for (uint16_t colCtr=0; colCtr < numLayers; colCtr++)
+                {
+                  combiner.at(rowCtr).at(colCtr) = (1.0 - weight) * lowCombiner.at(rowCtr).at(colCtr) + weight * highCombiner.at(rowCtr).at(colCtr);
+                  normSq+=std::norm( combiner.at(rowCtr).at(colCtr) );
+                }
+              for (uint16_t colCtr=0; colCtr < numLayers; colCtr++)
+                {
+                  combiner.at(rowCtr).at(colCtr) *= 1.0/std::sqrt( normSq );
+                }
+            }
+        }
+    }
+  NS_LOG_DEBUG("Built spectrum frequency selective matrices with dimensions "<<m_digitalCombiner.size()<<" x "<<numLayers<<" x "<<numLayers
+               <<", computed in "<<numSolvedBands<<" subbands");
 
   // configure the antenna to use the new beamforming vector
   Ptr<AntennaArrayModel> castAntenna = DynamicCast<AntennaArrayModel>(m_antenna);
+  NS_ASSERT_MSG( castAntenna != 0 , "ERROR: Tried to apply hybrid beamforming to an antenna model without multilayer support");
   std::vector< Ptr<NetDevice> >::iterator itDev = vOtherDevs.begin();
   std::vector< uint16_t >::iterator itLId = vLayerInds.begin();
   for (std::vector< Ptr<CodebookBFVectorCacheEntry>>::iterator itBf = bfCachesInSlot.begin() ; itBf != bfCachesInSlot.end() ; itBf++ )
     {
       NS_LOG_LOGIC("Setting up MMSE antenna weights for UE "<< (*itDev )->GetNode ()->GetId () );
-
-      NS_ASSERT_MSG( castAntenna != 0 , "ERROR: Tried to apply hybrid beamforming to an antenna model without multilayer support");
       castAntenna->SetBeamformingVectorMultilayers ( (*itBf)->m_antennaWeights, (*itBf)->txBeamInd, (*itDev), (*itLId));
-      castAntenna->SetDigitalCombining( mmseWDCmatrix );
-      castAntenna->ToggleDigitalCombining( true );
       itDev++;
       itLId++;
     }
+  castAntenna->SetDigitalCombining( m_digitalCombiner );
+  castAntenna->ToggleDigitalCombining( true );
 }
 
 
@@ -25,6 +25,8 @@
 #include "ns3/propagation-loss-model.h"
 #include "ns3/spectrum-propagation-loss-model.h"
 #include "ns3/mmwave-phy-mac-common.h"
+#include "ns3/bounded-cache.h"
+#include "ns3/mmwave-mmse-batch-solver.h"
 #include <map>
 #include <valarray>
 
@@ -173,6 +175,33 @@ public:
      */
   virtual bool CheckBfCacheExpiration(Ptr<NetDevice> otherDevice, Ptr<BFVectorCacheEntry> pCacheValue);
 
+  /**
+   * Set the maximum number of beamforming vectors stored in the cache
+   * \param capacity the maximum number of entries, 0 means unbounded
+   */
+  void SetVectorCacheCapacity (uint32_t capacity);
+
+  /**
+   * \return the maximum number of beamforming vectors stored in the cache
+   */
+  uint32_t GetVectorCacheCapacity () const;
+
+  /**
+   * Set the eviction policy of the beamforming vector cache
+   * \param policy the eviction policy
+   */
+  void SetVectorCacheEvictionPolicy (BoundedCacheBase::EvictionPolicy policy);
+
+  /**
+   * \return the eviction policy of the beamforming vector cache
+   */
+  BoundedCacheBase::EvictionPolicy GetVectorCacheEvictionPolicy () const;
+
+  /**
+   * \return the counters of the beamforming vector cache
+   */
+  Ptr<BoundedCacheStatistics> GetVectorCacheStatistics () const;
+
 protected:
 
    /**
@@ -185,12 +214,27 @@ protected:
    {//TODO this is a replica of ThreeGppChannel id generation, it is not required to import modification to that function, but it should be considered
      return (((x1 + x2) * (x1 + x2 + 1)) / 2) + x2;
    }
-   std::map< uint32_t, Ptr<BFVectorCacheEntry> > m_vectorCache; // a memory to remember previous bf vectors and reuse them without recomputing
+   /**
+    * Advance the generation of m_vectorCache according to the current time
+    */
+   void UpdateVectorCacheGeneration ();
+
+   BoundedCache< uint32_t, Ptr<BFVectorCacheEntry> > m_vectorCache; // a memory to remember previous bf vectors and reuse them without recomputing
+   Time m_vectorCacheGenerationPeriod; // duration of a generation of m_vectorCache
 };
 
 
 typedef std::valarray<std::complex<double>> ComplexArray_t;
 
+/**
+ * Precomputed tables of the FFT of a given size
+ */
+struct FftPlan
+{
+  std::vector<uint16_t> m_bitReverse; //!< the bit reversal permutation, empty if the size is not a power of two
+  complexVector_t m_twiddles; //!< the twiddle factors. With a power of two size, those of the stage of size M start at index M/2 - 1, otherwise exp(-j2*pi*k/N) for k = 0, ..., N-1
+};
+
 struct CodebookBFVectorCacheEntry : public BFVectorCacheEntry
 {
   Time m_generatedTime;
@@ -251,8 +295,29 @@ public:
 private:
 
   static constexpr double PI = 3.141592653589793238460;
-  void InPlaceArrayFFT (ComplexArray_t& x, bool inv = false);
+
+  /**
+   * Get the plan of the FFT of a given size, computing it at the first call
+   * \param n the size of the FFT
+   * \return the plan
+   */
+  const FftPlan& GetFftPlan (uint16_t n);
+
+  /**
+   * Compute in place the energy-normalized FFT of the n elements x[0],
+   * x[stride], ..., x[(n - 1) * stride]. Power of two sizes use an iterative
+   * radix-2 decimation in time, the other sizes a direct DFT.
+   * \param x the first element
+   * \param n the number of elements
+   * \param stride the distance between consecutive elements
+   */
+  void InPlaceStridedFFT (std::complex<double> *x, uint16_t n, uint32_t stride);
+
   void Channel4DFFT (complex2DVector_t& matrix,Ptr<NetDevice> otherDevice);
+
+  std::map<uint16_t, FftPlan> m_fftPlans; //!< the FFT plans, one for each array dimension
+  complexVector_t m_fftBuffer; //!< the flat copy of the channel matrix transformed by Channel4DFFT
+  complexVector_t m_fftScratch; //!< the scratch buffer of the direct DFT
 };
 
 
@@ -295,13 +360,10 @@ public:
   void SetNoisePowerSpectralDensity( double noisePSD );
 
 protected:
-  complex2DVector_t MmseCholesky (complex2DVector_t matrixH);
   std::vector< Ptr<CodebookBFVectorCacheEntry>> GetBfCachesInSlotBundle(std::vector< Ptr<NetDevice> > vOtherDevs);
 
-private:
-
-  complexVector_t MmseSolve (complex2DVector_t matrixH, complexVector_t y);
   double m_noisePowerSpectralDensity;
+  MmWaveMmseBatchSolver m_mmseSolver; //!< the MMSE solver, whose storage is reused across the slots
 };
 
 
@@ -336,7 +398,8 @@ public:
   virtual void SetBeamformingVectorForSlotBundle( std::vector< Ptr<NetDevice> > vOtherDevs , std::vector<uint16_t> vLayerInds) override;
 private:
 
-  complex2DVector_t MmseSolveSimplified (complex2DVector_t matrixH);
+  uint32_t m_combinerSubbandStep; //!< the spacing of the subbands in which the MMSE combiner is computed, it is interpolated in the others
+  std::vector<complex2DVector_t> m_digitalCombiner; //!< the digital combining matrices [subband, digital layer, analog layer]
 };
 
 } // namespace mmwave
@@ -0,0 +1,821 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2020 SIGNET Lab, Department of Information Engineering,
+ *   University of Padova
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "mmwave-distributed-spectrum-channel.h"
+#include "mmwave-spectrum-signal-parameters.h"
+#include <ns3/log.h>
+#include <ns3/abort.h>
+#include <ns3/simulator.h>
+#include <ns3/node.h>
+#include <ns3/net-device.h>
+#include <ns3/packet-burst.h>
+#include <ns3/spectrum-value.h>
+#include <ns3/mobility-model.h>
+#include <ns3/constant-velocity-mobility-model.h>
+#include <ns3/mpi-interface.h>
+#include <ns3/mpi-receiver.h>
+#include <ns3/distributed-simulator-impl.h>
+#include <algorithm>
+#include <cstring>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveDistributedSpectrumChannel");
+
+namespace mmwave {
+
+NS_OBJECT_ENSURE_REGISTERED (MmWaveRemoteSignalHeader);
+NS_OBJECT_ENSURE_REGISTERED (MmWaveRemoteFragmentHeader);
+NS_OBJECT_ENSURE_REGISTERED (MmWaveDistributedSpectrumChannel);
+
+namespace {
+
+/// the size of the fragments of the messages, within the maximum size of the MPI messages
+const uint32_t FRAGMENT_SIZE = 1400;
+
+void
+WriteDouble (Buffer::Iterator &i, double value)
+{
+  uint64_t bits;
+  std::memcpy (&bits, &value, sizeof (bits));
+  i.WriteHtonU64 (bits);
+}
+
+double
+ReadDouble (Buffer::Iterator &i)
+{
+  uint64_t bits = i.ReadNtohU64 ();
+  double value;
+  std::memcpy (&value, &bits, sizeof (value));
+  return value;
+}
+
+void
+WriteVector (Buffer::Iterator &i, const Vector &v)
+{
+  WriteDouble (i, v.x);
+  WriteDouble (i, v.y);
+  WriteDouble (i, v.z);
+}
+
+Vector
+ReadVector (Buffer::Iterator &i)
+{
+  double x = ReadDouble (i);
+  double y = ReadDouble (i);
+  double z = ReadDouble (i);
+  return Vector (x, y, z);
+}
+
+void
+WriteComplexVector (Buffer::Iterator &i, const AntennaArrayBasicModel::complexVector_t &v)
+{
+  i.WriteHtonU32 (v.size ());
+  for (std::size_t k = 0; k < v.size (); k++)
+    {
+      WriteDouble (i, v[k].real ());
+      WriteDouble (i, v[k].imag ());
+    }
+}
+
+AntennaArrayBasicModel::complexVector_t
+ReadComplexVector (Buffer::Iterator &i)
+{
+  AntennaArrayBasicModel::complexVector_t v (i.ReadNtohU32 ());
+  for (std::size_t k = 0; k < v.size (); k++)
+    {
+      double re = ReadDouble (i);
+      double im = ReadDouble (i);
+      v[k] = std::complex<double> (re, im);
+    }
+  return v;
+}
+
+uint32_t
+GetComplexVectorSize (const AntennaArrayBasicModel::complexVector_t &v)
+{
+  return 4 + 16 * v.size ();
+}
+
+uint32_t
+GetSnapshotSize (const MmWaveRemoteAntennaSnapshot &snapshot)
+{
+  // omni, number of layers, number of vectors
+  uint32_t size = 1 + 1 + 1;
+  for (std::map<uint8_t, AntennaArrayBasicModel::BeamformingVector>::const_iterator it = snapshot.vectors.begin ();
+       it != snapshot.vectors.end (); ++it)
+    {
+      // layer, beam id, weights
+      size += 1 + 4 + GetComplexVectorSize (it->second.first);
+    }
+  // digital combining, number of bands
+  size += 1 + 4;
+  for (std::size_t b = 0; b < snapshot.combining.size (); b++)
+    {
+      size += 4;
+      for (std::size_t l = 0; l < snapshot.combining[b].size (); l++)
+        {
+          size += GetComplexVectorSize (snapshot.combining[b][l]);
+        }
+    }
+  return size;
+}
+
+void
+WriteSnapshot (Buffer::Iterator &i, const MmWaveRemoteAntennaSnapshot &snapshot)
+{
+  i.WriteU8 (snapshot.omni);
+  i.WriteU8 (snapshot.numLayers);
+  NS_ABORT_MSG_IF (snapshot.vectors.size () > 255, "Too many beamforming vectors");
+  i.WriteU8 (snapshot.vectors.size ());
+  for (std::map<uint8_t, AntennaArrayBasicModel::BeamformingVector>::const_iterator it = snapshot.vectors.begin ();
+       it != snapshot.vectors.end (); ++it)
+    {
+      i.WriteU8 (it->first);
+      i.WriteHtonU32 (it->second.second);
+      WriteComplexVector (i, it->second.first);
+    }
+  i.WriteU8 (snapshot.digitalCombining);
+  i.WriteHtonU32 (snapshot.combining.size ());
+  for (std::size_t b = 0; b < snapshot.combining.size (); b++)
+    {
+      i.WriteHtonU32 (snapshot.combining[b].size ());
+      for (std::size_t l = 0; l < snapshot.combining[b].size (); l++)
+        {
+          WriteComplexVector (i, snapshot.combining[b][l]);
+        }
+    }
+}
+
+void
+ReadSnapshot (Buffer::Iterator &i, MmWaveRemoteAntennaSnapshot &snapshot)
+{
+  snapshot.omni = i.ReadU8 ();
+  snapshot.numLayers = i.ReadU8 ();
+  snapshot.vectors.clear ();
+  uint8_t numVectors = i.ReadU8 ();
+  for (uint8_t k = 0; k < numVectors; k++)
+    {
+      uint8_t layer = i.ReadU8 ();
+      AntennaArrayBasicModel::BeamId beamId = i.ReadNtohU32 ();
+      snapshot.vectors[layer] = std::make_pair (ReadComplexVector (i), beamId);
+    }
+  snapshot.digitalCombining = i.ReadU8 ();
+  snapshot.combining.resize (i.ReadNtohU32 ());
+  for (std::size_t b = 0; b < snapshot.combining.size (); b++)
+    {
+      snapshot.combining[b].resize (i.ReadNtohU32 ());
+      for (std::size_t l = 0; l < snapshot.combining[b].size (); l++)
+        {
+          snapshot.combining[b][l] = ReadComplexVector (i);
+        }
+    }
+}
+
+} // unnamed namespace
+
+MmWaveRemoteAntennaSnapshot::MmWaveRemoteAntennaSnapshot ()
+  : omni (false),
+    numLayers (0),
+    digitalCombining (false)
+{
+}
+
+void
+MmWaveRemoteAntennaSnapshot::Take (Ptr<AntennaArrayModel> antenna)
+{
+  omni = antenna->IsOmniTx ();
+  numLayers = antenna->GetCurrNumLayers ();
+  vectors.clear ();
+  if (!omni)
+    {
+      std::vector<uint8_t> layers = antenna->GetBeamformingLayers ();
+      for (std::size_t k = 0; k < layers.size (); k++)
+        {
+          vectors[layers[k]] = antenna->GetCurrentBeamformingVectorMultilayers (layers[k]);
+        }
+    }
+  digitalCombining = antenna->isDigitalCombiningOn ();
+  combining.clear ();
+  if (digitalCombining)
+    {
+      combining = antenna->GetDigitalCombining ();
+    }
+}
+
+void
+MmWaveRemoteAntennaSnapshot::Apply (Ptr<AntennaArrayModel> antenna) const
+{
+  antenna->ClearBeamformingVectorList ();
+  antenna->SetCurrNumLayers (numLayers);
+  for (std::map<uint8_t, AntennaArrayBasicModel::BeamformingVector>::const_iterator it = vectors.begin ();
+       it != vectors.end (); ++it)
+    {
+      antenna->SetBeamformingVectorMultilayers (it->second.first, it->second.second, 0, it->first);
+    }
+  antenna->ToggleDigitalCombining (digitalCombining);
+  if (digitalCombining)
+    {
+      antenna->SetDigitalCombining (combining);
+    }
+  if (omni)
+    {
+      antenna->ChangeToOmniTx ();
+    }
+}
+
+MmWaveRemoteSignalHeader::MmWaveRemoteSignalHeader ()
+  : m_channelId (0),
+    m_txPhyId (0),
+    m_cellId (0),
+    m_slotInd (0),
+    m_layerInd (0),
+    m_txIsEnb (false),
+    m_hasAntenna (false)
+{
+}
+
+TypeId
+MmWaveRemoteSignalHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MmWaveRemoteSignalHeader")
+    .SetParent<Header> ()
+    .SetGroupName ("MmWave")
+    .AddConstructor<MmWaveRemoteSignalHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+MmWaveRemoteSignalHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+MmWaveRemoteSignalHeader::GetSerializedSize (void) const
+{
+  // channel, transmitter, duration, cell, slot, layer, eNB flag,
+  // position, velocity, PSD, antenna flag
+  uint32_t size = 4 + 4 + 8 + 2 + 1 + 1 + 1 + 24 + 24 + 4 + 8 * m_psd.size () + 1;
+  if (m_hasAntenna)
+    {
+      size += GetSnapshotSize (m_antenna);
+    }
+  return size;
+}
+
+void
+MmWaveRemoteSignalHeader::Serialize (Buffer::Iterator start) const
+{
+  Buffer::Iterator i = start;
+  i.WriteHtonU32 (m_channelId);
+  i.WriteHtonU32 (m_txPhyId);
+  i.WriteHtonU64 (m_duration.GetTimeStep ());
+  i.WriteHtonU16 (m_cellId);
+  i.WriteU8 (m_slotInd);
+  i.WriteU8 (m_layerInd);
+  i.WriteU8 (m_txIsEnb);
+  WriteVector (i, m_position);
+  WriteVector (i, m_velocity);
+  i.WriteHtonU32 (m_psd.size ());
+  for (std::size_t k = 0; k < m_psd.size (); k++)
+    {
+      WriteDouble (i, m_psd[k]);
+    }
+  i.WriteU8 (m_hasAntenna);
+  if (m_hasAntenna)
+    {
+      WriteSnapshot (i, m_antenna);
+    }
+}
+
+uint32_t
+MmWaveRemoteSignalHeader::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+  m_channelId = i.ReadNtohU32 ();
+  m_txPhyId = i.ReadNtohU32 ();
+  m_duration = TimeStep (i.ReadNtohU64 ());
+  m_cellId = i.ReadNtohU16 ();
+  m_slotInd = i.ReadU8 ();
+  m_layerInd = i.ReadU8 ();
+  m_txIsEnb = i.ReadU8 ();
+  m_position = ReadVector (i);
+  m_velocity = ReadVector (i);
+  m_psd.resize (i.ReadNtohU32 ());
+  for (std::size_t k = 0; k < m_psd.size (); k++)
+    {
+      m_psd[k] = ReadDouble (i);
+    }
+  m_hasAntenna = i.ReadU8 ();
+  if (m_hasAntenna)
+    {
+      ReadSnapshot (i, m_antenna);
+    }
+  return GetSerializedSize ();
+}
+
+void
+MmWaveRemoteSignalHeader::Print (std::ostream &os) const
+{
+  os << "channel=" << m_channelId
+     << " txPhy=" << m_txPhyId
+     << " duration=" << m_duration
+     << " cellId=" << m_cellId
+     << " slot=" << (uint16_t) m_slotInd
+     << " layer=" << (uint16_t) m_layerInd
+     << " txIsEnb=" << m_txIsEnb
+     << " antenna=" << m_hasAntenna;
+}
+
+MmWaveRemoteFragmentHeader::MmWaveRemoteFragmentHeader ()
+  : m_sourceRank (0),
+    m_sequence (0),
+    m_index (0),
+    m_count (0)
+{
+}
+
+TypeId
+MmWaveRemoteFragmentHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MmWaveRemoteFragmentHeader")
+    .SetParent<Header> ()
+    .SetGroupName ("MmWave")
+    .AddConstructor<MmWaveRemoteFragmentHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+MmWaveRemoteFragmentHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+MmWaveRemoteFragmentHeader::GetSerializedSize (void) const
+{
+  return 4 + 4 + 2 + 2;
+}
+
+void
+MmWaveRemoteFragmentHeader::Serialize (Buffer::Iterator start) const
+{
+  Buffer::Iterator i = start;
+  i.WriteHtonU32 (m_sourceRank);
+  i.WriteHtonU32 (m_sequence);
+  i.WriteHtonU16 (m_index);
+  i.WriteHtonU16 (m_count);
+}
+
+uint32_t
+MmWaveRemoteFragmentHeader::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+  m_sourceRank = i.ReadNtohU32 ();
+  m_sequence = i.ReadNtohU32 ();
+  m_index = i.ReadNtohU16 ();
+  m_count = i.ReadNtohU16 ();
+  return GetSerializedSize ();
+}
+
+void
+MmWaveRemoteFragmentHeader::Print (std::ostream &os) const
+{
+  os << "source=" << m_sourceRank
+     << " sequence=" << m_sequence
+     << " fragment=" << m_index << "/" << m_count;
+}
+
+std::vector<MmWaveDistributedSpectrumChannel *> MmWaveDistributedSpectrumChannel::s_channels;
+std::map<uint32_t, uint32_t> MmWaveDistributedSpectrumChannel::s_sequences;
+std::map<std::pair<uint32_t, uint32_t>, std::map<uint16_t, Ptr<Packet> > > MmWaveDistributedSpectrumChannel::s_fragments;
+std::map<std::pair<uint32_t, uint32_t>, Ptr<Packet> > MmWaveDistributedSpectrumChannel::s_messages;
+EventId MmWaveDistributedSpectrumChannel::s_deliverEvent;
+
+MmWaveDistributedSpectrumChannel::MmWaveDistributedSpectrumChannel ()
+{
+  NS_LOG_FUNCTION (this);
+  m_channelId = s_channels.size ();
+  s_channels.push_back (this);
+}
+
+MmWaveDistributedSpectrumChannel::~MmWaveDistributedSpectrumChannel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TypeId
+MmWaveDistributedSpectrumChannel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MmWaveDistributedSpectrumChannel")
+    .SetParent<MultiModelSpectrumChannel> ()
+    .SetGroupName ("MmWave")
+    .AddConstructor<MmWaveDistributedSpectrumChannel> ()
+    .AddAttribute ("Lookahead",
+                   "The delay of the signals forwarded to the other MPI ranks, which is "
+                   "also the lookahead of the DistributedSimulatorImpl. It should be the "
+                   "slot duration, so that the interference of the remote cells is "
+                   "received in the following slot.",
+                   TimeValue (MicroSeconds (250)),
+                   MakeTimeAccessor (&MmWaveDistributedSpectrumChannel::m_lookahead),
+                   MakeTimeChecker (TimeStep (1)))
+  ;
+  return tid;
+}
+
+void
+MmWaveDistributedSpectrumChannel::DoDispose ()
+{
+  NS_LOG_FUNCTION (this);
+  s_channels.at (m_channelId) = 0;
+  m_txPhys.clear ();
+  m_txPhyIds.clear ();
+  m_remoteProxies.clear ();
+  m_sentAntennas.clear ();
+  m_remoteAntennas.clear ();
+  bool lastChannel = true;
+  for (std::size_t k = 0; k < s_channels.size (); k++)
+    {
+      lastChannel &= (s_channels[k] == 0);
+    }
+  if (lastChannel)
+    {
+      // release the messages of the simulation which has been destroyed
+      s_deliverEvent.Cancel ();
+      s_deliverEvent = EventId ();
+      s_fragments.clear ();
+      s_messages.clear ();
+    }
+  MultiModelSpectrumChannel::DoDispose ();
+}
+
+bool
+MmWaveDistributedSpectrumChannel::IsDistributed (void)
+{
+  return MpiInterface::IsEnabled () && MpiInterface::GetSize () > 1;
+}
+
+bool
+MmWaveDistributedSpectrumChannel::IsLocal (Ptr<SpectrumPhy> phy)
+{
+  Ptr<NetDevice> device = phy->GetDevice ();
+  if (device == 0 || device->GetNode () == 0)
+    {
+      // not attached to a node, hence not partitioned
+      return true;
+    }
+  return device->GetNode ()->GetSystemId () == MpiInterface::GetSystemId ();
+}
+
+void
+MmWaveDistributedSpectrumChannel::SetSimulatorLookahead (void)
+{
+  Time lookahead = Time::Max ();
+  for (std::size_t k = 0; k < s_channels.size (); k++)
+    {
+      if (s_channels[k] != 0)
+        {
+          lookahead = std::min (lookahead, s_channels[k]->m_lookahead);
+        }
+    }
+  Ptr<DistributedSimulatorImpl> simulator = DynamicCast<DistributedSimulatorImpl> (Simulator::GetImplementation ());
+  NS_ABORT_MSG_IF (simulator == 0, "The MmWaveDistributedSpectrumChannel requires the ns3::DistributedSimulatorImpl");
+  simulator->SetMaximumLookAhead (lookahead);
+}
+
+void
+MmWaveDistributedSpectrumChannel::AddTxPhy (Ptr<SpectrumPhy> phy)
+{
+  NS_LOG_FUNCTION (this << phy);
+  if (m_txPhyIds.find (phy) != m_txPhyIds.end ())
+    {
+      return;
+    }
+  m_txPhyIds[phy] = m_txPhys.size ();
+  m_txPhys.push_back (phy);
+
+  if (m_txPhys.size () == 1 && IsDistributed ())
+    {
+      SetSimulatorLookahead ();
+      // the devices are attached to the phys after their registration
+      Simulator::ScheduleNow (&MmWaveDistributedSpectrumChannel::SetUpRemoteDelivery, this);
+    }
+}
+
+void
+MmWaveDistributedSpectrumChannel::SetUpRemoteDelivery (void)
+{
+  NS_LOG_FUNCTION (this);
+  // every rank chooses the same proxies, i.e., the first registered
+  // transmitter of each rank
+  uint32_t localRank = MpiInterface::GetSystemId ();
+  bool hasLocalProxy = false;
+  for (std::size_t k = 0; k < m_txPhys.size (); k++)
+    {
+      Ptr<NetDevice> device = m_txPhys[k]->GetDevice ();
+      if (device == 0 || device->GetNode () == 0)
+        {
+          continue;
+        }
+      uint32_t rank = device->GetNode ()->GetSystemId ();
+      if (rank != localRank)
+        {
+          if (m_remoteProxies.find (rank) == m_remoteProxies.end ())
+            {
+              NS_LOG_LOGIC ("Messages to rank " << rank << " sent to node " << device->GetNode ()->GetId ());
+              m_remoteProxies[rank] = device;
+            }
+        }
+      else if (!hasLocalProxy)
+        {
+          hasLocalProxy = true;
+          if (device->GetObject<MpiReceiver> () == 0)
+            {
+              Ptr<MpiReceiver> receiver = CreateObject<MpiReceiver> ();
+              receiver->SetReceiveCallback (MakeCallback (&MmWaveDistributedSpectrumChannel::ReceiveFragment));
+              device->AggregateObject (receiver);
+            }
+        }
+    }
+}
+
+void
+MmWaveDistributedSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
+{
+  NS_LOG_FUNCTION (this << phy);
+  if (IsDistributed () && !IsLocal (phy))
+    {
+      NS_LOG_LOGIC ("Replica of a remote receiver not added");
+      return;
+    }
+  MultiModelSpectrumChannel::AddRx (phy);
+}
+
+void
+MmWaveDistributedSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> params)
+{
+  NS_LOG_FUNCTION (this << params);
+  if (!IsDistributed ())
+    {
+      MultiModelSpectrumChannel::StartTx (params);
+      return;
+    }
+  if (!IsLocal (params->txPhy))
+    {
+      NS_LOG_LOGIC ("Signal of the replica of a remote transmitter discarded");
+      return;
+    }
+
+  MultiModelSpectrumChannel::StartTx (params);
+
+  Ptr<MmWaveSpectrumSignalParametersBase> mmwaveParams = DynamicCast<MmWaveSpectrumSignalParametersBase> (params);
+  if (mmwaveParams == 0 || mmwaveParams->signalType != MMWAVE_DATA_FRAME)
+    {
+      return;
+    }
+  std::map<Ptr<SpectrumPhy>, uint32_t>::const_iterator it = m_txPhyIds.find (params->txPhy);
+  if (it == m_txPhyIds.end ())
+    {
+      NS_LOG_LOGIC ("Signal of an unregistered transmitter not forwarded");
+      return;
+    }
+  for (std::map<uint32_t, Ptr<NetDevice> >::const_iterator proxyIt = m_remoteProxies.begin ();
+       proxyIt != m_remoteProxies.end (); ++proxyIt)
+    {
+      SendRemoteTx (params, it->second, proxyIt->first, proxyIt->second);
+    }
+}
+
+void
+MmWaveDistributedSpectrumChannel::SendRemoteTx (Ptr<SpectrumSignalParameters> params, uint32_t txPhyId,
+                                                uint32_t rank, Ptr<NetDevice> proxy)
+{
+  NS_LOG_FUNCTION (this << params << txPhyId << rank);
+  Ptr<MmwaveSpectrumSignalParametersDataFrame> dataParams = StaticCast<MmwaveSpectrumSignalParametersDataFrame> (params);
+
+  MmWaveRemoteSignalHeader header;
+  header.m_channelId = m_channelId;
+  header.m_txPhyId = txPhyId;
+  header.m_duration = dataParams->duration;
+  header.m_cellId = dataParams->cellId;
+  header.m_slotInd = dataParams->slotInd;
+  header.m_layerInd = dataParams->layerInd;
+  header.m_txIsEnb = dataParams->txIsEnb;
+  Ptr<MobilityModel> mobility = params->txPhy->GetMobility ();
+  if (mobility != 0)
+    {
+      header.m_position = mobility->GetPosition ();
+      header.m_velocity = mobility->GetVelocity ();
+    }
+  header.m_psd.assign (params->psd->ConstValuesBegin (), params->psd->ConstValuesEnd ());
+
+  // the configuration of the array is sent only when it changed since the
+  // last signal sent to the same rank
+  Ptr<AntennaArrayModel> antenna = DynamicCast<AntennaArrayModel> (params->txAntenna);
+  if (antenna != 0)
+    {
+      std::pair<uint32_t, Ptr<AntennaModel> > key (rank, params->txAntenna);
+      std::map<std::pair<uint32_t, Ptr<AntennaModel> >, uint64_t>::iterator it = m_sentAntennas.find (key);
+      if (it == m_sentAntennas.end () || it->second != antenna->GetConfigurationId ())
+        {
+          header.m_hasAntenna = true;
+          header.m_antenna.Take (antenna);
+          m_sentAntennas[key] = antenna->GetConfigurationId ();
+        }
+    }
+
+  Ptr<Packet> message = Create<Packet> ();
+  message->AddHeader (header);
+  uint32_t size = message->GetSize ();
+  uint32_t count = (size + FRAGMENT_SIZE - 1) / FRAGMENT_SIZE;
+  NS_ABORT_MSG_IF (count > 0xffff, "Signal too large to be forwarded: " << size << " bytes");
+
+  MmWaveRemoteFragmentHeader fragmentHeader;
+  fragmentHeader.m_sourceRank = MpiInterface::GetSystemId ();
+  fragmentHeader.m_sequence = s_sequences[rank]++;
+  fragmentHeader.m_count = count;
+  Time rxTime = Simulator::Now () + m_lookahead;
+  for (uint32_t k = 0; k < count; k++)
+    {
+      uint32_t offset = k * FRAGMENT_SIZE;
+      Ptr<Packet> fragment = message->CreateFragment (offset, std::min (FRAGMENT_SIZE, size - offset));
+      fragmentHeader.m_index = k;
+      fragment->AddHeader (fragmentHeader);
+      MpiInterface::SendPacket (fragment, rxTime, proxy->GetNode ()->GetId (), proxy->GetIfIndex ());
+    }
+}
+
+void
+MmWaveDistributedSpectrumChannel::ReceiveFragment (Ptr<Packet> p)
+{
+  NS_LOG_FUNCTION (p);
+  MmWaveRemoteFragmentHeader fragmentHeader;
+  p->RemoveHeader (fragmentHeader);
+  std::pair<uint32_t, uint32_t> key (fragmentHeader.m_sourceRank, fragmentHeader.m_sequence);
+  std::map<uint16_t, Ptr<Packet> > &fragments = s_fragments[key];
+  fragments[fragmentHeader.m_index] = p;
+  if (fragments.size () < fragmentHeader.m_count)
+    {
+      return;
+    }
+
+  Ptr<Packet> message = Create<Packet> ();
+  for (std::map<uint16_t, Ptr<Packet> >::const_iterator it = fragments.begin (); it != fragments.end (); ++it)
+    {
+      message->AddAtEnd (it->second);
+    }
+  s_fragments.erase (key);
+  s_messages[key] = message;
+
+  // the MPI interface does not preserve the order of the messages: the
+  // messages of this time step are delivered by a single event, scheduled
+  // after the ones of their fragments
+  if (!s_deliverEvent.IsRunning ())
+    {
+      s_deliverEvent = Simulator::ScheduleNow (&MmWaveDistributedSpectrumChannel::DeliverMessages);
+    }
+}
+
+void
+MmWaveDistributedSpectrumChannel::DeliverMessages (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  s_deliverEvent = EventId ();
+  while (!s_messages.empty ())
+    {
+      Ptr<Packet> message = s_messages.begin ()->second;
+      s_messages.erase (s_messages.begin ());
+      MmWaveRemoteSignalHeader header;
+      message->RemoveHeader (header);
+      NS_ASSERT_MSG (header.m_channelId < s_channels.size () && s_channels[header.m_channelId] != 0,
+                     "Unknown channel " << header.m_channelId << ": all the ranks must create the same channels");
+      s_channels[header.m_channelId]->StartRemoteTx (header);
+    }
+}
+
+void
+MmWaveDistributedSpectrumChannel::StartRemoteTx (const MmWaveRemoteSignalHeader &header)
+{
+  NS_LOG_FUNCTION (this << header);
+  NS_ASSERT_MSG (header.m_txPhyId < m_txPhys.size (),
+                 "Unknown transmitter " << header.m_txPhyId << ": all the ranks must register the same transmitters");
+  Ptr<SpectrumPhy> txPhy = m_txPhys[header.m_txPhyId];
+  NS_ASSERT_MSG (!IsLocal (txPhy), "Signal of the local transmitter " << header.m_txPhyId << " received from a remote rank");
+
+  // move the replica of the transmitter where the transmitter is
+  Ptr<MobilityModel> mobility = txPhy->GetMobility ();
+  if (mobility != 0)
+    {
+      Vector position = mobility->GetPosition ();
+      if (position.x != header.m_position.x || position.y != header.m_position.y || position.z != header.m_position.z)
+        {
+          mobility->SetPosition (header.m_position);
+        }
+      Ptr<ConstantVelocityMobilityModel> cvMobility = DynamicCast<ConstantVelocityMobilityModel> (mobility);
+      if (cvMobility != 0)
+        {
+          Vector velocity = cvMobility->GetVelocity ();
+          if (velocity.x != header.m_velocity.x || velocity.y != header.m_velocity.y || velocity.z != header.m_velocity.z)
+            {
+              cvMobility->SetVelocity (header.m_velocity);
+            }
+        }
+    }
+
+  Ptr<AntennaModel> antenna = txPhy->GetRxAntenna ();
+  if (header.m_hasAntenna && antenna != 0)
+    {
+      RemoteAntenna &remoteAntenna = m_remoteAntennas[antenna];
+      remoteAntenna.snapshot = header.m_antenna;
+      remoteAntenna.applied = false;
+    }
+  ApplyRemoteAntenna (antenna);
+
+  Ptr<MmwaveSpectrumSignalParametersDataFrame> params = Create<MmwaveSpectrumSignalParametersDataFrame> ();
+  params->duration = header.m_duration;
+  params->txPhy = txPhy;
+  params->txAntenna = antenna;
+  params->psd = Create<SpectrumValue> (GetRemoteSpectrumModel (txPhy, header.m_psd.size ()));
+  std::copy (header.m_psd.begin (), header.m_psd.end (), params->psd->ValuesBegin ());
+  params->packetBurst = Create<PacketBurst> ();
+  params->cellId = header.m_cellId;
+  params->slotInd = header.m_slotInd;
+  params->layerInd = header.m_layerInd;
+  params->txIsEnb = header.m_txIsEnb;
+  MultiModelSpectrumChannel::StartTx (params);
+}
+
+Ptr<const SpectrumModel>
+MmWaveDistributedSpectrumChannel::GetRemoteSpectrumModel (Ptr<SpectrumPhy> txPhy, uint32_t numBands) const
+{
+  // the replicas of the remote UEs are not attached, hence they may miss
+  // the spectrum model, which is then taken from another device with the
+  // same number of bands
+  Ptr<const SpectrumModel> model = txPhy->GetRxSpectrumModel ();
+  for (uint32_t i = 0; model == 0 && i < m_txPhys.size (); i++)
+    {
+      Ptr<const SpectrumModel> candidate = m_txPhys[i]->GetRxSpectrumModel ();
+      if (candidate != 0 && candidate->GetNumBands () == numBands)
+        {
+          model = candidate;
+        }
+    }
+  NS_ASSERT_MSG (model != 0, "No spectrum model for the replica of the transmitter");
+  NS_ASSERT_MSG (model->GetNumBands () == numBands,
+                 "The spectrum models of the transmitter and of its replica differ");
+  return model;
+}
+
+void
+MmWaveDistributedSpectrumChannel::ApplyRemoteAntenna (Ptr<AntennaModel> antenna)
+{
+  std::map<Ptr<AntennaModel>, RemoteAntenna>::iterator it = m_remoteAntennas.find (antenna);
+  if (it == m_remoteAntennas.end ())
+    {
+      return;
+    }
+  // the replica of the remote device may have changed the configuration
+  Ptr<AntennaArrayModel> array = DynamicCast<AntennaArrayModel> (antenna);
+  if (!it->second.applied || array->GetConfigurationId () != it->second.configurationId)
+    {
+      it->second.snapshot.Apply (array);
+      it->second.configurationId = array->GetConfigurationId ();
+      it->second.applied = true;
+    }
+}
+
+void
+MmWaveDistributedSpectrumChannel::StartRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver)
+{
+  NS_LOG_FUNCTION (this << params << receiver);
+  if (IsDistributed () && !IsLocal (params->txPhy))
+    {
+      // the beamforming gain is computed with the configuration of the
+      // remote array
+      ApplyRemoteAntenna (params->txAntenna);
+    }
+  MultiModelSpectrumChannel::StartRx (params, receiver);
+}
+
+} // namespace mmwave
+
+} // namespace ns3
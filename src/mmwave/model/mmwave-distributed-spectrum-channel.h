@@ -0,0 +1,255 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2020 SIGNET Lab, Department of Information Engineering,
+ *   University of Padova
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MMWAVE_DISTRIBUTED_SPECTRUM_CHANNEL_H
+#define MMWAVE_DISTRIBUTED_SPECTRUM_CHANNEL_H
+
+#include <ns3/multi-model-spectrum-channel.h>
+#include <ns3/antenna-array-model.h>
+#include <ns3/header.h>
+#include <ns3/packet.h>
+#include <ns3/nstime.h>
+#include <ns3/event-id.h>
+#include <ns3/vector.h>
+#include <map>
+#include <vector>
+
+namespace ns3 {
+
+namespace mmwave {
+
+/**
+ * \ingroup mmwave
+ * The beamforming configuration of an AntennaArrayModel, which is sent to
+ * the other MPI ranks together with the signals of the array.
+ */
+struct MmWaveRemoteAntennaSnapshot
+{
+  MmWaveRemoteAntennaSnapshot ();
+
+  /**
+   * Take a snapshot of the current configuration of an array
+   * \param antenna the array
+   */
+  void Take (Ptr<AntennaArrayModel> antenna);
+  /**
+   * Configure an array as the one of the snapshot
+   * \param antenna the array
+   */
+  void Apply (Ptr<AntennaArrayModel> antenna) const;
+
+  bool omni;                 ///< whether the array is omni
+  uint8_t numLayers;         ///< the number of layers of the array
+  std::map<uint8_t, AntennaArrayBasicModel::BeamformingVector> vectors; ///< the beamforming vector of each layer
+  bool digitalCombining;     ///< whether the digital combining is on
+  AntennaArrayModel::complex3DVector_t combining; ///< the digital combining matrix
+};
+
+/**
+ * \ingroup mmwave
+ * Header of a data frame forwarded to a remote MPI rank by the
+ * MmWaveDistributedSpectrumChannel: it carries the parameters of the
+ * signal, the mobility of the transmitter and, when it changed since the
+ * last frame sent to the same rank, the configuration of its array.
+ */
+class MmWaveRemoteSignalHeader : public Header
+{
+public:
+  MmWaveRemoteSignalHeader ();
+
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+  virtual void Print (std::ostream &os) const;
+
+  uint32_t m_channelId;      ///< the channel of the signal
+  uint32_t m_txPhyId;        ///< the transmitter, in the registration order of the channel
+  Time m_duration;           ///< the duration of the signal
+  uint16_t m_cellId;         ///< the cell of the transmitter
+  uint8_t m_slotInd;         ///< the slot of the signal
+  uint8_t m_layerInd;        ///< the layer of the signal
+  bool m_txIsEnb;            ///< whether the transmitter is an eNB
+  Vector m_position;         ///< the position of the transmitter
+  Vector m_velocity;         ///< the velocity of the transmitter
+  std::vector<double> m_psd; ///< the transmitted power spectral density
+  bool m_hasAntenna;         ///< whether m_antenna is valid
+  MmWaveRemoteAntennaSnapshot m_antenna; ///< the configuration of the array of the transmitter
+};
+
+/**
+ * \ingroup mmwave
+ * Header of a fragment of a MmWaveRemoteSignalHeader, since the MPI
+ * interface limits the size of the messages.
+ */
+class MmWaveRemoteFragmentHeader : public Header
+{
+public:
+  MmWaveRemoteFragmentHeader ();
+
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+  virtual void Print (std::ostream &os) const;
+
+  uint32_t m_sourceRank;     ///< the rank which sent the message
+  uint32_t m_sequence;       ///< the sequence number of the message, per source and destination ranks
+  uint16_t m_index;          ///< the index of the fragment
+  uint16_t m_count;          ///< the number of fragments of the message
+};
+
+/**
+ * \ingroup mmwave
+ * A MultiModelSpectrumChannel whose devices are partitioned across the
+ * ranks of an MPI simulation run by the DistributedSimulatorImpl.
+ *
+ * Every rank builds the whole scenario, so that the transmitters of the
+ * channel are registered in the same order everywhere, but only the
+ * receivers of the nodes of the local rank are added to the channel. The
+ * data frames of the local transmitters are delivered locally as by the
+ * MultiModelSpectrumChannel and forwarded to the other ranks with their
+ * PSD, the mobility of the transmitter and the configuration of its array,
+ * which are applied to the local replica of the transmitter before the
+ * frame is delivered to the local receivers. Hence the channel matrices and
+ * the beamforming gains are computed by the rank of the receiver.
+ *
+ * The frames reach the other ranks after the Lookahead of the channel,
+ * which is also the lookahead of the DistributedSimulatorImpl and should be
+ * the slot duration: the interference from the cells of the other ranks is
+ * thus received one slot late. The control frames are not forwarded, hence
+ * the UEs must be on the rank of their serving eNB. The frames transmitted
+ * by the replicas of the remote devices are discarded.
+ *
+ * Without MPI, or with a single rank, the channel behaves as the
+ * MultiModelSpectrumChannel.
+ */
+class MmWaveDistributedSpectrumChannel : public MultiModelSpectrumChannel
+{
+public:
+  MmWaveDistributedSpectrumChannel ();
+  virtual ~MmWaveDistributedSpectrumChannel ();
+
+  static TypeId GetTypeId (void);
+
+  // inherited from SpectrumChannel
+  virtual void AddRx (Ptr<SpectrumPhy> phy);
+  virtual void StartTx (Ptr<SpectrumSignalParameters> params);
+
+  /**
+   * Register a transmitter of the channel. All the ranks must register the
+   * same transmitters in the same order, since they are identified by the
+   * registration order.
+   * \param phy the transmitter
+   */
+  void AddTxPhy (Ptr<SpectrumPhy> phy);
+
+protected:
+  virtual void DoDispose ();
+  virtual void StartRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver);
+
+private:
+  /**
+   * \return true if the simulation runs on more than one MPI rank
+   */
+  static bool IsDistributed (void);
+  /**
+   * \param phy a spectrum phy
+   * \return true if the node of the phy belongs to the local rank
+   */
+  static bool IsLocal (Ptr<SpectrumPhy> phy);
+  /**
+   * Set the lookahead of the DistributedSimulatorImpl to the minimum
+   * lookahead of the channels.
+   */
+  static void SetSimulatorLookahead (void);
+  /**
+   * Choose, for each rank, the device which receives the messages of the
+   * other ranks, and install the MpiReceiver on the local one.
+   */
+  void SetUpRemoteDelivery (void);
+  /**
+   * Forward a data frame of a local transmitter to a remote rank.
+   * \param params the parameters of the frame
+   * \param txPhyId the identifier of the transmitter
+   * \param rank the remote rank
+   * \param proxy the device of the rank receiving the messages
+   */
+  void SendRemoteTx (Ptr<SpectrumSignalParameters> params, uint32_t txPhyId,
+                     uint32_t rank, Ptr<NetDevice> proxy);
+  /**
+   * Deliver to the local receivers a data frame forwarded by a remote rank.
+   * \param header the frame
+   */
+  void StartRemoteTx (const MmWaveRemoteSignalHeader &header);
+  /**
+   * \param txPhy the replica of a remote transmitter
+   * \param numBands the number of bands of the PSD of the frame
+   * \return the spectrum model of the frames of the transmitter
+   */
+  Ptr<const SpectrumModel> GetRemoteSpectrumModel (Ptr<SpectrumPhy> txPhy, uint32_t numBands) const;
+  /**
+   * Configure the replica of a remote array as in the last snapshot
+   * received, if its configuration changed in the meantime.
+   * \param antenna the replica of the array
+   */
+  void ApplyRemoteAntenna (Ptr<AntennaModel> antenna);
+
+  /**
+   * Receive a fragment of a message of a remote rank.
+   * \param p the fragment
+   */
+  static void ReceiveFragment (Ptr<Packet> p);
+  /**
+   * Deliver the messages received, in the order of their source rank and
+   * sequence number, so that the results do not depend on the order of
+   * arrival.
+   */
+  static void DeliverMessages (void);
+
+  /// the configuration of the replica of a remote array
+  struct RemoteAntenna
+  {
+    MmWaveRemoteAntennaSnapshot snapshot; ///< the last configuration received
+    uint64_t configurationId;             ///< the configuration id of the replica after the snapshot was applied
+    bool applied;                         ///< whether the snapshot was applied
+  };
+
+  Time m_lookahead;          ///< the delay of the frames forwarded to the other ranks
+  uint32_t m_channelId;      ///< the identifier of the channel, i.e., its construction order
+  std::vector<Ptr<SpectrumPhy> > m_txPhys; ///< the registered transmitters
+  std::map<Ptr<SpectrumPhy>, uint32_t> m_txPhyIds; ///< the identifiers of the registered transmitters
+  std::map<uint32_t, Ptr<NetDevice> > m_remoteProxies; ///< the device receiving the messages on each remote rank
+  std::map<std::pair<uint32_t, Ptr<AntennaModel> >, uint64_t> m_sentAntennas; ///< the configuration id of the local arrays last sent to each rank
+  std::map<Ptr<AntennaModel>, RemoteAntenna> m_remoteAntennas; ///< the configuration of the replicas of the remote arrays
+
+  static std::vector<MmWaveDistributedSpectrumChannel *> s_channels; ///< the channels, in construction order
+  static std::map<uint32_t, uint32_t> s_sequences; ///< the sequence number of the next message to each rank
+  static std::map<std::pair<uint32_t, uint32_t>, std::map<uint16_t, Ptr<Packet> > > s_fragments; ///< the fragments of the incomplete messages
+  static std::map<std::pair<uint32_t, uint32_t>, Ptr<Packet> > s_messages; ///< the complete messages to deliver
+  static EventId s_deliverEvent; ///< the event delivering the complete messages
+};
+
+} // namespace mmwave
+
+} // namespace ns3
+
+#endif /* MMWAVE_DISTRIBUTED_SPECTRUM_CHANNEL_H */
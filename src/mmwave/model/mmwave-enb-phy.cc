@@ -253,14 +253,14 @@ MmWaveEnbPhy::DoInitialize (void)
 void
 MmWaveEnbPhy::DoDispose (void)
 {
-
+  m_ueDeviceIndex.clear ();
 }
 
 
 // TODO remove these methods
 //Function for average
 double
-MmWaveEnbPhy::MakeAvg ( std::vector<double> v )
+MmWaveEnbPhy::MakeAvg (const std::vector<double>& v)
 {
   double return_value = 0.0;
   int n = v.size ();
@@ -277,7 +277,7 @@ MmWaveEnbPhy::MakeAvg ( std::vector<double> v )
 
 //Function for variance
 double
-MmWaveEnbPhy::MakeVar ( std::vector<double> v, double mean )
+MmWaveEnbPhy::MakeVar (const std::vector<double>& v, double mean)
 {
   double sum = 0.0;
   double temp = 0.0;
@@ -316,27 +316,24 @@ MmWaveEnbPhy::AddGaussianNoise (double LastSinrValue)
 
 
 
-std::pair<uint64_t, uint64_t>
-MmWaveEnbPhy::ApplyFilter (std::vector<double> noisySinr)
+double
+MmWaveEnbPhy::MakePairVar (double first, double second)
 {
-  std::vector<double> noisySinrdB;
-  for (uint64_t i = 0; i < noisySinr.size (); ++i)
-    {
-      noisySinrdB.push_back (10 * std::log10 (noisySinr.at (i)));
-    }
+  // same operations of MakeVar (v, MakeAvg (v)) with v = {first, second}
+  double mean = (0.0 + first + second) / 2;
+  double sum = 0.0;
+  sum += std::pow ((first - mean),2);
+  sum += std::pow ((second - mean),2);
+  return sum / 2;
+}
 
-  std::vector<double> vectorVar;
-  NS_LOG_DEBUG ("noisySinrdBSize() " << noisySinrdB.size ());
-  for (uint64_t i = 0; i < noisySinrdB.size () - 1; ++i)
-    {
-      std::vector<double> partialSamples;
-      partialSamples.push_back (noisySinrdB.at (i));
-      partialSamples.push_back (noisySinrdB.at (i + 1));
-      double meanValue = MakeAvg (partialSamples);
-      double varValue = MakeVar (partialSamples,meanValue);
-      vectorVar.push_back (varValue);
-      partialSamples.clear ();
-    }
+std::pair<uint64_t, uint64_t>
+MmWaveEnbPhy::ApplyFilter (const MmWaveSinrWindow& noisySinr, const MmWaveSinrWindow& vectorVar)
+{
+  // vectorVar holds the variances of the consecutive noisy samples in dB,
+  // updated for each new sample
+  NS_ASSERT_MSG (vectorVar.GetSize () + 1 == noisySinr.GetSize (), "The variances do not match the noisy SINR samples");
+  NS_LOG_DEBUG ("noisySinrdBSize() " << noisySinr.GetSize ());
 
   uint64_t startFilter = 1e6;
   uint64_t endFilter = 1e6;
@@ -346,14 +343,13 @@ MmWaveEnbPhy::ApplyFilter (std::vector<double> noisySinr)
 
   uint64_t noisySinrIndex = 0;
 
-  for (uint64_t varIndex = vectorVar.size () - 1; varIndex > 0; varIndex--)      // start filter when variance of the noisy trace is high
+  for (uint64_t varIndex = vectorVar.GetSize () - 1; varIndex > 0 && varIndex < vectorVar.GetSize (); varIndex--)      // start filter when variance of the noisy trace is high
     {
       NS_LOG_DEBUG ("varIndex " << varIndex);
       noisySinrIndex = varIndex + 1;
-      NS_LOG_DEBUG ("vectorVar[i] " << vectorVar.at (varIndex));
-      NS_LOG_DEBUG ("vectorVar[i] == NaN " << (std::isnan (vectorVar.at (varIndex))));
-      bool highVariance = (vectorVar.at (varIndex) > 5 || std::isnan (vectorVar.at (varIndex)));
-      bool lowSinr = noisySinr.at (noisySinrIndex) < 10;
+      NS_LOG_DEBUG ("vectorVar[i] " << vectorVar.At (varIndex));
+      bool highVariance = (vectorVar.At (varIndex) > 5 || std::isnan (vectorVar.At (varIndex)));
+      bool lowSinr = noisySinr.At (noisySinrIndex) < 10;
 
       if (highVariance || (lowSinr && !highVariance))            // filter is applied only for low-SINR regimes [dB]
         {
@@ -371,73 +367,45 @@ MmWaveEnbPhy::ApplyFilter (std::vector<double> noisySinr)
   /* in this case, consider at least a window of 15 samples, after which we can consider
   * as we are leaving the blockage phase and we start coming back to LOS PL regimes
   */
-  uint64_t varIndex = 0;
-  uint64_t numberOfVarWindow = 16;
-  NS_LOG_DEBUG ("VectorVarSize() " << vectorVar.size ());
-  for (uint64_t noisySinrIndex = endFilter; noisySinrIndex > numberOfVarWindow; --noisySinrIndex)       // must be at least after the beginnning of the blocakge
+  const uint64_t numberOfVarWindow = 16;
+  // number of variances not below 1 (or NaN) in the window [noisySinrIndex - numberOfVarWindow, noisySinrIndex - 1)
+  // and number of noisy samples not above 10 dB in the window [noisySinrIndex - numberOfVarWindow, noisySinrIndex),
+  // which slide back with noisySinrIndex
+  uint64_t highVarSamples = 0;
+  uint64_t lowSinrSamples = 0;
+  if (endFilter > numberOfVarWindow)
     {
-      NS_LOG_DEBUG ("noisySinrIndex " << noisySinrIndex);
-      varIndex = noisySinrIndex - 1;
-
-      std::vector<double>::const_iterator first = vectorVar.begin () + varIndex;
-      std::vector<double>::const_iterator last = vectorVar.begin () + varIndex - (numberOfVarWindow - 1);          // vectorVar has one sample less than noisySinrdB
-      std::vector<double> prov (last,first);
-
-      std::vector<double>::const_iterator firstNoisy = noisySinrdB.begin () + noisySinrIndex;
-      std::vector<double>::const_iterator lastNoisy = noisySinrdB.begin () + noisySinrIndex - numberOfVarWindow;
-      std::vector<double> provNoisy (lastNoisy,firstNoisy);
-
-      NS_LOG_INFO ("provNoisy.size " << provNoisy.size ());
-      for (std::vector<double>::const_iterator h = provNoisy.begin (); h != provNoisy.end (); h++)
+      for (uint64_t i = endFilter - numberOfVarWindow; i < endFilter - 1; i++)
         {
-          NS_LOG_INFO ("h " << *h);
-          NS_LOG_INFO ("i " << noisySinrIndex  );
-          NS_LOG_INFO ("hh " << *(noisySinrdB.begin () + noisySinrIndex - numberOfVarWindow));
+          highVarSamples += !(vectorVar.At (i) < 1);
         }
-
+      for (uint64_t i = endFilter - numberOfVarWindow; i < endFilter; i++)
+        {
+          lowSinrSamples += !(10 * std::log10 (noisySinr.At (i)) > 10);
+        }
+    }
+  for (uint64_t noisySinrIndex = endFilter; noisySinrIndex > numberOfVarWindow; --noisySinrIndex)       // must be at least after the beginnning of the blocakge
+    {
+      NS_LOG_DEBUG ("noisySinrIndex " << noisySinrIndex);
 
       /* the filtering ends when the variance of the noisy trace is almost the same, so when
       * the SINR is on sufficiently high values
       */
-
-      if (Simulator::Now () > Seconds (2.1) && Simulator::Now () < Seconds (2.3))
-        {
-          NS_LOG_DEBUG ("(std::all_of(prov.begin(),prov.end(), [](double j){return j < 1;})) " << (std::all_of (prov.begin (),prov.end (), [] (double j){
-                                                                                                                  return j < 1;
-                                                                                                                })));
-          NS_LOG_DEBUG ("(std::all_of(prov.begin(),prov.end(), [](double j){nan;})) " << (std::all_of (prov.begin (),prov.end (), [] (double k){
-                                                                                                         return !std::isnan (k);
-                                                                                                       })));
-          NS_LOG_DEBUG ("(std::all_of(provNoisy.begin(),provNoisy.end(), [](double p){return p > 10;})) " << (std::all_of (provNoisy.begin (),provNoisy.end (), [] (double p){
-                                                                                                                             return p > 10;
-                                                                                                                           })));
-        }
-
-      if (((std::all_of (prov.begin (),prov.end (), [] (double j){
-                           return j < 1;
-                         }))
-           && (std::all_of (prov.begin (),prov.end (), [] (double k){
-                              return !std::isnan (k);
-                            })))
-          || (std::all_of (provNoisy.begin (),provNoisy.end (), [] (double p){
-                             return p > 10;
-                           })))
+      if (highVarSamples == 0 || lowSinrSamples == 0)
         {
           startFilter = noisySinrIndex;
           flagStartFilter = false;               // a "end" sample has been identified
           break;
         }
 
-      // bool lowVariance = (vectorVar.at(varIndex) < 1 && !std::isnan(vectorVar.at(varIndex)));
-      // bool highSinr = noisySinr.at(noisySinrIndex) > 10;
-
-      // if (highSinr && lowVariance)  // filter is applied only for low-SINR regimes [dB]
-      // {
-      //        startFilter = noisySinrIndex;
-      //        flagStartFilter = false; // a "start" sample has been identified
-      //        break;
-      // }
-
+      if (noisySinrIndex - 1 > numberOfVarWindow)
+        {
+          uint64_t oldest = noisySinrIndex - 1 - numberOfVarWindow;
+          highVarSamples += !(vectorVar.At (oldest) < 1);
+          highVarSamples -= !(vectorVar.At (noisySinrIndex - 2) < 1);
+          lowSinrSamples += !(10 * std::log10 (noisySinr.At (oldest)) > 10);
+          lowSinrSamples -= !(10 * std::log10 (noisySinr.At (noisySinrIndex - 1)) > 10);
+        }
     }
 
   if (flagStartFilter)       // in this case, filter till the end of the trace
@@ -909,19 +877,18 @@ MmWaveEnbPhy::UpdateUeSinrEstimate ()
       if (m_noiseAndFilter)
         {
           pairDevices_t pairDevices = std::make_pair (ue->first, m_cellId);              // this is the current pair (UE-eNB)
-          std::map< pairDevices_t, std::vector<double> >::iterator iteratorSinr =
+          std::map< pairDevices_t, MmWaveSinrWindow >::iterator iteratorSinr =
             m_sinrVector.find (pairDevices);                                                     // pair [pairDevices,Sinrvalue]
 
           if (iteratorSinr != m_sinrVector.end ())              // this map has already been initialized, so I can add a new element for the SINR collection
             {
               if (Now ().GetMicroSeconds () <= m_transient )
                 {
-                  m_sinrVector.at (pairDevices).push_back (sinrAvg);                     // before transient, so just collect SINR values
+                  iteratorSinr->second.Push (sinrAvg);                     // before transient, so just collect SINR values
                 }
               else
                 {
-                  m_sinrVector.at (pairDevices).erase (m_sinrVector.at (pairDevices).begin ());
-                  m_sinrVector.at (pairDevices).push_back (sinrAvg);                     // before transient, so just collect SINR values
+                  iteratorSinr->second.Slide (sinrAvg);                     // after transient, the oldest SINR value is dropped
                 }
 
               NS_LOG_DEBUG ("At time " << Now ().GetMicroSeconds () << " push back the REAL SINR " << 10 * std::log10 (sinrAvg) <<
@@ -929,8 +896,7 @@ MmWaveEnbPhy::UpdateUeSinrEstimate ()
             }
           else               // vector is not initialized, so it means that we are still in the initial transient phase, for that pair
             {
-              m_sinrVector.insert (std::pair<pairDevices_t, std::vector<double> > (pairDevices,std::vector<double> ()));
-              m_sinrVector.at (pairDevices).push_back (sinrAvg);                 // push back a new SINR value
+              m_sinrVector[pairDevices].Push (sinrAvg);                 // push back a new SINR value
               NS_LOG_DEBUG ("At time " << Now ().GetMicroSeconds () << " first initializazion and push back the SINR " << 10 * std::log10 (sinrAvg) <<
                             " for pair with CellId " << m_cellId << " and UE " << ue->first);
             }
@@ -938,46 +904,34 @@ MmWaveEnbPhy::UpdateUeSinrEstimate ()
 
 
 
-          std::map< pairDevices_t, std::vector<double> >::iterator iteratorFinalTrace =
-            m_finalSinrVector.find (pairDevices);                                             // pair [pairDevices,Sinrvalue]
           /* INITIALIZATION OF VECTORS */
-          if (iteratorFinalTrace == m_finalSinrVector.end ())
-            {
-              m_samplesFilter.insert (std::pair<pairDevices_t,std::pair<uint64_t,uint64_t> > (pairDevices,std::pair<uint64_t,uint64_t> ()));
-              m_finalSinrVector.insert (std::pair<pairDevices_t,std::vector<double> > (pairDevices,std::vector<double> ()) );
-            }
-
-
-          std::map< pairDevices_t, std::vector<double> >::iterator iteratorSinrToFilter =
-            m_sinrVectorToFilter.find (pairDevices);                                             // pair [pairDevices,Sinrvalue]
-          /* INITIALIZATION OF VECTORS */
-          if (iteratorSinrToFilter == m_sinrVectorToFilter.end ())
-            {
-              m_sinrVectorToFilter.insert (std::pair<pairDevices_t,std::vector<double> > (pairDevices,std::vector<double> ()));
-              m_sinrVectorNoisy.insert (std::pair<pairDevices_t,std::vector<double> > (pairDevices,std::vector<double> ()));
-            }
+          MmWaveSinrWindow& sinrToFilter = m_sinrVectorToFilter[pairDevices];
+          MmWaveSinrWindow& sinrNoisyWindow = m_sinrVectorNoisy[pairDevices];
+          MmWaveSinrWindow& sinrNoisyVar = m_sinrVectorNoisyVar[pairDevices];
 
           /* generate Gaussian noise for the last SINR value (that is the current one) */
-          double sinrNoisy = AddGaussianNoise (m_sinrVector.at (pairDevices).back ());
+          double sinrNoisy = AddGaussianNoise (m_sinrVector.at (pairDevices).Back ());
+          // the variance between the new noisy sample and the previous one, used by ApplyFilter
+          bool hasPreviousNoisy = (sinrNoisyWindow.GetSize () > 0);
+          double previousNoisy = hasPreviousNoisy ? sinrNoisyWindow.Back () : 0;
 
 
           /* UPDATE TRACE TO BE FILTERED */
           if (Now ().GetMicroSeconds () <= m_transient)
             {
-              m_sinrVectorNoisy.at (pairDevices).push_back (sinrNoisy);
+              sinrNoisyWindow.Push (sinrNoisy);
 
               // if (sinrNoisy < 0)
               // {
               //        NS_LOG_DEBUG("Old SINR value was " << 10*std::log10(sinrNoisy) << " while now is " << 10*std::log10(0.1));
               //        sinrNoisy = 0.1;
               // }
-              m_sinrVectorToFilter.at (pairDevices).push_back (sinrNoisy);
+              sinrToFilter.Push (sinrNoisy);
 
             }
           else
             {
-              m_sinrVectorNoisy.at (pairDevices).erase (m_sinrVectorNoisy.at (pairDevices).begin ());
-              m_sinrVectorNoisy.at (pairDevices).push_back (sinrNoisy);
+              sinrNoisyWindow.Slide (sinrNoisy);
 
               // if (sinrNoisy < 0)
               // {
@@ -985,64 +939,64 @@ MmWaveEnbPhy::UpdateUeSinrEstimate ()
               //        sinrNoisy = 0.1;
               // }
 
-              double toPlot = *m_sinrVectorToFilter.at (pairDevices).begin ();
-              double toPlotbis = sinrNoisy;
-              NS_LOG_DEBUG ("(Remove SINR)  " << toPlot);
-              NS_LOG_DEBUG ("(Add SINR)  " << toPlotbis);
+              NS_LOG_DEBUG ("(Remove SINR)  " << (sinrToFilter.GetSize () > 0 ? sinrToFilter.At (0) : 0));
+              NS_LOG_DEBUG ("(Add SINR)  " << sinrNoisy);
+
+              sinrToFilter.Slide (sinrNoisy);
 
-              m_sinrVectorToFilter.at (pairDevices).erase (m_sinrVectorToFilter.at (pairDevices).begin ());
-              m_sinrVectorToFilter.at (pairDevices).push_back (sinrNoisy);
 
+            }
 
+          if (hasPreviousNoisy && sinrNoisyWindow.GetSize () > 1)
+            {
+              double sinrVar = MakePairVar (10 * std::log10 (previousNoisy), 10 * std::log10 (sinrNoisy));
+              if (sinrNoisyVar.GetSize () + 1 < sinrNoisyWindow.GetSize ())
+                {
+                  sinrNoisyVar.Push (sinrVar);
+                }
+              else
+                {
+                  sinrNoisyVar.Slide (sinrVar);
+                }
             }
 
 
           if (Now ().GetMicroSeconds () > m_transient)             // apply filter only when I have a sufficiently large set of SINR samples
             {
-              std::vector<double> vectorNoisy = m_sinrVectorNoisy.at (pairDevices);
-              std::pair <uint64_t, uint64_t > pairFiltering = ApplyFilter (vectorNoisy);                   // find where to apply the filter, according to the variance
-              m_samplesFilter.at (pairDevices) = pairFiltering;                  // where to apply the linear filter
+              std::pair <uint64_t, uint64_t > pairFiltering = ApplyFilter (sinrNoisyWindow, sinrNoisyVar);                   // find where to apply the filter, according to the variance
               NS_LOG_DEBUG ("£££££££££££££££ start at sample " << std::get<0> (pairFiltering) );
               NS_LOG_DEBUG ("£££££££££££££££ end at sample " << std::get<1> (pairFiltering) );
 
+              /* the last sample in the filtered sequence is referred to the current time instant,
+              * referred to the uplink reference signal that is used to build the RT in the LteEnbRrc class */
+              double sampleToForward;
               /* just apply filter where the SINR is too low and we are in a blockage situation */
-              if (std::get<0> (m_samplesFilter.at (pairDevices)) == std::get<1> (m_samplesFilter.at (pairDevices)) )                 // if start = end
+              if (std::get<0> (pairFiltering) == std::get<1> (pairFiltering) )                 // if start = end
                 {
-                  m_finalSinrVector.at (pairDevices) = m_sinrVectorToFilter.at (pairDevices);                     // no need to apply the filter
+                  sampleToForward = sinrToFilter.Back ();                     // no need to apply the filter
                   NS_LOG_DEBUG ("At time " << Now ().GetMicroSeconds () << " there is no need to apply the Kalman filter for mmWave eNB "
                                            << m_cellId << " and UE " << ue->first);
                 }
               else
                 {
-                  std::vector<double> vectorToFilter = m_sinrVectorToFilter.at (pairDevices);
-                  std::vector<double> sinrVector = m_sinrVector.at (pairDevices);
-                  std::pair<uint64_t, uint64_t> filterPair = m_samplesFilter.at (pairDevices);
-                  std::vector<double> finalTrace;
-                  finalTrace = MakeFilter (vectorNoisy, sinrVector, filterPair);
+                  // the whole windows are needed only when the filter is applied
+                  std::vector<double> finalTrace = MakeFilter (sinrNoisyWindow.GetSamples (), m_sinrVector.at (pairDevices).GetSamples (), pairFiltering);
                   NS_LOG_DEBUG ("finaltrace " << finalTrace.back ());
-                  m_finalSinrVector.at (pairDevices) = finalTrace;
-                  finalTrace.clear ();
+                  sampleToForward = finalTrace.back ();
                 }
+              // the filtered sample replaces the noisy one in the trace to be filtered
+              sinrToFilter.SetBack (sampleToForward);
 
-
-              /* the last sample in the filtered sequence is referred to the current time instant,
-              * referred to the uplink reference signal that is used to build the RT in the LteEnbRrc class */
-              double sampleToForward = m_finalSinrVector.at (pairDevices).back ();
               if (sampleToForward < 0)                   // this would be converted in NaN, in the log scale
                 {
                   sampleToForward = 1e-20;
                 }
               NS_LOG_DEBUG (" mmWave eNB " << m_cellId << " reports the SINR " << 10 * std::log10 (sampleToForward) << " for UE " << ue->first);
               m_sinrMap[ue->first] = sampleToForward;                   // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<< in order to FORWARD to LteEnbRrc the value of SINR for the RT
-
-              //m_sinrVectorToFilter.at(pairDevices).erase(m_sinrVectorToFilter.at(pairDevices).begin());
-              //m_sinrVectorToFilter.at(pairDevices).push_back(m_finalSinrVector.at(pairDevices).back());
-              m_sinrVectorToFilter.at (pairDevices).pop_back ();
-              m_sinrVectorToFilter.at (pairDevices).push_back (m_finalSinrVector.at (pairDevices).back ());
             }
           else               // before the transient is over, just forwart the (last) noisy sample, without having filtered
             {
-              double sampleToForward = m_sinrVectorToFilter.at (pairDevices).back ();
+              double sampleToForward = sinrToFilter.Back ();
               if (sampleToForward < 0)                   // this would be converted in NaN, in the log scale
                 {
                   sampleToForward = 1e-20;
@@ -1093,14 +1047,6 @@ MmWaveEnbPhy::UpdateUeSinrEstimate ()
 
 
 
-
-          /* after the SINR sample is forwarded, I need to REFRESH all the maps, so that
-          * a new SINR sequence can be created, to generate a new SINR sample
-          * for the next RT
-          */
-          m_finalSinrVector.erase (pairDevices);
-          m_samplesFilter.erase (pairDevices);
-          NS_LOG_DEBUG ("ERASE MAPS FOR RT");
         }
       else           // noise and filtering processes are not applied!
         {
@@ -1447,22 +1393,15 @@ MmWaveEnbPhy::StartSlot (void)
                   pktBurst->AddPacket (emptyPdu);
                 }
 
-              for (uint8_t i = 0; i < m_deviceMap.size (); i++)
+              Ptr<NetDevice> ueDevice = GetServedUeDevice (currSlot.m_dci.m_rnti);
+              if (ueDevice != 0)
                 {
-                  Ptr<mmwave::MmWaveUeNetDevice> ueDev = m_deviceMap.at (i)->GetObject<mmwave::MmWaveUeNetDevice> ();
-                  if (currSlot.m_dci.m_rnti == ueDev->GetPhy ()->GetRnti ())
+                  if ( bfCasted != 0)
                     {
-                      if ( bfCasted != 0)
-                        {
-                          vDevsInBundle.push_back(m_deviceMap.at (i));
-                          vLayersInBundle.push_back(currSlot.m_dci.m_layerInd);
-                        }
-//                      else
-//                        {
-                          GetDlSpectrumPhyList ().at(currSlot.m_dci.m_layerInd)->ConfigureBeamforming (m_deviceMap.at (i)); //always operates in the correct layerind
-//                        }
-                      break;
+                      vDevsInBundle.push_back(ueDevice);
+                      vLayersInBundle.push_back(currSlot.m_dci.m_layerInd);
                     }
+                  GetDlSpectrumPhyList ().at(currSlot.m_dci.m_layerInd)->ConfigureBeamforming (ueDevice); //always operates in the correct layerind
                 }
               NS_LOG_DEBUG ("ENB " << m_cellId << " TXing DL DATA frame " << m_frameNum << " subframe " << (unsigned) m_sfNum << " symbols "
                             << (unsigned) currSlot.m_dci.m_symStart << "-" << (unsigned) (currSlot.m_dci.m_symStart + currSlot.m_dci.m_numSym - 1)
@@ -1568,29 +1507,18 @@ MmWaveEnbPhy::StartSlot (void)
 //                                                 currSlot.m_dci.m_harqProcess, currSlot.m_dci.m_rv, false,
 //                                                 currSlot.m_dci.m_symStart, currSlot.m_dci.m_numSym);
 
-              for (uint8_t i = 0; i < m_deviceMap.size (); i++)
+              Ptr<NetDevice> ueDevice = GetServedUeDevice (currSlot.m_rnti);
+              if (ueDevice != 0)
                 {
-                  Ptr<mmwave::MmWaveUeNetDevice> ueDev = DynamicCast<mmwave::MmWaveUeNetDevice> (m_deviceMap.at (i));
-                  Ptr<McUeNetDevice> mcUeDev = DynamicCast<McUeNetDevice> (m_deviceMap.at (i));
-                  uint64_t ueRnti = (ueDev != 0) ? (ueDev->GetPhy ()->GetRnti ()) : (mcUeDev->GetMmWavePhy ()->GetRnti ());
-                  Ptr<NetDevice> associatedEnb = (ueDev != 0) ? (ueDev->GetTargetEnb ()) : (mcUeDev->GetMmWaveTargetEnb ());
+                  NS_LOG_DEBUG ("Configuring BF for rnti: " << currSlot.m_rnti << " layer Ind: " << (int)currSlot.m_dci.m_layerInd << " this eNB " << m_netDevice);
 
-                  if (currSlot.m_rnti == ueRnti && m_netDevice == associatedEnb)
+                  if ( bfCasted != 0)
                     {
-                      NS_LOG_DEBUG ("Configuring BF for rnti: " << currSlot.m_rnti << " ue rnti: " << ueRnti << " layer Ind: " << (int)currSlot.m_dci.m_layerInd<< " target eNB " << associatedEnb << " this eNB " << m_netDevice);
-
-                      if ( bfCasted != 0)
-                        {
-                          vDevsInBundle.push_back(m_deviceMap.at (i));
-                          vLayersInBundle.push_back(currSlot.m_dci.m_layerInd);
-                        }
-//                      else
-//                        {
-                      //NS_LOG_DEBUG ("Change Beamforming Vector");
-                      //Antenna model is samle for all layers
-                      GetDlSpectrumPhyList ().at(currSlot.m_dci.m_layerInd)->ConfigureBeamforming (m_deviceMap.at (i));
-                     break;
+                      vDevsInBundle.push_back(ueDevice);
+                      vLayersInBundle.push_back(currSlot.m_dci.m_layerInd);
                     }
+                  //Antenna model is samle for all layers
+                  GetDlSpectrumPhyList ().at(currSlot.m_dci.m_layerInd)->ConfigureBeamforming (ueDevice);
                 }
 
               NS_LOG_DEBUG ("ENB " << m_cellId << " RXing UL DATA frame " << m_frameNum << " subframe "
@@ -1767,33 +1695,7 @@ MmWaveEnbPhy::SendDataChannels (Ptr<PacketBurst> pb, Time slotPrd, SlotAllocInfo
     {     // update beamforming vectors (currently supports 1 user only)
       //std::map<uint16_t, std::vector<unsigned> >::iterator ueRbIt = slotInfo.m_ueRbMap.begin();
       //uint16_t rnti = ueRbIt->first;
-      for (uint8_t i = 0; i < m_deviceMap.size (); i++)
-        {
-          uint64_t ueRnti = 0;
-          Ptr<mmwave::MmWaveUeNetDevice> ueDev = m_deviceMap.at (i)->GetObject<mmwave::MmWaveUeNetDevice> ();
-          Ptr<NetDevice> associatedEnb = 0;
-          if (ueDev != 0)
-            {
-              ueRnti = ueDev->GetPhy ()->GetRnti ();
-              associatedEnb = ueDev->GetTargetEnb ();
-            }
-          else
-            {
-              Ptr<McUeNetDevice> ueMcDev = m_deviceMap.at (i)->GetObject<McUeNetDevice> ();
-              ueRnti = ueMcDev->GetMmWavePhy ()->GetRnti ();
-              associatedEnb = ueMcDev->GetMmWaveTargetEnb ();
-            }
-
-          NS_LOG_DEBUG ("Scheduled rnti: " << slotInfo.m_dci.m_rnti << " ue rnti: " << ueRnti << " target eNB " << associatedEnb << " this eNB " << m_netDevice);
-//          if (slotInfo.m_dci.m_rnti == ueRnti && m_netDevice == associatedEnb)
-//            {
-//              NS_LOG_DEBUG ("Change Beamforming Vector");
-//              //Antenna model is same for all layers but the bf vector contained in it is not
-//     	        GetDlSpectrumPhyList ().at(currSlot.m_dci.m_layerInd)->ConfigureBeamforming (m_deviceMap.at (i));
-//              break;
-//            }
-
-        }
+      NS_LOG_DEBUG ("Scheduled rnti: " << slotInfo.m_dci.m_rnti << " this eNB " << m_netDevice);
     }
 
   /*
@@ -1980,6 +1882,9 @@ MmWaveEnbPhy::AddUePhy (uint16_t rnti)
   if (it == m_ueAttachedRnti.end ())
     {
       m_ueAttachedRnti.insert (rnti);
+      // the device is resolved when the UE is first scheduled, since its
+      // RNTI is not known to the UE yet
+      m_ueDeviceIndex[rnti] = UeDeviceInfo ();
       return (true);
     }
   else
@@ -1989,6 +1894,63 @@ MmWaveEnbPhy::AddUePhy (uint16_t rnti)
     }
 }
 
+Ptr<NetDevice>
+MmWaveEnbPhy::GetServedUeDevice (uint16_t rnti)
+{
+  std::map <uint16_t, UeDeviceInfo>::iterator it = m_ueDeviceIndex.find (rnti);
+  if (it == m_ueDeviceIndex.end ())
+    {
+      // not attached through the CPHY SAP, look for it every time
+      UeDeviceInfo info;
+      return ResolveUeDevice (rnti, info) ? info.m_device : 0;
+    }
+  if (!IsServedUeDevice (rnti, it->second) && !ResolveUeDevice (rnti, it->second))
+    {
+      return 0;
+    }
+  return it->second.m_device;
+}
+
+bool
+MmWaveEnbPhy::IsServedUeDevice (uint16_t rnti, const UeDeviceInfo& info) const
+{
+  if (info.m_device == 0 || info.m_phy->GetRnti () != rnti)
+    {
+      return false;
+    }
+  Ptr<NetDevice> associatedEnb = (info.m_ueDevice != 0) ? info.m_ueDevice->GetTargetEnb () : info.m_mcUeDevice->GetMmWaveTargetEnb ();
+  return associatedEnb == m_netDevice;
+}
+
+bool
+MmWaveEnbPhy::ResolveUeDevice (uint16_t rnti, UeDeviceInfo& info) const
+{
+  NS_LOG_FUNCTION (this << rnti);
+  for (std::vector< Ptr<NetDevice> >::const_iterator dev = m_deviceMap.begin (); dev != m_deviceMap.end (); ++dev)
+    {
+      UeDeviceInfo candidate;
+      candidate.m_device = *dev;
+      candidate.m_ueDevice = DynamicCast<MmWaveUeNetDevice> (*dev);
+      if (candidate.m_ueDevice != 0)
+        {
+          candidate.m_phy = candidate.m_ueDevice->GetPhy ();
+        }
+      else
+        {
+          candidate.m_mcUeDevice = DynamicCast<McUeNetDevice> (*dev);
+          NS_ASSERT_MSG (candidate.m_mcUeDevice != 0, "Unknown UE device type");
+          candidate.m_phy = candidate.m_mcUeDevice->GetMmWavePhy ();
+        }
+      if (IsServedUeDevice (rnti, candidate))
+        {
+          info = candidate;
+          return true;
+        }
+    }
+  info = UeDeviceInfo ();
+  return false;
+}
+
 void
 MmWaveEnbPhy::DoRemoveUe (uint16_t rnti)
 {
@@ -1996,6 +1958,7 @@ MmWaveEnbPhy::DoRemoveUe (uint16_t rnti)
   if (it != m_ueAttachedRnti.end ())
     {
       m_ueAttachedRnti.erase (it);
+      m_ueDeviceIndex.erase (rnti);
     }
   else
     {
@@ -46,6 +46,7 @@
 #include <ns3/lte-enb-phy-sap.h>
 #include <ns3/lte-enb-cphy-sap.h>
 #include <ns3/mmwave-harq-phy.h>
+#include "mmwave-sinr-window.h"
 
 namespace ns3 {
 
@@ -58,6 +59,8 @@ namespace mmwave {
 class MmWaveNetDevice;
 class MmWaveUePhy;
 class MmWaveEnbMac;
+class MmWaveUeNetDevice;
+class McUeNetDevice;
 
 class MmWaveEnbPhy : public MmWavePhy
 {
@@ -135,11 +138,25 @@ public:
 
   double AddGaussianNoise (double sample);
 
-  std::pair <uint64_t,uint64_t> ApplyFilter (std::vector<double>);
+  /**
+   * Find the noisy SINR samples to be filtered
+   * \param noisySinr the window of the noisy SINR samples
+   * \param noisySinrVar the variances of the consecutive noisy SINR samples in dB,
+   *        one less than the noisy samples
+   * \return the first and the last sample to be filtered
+   */
+  std::pair <uint64_t,uint64_t> ApplyFilter (const MmWaveSinrWindow& noisySinr, const MmWaveSinrWindow& noisySinrVar);
 
-  double MakeAvg (std::vector<double>);
+  double MakeAvg (const std::vector<double>&);
 
-  double MakeVar (std::vector<double>, double);
+  double MakeVar (const std::vector<double>&, double);
+
+  /**
+   * \param first the first sample
+   * \param second the second sample
+   * \return the variance of two samples, as computed by MakeVar
+   */
+  double MakePairVar (double first, double second);
 
   std::vector<double> MakeFilter (std::vector<double>, std::vector<double>, std::pair <uint64_t, uint64_t > );
 
@@ -168,6 +185,42 @@ private:
 
   void IncrSlotCtrAndStartSlot();
 
+  /**
+   * Find the device of the UE served by this eNB with a given RNTI.
+   * The devices of the attached RNTIs are resolved once and kept in
+   * m_ueDeviceIndex as long as their RNTI and serving eNB do not change.
+   * \param rnti the RNTI of the UE
+   * eturn the device of the UE, 0 if not found
+   */
+  Ptr<NetDevice> GetServedUeDevice (uint16_t rnti);
+
+  /**
+   * The device of a UE attached to this eNB and its role
+   */
+  struct UeDeviceInfo
+  {
+    Ptr<NetDevice> m_device;                  ///< the UE device, 0 if not resolved yet
+    Ptr<MmWaveUePhy> m_phy;                   ///< the mmWave PHY of the UE
+    Ptr<MmWaveUeNetDevice> m_ueDevice;        ///< the device, if it is a mmWave UE
+    Ptr<McUeNetDevice> m_mcUeDevice;          ///< the device, if it is a MC UE
+  };
+
+  /**
+   * \param rnti the RNTI of the UE
+   * \param info the device information to check
+   * eturn true if info describes the device of the UE served by this eNB with this RNTI
+   */
+  bool IsServedUeDevice (uint16_t rnti, const UeDeviceInfo& info) const;
+
+  /**
+   * Look for the device of the UE served by this eNB with a given RNTI
+   * among all the devices of m_deviceMap
+   * \param rnti the RNTI of the UE
+   * \param info the device information, set if the device is found
+   * eturn true if the device is found
+   */
+  bool ResolveUeDevice (uint16_t rnti, UeDeviceInfo& info) const;
+
   struct SlotBundleInfo
   {
     SlotBundleInfo ()
@@ -204,14 +257,14 @@ private:
   LteEnbCphySapUser* m_enbCphySapUser;
   LteRrcSap::SystemInformationBlockType1 m_sib1;
   std::set <uint16_t> m_ueAttachedRnti;
+  std::map <uint16_t, UeDeviceInfo> m_ueDeviceIndex;        // the devices of the attached RNTIs
   std::map <uint64_t, Ptr<NetDevice> > m_ueAttachedImsiMap;
   std::map <uint64_t, double > m_sinrMap;
   std::map <uint64_t, Ptr<SpectrumValue> > m_rxPsdMap;
-  std::map <pairDevices_t, std::vector<double> > m_sinrVector;        // array containing all SINR values for a specific pair (UE-eNB)
-  std::map <pairDevices_t, std::vector<double> > m_sinrVectorToFilter;        // array containing the  SINR values that must be filtered
-  std::map <pairDevices_t, std::vector<double> > m_sinrVectorNoisy;        // array containing the  noisy SINR values that must be filteredF
-  std::map <pairDevices_t, std::vector<double> > m_finalSinrVector;        // array containing all  SINR values after the filtering for a specific pair (UE-eNB)
-  std::map <pairDevices_t, std::pair <uint64_t,uint64_t> > m_samplesFilter;       // array containing all noisy SINR values for a specific pair (UE-eNB)
+  std::map <pairDevices_t, MmWaveSinrWindow > m_sinrVector;        // array containing all SINR values for a specific pair (UE-eNB)
+  std::map <pairDevices_t, MmWaveSinrWindow > m_sinrVectorToFilter;        // array containing the  SINR values that must be filtered
+  std::map <pairDevices_t, MmWaveSinrWindow > m_sinrVectorNoisy;        // array containing the  noisy SINR values that must be filteredF
+  std::map <pairDevices_t, MmWaveSinrWindow > m_sinrVectorNoisyVar;        // array containing the variances of consecutive noisy SINR values in dB
 
   int m_updateSinrPeriod;       // the period of SINR update for eNBs
   double m_ueUpdateSinrPeriod;       // the period of SINR reporting to the UEs
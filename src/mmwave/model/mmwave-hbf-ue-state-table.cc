@@ -0,0 +1,182 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   Copyright (c) 2019 University of Padova, Dep. of Information Engineering, SIGNET lab.
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include "mmwave-hbf-ue-state-table.h"
+#include <ns3/log.h>
+#include <ns3/assert.h>
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveHbfUeStateTable");
+
+namespace mmwave {
+
+const uint32_t MmWaveHbfUeStateTable::INVALID_SLOT;
+
+MmWaveHbfUeStateTable::MmWaveHbfUeStateTable ()
+  : m_numHarqProcesses (0)
+{
+}
+
+void
+MmWaveHbfUeStateTable::SetNumHarqProcesses (uint8_t numHarqProcesses)
+{
+  NS_LOG_FUNCTION (this << (uint16_t) numHarqProcesses);
+  NS_ASSERT_MSG (std::find (m_hasHarq.begin (), m_hasHarq.end (), 1) == m_hasHarq.end (),
+                 "The number of HARQ processes cannot change after configuring a UE");
+  m_numHarqProcesses = numHarqProcesses;
+  ResizeSlots (m_rnti.size ());
+}
+
+uint32_t
+MmWaveHbfUeStateTable::GetSlot (uint16_t rnti) const
+{
+  if (rnti < m_slotOfRnti.size ())
+    {
+      return m_slotOfRnti[rnti];
+    }
+  return INVALID_SLOT;
+}
+
+uint32_t
+MmWaveHbfUeStateTable::AddUe (uint16_t rnti)
+{
+  uint32_t slot = GetSlot (rnti);
+  if (slot != INVALID_SLOT)
+    {
+      return slot;
+    }
+  NS_LOG_FUNCTION (this << rnti);
+
+  if (rnti >= m_slotOfRnti.size ())
+    {
+      m_slotOfRnti.resize (rnti + 1, INVALID_SLOT);
+    }
+  if (!m_freeSlots.empty ())
+    {
+      slot = m_freeSlots.back ();
+      m_freeSlots.pop_back ();
+    }
+  else
+    {
+      slot = m_rnti.size ();
+      ResizeSlots (slot + 1);
+    }
+  m_slotOfRnti[rnti] = slot;
+  m_rnti[slot] = rnti;
+
+  std::vector<uint32_t>::iterator it = m_slots.begin ();
+  while (it != m_slots.end () && m_rnti[*it] < rnti)
+    {
+      ++it;
+    }
+  m_slots.insert (it, slot);
+  return slot;
+}
+
+void
+MmWaveHbfUeStateTable::RemoveUeIfUnused (uint32_t slot)
+{
+  NS_ASSERT_MSG (slot < m_rnti.size () && GetSlot (m_rnti[slot]) == slot, "Slot " << slot << " not in use");
+  if (m_hasHarq[slot] || m_hasWbCqi[slot] || m_hasUlCqi[slot] || m_hasBsr[slot])
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this << m_rnti[slot]);
+
+  m_slotOfRnti[m_rnti[slot]] = INVALID_SLOT;
+  m_slots.erase (std::find (m_slots.begin (), m_slots.end (), slot));
+  m_ulCqi[slot].clear ();
+  m_freeSlots.push_back (slot);
+}
+
+void
+MmWaveHbfUeStateTable::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_slotOfRnti.clear ();
+  m_rnti.clear ();
+  m_slots.clear ();
+  m_freeSlots.clear ();
+  ResizeSlots (0);
+}
+
+uint16_t
+MmWaveHbfUeStateTable::GetRnti (uint32_t slot) const
+{
+  return m_rnti[slot];
+}
+
+const std::vector<uint32_t>&
+MmWaveHbfUeStateTable::GetSlots (void) const
+{
+  return m_slots;
+}
+
+void
+MmWaveHbfUeStateTable::ConfigureHarq (uint32_t slot)
+{
+  NS_LOG_FUNCTION (this << m_rnti[slot]);
+  m_hasHarq[slot] = 1;
+  for (uint32_t index = GetHarqIndex (slot, 0); index < GetHarqIndex (slot + 1, 0); index++)
+    {
+      m_dlHarqStatus[index] = 0;
+      m_dlHarqTimer[index] = 0;
+      m_dlHarqDciInfo[index] = DciInfoElementTdma ();
+      m_dlHarqRlcPdu[index].clear ();
+      m_ulHarqStatus[index] = 0;
+      m_ulHarqTimer[index] = 0;
+      m_ulHarqDciInfo[index] = DciInfoElementTdma ();
+    }
+}
+
+uint32_t
+MmWaveHbfUeStateTable::GetHarqIndex (uint32_t slot, uint8_t harqId) const
+{
+  return slot * m_numHarqProcesses + harqId;
+}
+
+void
+MmWaveHbfUeStateTable::ResizeSlots (uint32_t numSlots)
+{
+  m_rnti.resize (numSlots);
+  m_hasHarq.resize (numSlots, 0);
+  m_hasWbCqi.resize (numSlots, 0);
+  m_wbCqi.resize (numSlots, 0);
+  m_wbCqiTimer.resize (numSlots, 0);
+  m_hasUlCqi.resize (numSlots, 0);
+  m_ulCqi.resize (numSlots);
+  m_ulCqiNumSym.resize (numSlots, 0);
+  m_ulCqiTbSize.resize (numSlots, 0);
+  m_ulCqiTimer.resize (numSlots, 0);
+  m_hasBsr.resize (numSlots, 0);
+  m_bsr.resize (numSlots, 0);
+
+  uint32_t numHarq = numSlots * m_numHarqProcesses;
+  m_dlHarqStatus.resize (numHarq, 0);
+  m_dlHarqTimer.resize (numHarq, 0);
+  m_dlHarqDciInfo.resize (numHarq);
+  m_dlHarqRlcPdu.resize (numHarq);
+  m_ulHarqStatus.resize (numHarq, 0);
+  m_ulHarqTimer.resize (numHarq, 0);
+  m_ulHarqDciInfo.resize (numHarq);
+}
+
+} // namespace mmwave
+} // namespace ns3
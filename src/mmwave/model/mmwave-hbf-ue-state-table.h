@@ -0,0 +1,150 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   Copyright (c) 2019 University of Padova, Dep. of Information Engineering, SIGNET lab.
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#ifndef SRC_MMWAVE_HBF_UE_STATE_TABLE_H_
+#define SRC_MMWAVE_HBF_UE_STATE_TABLE_H_
+
+#include "mmwave-phy-mac-common.h"
+#include <vector>
+#include <stdint.h>
+
+namespace ns3 {
+
+namespace mmwave {
+
+/**
+ * Per-UE state of the hybrid beamforming MAC schedulers
+ * (MmWaveAsyncHbfMacScheduler and MmWavePaddedHbfMacScheduler).
+ *
+ * Each UE known to the scheduler is assigned a compact slot id when it
+ * first appears, and keeps it until all of its state is released. The RNTI
+ * is mapped to the slot once per scheduler call, then the state is read
+ * from arrays indexed by the slot (structure of arrays). The HARQ
+ * processes of a UE are stored consecutively, at the indices returned by
+ * GetHarqIndex. A slot is reused by the next UE when its HARQ processes
+ * are released and its CQIs and BSR are no longer valid.
+ */
+class MmWaveHbfUeStateTable
+{
+public:
+  static const uint32_t INVALID_SLOT = 0xFFFFFFFF; //!< the slot of the RNTIs not in the table
+
+  /**
+   * Constructor of an empty table
+   */
+  MmWaveHbfUeStateTable ();
+
+  /**
+   * Set the number of HARQ processes of each UE, before configuring the HARQ
+   * processes of any UE
+   * \param numHarqProcesses the number of HARQ processes
+   */
+  void SetNumHarqProcesses (uint8_t numHarqProcesses);
+
+  /**
+   * \param rnti the RNTI of the UE
+   * \return the slot of the UE, or INVALID_SLOT if the UE is not in the table
+   */
+  uint32_t GetSlot (uint16_t rnti) const;
+
+  /**
+   * Get the slot of a UE, adding the UE to the table if needed. The state of
+   * a new UE is not valid.
+   * \param rnti the RNTI of the UE
+   * \return the slot of the UE
+   */
+  uint32_t AddUe (uint16_t rnti);
+
+  /**
+   * Remove a UE from the table if none of its state is valid
+   * \param slot the slot of the UE
+   */
+  void RemoveUeIfUnused (uint32_t slot);
+
+  /**
+   * Remove all the UEs
+   */
+  void Clear (void);
+
+  /**
+   * \param slot the slot of a UE
+   * \return the RNTI of the UE
+   */
+  uint16_t GetRnti (uint32_t slot) const;
+
+  /**
+   * \return the slots of the UEs in the table, by increasing RNTI
+   */
+  const std::vector<uint32_t>& GetSlots (void) const;
+
+  /**
+   * Initialize the HARQ processes of a UE, all available
+   * \param slot the slot of the UE
+   */
+  void ConfigureHarq (uint32_t slot);
+
+  /**
+   * \param slot the slot of a UE
+   * \param harqId the HARQ process id
+   * \return the index of the HARQ process of the UE in the HARQ arrays
+   */
+  uint32_t GetHarqIndex (uint32_t slot, uint8_t harqId) const;
+
+  // per-UE state, indexed by slot
+  std::vector<uint8_t> m_hasHarq; //!< whether the HARQ processes are configured
+  std::vector<uint8_t> m_hasWbCqi; //!< whether a DL wideband CQI was received
+  std::vector<uint8_t> m_wbCqi; //!< the DL wideband CQI
+  std::vector<uint32_t> m_wbCqiTimer; //!< the TTIs for which the DL CQI is still valid
+  std::vector<uint8_t> m_hasUlCqi; //!< whether a UL CQI was received
+  std::vector<std::vector<double> > m_ulCqi; //!< the UL SINR of each chunk
+  std::vector<uint8_t> m_ulCqiNumSym; //!< the symbols of the allocation of the UL CQI
+  std::vector<uint32_t> m_ulCqiTbSize; //!< the TB size of the allocation of the UL CQI
+  std::vector<uint32_t> m_ulCqiTimer; //!< the TTIs for which the UL CQI is still valid
+  std::vector<uint8_t> m_hasBsr; //!< whether a BSR was received
+  std::vector<uint32_t> m_bsr; //!< the UL buffer size
+
+  // per-HARQ process state, indexed by GetHarqIndex
+  //HARQ status
+  // 0: process Id available
+  // x>0: process Id equal to `x` trasmission count
+  std::vector<uint8_t> m_dlHarqStatus; //!< the status of the DL HARQ processes
+  std::vector<uint8_t> m_dlHarqTimer; //!< the timers of the DL HARQ processes
+  std::vector<DciInfoElementTdma> m_dlHarqDciInfo; //!< the DCIs of the DL HARQ processes
+  std::vector<std::vector<RlcPduInfo> > m_dlHarqRlcPdu; //!< the RLC PDUs of the DL HARQ processes
+  std::vector<uint8_t> m_ulHarqStatus; //!< the status of the UL HARQ processes
+  std::vector<uint8_t> m_ulHarqTimer; //!< the timers of the UL HARQ processes
+  std::vector<DciInfoElementTdma> m_ulHarqDciInfo; //!< the DCIs of the UL HARQ processes
+
+private:
+  /**
+   * Resize the state arrays
+   * \param numSlots the new number of slots
+   */
+  void ResizeSlots (uint32_t numSlots);
+
+  uint8_t m_numHarqProcesses; //!< the number of HARQ processes of each UE
+  std::vector<uint32_t> m_slotOfRnti; //!< the slot of each RNTI
+  std::vector<uint16_t> m_rnti; //!< the RNTI of each slot
+  std::vector<uint32_t> m_slots; //!< the used slots, by increasing RNTI
+  std::vector<uint32_t> m_freeSlots; //!< the slots that can be reused
+};
+
+} // namespace mmwave
+} // namespace ns3
+
+#endif /* SRC_MMWAVE_HBF_UE_STATE_TABLE_H_ */
@@ -43,9 +43,7 @@ namespace mmwave {
 
 
 mmWaveInterference::mmWaveInterference ()
-  : m_receiving (false),
-    m_lastSignalId (0),
-    m_lastSignalIdBeforeReset (0)
+  : m_receiving (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -61,6 +59,7 @@ mmWaveInterference::DoDispose ()
   NS_LOG_FUNCTION (this);
   m_PowerChunkProcessorList.clear ();
   m_sinrChunkProcessorList.clear ();
+  ClearPendingSignals ();
   m_rxSignal = 0;
   m_allSignals = 0;
   m_noise = 0;
@@ -138,17 +137,26 @@ mmWaveInterference::AddSignal (Ptr<const SpectrumValue> spd, const Time duration
 {
   NS_LOG_FUNCTION (this << *spd << duration);
   DoAddSignal (spd);
-  uint32_t signalId = ++m_lastSignalId;
-  if (signalId == m_lastSignalIdBeforeReset)
+  // signals are synchronized to the slots, hence many of them end at the same
+  // time: they are summed and subtracted by a single event
+  Time endTime = Now () + duration;
+  std::map<Time, PendingSignals>::iterator it = m_pendingSignals.find (endTime);
+  if (it == m_pendingSignals.end ())
     {
-      // This happens when m_lastSignalId eventually wraps around. Given that so
-      // many signals have elapsed since the last reset, we hope that by now there is
-      // no stale pending signal (i.e., a signal that was scheduled
-      // for subtraction before the reset). So we just move the
-      // boundary further.
-      m_lastSignalIdBeforeReset += 0x10000000;
+      PendingSignals& pending = m_pendingSignals[endTime];
+      pending.m_psd = spd;
+      pending.m_event = Simulator::Schedule (duration, &mmWaveInterference::DoSubtractSignals, this);
+    }
+  else
+    {
+      PendingSignals& pending = it->second;
+      if (pending.m_sum == 0)
+        {
+          pending.m_sum = pending.m_psd->Copy ();
+          pending.m_psd = pending.m_sum;
+        }
+      (*pending.m_sum) += (*spd);
     }
-  Simulator::Schedule (duration, &mmWaveInterference::DoSubtractSignal, this, spd, signalId);
 }
 
 
@@ -161,19 +169,25 @@ mmWaveInterference::DoAddSignal  (Ptr<const SpectrumValue> spd)
 }
 
 void
-mmWaveInterference::DoSubtractSignal  (Ptr<const SpectrumValue> spd, uint32_t signalId)
+mmWaveInterference::DoSubtractSignals ()
 {
-  NS_LOG_FUNCTION (this << *spd);
+  NS_LOG_FUNCTION (this);
   ConditionallyEvaluateChunk ();
-  int32_t deltaSignalId = signalId - m_lastSignalIdBeforeReset;
-  if (deltaSignalId > 0)
-    {
-      (*m_allSignals) -= (*spd);
-    }
-  else
+  std::map<Time, PendingSignals>::iterator it = m_pendingSignals.find (Now ());
+  NS_ASSERT_MSG (it != m_pendingSignals.end (), "No signals ending at " << Now ());
+  (*m_allSignals) -= (*it->second.m_psd);
+  m_pendingSignals.erase (it);
+}
+
+void
+mmWaveInterference::ClearPendingSignals ()
+{
+  NS_LOG_FUNCTION (this);
+  for (std::map<Time, PendingSignals>::iterator it = m_pendingSignals.begin (); it != m_pendingSignals.end (); ++it)
     {
-      NS_LOG_INFO ("ignoring signal scheduled for subtraction before last reset");
+      it->second.m_event.Cancel ();
     }
+  m_pendingSignals.clear ();
 }
 
 
@@ -189,8 +203,13 @@ mmWaveInterference::ConditionallyEvaluateChunk ()
   if (m_receiving && (Now () > m_lastChangeTime))
     {
       NS_LOG_LOGIC (this << " signal = " << *m_rxSignal << " allSignals = " << *m_allSignals << " noise = " << *m_noise);
-      SpectrumValue interf =  (*m_allSignals) - (*m_rxSignal) + (*m_noise);
-      SpectrumValue sinr = (*m_rxSignal) / interf;
+      // the interference and the SINR are computed in place, in buffers
+      // reused by all the chunks
+      m_interf = (*m_allSignals);
+      m_interf -= (*m_rxSignal);
+      m_interf += (*m_noise);
+      m_sinr = (*m_rxSignal);
+      m_sinr /= m_interf;
       Time duration = Now () - m_lastChangeTime;
       for (std::list<Ptr<mmWaveChunkProcessor> >::const_iterator it = m_PowerChunkProcessorList.begin (); it != m_PowerChunkProcessorList.end (); ++it)
         {
@@ -198,7 +217,7 @@ mmWaveInterference::ConditionallyEvaluateChunk ()
         }
       for (std::list<Ptr<mmWaveChunkProcessor> >::const_iterator it = m_sinrChunkProcessorList.begin (); it != m_sinrChunkProcessorList.end (); ++it)
         {
-          (*it)->EvaluateChunk (sinr, duration);
+          (*it)->EvaluateChunk (m_sinr, duration);
         }
       m_lastChangeTime = Now ();
     }
@@ -216,7 +235,8 @@ mmWaveInterference::SetNoisePowerSpectralDensity (Ptr<const SpectrumValue> noise
       // abort rx
       m_receiving = false;
     }
-  m_lastSignalIdBeforeReset = m_lastSignalId;
+  // the signals added before the reset are not subtracted from the new m_allSignals
+  ClearPendingSignals ();
 }
 
 void
@@ -34,7 +34,9 @@
 #include <ns3/packet.h>
 #include <ns3/nstime.h>
 #include <ns3/spectrum-value.h>
+#include <ns3/event-id.h>
 #include <string.h>
+#include <map>
 #include <ns3/mmwave-chunk-processor.h>
 
 
@@ -59,7 +61,26 @@ public:
 private:
   void ConditionallyEvaluateChunk ();
   void DoAddSignal (Ptr<const SpectrumValue> spd);
-  void DoSubtractSignal  (Ptr<const SpectrumValue> spd, uint32_t signalId);
+  /**
+   * Subtract all the signals ending at the current time
+   */
+  void DoSubtractSignals ();
+  /**
+   * Forget all the pending signals and cancel their subtraction
+   */
+  void ClearPendingSignals ();
+
+  /**
+   * The signals ending at the same time, which are subtracted together by a
+   * single event
+   */
+  struct PendingSignals
+  {
+    Ptr<const SpectrumValue> m_psd; //!< the sum of the PSDs of the signals
+    Ptr<SpectrumValue> m_sum; //!< the accumulator of m_psd, created when a second signal is added
+    EventId m_event; //!< the event subtracting the signals
+  };
+
   std::list<Ptr<mmWaveChunkProcessor> > m_PowerChunkProcessorList;
   std::list<Ptr<mmWaveChunkProcessor> > m_sinrChunkProcessorList;
 
@@ -69,11 +90,12 @@ private:
   Ptr<SpectrumValue> m_rxSignal;
   Ptr<SpectrumValue> m_allSignals;
   Ptr<const SpectrumValue> m_noise;
+  SpectrumValue m_interf; //!< the buffer of the interference plus noise of the current chunk
+  SpectrumValue m_sinr; //!< the buffer of the SINR of the current chunk
 
   Time m_lastChangeTime;
 
-  uint32_t m_lastSignalId;
-  uint32_t m_lastSignalIdBeforeReset;
+  std::map<Time, PendingSignals> m_pendingSignals; //!< the signals to be subtracted, by end time
 };
 
 } // namespace mmwave
@@ -50,86 +50,80 @@ namespace ns3 {
 namespace mmwave {
 
 
+/**
+ * The MI map of a modulation
+ */
+struct MiMapTable
+{
+  const double *m_mi; //!< the MI values
+  const double *m_axis; //!< the uniformly spaced SINR values of the map
+  uint16_t m_size; //!< the number of values of the map
+  double m_scalingCoeff; //!< the inverse of the spacing of the SINR values
+};
+
+/**
+ * Get the MI map of the modulation of a MCS
+ * \param mcs the MCS
+ * 
+eturn the MI map
+ */
+static const MiMapTable&
+GetMiMapTable (uint8_t mcs)
+{
+  // since the values in the axis are uniformly spaced, we have
+  // index = ((sinrLin - value[0]) / (value[SIZE-1] - value[0])) * (SIZE-1)
+  // the scaling coefficient is always the same, so it is computed once
+  static const MiMapTable tables[3] = {
+    {MI_map_qpsk, MI_map_qpsk_axis, MMWAVE_MI_MAP_QPSK_SIZE,
+     (MMWAVE_MI_MAP_QPSK_SIZE - 1) / (MI_map_qpsk_axis[MMWAVE_MI_MAP_QPSK_SIZE - 1] - MI_map_qpsk_axis[0])},
+    {MI_map_16qam, MI_map_16qam_axis, MMWAVE_MI_MAP_16QAM_SIZE,
+     (MMWAVE_MI_MAP_16QAM_SIZE - 1) / (MI_map_16qam_axis[MMWAVE_MI_MAP_16QAM_SIZE - 1] - MI_map_16qam_axis[0])},
+    {MI_map_64qam, MI_map_64qam_axis, MMWAVE_MI_MAP_64QAM_SIZE,
+     (MMWAVE_MI_MAP_64QAM_SIZE - 1) / (MI_map_64qam_axis[MMWAVE_MI_MAP_64QAM_SIZE - 1] - MI_map_64qam_axis[0])}
+  };
+  if (mcs <= MMWAVE_MI_QPSK_MAX_ID)
+    {
+      return tables[0];
+    }
+  else if (mcs <= MMWAVE_MI_16QAM_MAX_ID)
+    {
+      return tables[1];
+    }
+  return tables[2];
+}
+
 double
 MmWaveMiErrorModel::Mib (const SpectrumValue& sinr, const std::vector<int>& map, uint8_t mcs)
 {
   NS_LOG_FUNCTION (sinr << &map << (uint32_t) mcs);
 
-  double MI;
-  double MIsum = 0.0;
-  SpectrumValue sinrCopy = sinr;
+  // the MI map is selected once for all the RBs, and the SINR is read in place
+  const MiMapTable &table = GetMiMapTable (mcs);
+  const double axisFirst = table.m_axis[0];
+  const double axisLast = table.m_axis[table.m_size - 1];
+  const double scalingCoeff = table.m_scalingCoeff;
+  const double *sinrValues = &(*sinr.ConstValuesBegin ());
+  const int *rbs = map.data ();
+  const std::size_t numRbs = map.size ();
 
-  for (uint32_t i = 0; i < map.size (); i++)
+  double MIsum = 0.0;
+  for (std::size_t i = 0; i < numRbs; i++)
     {
-      double sinrLin = sinrCopy[map.at (i)];
-      if (mcs <= MMWAVE_MI_QPSK_MAX_ID) // QPSK
+      double sinrLin = sinrValues[rbs[i]];
+      double MI = 1;
+      if (!(sinrLin > axisLast))
         {
-
-          if (sinrLin > MI_map_qpsk_axis[MMWAVE_MI_MAP_QPSK_SIZE - 1])
-            {
-              MI = 1;
-            }
-          else
-            {
-              // since the values in MI_map_qpsk_axis are uniformly spaced, we have
-              // index = ((sinrLin - value[0]) / (value[SIZE-1] - value[0])) * (SIZE-1)
-              // the scaling coefficient is always the same, so we use a static const
-              // to speed up the calculation
-              static const double scalingCoeffQpsk =
-                (MMWAVE_MI_MAP_QPSK_SIZE - 1) / (MI_map_qpsk_axis[MMWAVE_MI_MAP_QPSK_SIZE - 1] - MI_map_qpsk_axis[0]);
-              double sinrIndexDouble = (sinrLin -  MI_map_qpsk_axis[0]) * scalingCoeffQpsk + 1;
-              uint32_t sinrIndex = std::max (0.0, std::floor (sinrIndexDouble));
-              NS_ASSERT_MSG (sinrIndex < MMWAVE_MI_MAP_QPSK_SIZE, "MI map out of data");
-              MI = MI_map_qpsk[sinrIndex];
-            }
+          // the truncation of a non negative value is equal to its floor,
+          // and NaN and negative indices are mapped to 0
+          double sinrIndexDouble = (sinrLin - axisFirst) * scalingCoeff + 1;
+          uint32_t sinrIndex = sinrIndexDouble > 0 ? static_cast<uint32_t> (sinrIndexDouble) : 0;
+          NS_ASSERT_MSG (sinrIndex < table.m_size, "MI map out of data");
+          MI = table.m_mi[sinrIndex];
         }
-      else
-        {
-          if (mcs > MMWAVE_MI_QPSK_MAX_ID && mcs <= MMWAVE_MI_16QAM_MAX_ID )    // 16-QAM
-            {
-              if (sinrLin > MI_map_16qam_axis[MMWAVE_MI_MAP_16QAM_SIZE - 1])
-                {
-                  MI = 1;
-                }
-              else
-                {
-                  // since the values in MI_map_16QAM_axis are uniformly spaced, we have
-                  // index = ((sinrLin - value[0]) / (value[SIZE-1] - value[0])) * (SIZE-1)
-                  // the scaling coefficient is always the same, so we use a static const
-                  // to speed up the calculation
-                  static const double scalingCoeff16qam =
-                    (MMWAVE_MI_MAP_16QAM_SIZE - 1) / (MI_map_16qam_axis[MMWAVE_MI_MAP_16QAM_SIZE - 1] - MI_map_16qam_axis[0]);
-                  double sinrIndexDouble = (sinrLin -  MI_map_16qam_axis[0]) * scalingCoeff16qam + 1;
-                  uint32_t sinrIndex = std::max (0.0, std::floor (sinrIndexDouble));
-                  NS_ASSERT_MSG (sinrIndex < MMWAVE_MI_MAP_16QAM_SIZE, "MI map out of data");
-                  MI = MI_map_16qam[sinrIndex];
-                }
-            }
-          else // 64-QAM
-            {
-              if (sinrLin > MI_map_64qam_axis[MMWAVE_MI_MAP_64QAM_SIZE - 1])
-                {
-                  MI = 1;
-                }
-              else
-                {
-                  // since the values in MI_map_64QAM_axis are uniformly spaced, we have
-                  // index = ((sinrLin - value[0]) / (value[SIZE-1] - value[0])) * (SIZE-1)
-                  // the scaling coefficient is always the same, so we use a static const
-                  // to speed up the calculation
-                  static const double scalingCoeff64qam =
-                    (MMWAVE_MI_MAP_64QAM_SIZE - 1) / (MI_map_64qam_axis[MMWAVE_MI_MAP_64QAM_SIZE - 1] - MI_map_64qam_axis[0]);
-                  double sinrIndexDouble = (sinrLin -  MI_map_64qam_axis[0]) * scalingCoeff64qam + 1;
-                  uint32_t sinrIndex = std::max (0.0, std::floor (sinrIndexDouble));
-                  NS_ASSERT_MSG (sinrIndex < MMWAVE_MI_MAP_64QAM_SIZE, "MI map out of data");
-                  MI = MI_map_64qam[sinrIndex];
-                }
-            }
-        }
-      NS_LOG_LOGIC (" RB " << map.at (i) << "Minimum SNR = " << 10 * std::log10 (sinrLin) << " dB, " << sinrLin << " V, MCS = " << (uint16_t)mcs << ", MI = " << MI);
+      NS_LOG_LOGIC (" RB " << rbs[i] << "Minimum SNR = " << 10 * std::log10 (sinrLin) << " dB, " << sinrLin << " V, MCS = " << (uint16_t)mcs << ", MI = " << MI);
       MIsum += MI;
     }
-  MI = MIsum / map.size ();
+  double MI = MIsum / numRbs;
   NS_LOG_LOGIC (" MI = " << MI);
   return MI;
 }
@@ -184,31 +178,14 @@ MmWaveMiErrorModel::GetTbDecodificationStats (const SpectrumValue& sinr, const s
 {
   NS_LOG_FUNCTION (sinr << &map << (uint32_t) size << (uint32_t) mcs);
 
-  double tbMi = Mib (sinr, map, mcs);
-  double MI = 0.0;
-  double Reff = 0.0;
-  NS_ASSERT (mcs < 29);
-  if (miHistory.size () > 0)
-    {
-      // evaluate R_eff and MI_eff
-      uint32_t codeBitsSum = 0;
-      double miSum = 0.0;
-      for (uint16_t i = 0; i < miHistory.size (); i++)
-        {
-          NS_LOG_DEBUG (" Sum MI " << miHistory.at (i).m_mi << " Ci " << miHistory.at (i).m_codeBits);
-          codeBitsSum += miHistory.at (i).m_codeBits;
-          miSum += (miHistory.at (i).m_mi * miHistory.at (i).m_codeBits);
-        }
-      codeBitsSum += (((double)size * 8.0) / McsEcrTable [mcs]);
-      miSum += (tbMi * (((double)size * 8.0) / McsEcrTable [mcs]));
-      Reff = miHistory.at (0).m_infoBits / (double)codeBitsSum; // information bits are the size of the first TB
-      MI = miSum / (double)codeBitsSum;
-    }
-  else
-    {
-      MI = tbMi;
-    }
-  NS_LOG_DEBUG (" MI " << MI << " Reff " << Reff << " HARQ " << miHistory.size ());
+  return GetTbDecodificationStats (Mib (sinr, map, mcs), GetCodeBlockSegmentation (size), size, mcs, miHistory);
+}
+
+MmWaveCbSegmentation_t
+MmWaveMiErrorModel::GetCodeBlockSegmentation (uint32_t size)
+{
+  NS_LOG_FUNCTION (size);
+
   // estimate CB size (according to sec 5.1.2 of TS 36.212)
   uint16_t Z = 6144; // max size of a codeblock (including CRC)
   uint32_t B = size * 8;
@@ -302,6 +279,45 @@ MmWaveMiErrorModel::GetTbDecodificationStats (const SpectrumValue& sinr, const s
     }
   NS_LOG_INFO ("--------------------LteMiErrorModel: TB size of " << B << " needs of " << B1 << " bits reparted in " << C << " CBs as " << Cplus << " block(s) of " << Kplus << " and " << Cminus << " of " << Kminus);
 
+  MmWaveCbSegmentation_t segmentation;
+  segmentation.C = C;
+  segmentation.Cplus = Cplus;
+  segmentation.Kplus = Kplus;
+  segmentation.Cminus = Cminus;
+  segmentation.Kminus = Kminus;
+  return segmentation;
+}
+
+MmWaveTbStats_t
+MmWaveMiErrorModel::GetTbDecodificationStats (double tbMi, const MmWaveCbSegmentation_t &segmentation, uint32_t size, uint8_t mcs, const MmWaveHarqProcessInfoList_t &miHistory)
+{
+  NS_LOG_FUNCTION (tbMi << (uint32_t) size << (uint32_t) mcs);
+
+  double MI = 0.0;
+  double Reff = 0.0;
+  NS_ASSERT (mcs < 29);
+  if (miHistory.size () > 0)
+    {
+      // evaluate R_eff and MI_eff
+      uint32_t codeBitsSum = 0;
+      double miSum = 0.0;
+      for (uint16_t i = 0; i < miHistory.size (); i++)
+        {
+          NS_LOG_DEBUG (" Sum MI " << miHistory.at (i).m_mi << " Ci " << miHistory.at (i).m_codeBits);
+          codeBitsSum += miHistory.at (i).m_codeBits;
+          miSum += (miHistory.at (i).m_mi * miHistory.at (i).m_codeBits);
+        }
+      codeBitsSum += (((double)size * 8.0) / McsEcrTable [mcs]);
+      miSum += (tbMi * (((double)size * 8.0) / McsEcrTable [mcs]));
+      Reff = miHistory.at (0).m_infoBits / (double)codeBitsSum; // information bits are the size of the first TB
+      MI = miSum / (double)codeBitsSum;
+    }
+  else
+    {
+      MI = tbMi;
+    }
+  NS_LOG_DEBUG (" MI " << MI << " Reff " << Reff << " HARQ " << miHistory.size ());
+
   double errorRate = 1.0;
   uint8_t ecrId = 0;
   if (miHistory.size () == 0)
@@ -347,17 +363,17 @@ MmWaveMiErrorModel::GetTbDecodificationStats (const SpectrumValue& sinr, const s
       NS_LOG_DEBUG ("HARQ ECR " << (uint16_t)ecrId);
     }
 
-  if (C != 1)
+  if (segmentation.C != 1)
     {
-      double cbler = MappingMiBler (MI, ecrId, Kplus);
-      errorRate *= pow (1.0 - cbler, Cplus);
-      cbler = MappingMiBler (MI, ecrId, Kminus);
-      errorRate *= pow (1.0 - cbler, Cminus);
+      double cbler = MappingMiBler (MI, ecrId, segmentation.Kplus);
+      errorRate *= pow (1.0 - cbler, segmentation.Cplus);
+      cbler = MappingMiBler (MI, ecrId, segmentation.Kminus);
+      errorRate *= pow (1.0 - cbler, segmentation.Cminus);
       errorRate = 1.0 - errorRate;
     }
   else
     {
-      errorRate = MappingMiBler (MI, ecrId, Kplus);
+      errorRate = MappingMiBler (MI, ecrId, segmentation.Kplus);
     }
 
   NS_LOG_LOGIC (" Error rate " << errorRate);
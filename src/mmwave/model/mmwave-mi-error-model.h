@@ -65,6 +65,18 @@ struct MmWaveTbStats_t
   double miTotal;
 };
 
+/**
+ * The segmentation of a TB in code blocks, according to sec 5.1.2 of TS 36.212
+ */
+struct MmWaveCbSegmentation_t
+{
+  uint32_t C; //!< the number of code blocks
+  uint32_t Cplus; //!< the number of code blocks of size K+
+  uint32_t Kplus; //!< the size K+ of the larger code blocks
+  uint32_t Cminus; //!< the number of code blocks of size K-
+  uint32_t Kminus; //!< the size K- of the smaller code blocks
+};
+
 // global table of the effective code rates (ECR)s that have BLER performance curves
 static const double BlerCurvesEcrMap[38] = {
   // QPSK (M=2)
@@ -355,6 +367,27 @@ public:
    */
   static MmWaveTbStats_t GetTbDecodificationStats (const SpectrumValue& sinr, const std::vector<int>& map, uint32_t size, uint8_t mcs, MmWaveHarqProcessInfoList_t miHistory);
 
+  /**
+   * \brief compute the segmentation of a TB in code blocks, which only
+   * depends on its size
+   * \param size the size in bytes of the TB
+   * \return the code block segmentation
+   */
+  static MmWaveCbSegmentation_t GetCodeBlockSegmentation (uint32_t size);
+
+  /**
+   * \brief run the error-model algorithm for a TB whose MI and code block
+   * segmentation have already been computed, e.g., to evaluate several MCSs
+   * with the same modulation and TB size
+   * \param tbMi the mmib of the TB, computed by Mib
+   * \param segmentation the code block segmentation of the TB
+   * \param size the size in bytes of the TB
+   * \param mcs the MCS of the TB
+   * \param miHistory the MI of the previous transmissions of the TB
+   * \return the TB error rate and MI
+   */
+  static MmWaveTbStats_t GetTbDecodificationStats (double tbMi, const MmWaveCbSegmentation_t &segmentation, uint32_t size, uint8_t mcs, const MmWaveHarqProcessInfoList_t &miHistory);
+
 
 //private:
 
@@ -0,0 +1,176 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   Copyright (c) 2019 University of Padova, Dep. of Information Engineering, SIGNET lab.
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include "mmwave-mmse-batch-solver.h"
+#include <ns3/assert.h>
+
+namespace ns3 {
+
+namespace mmwave {
+
+const uint16_t MmWaveMmseBatchSolver::MAX_LAYERS;
+
+MmWaveMmseBatchSolver::MmWaveMmseBatchSolver ()
+  : m_numBatches (0),
+    m_numLayers (0)
+{
+}
+
+void
+MmWaveMmseBatchSolver::Resize (uint32_t numBatches, uint16_t numLayers)
+{
+  NS_ASSERT_MSG (numLayers <= MAX_LAYERS, "The MMSE solver supports at most " << MAX_LAYERS << " layers");
+  m_numBatches = numBatches;
+  m_numLayers = numLayers;
+  std::size_t size = static_cast<std::size_t> (numBatches) * numLayers * numLayers;
+  m_channels.resize (size);
+  m_factors.resize (size);
+  m_combiners.resize (size);
+}
+
+uint32_t
+MmWaveMmseBatchSolver::GetNumBatches (void) const
+{
+  return m_numBatches;
+}
+
+uint16_t
+MmWaveMmseBatchSolver::GetNumLayers (void) const
+{
+  return m_numLayers;
+}
+
+std::complex<double>*
+MmWaveMmseBatchSolver::GetChannel (uint32_t batch)
+{
+  NS_ASSERT (batch < m_numBatches);
+  return m_channels.data () + static_cast<std::size_t> (batch) * m_numLayers * m_numLayers;
+}
+
+const std::complex<double>*
+MmWaveMmseBatchSolver::GetCombiner (uint32_t batch) const
+{
+  NS_ASSERT (batch < m_numBatches);
+  return m_combiners.data () + static_cast<std::size_t> (batch) * m_numLayers * m_numLayers;
+}
+
+void
+MmWaveMmseBatchSolver::Factorize (uint32_t batch, double noise)
+{
+  //This method obtains the cholesky decomposition of the positive definite hermitian matrix M=(H'H+NoI),
+  //where we have left the input matrixH in the format H
+  //This method is a C++ adaptation of the cholesky decompositoin examples provided in https://rosettacode.org/wiki/Cholesky_decomposition#C
+  //The code in this section is NOT a direct copy of the site
+  NS_ASSERT (batch < m_numBatches);
+  const uint16_t n = m_numLayers;
+  const std::complex<double> *h = m_channels.data () + static_cast<std::size_t> (batch) * n * n;
+  std::complex<double> *l = m_factors.data () + static_cast<std::size_t> (batch) * n * n;
+
+  for (uint16_t kcol = 0; kcol < n; kcol++)
+    {
+      for (uint16_t kdiag = 0; kdiag < (kcol + 1); kdiag++) //equality reached in loop end
+        {
+          //first we build the necessary coefficient of Hermitian matrix M(kcol,kdiag) = H'H+I
+          std::complex<double> sum = (kcol == kdiag) ? noise : 0;
+          for (uint16_t sumiter = 0; sumiter < n; sumiter++)
+            {
+              sum += std::conj (h[sumiter * n + kcol]) * h[sumiter * n + kdiag];
+            }
+          //second we apply the negative sumatorium of the normal Cholesky algorithm in the accumulator variable 'sum'
+          for (uint16_t ksum = 0; ksum < kdiag; ksum++) //equality not reached in loop end
+            {
+              sum -= l[kcol * n + ksum] * std::conj (l[kdiag * n + ksum]);
+            }
+          //finally we update the matrix
+          l[kcol * n + kdiag] = (kcol == kdiag) ? sqrt (sum) : (sum / l[kdiag * n + kdiag]);
+        }
+      for (uint16_t kdiag = kcol + 1; kdiag < n; kdiag++)
+        {
+          l[kcol * n + kdiag] = 0.0;
+        }
+    }
+}
+
+void
+MmWaveMmseBatchSolver::SolveFactorized (uint32_t batch, std::complex<double> *x) const
+{
+  NS_ASSERT (batch < m_numBatches);
+  const uint16_t n = m_numLayers;
+  const std::complex<double> *l = m_factors.data () + static_cast<std::size_t> (batch) * n * n;
+
+  // define L'x=aux, solve L*aux = y, overwriting y with aux
+  for (uint16_t row = 0; row < n; row++)
+    {
+      std::complex<double> sum = x[row];
+      for (uint16_t col = 0; col < row; col++)
+        {
+          sum -= x[col] * l[row * n + col];
+        }
+      x[row] = sum / l[row * n + row];
+    }
+  // solve L'*x=aux, starting by the LAST coefficient because L' is upper triangular
+  for (uint16_t revRow = 0; revRow < n; revRow++)
+    {
+      uint16_t row = n - 1 - revRow;
+      std::complex<double> sum = x[row];
+      for (uint16_t col = row + 1; col < n; col++)
+        {
+          sum -= x[col] * std::conj (l[col * n + row]); //col-row indexes inverted for Hermitian matrix L'
+        }
+      x[row] = sum / l[row * n + row];
+    }
+}
+
+void
+MmWaveMmseBatchSolver::Solve (uint32_t batch, double noise)
+{
+  //Cholesky linear solver for X of set of linear systems (H'*H+No*I)X=H', returning X=(H'*H+No*I)^-1H'
+  //note: a linear solver is N times faster than a matrix inversion,in fact
+  //      the Cholesky matrix inversion algorithm consists in N linear solvers
+  Factorize (batch, noise);
+
+  const uint16_t n = m_numLayers;
+  const std::complex<double> *h = m_channels.data () + static_cast<std::size_t> (batch) * n * n;
+  std::complex<double> *combiner = m_combiners.data () + static_cast<std::size_t> (batch) * n * n;
+  std::complex<double> column[MAX_LAYERS];
+  for (uint16_t xCol = 0; xCol < n; xCol++)
+    {
+      // the column xCol of H' is the conjugate of the row xCol of H
+      for (uint16_t row = 0; row < n; row++)
+        {
+          column[row] = std::conj (h[xCol * n + row]);
+        }
+      SolveFactorized (batch, column);
+      for (uint16_t xRow = 0; xRow < n; xRow++)
+        {
+          combiner[xRow * n + xCol] = column[xRow];
+        }
+    }
+}
+
+void
+MmWaveMmseBatchSolver::SolveAll (double noise)
+{
+  for (uint32_t batch = 0; batch < m_numBatches; batch++)
+    {
+      Solve (batch, noise);
+    }
+}
+
+} // namespace mmwave
+} // namespace ns3
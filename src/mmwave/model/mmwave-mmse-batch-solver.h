@@ -0,0 +1,123 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   Copyright (c) 2019 University of Padova, Dep. of Information Engineering, SIGNET lab.
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#ifndef SRC_MMWAVE_MMSE_BATCH_SOLVER_H_
+#define SRC_MMWAVE_MMSE_BATCH_SOLVER_H_
+
+#include <complex>
+#include <vector>
+#include <stdint.h>
+
+namespace ns3 {
+
+namespace mmwave {
+
+/**
+ * Solver of a batch of small MMSE problems, one for each subband of the
+ * digital combining stage of the hybrid beamforming.
+ *
+ * Each batch holds a square equivalent channel H of size N x N, with N the
+ * number of layers, and the solver computes the combiner
+ * X = (H^H H + No I)^-1 H^H by means of the Cholesky factorization of
+ * H^H H + No I. The channels, the factors and the combiners of all the
+ * batches are stored in contiguous arrays, in row-major order, which are
+ * reused by the following calls, so that no memory is allocated as long as
+ * the number of batches and of layers does not grow.
+ */
+class MmWaveMmseBatchSolver
+{
+public:
+  static const uint16_t MAX_LAYERS = 16; //!< the maximum number of layers
+
+  /**
+   * Constructor
+   */
+  MmWaveMmseBatchSolver ();
+
+  /**
+   * Set the size of the batch. The content of the matrices is not
+   * initialized.
+   * \param numBatches the number of batches
+   * \param numLayers the number of layers, at most MAX_LAYERS
+   */
+  void Resize (uint32_t numBatches, uint16_t numLayers);
+
+  /**
+   * \return the number of batches
+   */
+  uint32_t GetNumBatches (void) const;
+
+  /**
+   * \return the number of layers
+   */
+  uint16_t GetNumLayers (void) const;
+
+  /**
+   * Get the equivalent channel of a batch, to be filled by the caller
+   * \param batch the index of the batch
+   * \return the first element of the N x N channel matrix, in row-major order
+   */
+  std::complex<double>* GetChannel (uint32_t batch);
+
+  /**
+   * Get the combiner of a batch, computed by Solve
+   * \param batch the index of the batch
+   * \return the first element of the N x N combining matrix, in row-major order
+   */
+  const std::complex<double>* GetCombiner (uint32_t batch) const;
+
+  /**
+   * Compute the Cholesky factorization L L^H = H^H H + No I of a batch
+   * \param batch the index of the batch
+   * \param noise the noise power spectral density No
+   */
+  void Factorize (uint32_t batch, double noise);
+
+  /**
+   * Solve in place the linear system (H^H H + No I) x = y of a batch, which
+   * must have been factorized
+   * \param batch the index of the batch
+   * \param x the N known terms y, overwritten with the solution x
+   */
+  void SolveFactorized (uint32_t batch, std::complex<double> *x) const;
+
+  /**
+   * Compute the combiner of a batch
+   * \param batch the index of the batch
+   * \param noise the noise power spectral density No
+   */
+  void Solve (uint32_t batch, double noise);
+
+  /**
+   * Compute the combiners of all the batches
+   * \param noise the noise power spectral density No
+   */
+  void SolveAll (double noise);
+
+private:
+  uint32_t m_numBatches; //!< the number of batches
+  uint16_t m_numLayers; //!< the number of layers
+  std::vector<std::complex<double> > m_channels; //!< the equivalent channels
+  std::vector<std::complex<double> > m_factors; //!< the lower triangular Cholesky factors
+  std::vector<std::complex<double> > m_combiners; //!< the combiners
+};
+
+} // namespace mmwave
+} // namespace ns3
+
+#endif /* SRC_MMWAVE_MMSE_BATCH_SOLVER_H_ */
@@ -191,15 +191,8 @@ void
 MmWavePaddedHbfMacScheduler::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
-  m_wbCqiRxed.clear ();
-  m_dlHarqProcessesDciInfoMap.clear ();
-  m_dlHarqProcessesTimer.clear ();
-  m_dlHarqProcessesRlcPduMap.clear ();
+  m_ueTable.Clear ();
   m_dlHarqInfoList.clear ();
-  m_ulHarqCurrentProcessId.clear ();
-  m_ulHarqProcessesStatus.clear ();
-  m_ulHarqProcessesTimer.clear ();
-  m_ulHarqProcessesDciInfoMap.clear ();
   delete m_macCschedSapProvider;
   delete m_macSchedSapProvider;
 }
@@ -297,6 +290,7 @@ MmWavePaddedHbfMacScheduler::ConfigureCommonParameters (Ptr<MmWavePhyMacCommon>
   m_amc = CreateObject <MmWaveAmc> (m_phyMacConfig);
   m_numRbg = m_phyMacConfig->GetNumRb () / m_phyMacConfig->GetNumRbPerRbg ();
   m_numHarqProcess = m_phyMacConfig->GetNumHarqProcess ();
+  m_ueTable.SetNumHarqProcesses (m_numHarqProcess);
   m_harqTimeout = m_phyMacConfig->GetHarqTimeout ();
   m_numDataSymbols = m_phyMacConfig->GetSymbolsPerSubframe () -
     m_phyMacConfig->GetDlCtrlSymbols () - m_phyMacConfig->GetUlCtrlSymbols ();
@@ -335,9 +329,14 @@ MmWavePaddedHbfMacScheduler::DoSchedDlRlcBufferReq (const struct MmWaveMacSchedS
   // initialize statistics of the flow in case of new flows
   if (newLc == true)
     {
-      m_wbCqiRxed.insert ( std::pair<uint16_t, uint8_t > (params.m_rnti, 1));   // only codeword 0 at this stage (SISO)
-      // initialized to 1 (i.e., the lowest value for transmitting a signal)
-      m_wbCqiTimers.insert ( std::pair<uint16_t, uint32_t > (params.m_rnti, m_cqiTimersThreshold));
+      uint32_t slot = m_ueTable.AddUe (params.m_rnti);
+      if (!m_ueTable.m_hasWbCqi[slot])
+        {
+          m_ueTable.m_hasWbCqi[slot] = 1;
+          m_ueTable.m_wbCqi[slot] = 1;   // only codeword 0 at this stage (SISO)
+          // initialized to 1 (i.e., the lowest value for transmitting a signal)
+          m_ueTable.m_wbCqiTimer[slot] = m_cqiTimersThreshold;
+        }
     }
 }
 
@@ -346,31 +345,18 @@ MmWavePaddedHbfMacScheduler::DoSchedDlCqiInfoReq (const struct MmWaveMacSchedSap
 {
   NS_LOG_FUNCTION (this);
 
-  std::map <uint16_t,uint8_t>::iterator it;
   for (unsigned int i = 0; i < params.m_cqiList.size (); i++)
     {
       if ( params.m_cqiList.at (i).m_cqiType == DlCqiInfo::WB )
         {
           // wideband CQI reporting
-          std::map <uint16_t,uint8_t>::iterator it;
           uint16_t rnti = params.m_cqiList.at (i).m_rnti;
-          it = m_wbCqiRxed.find (rnti);
-          if (it == m_wbCqiRxed.end ())
-            {
-              // create the new entry
-              m_wbCqiRxed.insert ( std::pair<uint16_t, uint8_t > (rnti, params.m_cqiList.at (i).m_wbCqi) ); // only codeword 0 at this stage (SISO)
-              // generate correspondent timer
-              m_wbCqiTimers.insert ( std::pair<uint16_t, uint32_t > (rnti, m_cqiTimersThreshold));
-            }
-          else
-            {
-              // update the CQI value
-              (*it).second = params.m_cqiList.at (i).m_wbCqi;
-              // update correspondent timer
-              std::map <uint16_t,uint32_t>::iterator itTimers;
-              itTimers = m_wbCqiTimers.find (rnti);
-              (*itTimers).second = m_cqiTimersThreshold;
-            }
+          uint32_t slot = m_ueTable.AddUe (rnti);
+          // create the new entry or update the CQI value
+          m_ueTable.m_hasWbCqi[slot] = 1;
+          m_ueTable.m_wbCqi[slot] = params.m_cqiList.at (i).m_wbCqi; // only codeword 0 at this stage (SISO)
+          // generate or update the correspondent timer
+          m_ueTable.m_wbCqiTimer[slot] = m_cqiTimersThreshold;
         }
       else if ( params.m_cqiList.at (i).m_cqiType == DlCqiInfo::SB )
         {
@@ -399,7 +385,6 @@ MmWavePaddedHbfMacScheduler::DoSchedUlCqiInfoReq (const struct MmWaveMacSchedSap
     case UlCqiInfo::PUSCH:
       {
         std::map <uint32_t, struct AllocMapElem>::iterator itMap;
-        std::map <uint16_t, struct UlCqiMapElem>::iterator itCqi;
         itMap = m_ulAllocationMap.find (params.m_sfnSf.Encode ());
         if (itMap == m_ulAllocationMap.end ())
           {
@@ -411,11 +396,12 @@ MmWavePaddedHbfMacScheduler::DoSchedUlCqiInfoReq (const struct MmWaveMacSchedSap
           {
             // convert from fixed point notation Sxxxxxxxxxxx.xxx to double
             //double sinr = LteFfConverter::fpS11dot3toDouble (params.m_ulCqi.m_sinr.at (i));
-            itCqi = m_ueUlCqi.find (itMap->second.m_rntiPerChunk.at (i));
-            if (itCqi == m_ueUlCqi.end ())
+            uint32_t slot = m_ueTable.AddUe (itMap->second.m_rntiPerChunk.at (i));
+            if (!m_ueTable.m_hasUlCqi[slot])
               {
                 // create a new entry
-                std::vector <double> newCqi;
+                std::vector <double> &newCqi = m_ueTable.m_ulCqi[slot];
+                newCqi.clear ();
                 for (unsigned j = 0; j < m_phyMacConfig->GetTotalNumChunk (); j++)
                   {
                     unsigned chunkInd = i;
@@ -431,21 +417,20 @@ MmWavePaddedHbfMacScheduler::DoSchedUlCqiInfoReq (const struct MmWaveMacSchedSap
                         newCqi.push_back (30.0);
                       }
                   }
-                m_ueUlCqi.insert (std::pair <uint16_t, struct UlCqiMapElem> (itMap->second.m_rntiPerChunk.at (i),
-                                                                             UlCqiMapElem (newCqi, itMap->second.m_numSym, itMap->second.m_tbSize)) );
+                m_ueTable.m_hasUlCqi[slot] = 1;
+                m_ueTable.m_ulCqiNumSym[slot] = itMap->second.m_numSym;
+                m_ueTable.m_ulCqiTbSize[slot] = itMap->second.m_tbSize;
                 // generate correspondent timer
-                m_ueCqiTimers.insert (std::pair <uint16_t, uint32_t > (itMap->second.m_rntiPerChunk.at (i), m_cqiTimersThreshold));
+                m_ueTable.m_ulCqiTimer[slot] = m_cqiTimersThreshold;
               }
             else
               {
                 // update the value
-                (*itCqi).second.m_ueUlCqi.at (i) = params.m_ulCqi.m_sinr.at (i);
-                (*itCqi).second.m_numSym = itMap->second.m_numSym;
-                (*itCqi).second.m_tbSize = itMap->second.m_tbSize;
+                m_ueTable.m_ulCqi[slot].at (i) = params.m_ulCqi.m_sinr.at (i);
+                m_ueTable.m_ulCqiNumSym[slot] = itMap->second.m_numSym;
+                m_ueTable.m_ulCqiTbSize[slot] = itMap->second.m_tbSize;
                 // update correspondent timer
-                std::map <uint16_t, uint32_t>::iterator itTimers;
-                itTimers = m_ueCqiTimers.find (itMap->second.m_rntiPerChunk.at (i));
-                (*itTimers).second = m_cqiTimersThreshold;
+                m_ueTable.m_ulCqiTimer[slot] = m_cqiTimersThreshold;
 
                 NS_LOG_LOGIC ("UL CQI report for RNTI " << itMap->second.m_rntiPerChunk.at (i) << " chunk " << i << " SINR " << params.m_ulCqi.m_sinr.at (i) << \
                              " frame " << frameNum << " subframe " << subframeNum << " startSym " << startSymIdx);
@@ -469,48 +454,47 @@ MmWavePaddedHbfMacScheduler::RefreshHarqProcesses ()
 {
   NS_LOG_FUNCTION (this);
 
-  std::map <uint16_t, DlHarqProcessesTimer_t>::iterator itTimers;
-  for (itTimers = m_dlHarqProcessesTimer.begin (); itTimers != m_dlHarqProcessesTimer.end (); itTimers++)
+  const std::vector<uint32_t> &slots = m_ueTable.GetSlots ();
+  for (std::vector<uint32_t>::const_iterator itSlot = slots.begin (); itSlot != slots.end (); itSlot++)
     {
+      if (!m_ueTable.m_hasHarq[*itSlot])
+        {
+          continue;
+        }
       for (uint16_t i = 0; i < m_phyMacConfig->GetNumHarqProcess (); i++)
         {
-          if ((*itTimers).second.at (i) == m_phyMacConfig->GetHarqTimeout ())
+          uint32_t harqIndex = m_ueTable.GetHarqIndex (*itSlot, i);
+          if (m_ueTable.m_dlHarqTimer[harqIndex] == m_phyMacConfig->GetHarqTimeout ())
             {             // reset HARQ process
-              NS_LOG_INFO (this << " Reset HARQ proc " << i << " for RNTI " << (*itTimers).first);
-              std::map <uint16_t, DlHarqProcessesStatus_t>::iterator itStat = m_dlHarqProcessesStatus.find ((*itTimers).first);
-              if (itStat == m_dlHarqProcessesStatus.end ())
-                {
-                  NS_FATAL_ERROR ("No Process Id Status found for this RNTI " << (*itTimers).first);
-                }
-              (*itStat).second.at (i) = 0;
-              (*itTimers).second.at (i) = 0;
+              NS_LOG_INFO (this << " Reset HARQ proc " << i << " for RNTI " << m_ueTable.GetRnti (*itSlot));
+              m_ueTable.m_dlHarqStatus[harqIndex] = 0;
+              m_ueTable.m_dlHarqTimer[harqIndex] = 0;
             }
           else
             {
-              (*itTimers).second.at (i)++;
+              m_ueTable.m_dlHarqTimer[harqIndex]++;
             }
         }
     }
 
-  std::map <uint16_t, UlHarqProcessesTimer_t>::iterator itTimers2;
-  for (itTimers2 = m_ulHarqProcessesTimer.begin (); itTimers2 != m_ulHarqProcessesTimer.end (); itTimers2++)
+  for (std::vector<uint32_t>::const_iterator itSlot = slots.begin (); itSlot != slots.end (); itSlot++)
     {
+      if (!m_ueTable.m_hasHarq[*itSlot])
+        {
+          continue;
+        }
       for (uint16_t i = 0; i < m_phyMacConfig->GetNumHarqProcess (); i++)
         {
-          if ((*itTimers2).second.at (i) == m_phyMacConfig->GetHarqTimeout ())
+          uint32_t harqIndex = m_ueTable.GetHarqIndex (*itSlot, i);
+          if (m_ueTable.m_ulHarqTimer[harqIndex] == m_phyMacConfig->GetHarqTimeout ())
             {             // reset HARQ process
-              NS_LOG_INFO (this << " Reset HARQ proc " << i << " for RNTI " << (*itTimers2).first);
-              std::map <uint16_t, UlHarqProcessesStatus_t>::iterator itStat = m_ulHarqProcessesStatus.find ((*itTimers2).first);
-              if (itStat == m_ulHarqProcessesStatus.end ())
-                {
-                  NS_FATAL_ERROR ("No Process Id Status found for this RNTI " << (*itTimers2).first);
-                }
-              (*itStat).second.at (i) = 0;
-              (*itTimers2).second.at (i) = 0;
+              NS_LOG_INFO (this << " Reset HARQ proc " << i << " for RNTI " << m_ueTable.GetRnti (*itSlot));
+              m_ueTable.m_ulHarqStatus[harqIndex] = 0;
+              m_ueTable.m_ulHarqTimer[harqIndex] = 0;
             }
           else
             {
-              (*itTimers2).second.at (i)++;
+              m_ueTable.m_ulHarqTimer[harqIndex]++;
             }
         }
     }
@@ -535,8 +519,8 @@ MmWavePaddedHbfMacScheduler::UpdateDlHarqProcessId (uint16_t rnti)
 //	{
 //		NS_FATAL_ERROR ("No Process Id found for this RNTI " << rnti);
 //	}
-  std::map <uint16_t, DlHarqProcessesStatus_t>::iterator itStat = m_dlHarqProcessesStatus.find (rnti);
-  if (itStat == m_dlHarqProcessesStatus.end ())
+  uint32_t slot = m_ueTable.GetSlot (rnti);
+  if (slot == MmWaveHbfUeStateTable::INVALID_SLOT || !m_ueTable.m_hasHarq[slot])
     {
       NS_FATAL_ERROR ("No Process Id Statusfound for this RNTI " << rnti);
     }
@@ -545,9 +529,10 @@ MmWavePaddedHbfMacScheduler::UpdateDlHarqProcessId (uint16_t rnti)
   uint8_t harqId = m_phyMacConfig->GetNumHarqProcess ();
   for (unsigned i = 0; i < m_phyMacConfig->GetNumHarqProcess (); i++)
     {
-      if (itStat->second[i] == 0)
+      uint32_t harqIndex = m_ueTable.GetHarqIndex (slot, i);
+      if (m_ueTable.m_dlHarqStatus[harqIndex] == 0)
         {
-          itStat->second[i] = 1;
+          m_ueTable.m_dlHarqStatus[harqIndex] = 1;
           harqId = i;
           break;
         }
@@ -590,8 +575,8 @@ MmWavePaddedHbfMacScheduler::UpdateUlHarqProcessId (uint16_t rnti)
 //	{
 //		NS_FATAL_ERROR ("No Process Id found for this RNTI " << rnti);
 //	}
-  std::map <uint16_t, UlHarqProcessesStatus_t>::iterator itStat = m_ulHarqProcessesStatus.find (rnti);
-  if (itStat == m_ulHarqProcessesStatus.end ())
+  uint32_t slot = m_ueTable.GetSlot (rnti);
+  if (slot == MmWaveHbfUeStateTable::INVALID_SLOT || !m_ueTable.m_hasHarq[slot])
     {
 //      NS_LOG_ERROR("No Process Id Statusfound for this RNTI " << rnti<<" implementing temporary fix");
 //
@@ -608,9 +593,10 @@ MmWavePaddedHbfMacScheduler::UpdateUlHarqProcessId (uint16_t rnti)
   uint8_t harqId = m_phyMacConfig->GetNumHarqProcess ();
   for (unsigned i = 0; i < m_phyMacConfig->GetNumHarqProcess (); i++)
     {
-      if (itStat->second[i] == 0)
+      uint32_t harqIndex = m_ueTable.GetHarqIndex (slot, i);
+      if (m_ueTable.m_ulHarqStatus[harqIndex] == 0)
         {
-          itStat->second[i] = 1;
+          m_ueTable.m_ulHarqStatus[harqIndex] = 1;
           harqId = i;
           break;
         }
@@ -781,46 +767,32 @@ MmWavePaddedHbfMacScheduler::DoSchedTriggerReq (const struct MmWaveMacSchedSapPr
           uint8_t harqId = m_dlHarqInfoList.at (i).m_harqProcessId;
           uint16_t rnti = m_dlHarqInfoList.at (i).m_rnti;
           itUeInfo = ueInfo.find (rnti);
-          std::map <uint16_t, UlHarqProcessesStatus_t>::iterator itStat = m_dlHarqProcessesStatus.find (rnti);
-          if (itStat == m_dlHarqProcessesStatus.end ())
+          uint32_t slot = m_ueTable.GetSlot (rnti);
+          if (slot == MmWaveHbfUeStateTable::INVALID_SLOT || !m_ueTable.m_hasHarq[slot])
             {
               NS_FATAL_ERROR ("No HARQ status info found for UE " << rnti);
             }
-          std::map <uint16_t, DlHarqRlcPduList_t>::iterator itRlcPdu =  m_dlHarqProcessesRlcPduMap.find (rnti);
-          if (itRlcPdu == m_dlHarqProcessesRlcPduMap.end ())
-            {
-              NS_FATAL_ERROR ("Unable to find RlcPdcList in HARQ buffer for RNTI " << m_dlHarqInfoList.at (i).m_rnti);
-            }
-          if (m_dlHarqInfoList.at (i).m_harqStatus == DlHarqInfo::ACK || itStat->second.at (harqId) == 0)
+          NS_ASSERT (harqId < m_numHarqProcess);
+          uint32_t harqIndex = m_ueTable.GetHarqIndex (slot, harqId);
+          if (m_dlHarqInfoList.at (i).m_harqStatus == DlHarqInfo::ACK || m_ueTable.m_dlHarqStatus[harqIndex] == 0)
             {             // acknowledgment or process timeout, reset process
               NS_LOG_DEBUG ("UE" << rnti << " DL harqId " << (unsigned)harqId << " HARQ-ACK received");
-              itStat->second.at (harqId) = 0;                      // release process ID
-              for (uint16_t k = 0; k < itRlcPdu->second.size (); k++)                           // clear RLC buffers
-                {
-                  itRlcPdu->second.at (harqId).clear ();
-                }
+              m_ueTable.m_dlHarqStatus[harqIndex] = 0;                      // release process ID
+              m_ueTable.m_dlHarqRlcPdu[harqIndex].clear ();                 // clear RLC buffers
               continue;
             }
           else if (m_dlHarqInfoList.at (i).m_harqStatus == DlHarqInfo::NACK)
             {
-              std::map <uint16_t, DlHarqProcessesDciInfoList_t>::iterator itHarq = m_dlHarqProcessesDciInfoMap.find (rnti);
-              if (itHarq == m_dlHarqProcessesDciInfoMap.end ())
-                {
-                  NS_FATAL_ERROR ("No DCI/HARQ buffer entry found for UE " << rnti);
-                }
-              DciInfoElementTdma dciInfoReTx = itHarq->second.at (harqId);
+              DciInfoElementTdma dciInfoReTx = m_ueTable.m_dlHarqDciInfo[harqIndex];
               NS_LOG_DEBUG ("UE" << rnti << " DL harqId " << (unsigned)harqId << " HARQ-NACK received, rv " << (unsigned)dciInfoReTx.m_rv);
               NS_ASSERT (harqId == dciInfoReTx.m_harqProcess);
-              //NS_ASSERT(itStat->second.at (harqId) > 0);
-              NS_ASSERT (itStat->second.at (harqId) - 1 == dciInfoReTx.m_rv);
+              //NS_ASSERT(m_ueTable.m_dlHarqStatus[harqIndex] > 0);
+              NS_ASSERT (m_ueTable.m_dlHarqStatus[harqIndex] - 1 == dciInfoReTx.m_rv);
               if (dciInfoReTx.m_rv == 3)                   // maximum number of retx reached -> drop process
                 {
                   NS_LOG_INFO ("Max number of retransmissions reached -> drop process");
-                  itStat->second.at (harqId) = 0;
-                  for (uint16_t k = 0; k < (*itRlcPdu).second.size (); k++)
-                    {
-                      itRlcPdu->second.at (harqId).clear ();
-                    }
+                  m_ueTable.m_dlHarqStatus[harqIndex] = 0;
+                  m_ueTable.m_dlHarqRlcPdu[harqIndex].clear ();
                   continue;
                 }
               else
@@ -924,9 +896,8 @@ MmWavePaddedHbfMacScheduler::DoSchedTriggerReq (const struct MmWaveMacSchedSapPr
               itSetUeQuery = setUeInCurrentSymbolBlock.find ( rnti );
             }
           uint8_t harqId = m_dlHarqInfoList.at ( idxSortedHarq ).m_harqProcessId;
-          std::map <uint16_t, DlHarqProcessesStatus_t>::iterator itStat = m_dlHarqProcessesStatus.find (rnti); //this is the second time this is searched, error check was done first time so here we know we will always succeed
-          std::map <uint16_t, DlHarqProcessesDciInfoList_t>::iterator itHarq = m_dlHarqProcessesDciInfoMap.find (rnti); //this is the second time this is searched, error check was done first time so here we know we will always succeed
-          DciInfoElementTdma dciInfoReTx = itHarq->second.at (harqId);
+          uint32_t harqIndex = m_ueTable.GetHarqIndex (m_ueTable.GetSlot (rnti), harqId); //this is the second time this is searched, error check was done first time so here we know we will always succeed
+          DciInfoElementTdma dciInfoReTx = m_ueTable.m_dlHarqDciInfo[harqIndex];
 
 
           if (symAvail == 0)
@@ -952,23 +923,16 @@ MmWavePaddedHbfMacScheduler::DoSchedTriggerReq (const struct MmWaveMacSchedSapPr
               dciInfoReTx.m_symStart = nextSymAvail;
               dciInfoReTx.m_rv++;
               dciInfoReTx.m_ndi = 0;
-              itHarq->second.at (harqId) = dciInfoReTx;
-              itStat->second.at (harqId) = itStat->second.at (harqId) + 1;
+              m_ueTable.m_dlHarqDciInfo[harqIndex] = dciInfoReTx;
+              m_ueTable.m_dlHarqStatus[harqIndex] = m_ueTable.m_dlHarqStatus[harqIndex] + 1;
               //                  SlotAllocInfo slotInfo (slotIdx++, SlotAllocInfo::DL_slotAllocInfo, SlotAllocInfo::CTRL_DATA, SlotAllocInfo::DIGITAL, itUeInfo->first, layerIdx);
               SlotAllocInfo slotInfo (tempDlslotIdx++, SlotAllocInfo::DL_slotAllocInfo, SlotAllocInfo::CTRL_DATA, SlotAllocInfo::DIGITAL, itUeInfo->first, layerIdx);
               slotInfo.m_dci = dciInfoReTx;
               NS_LOG_LOGIC ("UE" << dciInfoReTx.m_rnti << " gets DL slots " << (unsigned)dciInfoReTx.m_symStart << "-" << (unsigned)(dciInfoReTx.m_symStart + dciInfoReTx.m_numSym - 1) <<
                             " tbs " << dciInfoReTx.m_tbSize << " harqId " << (unsigned)dciInfoReTx.m_harqProcess << " harqId " << (unsigned)dciInfoReTx.m_harqProcess <<
                             " rv " << (unsigned)dciInfoReTx.m_rv << " in frame " << ret.m_sfnSf.m_frameNum << " subframe " << (unsigned)ret.m_sfnSf.m_sfNum << " layer " << (unsigned) dciInfoReTx.m_layerInd << " RETX");
-              std::map <uint16_t, DlHarqRlcPduList_t>::iterator itRlcList =  m_dlHarqProcessesRlcPduMap.find (rnti);
-              if ( itRlcList == m_dlHarqProcessesRlcPduMap.end () )
-                {
-                  NS_FATAL_ERROR ("Unable to find RlcPdcList in HARQ buffer for RNTI " << rnti);
-                }
-              for (uint16_t k = 0; k < (*itRlcList).second.at (dciInfoReTx.m_harqProcess).size (); k++)
-                {
-                  slotInfo.m_rlcPduInfo.push_back ((*itRlcList).second.at (dciInfoReTx.m_harqProcess).at (k));
-                }
+              const std::vector<RlcPduInfo> &rlcPduList = m_ueTable.m_dlHarqRlcPdu[harqIndex];
+              slotInfo.m_rlcPduInfo.insert (slotInfo.m_rlcPduInfo.end (), rlcPduList.begin (), rlcPduList.end ());
 
               //                  ret.m_sfAllocInfo.m_slotAllocInfo.push_back (slotInfo);
               tempDlslotAllocInfo[layerIdx].push_back (slotInfo); //
@@ -1032,36 +996,31 @@ MmWavePaddedHbfMacScheduler::DoSchedTriggerReq (const struct MmWaveMacSchedSapPr
           uint8_t harqId = harqInfo.m_harqProcessId;
           uint16_t rnti = harqInfo.m_rnti;
           itUeInfo = ueInfo.find (rnti);
-          std::map <uint16_t, UlHarqProcessesStatus_t>::iterator itStat = m_ulHarqProcessesStatus.find (rnti);
-          if (itStat == m_ulHarqProcessesStatus.end ())
+          uint32_t slot = m_ueTable.GetSlot (rnti);
+          if (slot == MmWaveHbfUeStateTable::INVALID_SLOT || !m_ueTable.m_hasHarq[slot])
             {
               NS_LOG_ERROR ("No info found in HARQ buffer for UE (might have changed eNB) " << rnti);
+              continue;
             }
-          if (harqInfo.m_receptionStatus == UlHarqInfo::Ok || itStat->second.at (harqId) == 0)
+          NS_ASSERT (harqId < m_numHarqProcess);
+          uint32_t harqIndex = m_ueTable.GetHarqIndex (slot, harqId);
+          if (harqInfo.m_receptionStatus == UlHarqInfo::Ok || m_ueTable.m_ulHarqStatus[harqIndex] == 0)
             {
               NS_LOG_DEBUG ("UE" << rnti << " UL harqId " << (unsigned)harqInfo.m_harqProcessId << " HARQ-ACK received");
-              if (itStat != m_ulHarqProcessesStatus.end ())
-                {
-                  itStat->second.at (harqId) = 0;                        // release process ID
-                }
+              m_ueTable.m_ulHarqStatus[harqIndex] = 0;                        // release process ID
             }
           else if (harqInfo.m_receptionStatus == UlHarqInfo::NotOk)
             {
-              std::map <uint16_t, UlHarqProcessesDciInfoList_t>::iterator itHarq = m_ulHarqProcessesDciInfoMap.find (rnti);
-              if (itHarq == m_ulHarqProcessesDciInfoMap.end ())
-                {
-                  NS_LOG_ERROR ("No info found in UL-HARQ buffer for UE (might have changed eNB) " << rnti);
-                }
               // retx correspondent block: retrieve the UL-DCI
-              DciInfoElementTdma dciInfoReTx = itHarq->second.at (harqId);
+              DciInfoElementTdma dciInfoReTx = m_ueTable.m_ulHarqDciInfo[harqIndex];
               NS_LOG_DEBUG ("UE" << rnti << " UL harqId " << (unsigned)harqInfo.m_harqProcessId << " HARQ-NACK received, rv " << (unsigned)dciInfoReTx.m_rv);
               NS_ASSERT (harqId == dciInfoReTx.m_harqProcess);
-              NS_ASSERT (itStat->second.at (harqId) > 0);
-              NS_ASSERT (itStat->second.at (harqId) - 1 == dciInfoReTx.m_rv);
+              NS_ASSERT (m_ueTable.m_ulHarqStatus[harqIndex] > 0);
+              NS_ASSERT (m_ueTable.m_ulHarqStatus[harqIndex] - 1 == dciInfoReTx.m_rv);
               if (dciInfoReTx.m_rv == 3)
                 {
                   NS_LOG_INFO ("Max number of retransmissions reached (UL)-> drop process");
-                  itStat->second.at (harqId) = 0;
+                  m_ueTable.m_ulHarqStatus[harqIndex] = 0;
                   continue;
                 }
               else
@@ -1105,9 +1064,8 @@ MmWavePaddedHbfMacScheduler::DoSchedTriggerReq (const struct MmWaveMacSchedSapPr
               itSetUeQuery = setUeInCurrentSymbolBlock.find ( rnti );
             }
           uint8_t harqId = m_ulHarqInfoList.at ( idxSortedHarq ).m_harqProcessId;
-          std::map <uint16_t, UlHarqProcessesStatus_t>::iterator itStat = m_ulHarqProcessesStatus.find (rnti); //this is the second time this is searched, error check was done first time so here we know we will always succeed
-          std::map <uint16_t, DlHarqProcessesDciInfoList_t>::iterator itHarq = m_ulHarqProcessesDciInfoMap.find (rnti); //this is the second time this is searched, error check was done first time so here we know we will always succeed
-          DciInfoElementTdma dciInfoReTx = itHarq->second.at (harqId);
+          uint32_t harqIndex = m_ueTable.GetHarqIndex (m_ueTable.GetSlot (rnti), harqId); //this is the second time this is searched, error check was done first time so here we know we will always succeed
+          DciInfoElementTdma dciInfoReTx = m_ueTable.m_ulHarqDciInfo[harqIndex];
 
           if (symAvail == 0)
             {
@@ -1131,8 +1089,8 @@ MmWavePaddedHbfMacScheduler::DoSchedTriggerReq (const struct MmWaveMacSchedSapPr
               dciInfoReTx.m_symStart = futureLastSymAvail + 1; //time alignment across all layers at the block start
               dciInfoReTx.m_rv++;
               dciInfoReTx.m_ndi = 0;
-              itStat->second.at (harqId) = itStat->second.at (harqId) + 1;
-              itHarq->second.at (harqId) = dciInfoReTx;
+              m_ueTable.m_ulHarqStatus[harqIndex] = m_ueTable.m_ulHarqStatus[harqIndex] + 1;
+              m_ueTable.m_ulHarqDciInfo[harqIndex] = dciInfoReTx;
               SlotAllocInfo slotInfo (tempUlSlotIdx++, SlotAllocInfo::UL_slotAllocInfo, SlotAllocInfo::CTRL_DATA, SlotAllocInfo::DIGITAL, rnti, layerIdx);
               slotInfo.m_dci = dciInfoReTx;
               NS_LOG_LOGIC ("UE" << dciInfoReTx.m_rnti << " gets UL slots " << (unsigned)dciInfoReTx.m_symStart << "-" << (unsigned)(dciInfoReTx.m_symStart + dciInfoReTx.m_numSym - 1) <<
@@ -1217,11 +1175,11 @@ MmWavePaddedHbfMacScheduler::DoSchedTriggerReq (const struct MmWaveMacSchedSapPr
                 || ((*itRlcBuf).m_rlcStatusPduSize > 0)) )
             {
               NS_LOG_INFO (this << " User " << itRlcBuf->m_rnti << " LC " << (uint16_t)itRlcBuf->m_logicalChannelIdentity << " is active, status  " << (*itRlcBuf).m_rlcStatusPduSize << " retx " << (*itRlcBuf).m_rlcRetransmissionQueueSize << " tx " << (*itRlcBuf).m_rlcTransmissionQueueSize);
-              std::map <uint16_t,uint8_t>::iterator itCqi = m_wbCqiRxed.find (itRlcBuf->m_rnti);
+              uint32_t slot = m_ueTable.GetSlot (itRlcBuf->m_rnti);
               uint8_t cqi = 0;
-              if (itCqi != m_wbCqiRxed.end ())
+              if (slot != MmWaveHbfUeStateTable::INVALID_SLOT && m_ueTable.m_hasWbCqi[slot])
                 {
-                  cqi = itCqi->second;
+                  cqi = m_ueTable.m_wbCqi[slot];
                 }
               else                   // no CQI available
                 {
@@ -1292,17 +1250,18 @@ MmWavePaddedHbfMacScheduler::DoSchedTriggerReq (const struct MmWaveMacSchedSapPr
   // get info on active UL flows
   if (symAvail > 0 && !m_dlOnly)        // remaining symbols in future UL subframe after HARQ retx sched
     {
-      std::map <uint16_t,uint32_t>::iterator ceBsrIt;
-      for (ceBsrIt = m_ceBsrRxed.begin (); ceBsrIt != m_ceBsrRxed.end (); ceBsrIt++)
+      const std::vector<uint32_t> &slots = m_ueTable.GetSlots ();
+      for (std::vector<uint32_t>::const_iterator itSlot = slots.begin (); itSlot != slots.end (); itSlot++)
         {
-          if (ceBsrIt->second > 0)                // UL buffer size > 0
+          uint32_t bsrSlot = *itSlot;
+          uint16_t bsrRnti = m_ueTable.GetRnti (bsrSlot);
+          if (m_ueTable.m_hasBsr[bsrSlot] && m_ueTable.m_bsr[bsrSlot] > 0)                // UL buffer size > 0
             {
-              std::map <uint16_t, struct UlCqiMapElem>::iterator itCqi = m_ueUlCqi.find (ceBsrIt->first);
               int cqi = 0;
               int mcs = 0;
-              if (itCqi == m_ueUlCqi.end ())                   // no cqi info for this UE
+              if (!m_ueTable.m_hasUlCqi[bsrSlot])                   // no cqi info for this UE
                 {
-                  NS_LOG_INFO (this << " UE " << ceBsrIt->first << " does not have UL-CQI");
+                  NS_LOG_INFO (this << " UE " << bsrRnti << " does not have UL-CQI");
                   cqi = 1;
                   mcs = 0;
                 }
@@ -1318,11 +1277,11 @@ MmWavePaddedHbfMacScheduler::DoSchedTriggerReq (const struct MmWaveMacSchedSapPr
 //								( (-std::log (5.0 * m_berDl )) / 1.5) ));
 //						cqi += m_amc->GetCqiFromSpectralEfficiency (se1);
                       NS_ASSERT (specIt != specVals.ValuesEnd ());
-                      *specIt = itCqi->second.m_ueUlCqi.at (ichunk);                           //sinrLin;
+                      *specIt = m_ueTable.m_ulCqi[bsrSlot].at (ichunk);                           //sinrLin;
                       specIt++;
                     }
 
-                  cqi = m_amc->CreateCqiFeedbackWbTdma (specVals, itCqi->second.m_numSym, itCqi->second.m_tbSize, mcs);
+                  cqi = m_amc->CreateCqiFeedbackWbTdma (specVals, m_ueTable.m_ulCqiNumSym[bsrSlot], m_ueTable.m_ulCqiTbSize[bsrSlot], mcs);
 //					for (unsigned i = 0; i < chunkCqi.size(); i++)
 //					{
 //						cqi += chunkCqi[i];
@@ -1348,14 +1307,14 @@ MmWavePaddedHbfMacScheduler::DoSchedTriggerReq (const struct MmWaveMacSchedSapPr
                   //				cqi = m_amc->GetCqiFromSpectralEfficiency (se);
                   if (cqi == 0 && !m_fixedMcsUl)                       // out of range (SINR too low)
                     {
-                      NS_LOG_INFO ("*** RNTI " << ceBsrIt->first << " UL-CQI out of range, skipping allocation in UL");
+                      NS_LOG_INFO ("*** RNTI " << bsrRnti << " UL-CQI out of range, skipping allocation in UL");
                       break;                            // do not allocate UE in uplink
                     }
                 }
-              itUeInfo = ueInfo.find (ceBsrIt->first);
+              itUeInfo = ueInfo.find (bsrRnti);
               if (itUeInfo == ueInfo.end ())
                 {
-                  itUeInfo = ueInfo.insert (std::pair<uint16_t, struct UeSchedInfo> (ceBsrIt->first, UeSchedInfo () )).first;
+                  itUeInfo = ueInfo.insert (std::pair<uint16_t, struct UeSchedInfo> (bsrRnti, UeSchedInfo () )).first;
                   nFlowsUl++;
                 }
               else if (itUeInfo->second.m_maxUlBufSize == 0)
@@ -1370,7 +1329,7 @@ MmWavePaddedHbfMacScheduler::DoSchedTriggerReq (const struct MmWaveMacSchedSapPr
                 {
                   itUeInfo->second.m_ulMcs = mcs;                      //m_amc->GetMcsFromCqi (cqi);  // get MCS
                 }
-              itUeInfo->second.m_maxUlBufSize = ceBsrIt->second + m_rlcHdrSize + m_macHdrSize + 8;
+              itUeInfo->second.m_maxUlBufSize = m_ueTable.m_bsr[bsrSlot] + m_rlcHdrSize + m_macHdrSize + 8;
             }
         }
     }
@@ -1503,19 +1462,15 @@ MmWavePaddedHbfMacScheduler::DoSchedTriggerReq (const struct MmWaveMacSchedSapPr
 
               if (m_harqOn == true)
                 {                   // store DCI for HARQ buffer
-                  std::map <uint16_t, DlHarqProcessesDciInfoList_t>::iterator itDciInfo = m_dlHarqProcessesDciInfoMap.find (dci.m_rnti);
-                  if (itDciInfo == m_dlHarqProcessesDciInfoMap.end ())
+                  uint32_t slot = m_ueTable.GetSlot (dci.m_rnti);
+                  if (slot == MmWaveHbfUeStateTable::INVALID_SLOT || !m_ueTable.m_hasHarq[slot])
                     {
                       NS_FATAL_ERROR ("Unable to find RNTI entry in DCI HARQ buffer for RNTI " << dci.m_rnti);
                     }
-                  (*itDciInfo).second.at (dci.m_harqProcess) = dci;
+                  uint32_t harqIndex = m_ueTable.GetHarqIndex (slot, dci.m_harqProcess);
+                  m_ueTable.m_dlHarqDciInfo[harqIndex] = dci;
                   // refresh timer
-                  std::map <uint16_t, DlHarqProcessesTimer_t>::iterator itHarqTimer =  m_dlHarqProcessesTimer.find (dci.m_rnti);
-                  if (itHarqTimer == m_dlHarqProcessesTimer.end ())
-                    {
-                      NS_FATAL_ERROR ("Unable to find HARQ timer for RNTI " << (uint16_t)dci.m_rnti);
-                    }
-                  (*itHarqTimer).second.at (dci.m_harqProcess) = 0;
+                  m_ueTable.m_dlHarqTimer[harqIndex] = 0;
                 }
 
               // distribute bytes between active RLC queues
@@ -1553,12 +1508,8 @@ MmWavePaddedHbfMacScheduler::DoSchedTriggerReq (const struct MmWaveMacSchedSapPr
                   if (m_harqOn == true)
                     {
                       // store RLC PDU list for HARQ
-                      std::map <uint16_t, DlHarqRlcPduList_t>::iterator itRlcPdu =  m_dlHarqProcessesRlcPduMap.find (dci.m_rnti);
-                      if (itRlcPdu == m_dlHarqProcessesRlcPduMap.end ())
-                        {
-                          NS_FATAL_ERROR ("Unable to find RlcPdcList in HARQ buffer for RNTI " << dci.m_rnti);
-                        }
-                      (*itRlcPdu).second.at (dci.m_harqProcess).push_back (ueSchedInfo.m_rlcPduInfo[i]);
+                      uint32_t harqIndex = m_ueTable.GetHarqIndex (m_ueTable.GetSlot (dci.m_rnti), dci.m_harqProcess);
+                      m_ueTable.m_dlHarqRlcPdu[harqIndex].push_back (ueSchedInfo.m_rlcPduInfo[i]);
                     }
                 }
 
@@ -1623,22 +1574,17 @@ MmWavePaddedHbfMacScheduler::DoSchedTriggerReq (const struct MmWaveMacSchedSapPr
               if (m_harqOn == true)
                 {
                   uint8_t harqId = dci.m_harqProcess;
-                  std::map <uint16_t, UlHarqProcessesDciInfoList_t>::iterator itHarqTbInfo = m_ulHarqProcessesDciInfoMap.find (dci.m_rnti);
-                  if (itHarqTbInfo == m_ulHarqProcessesDciInfoMap.end ())
+                  uint32_t slot = m_ueTable.GetSlot (dci.m_rnti);
+                  if (slot == MmWaveHbfUeStateTable::INVALID_SLOT || !m_ueTable.m_hasHarq[slot])
                     {
                       NS_FATAL_ERROR ("Unable to find RNTI entry in UL DCI HARQ buffer for RNTI " << dci.m_rnti);
                     }
-                  (*itHarqTbInfo).second.at (harqId) = dci;
+                  uint32_t harqIndex = m_ueTable.GetHarqIndex (slot, harqId);
+                  m_ueTable.m_ulHarqDciInfo[harqIndex] = dci;
                   // Update HARQ process status (RV 0)
-                  std::map <uint16_t, UlHarqProcessesStatus_t>::iterator itStat = m_ulHarqProcessesStatus.find (dci.m_rnti);
-                  NS_ASSERT (itStat->second[dci.m_harqProcess] > 0);
+                  NS_ASSERT (m_ueTable.m_ulHarqStatus[harqIndex] > 0);
                   // refresh timer
-                  std::map <uint16_t, UlHarqProcessesTimer_t>::iterator itHarqTimer =  m_ulHarqProcessesTimer.find (dci.m_rnti);
-                  if (itHarqTimer == m_ulHarqProcessesTimer.end ())
-                    {
-                      NS_FATAL_ERROR ("Unable to find HARQ timer for RNTI " << (uint16_t)dci.m_rnti);
-                    }
-                  (*itHarqTimer).second.at (dci.m_harqProcess) = 0;
+                  m_ueTable.m_ulHarqTimer[harqIndex] = 0;
                 }
 
               layerIdxUl++;
@@ -1795,8 +1741,6 @@ MmWavePaddedHbfMacScheduler::DoSchedUlMacCtrlInfoReq (const struct MmWaveMacSche
 {
   NS_LOG_FUNCTION (this);
 
-  std::map <uint16_t,uint32_t>::iterator it;
-
   for (unsigned int i = 0; i < params.m_macCeList.size (); i++)
     {
       if ( params.m_macCeList.at (i).m_macCeType == MacCeElement::BSR )
@@ -1816,17 +1760,18 @@ MmWavePaddedHbfMacScheduler::DoSchedUlMacCtrlInfoReq (const struct MmWaveMacSche
             }
 
           uint16_t rnti = params.m_macCeList.at (i).m_rnti;
-          it = m_ceBsrRxed.find (rnti);
-          if (it == m_ceBsrRxed.end ())
+          uint32_t slot = m_ueTable.AddUe (rnti);
+          if (!m_ueTable.m_hasBsr[slot])
             {
               // create the new entry
-              m_ceBsrRxed.insert ( std::pair<uint16_t, uint32_t > (rnti, buffer));
+              m_ueTable.m_hasBsr[slot] = 1;
+              m_ueTable.m_bsr[slot] = buffer;
               NS_LOG_INFO (this << " Insert RNTI " << rnti << " queue " << buffer);
             }
           else
             {
               // update the buffer size value
-              (*it).second = buffer;
+              m_ueTable.m_bsr[slot] = buffer;
               NS_LOG_INFO (this << " Update RNTI " << rnti << " queue " << buffer);
             }
         }
@@ -1855,29 +1800,34 @@ MmWavePaddedHbfMacScheduler::SortRlcBufferReq (MmWaveMacSchedSapProvider::SchedD
 void
 MmWavePaddedHbfMacScheduler::RefreshDlCqiMaps (void)
 {
-  NS_LOG_FUNCTION (this << m_wbCqiTimers.size ());
+  NS_LOG_FUNCTION (this);
   // refresh DL CQI P01 Map
-  std::map <uint16_t,uint32_t>::iterator itP10 = m_wbCqiTimers.begin ();
-  while (itP10 != m_wbCqiTimers.end ())
+  std::vector<uint32_t> expired;
+  const std::vector<uint32_t> &slots = m_ueTable.GetSlots ();
+  for (std::vector<uint32_t>::const_iterator itSlot = slots.begin (); itSlot != slots.end (); itSlot++)
     {
-      NS_LOG_INFO (this << " P10-CQI for user " << (*itP10).first << " is " << (uint32_t)(*itP10).second << " thr " << (uint32_t)m_cqiTimersThreshold);
-      if ((*itP10).second == 0)
+      if (!m_ueTable.m_hasWbCqi[*itSlot])
+        {
+          continue;
+        }
+      uint16_t rnti = m_ueTable.GetRnti (*itSlot);
+      NS_LOG_INFO (this << " P10-CQI for user " << rnti << " is " << m_ueTable.m_wbCqiTimer[*itSlot] << " thr " << (uint32_t)m_cqiTimersThreshold);
+      if (m_ueTable.m_wbCqiTimer[*itSlot] == 0)
         {
           // delete correspondent entries
-          std::map <uint16_t,uint8_t>::iterator itMap = m_wbCqiRxed.find ((*itP10).first);
-          NS_ASSERT_MSG (itMap != m_wbCqiRxed.end (), " Does not find CQI report for user " << (*itP10).first);
-          NS_LOG_INFO (this << " P10-CQI exired for user " << (*itP10).first);
-          m_wbCqiRxed.erase (itMap);
-          std::map <uint16_t,uint32_t>::iterator temp = itP10;
-          itP10++;
-          m_wbCqiTimers.erase (temp);
+          NS_LOG_INFO (this << " P10-CQI exired for user " << rnti);
+          m_ueTable.m_hasWbCqi[*itSlot] = 0;
+          expired.push_back (*itSlot);
         }
       else
         {
-          (*itP10).second--;
-          itP10++;
+          m_ueTable.m_wbCqiTimer[*itSlot]--;
         }
     }
+  for (std::vector<uint32_t>::iterator it = expired.begin (); it != expired.end (); it++)
+    {
+      m_ueTable.RemoveUeIfUnused (*it);
+    }
 
   return;
 }
@@ -1887,28 +1837,33 @@ void
 MmWavePaddedHbfMacScheduler::RefreshUlCqiMaps (void)
 {
   // refresh UL CQI  Map
-  std::map <uint16_t,uint32_t>::iterator itUl = m_ueCqiTimers.begin ();
-  while (itUl != m_ueCqiTimers.end ())
+  std::vector<uint32_t> expired;
+  const std::vector<uint32_t> &slots = m_ueTable.GetSlots ();
+  for (std::vector<uint32_t>::const_iterator itSlot = slots.begin (); itSlot != slots.end (); itSlot++)
     {
-      NS_LOG_INFO (this << " UL-CQI for user " << (*itUl).first << " is " << (uint32_t)(*itUl).second << " thr " << (uint32_t)m_cqiTimersThreshold);
-      if ((*itUl).second == 0)
+      if (!m_ueTable.m_hasUlCqi[*itSlot])
+        {
+          continue;
+        }
+      uint16_t rnti = m_ueTable.GetRnti (*itSlot);
+      NS_LOG_INFO (this << " UL-CQI for user " << rnti << " is " << m_ueTable.m_ulCqiTimer[*itSlot] << " thr " << (uint32_t)m_cqiTimersThreshold);
+      if (m_ueTable.m_ulCqiTimer[*itSlot] == 0)
         {
           // delete correspondent entries
-          std::map <uint16_t, struct UlCqiMapElem>::iterator itMap = m_ueUlCqi.find ((*itUl).first);
-          NS_ASSERT_MSG (itMap != m_ueUlCqi.end (), " Does not find CQI report for user " << (*itUl).first);
-          NS_LOG_INFO (this << " UL-CQI expired for user " << (*itUl).first);
-          itMap->second.m_ueUlCqi.clear ();
-          m_ueUlCqi.erase (itMap);
-          std::map <uint16_t,uint32_t>::iterator temp = itUl;
-          itUl++;
-          m_ueCqiTimers.erase (temp);
+          NS_LOG_INFO (this << " UL-CQI expired for user " << rnti);
+          m_ueTable.m_hasUlCqi[*itSlot] = 0;
+          m_ueTable.m_ulCqi[*itSlot].clear ();
+          expired.push_back (*itSlot);
         }
       else
         {
-          (*itUl).second--;
-          itUl++;
+          m_ueTable.m_ulCqiTimer[*itSlot]--;
         }
     }
+  for (std::vector<uint32_t>::iterator it = expired.begin (); it != expired.end (); it++)
+    {
+      m_ueTable.RemoveUeIfUnused (*it);
+    }
 
   return;
 }
@@ -1977,17 +1932,17 @@ MmWavePaddedHbfMacScheduler::UpdateUlRlcBufferInfo (uint16_t rnti, uint16_t size
 {
 
   size = size - 2; // remove the minimum RLC overhead
-  std::map <uint16_t,uint32_t>::iterator it = m_ceBsrRxed.find (rnti);
-  if (it != m_ceBsrRxed.end ())
+  uint32_t slot = m_ueTable.GetSlot (rnti);
+  if (slot != MmWaveHbfUeStateTable::INVALID_SLOT && m_ueTable.m_hasBsr[slot])
     {
-      NS_LOG_INFO (this << " Update RLC BSR UE " << rnti << " size " << size << " BSR " << (*it).second);
-      if ((*it).second >= size)
+      NS_LOG_INFO (this << " Update RLC BSR UE " << rnti << " size " << size << " BSR " << m_ueTable.m_bsr[slot]);
+      if (m_ueTable.m_bsr[slot] >= size)
         {
-          (*it).second -= size;
+          m_ueTable.m_bsr[slot] -= size;
         }
       else
         {
-          (*it).second = 0;
+          m_ueTable.m_bsr[slot] = 0;
         }
     }
   else
@@ -2016,35 +1971,10 @@ MmWavePaddedHbfMacScheduler::DoCschedUeConfigReq (const struct MmWaveMacCschedSa
 {
   NS_LOG_FUNCTION (this << " RNTI " << params.m_rnti << " txMode " << (uint16_t)params.m_transmissionMode);
 
-  if (m_dlHarqProcessesStatus.find (params.m_rnti) == m_dlHarqProcessesStatus.end ())
-    {
-      //m_dlHarqCurrentProcessId.insert (std::pair <uint16_t,uint8_t > (params.m_rnti, 0));
-      DlHarqProcessesStatus_t dlHarqPrcStatus;
-      dlHarqPrcStatus.resize (m_phyMacConfig->GetNumHarqProcess (), 0);
-      m_dlHarqProcessesStatus.insert (std::pair <uint16_t, DlHarqProcessesStatus_t> (params.m_rnti, dlHarqPrcStatus));
-      DlHarqProcessesTimer_t dlHarqProcessesTimer;
-      dlHarqProcessesTimer.resize (m_phyMacConfig->GetNumHarqProcess (),0);
-      m_dlHarqProcessesTimer.insert (std::pair <uint16_t, DlHarqProcessesTimer_t> (params.m_rnti, dlHarqProcessesTimer));
-      DlHarqProcessesDciInfoList_t dlHarqTbInfoList;
-      dlHarqTbInfoList.resize (m_phyMacConfig->GetNumHarqProcess ());
-      m_dlHarqProcessesDciInfoMap.insert (std::pair <uint16_t, DlHarqProcessesDciInfoList_t> (params.m_rnti, dlHarqTbInfoList));
-      DlHarqRlcPduList_t dlHarqRlcPduList;
-      dlHarqRlcPduList.resize (m_phyMacConfig->GetNumHarqProcess ());
-      m_dlHarqProcessesRlcPduMap.insert (std::pair <uint16_t, DlHarqRlcPduList_t> (params.m_rnti, dlHarqRlcPduList));
-    }
-
-  if (m_ulHarqProcessesStatus.find (params.m_rnti) == m_ulHarqProcessesStatus.end ())
+  uint32_t slot = m_ueTable.AddUe (params.m_rnti);
+  if (!m_ueTable.m_hasHarq[slot])
     {
-      //				m_ulHarqCurrentProcessId.insert (std::pair <uint16_t,uint8_t > (rnti, 0));
-      UlHarqProcessesStatus_t ulHarqPrcStatus;
-      ulHarqPrcStatus.resize (m_phyMacConfig->GetNumHarqProcess (), 0);
-      m_ulHarqProcessesStatus.insert (std::pair <uint16_t, UlHarqProcessesStatus_t> (params.m_rnti, ulHarqPrcStatus));
-      UlHarqProcessesTimer_t ulHarqProcessesTimer;
-      ulHarqProcessesTimer.resize (m_phyMacConfig->GetNumHarqProcess (),0);
-      m_ulHarqProcessesTimer.insert (std::pair <uint16_t, UlHarqProcessesTimer_t> (params.m_rnti, ulHarqProcessesTimer));
-      UlHarqProcessesDciInfoList_t ulHarqTbInfoList;
-      ulHarqTbInfoList.resize (m_phyMacConfig->GetNumHarqProcess ());
-      m_ulHarqProcessesDciInfoMap.insert (std::pair <uint16_t, UlHarqProcessesDciInfoList_t> (params.m_rnti, ulHarqTbInfoList));
+      m_ueTable.ConfigureHarq (slot);
     }
 }
 
@@ -2083,16 +2013,14 @@ MmWavePaddedHbfMacScheduler::DoCschedUeReleaseReq (const struct MmWaveMacCschedS
 {
   NS_LOG_FUNCTION (this << " Release RNTI " << params.m_rnti);
 
-  //m_dlHarqCurrentProcessId.erase (params.m_rnti);
-  m_dlHarqProcessesStatus.erase  (params.m_rnti);
-  m_dlHarqProcessesTimer.erase (params.m_rnti);
-  m_dlHarqProcessesDciInfoMap.erase  (params.m_rnti);
-  m_dlHarqProcessesRlcPduMap.erase  (params.m_rnti);
-  //m_ulHarqCurrentProcessId.erase  (params.m_rnti);
-  m_ulHarqProcessesTimer.erase (params.m_rnti);
-  m_ulHarqProcessesStatus.erase  (params.m_rnti);
-  m_ulHarqProcessesDciInfoMap.erase  (params.m_rnti);
-  m_ceBsrRxed.erase (params.m_rnti);
+  uint32_t slot = m_ueTable.GetSlot (params.m_rnti);
+  if (slot != MmWaveHbfUeStateTable::INVALID_SLOT)
+    {
+      // the CQIs are kept until they expire
+      m_ueTable.m_hasHarq[slot] = 0;
+      m_ueTable.m_hasBsr[slot] = 0;
+      m_ueTable.RemoveUeIfUnused (slot);
+    }
   std::list<MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters>::iterator it = m_rlcBufferReq.begin ();
   while (it != m_rlcBufferReq.end ())
     {
@@ -38,6 +38,7 @@
 #include "mmwave-mac-csched-sap.h"
 #include "mmwave-mac-scheduler.h"
 #include "mmwave-amc.h"
+#include "mmwave-hbf-ue-state-table.h"
 #include "string"
 #include <vector>
 #include <set>
@@ -219,43 +220,13 @@ private:
   std::list <MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters> m_rlcBufferReq;
 
   /*
-   * Map of UE's DL CQI WB received
+   * State of the UEs: DL CQI WB and UL-CQI per RBG received, with their
+   * timers, buffer status reports received and HARQ processes
    */
-  std::map <uint16_t,uint8_t> m_wbCqiRxed;
-  /*
-   * Map of UE's timers on DL CQI WB received
-   */
-  std::map <uint16_t,uint32_t> m_wbCqiTimers;
+  MmWaveHbfUeStateTable m_ueTable;
 
   uint32_t m_cqiTimersThreshold;       // # of TTIs for which a CQI can be considered valid
 
-  /*
-   * Map of UEs' UL-CQI per RBG
-   */
-  struct UlCqiMapElem
-  {
-    UlCqiMapElem (std::vector<double> ulCqi, uint8_t nSym, uint32_t tbs)
-      : m_ueUlCqi (ulCqi),
-        m_numSym (nSym),
-        m_tbSize (tbs)
-    {
-    }
-    std::vector <double> m_ueUlCqi;
-    uint8_t         m_numSym;
-    uint32_t        m_tbSize;
-  };
-
-  std::map <uint16_t, struct UlCqiMapElem> m_ueUlCqi;
-  /*
-   * Map of UEs' timers on UL-CQI per RBG
-   */
-  std::map <uint16_t, uint32_t> m_ueCqiTimers;
-
-  /*
-   * Map of UE's buffer status reports received
-   */
-  std::map <uint16_t,uint32_t> m_ceBsrRxed;
-
   uint16_t m_nextRnti;
   uint64_t m_nextRntiDl;
   uint64_t m_nextRntiUl;
@@ -300,25 +271,9 @@ private:
   uint8_t m_numHarqProcess;
   uint8_t m_harqTimeout;
 
-  std::map <uint16_t, uint8_t> m_dlHarqCurrentProcessId;
-  //HARQ status
-  // 0: process Id available
-  // x>0: process Id equal to `x` trasmission count
-  std::map <uint16_t, DlHarqProcessesStatus_t> m_dlHarqProcessesStatus;
-  std::map <uint16_t, DlHarqProcessesTimer_t> m_dlHarqProcessesTimer;
-  std::map <uint16_t, DlHarqProcessesDciInfoList_t> m_dlHarqProcessesDciInfoMap;
-  std::map <uint16_t, DlHarqRlcPduList_t> m_dlHarqProcessesRlcPduMap;
   std::vector <DlHarqInfo> m_dlHarqInfoList;       // HARQ retx buffered
   std::vector <UlHarqInfo> m_ulHarqInfoList;       // HARQ retx buffered
 
-  std::map <uint16_t, uint8_t> m_ulHarqCurrentProcessId;
-  //HARQ status
-  // 0: process Id available
-  // x>0: process Id equal to `x` trasmission count
-  std::map <uint16_t, UlHarqProcessesStatus_t>    m_ulHarqProcessesStatus;
-  std::map <uint16_t, UlHarqProcessesTimer_t>     m_ulHarqProcessesTimer;
-  std::map <uint16_t, UlHarqProcessesDciInfoList_t> m_ulHarqProcessesDciInfoMap;
-
   // needed to keep track of uplink allocations in later slots
   std::list <struct SfAllocInfo> m_ulSfAllocInfo;
 
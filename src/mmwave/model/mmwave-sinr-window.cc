@@ -0,0 +1,100 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   Copyright (c) 2019 University of Padova, Dep. of Information Engineering, SIGNET lab.
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include "mmwave-sinr-window.h"
+#include <ns3/assert.h>
+
+namespace ns3 {
+
+namespace mmwave {
+
+MmWaveSinrWindow::MmWaveSinrWindow ()
+  : m_first (0),
+    m_size (0)
+{
+}
+
+void
+MmWaveSinrWindow::Push (double sample)
+{
+  if (m_size == m_buffer.size ())
+    {
+      // the buffer is full, move the samples to a larger one, starting from
+      // the oldest sample
+      std::vector<double> buffer = GetSamples ();
+      buffer.resize (m_buffer.empty () ? 16 : 2 * m_buffer.size ());
+      m_buffer.swap (buffer);
+      m_first = 0;
+    }
+  m_buffer[(m_first + m_size) % m_buffer.size ()] = sample;
+  m_size++;
+}
+
+void
+MmWaveSinrWindow::Slide (double sample)
+{
+  if (m_size == 0)
+    {
+      Push (sample);
+      return;
+    }
+  // the newest sample takes the place of the oldest one
+  m_buffer[(m_first + m_size) % m_buffer.size ()] = sample;
+  m_first = (m_first + 1) % m_buffer.size ();
+}
+
+std::size_t
+MmWaveSinrWindow::GetSize (void) const
+{
+  return m_size;
+}
+
+double
+MmWaveSinrWindow::At (std::size_t index) const
+{
+  NS_ASSERT (index < m_size);
+  return m_buffer[(m_first + index) % m_buffer.size ()];
+}
+
+double
+MmWaveSinrWindow::Back (void) const
+{
+  return At (m_size - 1);
+}
+
+void
+MmWaveSinrWindow::SetBack (double sample)
+{
+  NS_ASSERT (m_size > 0);
+  m_buffer[(m_first + m_size - 1) % m_buffer.size ()] = sample;
+}
+
+std::vector<double>
+MmWaveSinrWindow::GetSamples (void) const
+{
+  std::vector<double> samples;
+  samples.reserve (m_size);
+  for (std::size_t i = 0; i < m_size; i++)
+    {
+      samples.push_back (At (i));
+    }
+  return samples;
+}
+
+} // namespace mmwave
+} // namespace ns3
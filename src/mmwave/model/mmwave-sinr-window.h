@@ -0,0 +1,95 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   Copyright (c) 2019 University of Padova, Dep. of Information Engineering, SIGNET lab.
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#ifndef SRC_MMWAVE_SINR_WINDOW_H_
+#define SRC_MMWAVE_SINR_WINDOW_H_
+
+#include <vector>
+#include <cstddef>
+
+namespace ns3 {
+
+namespace mmwave {
+
+/**
+ * Window of the last SINR samples of a UE-eNB pair, used by the noise and
+ * filtering of the SINR estimates of the MmWaveEnbPhy.
+ *
+ * The window grows during the initial transient, then it slides, i.e., each
+ * new sample replaces the oldest one. The samples are stored in a ring
+ * buffer, so that sliding the window takes constant time and does not move
+ * the other samples.
+ */
+class MmWaveSinrWindow
+{
+public:
+  /**
+   * Constructor of an empty window
+   */
+  MmWaveSinrWindow ();
+
+  /**
+   * Append a sample, increasing the size of the window
+   * \param sample the new sample
+   */
+  void Push (double sample);
+
+  /**
+   * Append a sample and drop the oldest one, keeping the size of the window.
+   * The sample is just appended if the window is empty.
+   * \param sample the new sample
+   */
+  void Slide (double sample);
+
+  /**
+   * \return the number of samples in the window
+   */
+  std::size_t GetSize (void) const;
+
+  /**
+   * \param index the index of the sample, 0 being the oldest one
+   * \return the sample
+   */
+  double At (std::size_t index) const;
+
+  /**
+   * \return the newest sample
+   */
+  double Back (void) const;
+
+  /**
+   * Replace the newest sample
+   * \param sample the new value of the newest sample
+   */
+  void SetBack (double sample);
+
+  /**
+   * \return the samples, from the oldest to the newest one
+   */
+  std::vector<double> GetSamples (void) const;
+
+private:
+  std::vector<double> m_buffer; //!< the ring buffer
+  std::size_t m_first; //!< the position of the oldest sample in m_buffer
+  std::size_t m_size; //!< the number of samples
+};
+
+} // namespace mmwave
+} // namespace ns3
+
+#endif /* SRC_MMWAVE_SINR_WINDOW_H_ */
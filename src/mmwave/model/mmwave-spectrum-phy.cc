@@ -53,6 +53,7 @@
 #include <ns3/double.h>
 #include <ns3/mmwave-mi-error-model.h>
 #include "mmwave-mac-pdu-tag.h"
+#include "mmwave-distributed-spectrum-channel.h"
 
 #include <ns3/three-gpp-spectrum-propagation-loss-model.h>
 
@@ -100,7 +101,9 @@ MmWaveSpectrumPhy::MmWaveSpectrumPhy ()
   : m_cellId (0),
     m_state (IDLE),
     m_componentCarrierId (0),
-    m_layerInd (0)
+    m_layerInd (0),
+    m_isEnb (false),
+    m_isMcUe (false)
 {
   m_interferenceData = CreateObject<mmWaveInterference> ();
   m_random = CreateObject<UniformRandomVariable> ();
@@ -112,7 +115,9 @@ MmWaveSpectrumPhy::MmWaveSpectrumPhy (uint8_t layerInd)
   : m_cellId (0),
     m_state (IDLE),
     m_componentCarrierId (0),
-    m_layerInd (layerInd)
+    m_layerInd (layerInd),
+    m_isEnb (false),
+    m_isMcUe (false)
 {
   m_interferenceData = CreateObject<mmWaveInterference> ();
   m_random = CreateObject<UniformRandomVariable> ();
@@ -157,7 +162,9 @@ MmWaveSpectrumPhy::GetTypeId (void)
 void
 MmWaveSpectrumPhy::DoDispose ()
 {
-
+  m_enbPhy = 0;
+  m_uePhy = 0;
+  m_3gppSplm = 0;
 }
 
 void
@@ -187,16 +194,31 @@ MmWaveSpectrumPhy::SetDevice (Ptr<NetDevice> d)
 {
   m_device = d;
 
-  Ptr<MmWaveEnbNetDevice> enbNetDev = DynamicCast<MmWaveEnbNetDevice> (GetDevice ());
+  // the phy of the device may not be installed yet, it is resolved by
+  // ResolveDevicePhy when the first signal is received
+  m_isEnb = (DynamicCast<MmWaveEnbNetDevice> (d) != 0);
+  m_isMcUe = (DynamicCast<McUeNetDevice> (d) != 0);
+  m_enbPhy = 0;
+  m_uePhy = 0;
+}
 
-  // TODO m_isEnb is never used
-  if (enbNetDev != 0)
+void
+MmWaveSpectrumPhy::ResolveDevicePhy ()
+{
+  NS_LOG_FUNCTION (this);
+  if (m_isEnb)
     {
-      m_isEnb = true;
+      m_enbPhy = StaticCast<MmWaveEnbNetDevice> (m_device)->GetPhy (m_componentCarrierId);
+    }
+  else if (m_isMcUe)
+    {
+      m_uePhy = StaticCast<McUeNetDevice> (m_device)->GetMmWavePhy (m_componentCarrierId);
     }
   else
     {
-      m_isEnb = false;
+      Ptr<MmWaveUeNetDevice> ueDevice = DynamicCast<MmWaveUeNetDevice> (m_device);
+      NS_ASSERT_MSG (ueDevice != 0, "The device of the spectrum phy is neither an eNB nor a UE");
+      m_uePhy = ueDevice->GetPhy (m_componentCarrierId);
     }
 }
 
@@ -222,6 +244,17 @@ void
 MmWaveSpectrumPhy::SetChannel (Ptr<SpectrumChannel> c)
 {
   m_channel = c;
+  m_3gppSplm = 0;
+  if (c != 0)
+    {
+      m_3gppSplm = DynamicCast<ThreeGppSpectrumPropagationLossModel> (c->GetSpectrumPropagationLossModel ());
+    }
+  // the distributed channel identifies the transmitters by their registration order
+  Ptr<MmWaveDistributedSpectrumChannel> distributedChannel = DynamicCast<MmWaveDistributedSpectrumChannel> (c);
+  if (distributedChannel != 0)
+    {
+      distributedChannel->AddTxPhy (this);
+    }
 }
 
 Ptr<SpectrumChannel>
@@ -363,135 +396,114 @@ MmWaveSpectrumPhy::StartRx (Ptr<SpectrumSignalParameters> params)
   // the same cell
   //
 
-  Ptr<MmWaveEnbNetDevice> EnbTx =
-    DynamicCast<MmWaveEnbNetDevice> (params->txPhy->GetDevice ());
-  Ptr<MmWaveEnbNetDevice> enbRx =
-    DynamicCast<MmWaveEnbNetDevice> (GetDevice ());
-  if ((EnbTx != 0 && enbRx != 0) || (EnbTx == 0 && enbRx == 0))
+  // only the signals of the mmwave spectrum phys are received: their
+  // parameters derive from MmWaveSpectrumSignalParametersBase, which tells
+  // the type of the signal and the role of the transmitter
+  static const TypeId mmwaveSpectrumPhyTid = MmWaveSpectrumPhy::GetTypeId ();
+  if (params->txPhy->GetInstanceTypeId () != mmwaveSpectrumPhyTid)
+    {
+      NS_LOG_LOGIC ("Signal not transmitted by a mmWave spectrum phy neglected.");
+      return;
+    }
+  Ptr<MmWaveSpectrumSignalParametersBase> mmwaveRxParams = StaticCast<MmWaveSpectrumSignalParametersBase> (params);
+  if (mmwaveRxParams->txIsEnb == m_isEnb)
     {
       NS_LOG_LOGIC ("BS to BS or UE to UE transmission neglected.");
       return;
     }
 
-  // check if the received signal is mmWave DATA or CTRL
-  Ptr<MmwaveSpectrumSignalParametersDataFrame> mmwaveDataRxParams = DynamicCast<MmwaveSpectrumSignalParametersDataFrame> (params);
-  Ptr<MmWaveSpectrumSignalParametersDlCtrlFrame> mmwaveDlCtrlRxParams = DynamicCast<MmWaveSpectrumSignalParametersDlCtrlFrame> (params);
+  if (m_enbPhy == 0 && m_uePhy == 0)
+    {
+      ResolveDevicePhy ();
+    }
 
-  if (mmwaveDataRxParams != 0)
+  // check if the received signal is mmWave DATA or CTRL
+  if (mmwaveRxParams->signalType == MMWAVE_DATA_FRAME)
     {
       // mmWave DATA case
+      Ptr<MmwaveSpectrumSignalParametersDataFrame> mmwaveDataRxParams =
+        StaticCast<MmwaveSpectrumSignalParametersDataFrame> (mmwaveRxParams);
 
       // TODO in case our device is a UE, the code below checks if the UePhy is
       // allowed to receive a signal.
       // This should be done inside the UePhy class as a state machine
-      
-      LteRadioBearerTag bearerTag;
-      (*(mmwaveDataRxParams->packetBurst->Begin()))->PeekPacketTag (bearerTag);
-//      NS_LOG_INFO ("Data rx parameters: \n"
-//	  << "\tcellID: " << mmwaveDataRxParams->cellId << "\n"
-//	  << "\tlayerInd: " << (int ) mmwaveDataRxParams->layerInd << "\n"
-//	  << "\tNpackets: "<< (int )mmwaveDataRxParams->packetBurst->GetNPackets() << "\n"
-//	  << "\tRNTIpackets: "<< (int )bearerTag.GetRnti ());
 
       bool isAllocated = true;
       bool isMyLayer = true;
-      Ptr<mmwave::MmWaveUeNetDevice> ueRx = 0;
-      ueRx = DynamicCast<mmwave::MmWaveUeNetDevice> (GetDevice ());
-      Ptr<McUeNetDevice> rxMcUe = 0;
-      rxMcUe = DynamicCast<McUeNetDevice> (GetDevice ());
-      Ptr<MmWaveUeNetDevice> ueTx = DynamicCast<MmWaveUeNetDevice> (params->txPhy->GetDevice ());
-      
+
       uint16_t cellId = mmwaveDataRxParams->cellId;
       uint8_t layerInd = mmwaveDataRxParams->layerInd;
       Time duration = mmwaveDataRxParams->duration;
-      NS_LOG_INFO("RXData signal layer index: " << (int)layerInd << ", cell ID: " << (int)cellId << ", duration: " << duration
-		  	  << " slotInd: " << (int ) mmwaveDataRxParams->slotInd
-			  << " Npackets: " << (int )mmwaveDataRxParams->packetBurst->GetNPackets()
-			  << " RNTIpackets: "<< (int )bearerTag.GetRnti ());
-      // Begin of logic for UE as Rx
-      if (ueRx != 0)
-        {
-          NS_LOG_INFO ("[DL] UE's allocated layer index:" << (int) ueRx->GetPhy (m_componentCarrierId)->GetAllocLayerInd ());
-        }
-
-      if ((ueRx != 0) && (ueRx->GetPhy (m_componentCarrierId)->IsReceptionEnabled () == false))
-        {               // if the first cast is 0 (the device is MC) then this if will not be executed
-          NS_LOG_INFO ("This UE does not receive data currently.");
-			    isAllocated = false;
-        }
-      else if ((rxMcUe != 0) && (rxMcUe->GetMmWavePhy (m_componentCarrierId)->IsReceptionEnabled () == false))
-        {               // this is executed if the device is MC and is transmitting
-          isAllocated = false;
-        }
-     
-      if ((ueRx != 0) && (ueRx->GetPhy (m_componentCarrierId)->GetAllocLayerInd() != layerInd))
-        {               
-          NS_LOG_INFO ("This data is not for this UE");
-          isMyLayer = false;
-        }
-      else if ((rxMcUe != 0) && (rxMcUe->GetMmWavePhy (m_componentCarrierId)->GetAllocLayerInd() != layerInd))
-        {               
-          isMyLayer = false;
-        }
+      NS_LOG_INFO ("RXData signal layer index: " << (int)layerInd << ", cell ID: " << (int)cellId << ", duration: " << duration
+                   << " slotInd: " << (int ) mmwaveDataRxParams->slotInd
+                   << " Npackets: " << (int )mmwaveDataRxParams->packetBurst->GetNPackets ());
 
-      // Begin of logic for BS as Rx
-
-      if (enbRx !=0)
-        {
-	  NS_LOG_INFO (Simulator::Now() << " [UL] gNB's layer index:" << (int)m_layerInd << ", UE's allocated index:" << (int)layerInd);
-        }
-      if ((enbRx != 0) && (enbRx->GetPhy (m_componentCarrierId)->IsReceptionEnabled () == false))
+      if (m_isEnb)
         {
-          isAllocated = false;
+          // Begin of logic for BS as Rx
+          NS_LOG_INFO (Simulator::Now () << " [UL] gNB's layer index:" << (int)m_layerInd << ", UE's allocated index:" << (int)layerInd);
+          if (m_enbPhy->IsReceptionEnabled () == false)
+            {
+              isAllocated = false;
+            }
+          if (m_layerInd != layerInd)
+            {
+              isMyLayer = false;
+            }
         }
-
-      if ((enbRx != 0) && (m_layerInd != layerInd))
+      else
         {
-          isMyLayer = false;
+          // Begin of logic for UE as Rx
+          NS_LOG_INFO ("[DL] UE's allocated layer index:" << (int) m_uePhy->GetAllocLayerInd ());
+          if (m_uePhy->IsReceptionEnabled () == false)
+            {
+              NS_LOG_INFO ("This UE does not receive data currently.");
+              isAllocated = false;
+            }
+          if (m_uePhy->GetAllocLayerInd () != layerInd)
+            {
+              NS_LOG_INFO ("This data is not for this UE");
+              isMyLayer = false;
+            }
         }
 
-
       if (isAllocated)
-      {
-    	  // This "BF gain calculation" must be used
-    	  Ptr<MobilityModel> txMobility = mmwaveDataRxParams->txPhy->GetMobility ();
-    	  Ptr<ThreeGppSpectrumPropagationLossModel> pathlossmodel = DynamicCast<ThreeGppSpectrumPropagationLossModel>(m_channel->GetSpectrumPropagationLossModel());
-    	  if (enbRx !=0)
-    	  {//in the BS Rx case, beamforming is evaluated using the layer of this mmwave-spectrum-phy, not the transmission layer index
-    		  mmwaveDataRxParams->psd = pathlossmodel->CalcRxPowerSpectralDensityMultiLayers(mmwaveDataRxParams->psd,txMobility,this->GetMobility (),0,m_layerInd);//tx layer ind is UE which is always 0, I am a BS receiving in layer m_layerInd which is not necessarily the layerInd of the TXparam
-    		  NS_LOG_INFO("Computed the BF gain at BS receiving in layer " << (int ) m_layerInd << " SpectrumPhy::StartRx for signal of layer " << (int) layerInd);
-    	  }
-    	  else
-    	  {
-    		  mmwaveDataRxParams->psd = pathlossmodel->CalcRxPowerSpectralDensityMultiLayers(mmwaveDataRxParams->psd,txMobility,this->GetMobility (),layerInd,m_layerInd);//tx layer ind is one from BS indicated in TXparam (not necessarily my GetAllocLayerInd()), I am a receiving UE and rx layer is always 0
-    		  NS_LOG_INFO("Computed the BF gain at UE allocated layer " << (int ) ueRx->GetPhy (m_componentCarrierId)->GetAllocLayerInd() << " SpectrumPhy::StartRx for signal of layer " << (int) layerInd << " the UE m_layerInd is "<<(int)  m_layerInd);
-    	  }
-    	  NS_LOG_DEBUG("Node "<<  GetDevice()->GetAddress() <<" detected in layer " << (int) m_layerInd << " a signal with power "<<Sum (*(mmwaveDataRxParams->psd)));
-          m_interferenceData->AddSignal (mmwaveDataRxParams->psd, mmwaveDataRxParams->duration);
-    	  if (mmwaveDataRxParams->cellId == m_cellId && isMyLayer)
-    	  {
-    		  NS_LOG_INFO ("Data is for this UE/Layer, StartRxData");
-    		  //m_interferenceData->AddSignal (mmwaveDataRxParams->psd, mmwaveDataRxParams->duration);
-    		  StartRxData (mmwaveDataRxParams);
-    	  }
-    	  /*
+        {
+          // This "BF gain calculation" must be used
+          Ptr<MobilityModel> txMobility = mmwaveDataRxParams->txPhy->GetMobility ();
+          if (m_3gppSplm == 0)
+            {
+              m_3gppSplm = DynamicCast<ThreeGppSpectrumPropagationLossModel> (m_channel->GetSpectrumPropagationLossModel ());
+            }
+          if (m_isEnb)
+            {
+              // in the BS Rx case, beamforming is evaluated using the layer of this mmwave-spectrum-phy, not the transmission layer index
+              // tx layer ind is UE which is always 0, I am a BS receiving in layer m_layerInd which is not necessarily the layerInd of the TXparam
+              mmwaveDataRxParams->psd = m_3gppSplm->CalcRxPowerSpectralDensityMultiLayers (mmwaveDataRxParams->psd, txMobility, m_mobility, 0, m_layerInd, mmwaveDataRxParams->bfGainJob);
+              NS_LOG_INFO ("Computed the BF gain at BS receiving in layer " << (int ) m_layerInd << " SpectrumPhy::StartRx for signal of layer " << (int) layerInd);
+            }
           else
-          {
-                  if (ueRx != 0)
-                  {
-                          m_interferenceData->AddSignal (mmwaveDataRxParams->psd, mmwaveDataRxParams->duration);
-                  }
-          }
-    	   */
-      }
+            {
+              // tx layer ind is one from BS indicated in TXparam (not necessarily my GetAllocLayerInd()), I am a receiving UE and rx layer is always 0
+              mmwaveDataRxParams->psd = m_3gppSplm->CalcRxPowerSpectralDensityMultiLayers (mmwaveDataRxParams->psd, txMobility, m_mobility, layerInd, m_layerInd, mmwaveDataRxParams->bfGainJob);
+              NS_LOG_INFO ("Computed the BF gain at UE allocated layer " << (int ) m_uePhy->GetAllocLayerInd () << " SpectrumPhy::StartRx for signal of layer " << (int) layerInd << " the UE m_layerInd is " << (int)  m_layerInd);
+            }
+          NS_LOG_DEBUG ("Node " << GetDevice ()->GetAddress () << " detected in layer " << (int) m_layerInd << " a signal with power " << Sum (*(mmwaveDataRxParams->psd)));
+          m_interferenceData->AddSignal (mmwaveDataRxParams->psd, mmwaveDataRxParams->duration);
+          if (mmwaveDataRxParams->cellId == m_cellId && isMyLayer)
+            {
+              NS_LOG_INFO ("Data is for this UE/Layer, StartRxData");
+              StartRxData (mmwaveDataRxParams);
+            }
+        }
     }
-  else
+  else if (mmwaveRxParams->signalType == MMWAVE_DL_CTRL_FRAME)
     {
-      Ptr<MmWaveSpectrumSignalParametersDlCtrlFrame> DlCtrlRxParams =
-        DynamicCast<MmWaveSpectrumSignalParametersDlCtrlFrame> (params);
-      //if (DlCtrlRxParams != 0)
-      if (DlCtrlRxParams != 0 && m_layerInd==0) //receive control msg in only one RF (layer 0)
+      //receive control msg in only one RF (layer 0)
+      if (m_layerInd == 0)
         {
+          Ptr<MmWaveSpectrumSignalParametersDlCtrlFrame> DlCtrlRxParams =
+            StaticCast<MmWaveSpectrumSignalParametersDlCtrlFrame> (mmwaveRxParams);
           if (DlCtrlRxParams->cellId == m_cellId)
             {
               StartRxCtrl (DlCtrlRxParams);
@@ -504,6 +516,51 @@ MmWaveSpectrumPhy::StartRx (Ptr<SpectrumSignalParameters> params)
     }
 }
 
+Ptr<SpectrumRxJob>
+MmWaveSpectrumPhy::PrepareRx (Ptr<SpectrumSignalParameters> params, Time delay)
+{
+  NS_LOG_FUNCTION (this << delay);
+
+  // the same signals as in StartRx are considered, the job is discarded
+  // there if the state of the receiver changes in the meantime
+  static const TypeId mmwaveSpectrumPhyTid = MmWaveSpectrumPhy::GetTypeId ();
+  if (params->txPhy->GetInstanceTypeId () != mmwaveSpectrumPhyTid)
+    {
+      return 0;
+    }
+  Ptr<MmWaveSpectrumSignalParametersBase> mmwaveRxParams = StaticCast<MmWaveSpectrumSignalParametersBase> (params);
+  if (mmwaveRxParams->txIsEnb == m_isEnb || mmwaveRxParams->signalType != MMWAVE_DATA_FRAME)
+    {
+      return 0;
+    }
+  if (m_enbPhy == 0 && m_uePhy == 0)
+    {
+      ResolveDevicePhy ();
+    }
+  if ((m_isEnb && !m_enbPhy->IsReceptionEnabled ()) || (!m_isEnb && !m_uePhy->IsReceptionEnabled ()))
+    {
+      return 0;
+    }
+  if (m_3gppSplm == 0)
+    {
+      m_3gppSplm = DynamicCast<ThreeGppSpectrumPropagationLossModel> (m_channel->GetSpectrumPropagationLossModel ());
+    }
+  if (m_3gppSplm == 0)
+    {
+      return 0;
+    }
+
+  Ptr<MmwaveSpectrumSignalParametersDataFrame> mmwaveDataRxParams =
+    StaticCast<MmwaveSpectrumSignalParametersDataFrame> (mmwaveRxParams);
+  // same layers as in StartRx
+  uint8_t txLayerInd = m_isEnb ? 0 : mmwaveDataRxParams->layerInd;
+  mmwaveDataRxParams->bfGainJob = m_3gppSplm->PrepareBeamformingGainJob (mmwaveDataRxParams->psd->GetSpectrumModel (),
+                                                                          mmwaveDataRxParams->txPhy->GetMobility (),
+                                                                          m_mobility, txLayerInd, m_layerInd,
+                                                                          Simulator::Now () + delay);
+  return mmwaveDataRxParams->bfGainJob;
+}
+
 void
 MmWaveSpectrumPhy::StartRxData (Ptr<MmwaveSpectrumSignalParametersDataFrame> params)
 {
@@ -511,13 +568,6 @@ MmWaveSpectrumPhy::StartRxData (Ptr<MmwaveSpectrumSignalParametersDataFrame> par
 
   NS_LOG_FUNCTION (this);
 
-  Ptr<MmWaveEnbNetDevice> enbRx =
-    DynamicCast<MmWaveEnbNetDevice> (GetDevice ());
-  Ptr<mmwave::MmWaveUeNetDevice> ueRx =
-    DynamicCast<mmwave::MmWaveUeNetDevice> (GetDevice ());
-  Ptr<McUeNetDevice> rxMcUe =
-    DynamicCast<McUeNetDevice> (GetDevice ());
-
   switch (m_state)
     {
     case TX:
@@ -616,11 +666,7 @@ MmWaveSpectrumPhy::StartRxCtrl (Ptr<MmWaveSpectrumSignalParametersDlCtrlFrame> d
           {
             if (m_state == RX_CTRL)
               {
-                Ptr<mmwave::MmWaveUeNetDevice> ueRx =
-                  DynamicCast<mmwave::MmWaveUeNetDevice> (GetDevice ());
-                Ptr<McUeNetDevice> rxMcUe =
-                  DynamicCast<McUeNetDevice> (GetDevice ());
-                if (ueRx || rxMcUe)
+                if (!m_isEnb)
                   {
                     NS_FATAL_ERROR ("UE already receiving control data from serving cell");
                   }
@@ -981,6 +1027,7 @@ MmWaveSpectrumPhy::StartTxDataFrames (Ptr<PacketBurst> pb, std::list<Ptr<MmWaveC
         txParams->slotInd = slotInd;
         txParams->txAntenna = GetRxAntenna ();
         txParams->layerInd = layerInd;
+        txParams->txIsEnb = m_isEnb;
 
         //NS_LOG_DEBUG ("ctrlMsgList.size () == " << txParams->ctrlMsgList.size ());
         /* This section is used for trace */
@@ -1050,7 +1097,8 @@ MmWaveSpectrumPhy::StartTxDlControlFrames (std::list<Ptr<MmWaveControlMessage> >
         txParams->pss = true;
         txParams->ctrlMsgList = ctrlMsgList;
         txParams->txAntenna = GetRxAntenna ();
-        
+        txParams->txIsEnb = m_isEnb;
+
         m_channel->StartTx (txParams);
         
         m_endTxEvent = Simulator::Schedule (duration, &MmWaveSpectrumPhy::EndTx, this);
@@ -1096,6 +1144,8 @@ void
 MmWaveSpectrumPhy::SetComponentCarrierId (uint8_t componentCarrierId)
 {
   m_componentCarrierId = componentCarrierId;
+  m_enbPhy = 0;
+  m_uePhy = 0;
 }
 
 
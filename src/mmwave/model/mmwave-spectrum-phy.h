@@ -60,8 +60,13 @@
 
 namespace ns3 {
 
+class ThreeGppSpectrumPropagationLossModel;
+
 namespace mmwave {
 
+class MmWaveEnbPhy;
+class MmWaveUePhy;
+
 struct ExpectedTbInfo_t
 {
   uint8_t ndi;
@@ -152,6 +157,15 @@ public:
   void SetTxPowerSpectralDensity (Ptr<SpectrumValue> TxPsd);
   Ptr<SpectrumValue> GetTxPowerSpectralDensity ();
   void StartRx (Ptr<SpectrumSignalParameters> params);
+  /**
+   * Prepare the computation of the beamforming gain of a data signal, which
+   * is then used by StartRx
+   *
+   * \param params the parameters of the signal
+   * \param delay the time after which StartRx will be called
+   * \return the job computing the gain, or 0
+   */
+  virtual Ptr<SpectrumRxJob> PrepareRx (Ptr<SpectrumSignalParameters> params, Time delay);
   void StartRxData (Ptr<MmwaveSpectrumSignalParametersDataFrame> params);
   void StartRxCtrl (Ptr<MmWaveSpectrumSignalParametersDlCtrlFrame> params);
   Ptr<SpectrumChannel> GetSpectrumChannel ();
@@ -209,6 +223,11 @@ private:
    * \param the new state
    */
   void ChangeState (State newState);
+  /**
+   * \brief resolve the eNB or UE phy of the device of this spectrum phy for
+   * the component carrier of this instance, and cache it
+   */
+  void ResolveDevicePhy ();
   void EndTx ();
   void EndRxData ();
   void EndRxCtrl ();
@@ -259,6 +278,15 @@ private:
 
   bool m_isEnb;
 
+  /**
+   * The role of the device of this spectrum phy and its phy, resolved once so
+   * that StartRx does not need to cast the device of each received signal
+   */
+  Ptr<MmWaveEnbPhy> m_enbPhy;
+  Ptr<MmWaveUePhy> m_uePhy;
+  bool m_isMcUe;
+  Ptr<ThreeGppSpectrumPropagationLossModel> m_3gppSplm; //!< the spectrum propagation loss model of m_channel
+
   EventId m_endTxEvent;
   EventId m_endRxDataEvent;
   EventId m_endRxDlCtrlEvent;
@@ -68,13 +68,31 @@ mmwaveSpectrumSignalParameters::Copy ()
 
 
 
+MmWaveSpectrumSignalParametersBase::MmWaveSpectrumSignalParametersBase (MmWaveSignalType type)
+  : signalType (type),
+    txIsEnb (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+MmWaveSpectrumSignalParametersBase::MmWaveSpectrumSignalParametersBase (const MmWaveSpectrumSignalParametersBase& p)
+  : SpectrumSignalParameters (p),
+    signalType (p.signalType),
+    txIsEnb (p.txIsEnb)
+{
+  NS_LOG_FUNCTION (this << &p);
+}
+
+
+
 MmwaveSpectrumSignalParametersDataFrame::MmwaveSpectrumSignalParametersDataFrame ()
+  : MmWaveSpectrumSignalParametersBase (MMWAVE_DATA_FRAME)
 {
   NS_LOG_FUNCTION (this);
 }
 
 MmwaveSpectrumSignalParametersDataFrame::MmwaveSpectrumSignalParametersDataFrame (const MmwaveSpectrumSignalParametersDataFrame& p)
-  : SpectrumSignalParameters (p)
+  : MmWaveSpectrumSignalParametersBase (p)
 {
   NS_LOG_FUNCTION (this << &p);
   cellId = p.cellId;
@@ -104,12 +122,13 @@ MmwaveSpectrumSignalParametersDataFrame::Copy ()
 
 
 MmWaveSpectrumSignalParametersDlCtrlFrame::MmWaveSpectrumSignalParametersDlCtrlFrame ()
+  : MmWaveSpectrumSignalParametersBase (MMWAVE_DL_CTRL_FRAME)
 {
   NS_LOG_FUNCTION (this);
 }
 
 MmWaveSpectrumSignalParametersDlCtrlFrame::MmWaveSpectrumSignalParametersDlCtrlFrame (const MmWaveSpectrumSignalParametersDlCtrlFrame& p)
-  : SpectrumSignalParameters (p)
+  : MmWaveSpectrumSignalParametersBase (p)
 {
   NS_LOG_FUNCTION (this << &p);
   cellId = p.cellId;
@@ -31,6 +31,7 @@
 
 
 #include <ns3/spectrum-signal-parameters.h>
+#include <ns3/three-gpp-spectrum-propagation-loss-model.h>
 
 namespace ns3 {
 
@@ -67,7 +68,44 @@ struct mmwaveSpectrumSignalParameters : public SpectrumSignalParameters
 
 
 
-struct MmwaveSpectrumSignalParametersDataFrame : public SpectrumSignalParameters
+/**
+ * \ingroup mmwave
+ *
+ * Type of the signals exchanged by the mmwave spectrum phys
+ */
+enum MmWaveSignalType
+{
+  MMWAVE_DATA_FRAME,
+  MMWAVE_DL_CTRL_FRAME
+};
+
+/**
+ * \ingroup mmwave
+ *
+ * Common base of the signal parameters sent by MmWaveSpectrumPhy. It tags
+ * the parameters with their type and the role of the transmitter, so that
+ * the receivers can dispatch them with a static cast.
+ */
+struct MmWaveSpectrumSignalParametersBase : public SpectrumSignalParameters
+{
+  /**
+   * constructor
+   * \param type the type of the derived parameters
+   */
+  MmWaveSpectrumSignalParametersBase (MmWaveSignalType type);
+
+  /**
+   * copy constructor
+   */
+  MmWaveSpectrumSignalParametersBase (const MmWaveSpectrumSignalParametersBase& p);
+
+  MmWaveSignalType signalType; ///< the type of the derived parameters
+
+  bool txIsEnb; ///< whether the transmitter is an eNB
+};
+
+
+struct MmwaveSpectrumSignalParametersDataFrame : public MmWaveSpectrumSignalParametersBase
 {
 
   // inherited from SpectrumSignalParameters
@@ -92,10 +130,16 @@ struct MmwaveSpectrumSignalParametersDataFrame : public SpectrumSignalParameters
   uint8_t slotInd;
 
   uint8_t layerInd;
+
+  /**
+   * the beamforming gain prepared by the receiver with
+   * MmWaveSpectrumPhy::PrepareRx, it is not copied
+   */
+  Ptr<ThreeGppBeamformingGainJob> bfGainJob;
 };
 
 
-struct MmWaveSpectrumSignalParametersDlCtrlFrame : public SpectrumSignalParameters
+struct MmWaveSpectrumSignalParametersDlCtrlFrame : public MmWaveSpectrumSignalParametersBase
 {
 
   // inherited from SpectrumSignalParameters
@@ -0,0 +1,204 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "ns3/mmwave-distributed-spectrum-channel.h"
+#include "ns3/antenna-array-model.h"
+#include "ns3/packet.h"
+#include "ns3/test.h"
+#include "ns3/log.h"
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveDistributedSpectrumChannelTest");
+
+using namespace ns3;
+using namespace mmwave;
+
+/**
+* This test case checks that a signal forwarded by the
+* MmWaveDistributedSpectrumChannel is rebuilt by the receiving rank, i.e.,
+* that the MmWaveRemoteSignalHeader survives the fragmentation and that the
+* snapshot of the array configures the replica as the original array
+*/
+class MmWaveRemoteSignalTestCase : public TestCase
+{
+public:
+  /**
+  * Constructor
+  */
+  MmWaveRemoteSignalTestCase ();
+
+  /**
+  * Destructor
+  */
+  virtual ~MmWaveRemoteSignalTestCase ();
+
+private:
+  /**
+  * Run the test
+  */
+  virtual void DoRun (void);
+
+  /**
+  * Serialize a header, split it in fragments of the given size, reassemble
+  * them and deserialize the result
+  * \param header the header
+  * \param fragmentSize the size of the fragments
+  * \return the deserialized header
+  */
+  MmWaveRemoteSignalHeader Forward (const MmWaveRemoteSignalHeader &header, uint32_t fragmentSize);
+};
+
+MmWaveRemoteSignalTestCase::MmWaveRemoteSignalTestCase ()
+  : TestCase ("Checks the signals forwarded by the MmWaveDistributedSpectrumChannel")
+{
+}
+
+MmWaveRemoteSignalTestCase::~MmWaveRemoteSignalTestCase ()
+{
+}
+
+MmWaveRemoteSignalHeader
+MmWaveRemoteSignalTestCase::Forward (const MmWaveRemoteSignalHeader &header, uint32_t fragmentSize)
+{
+  Ptr<Packet> message = Create<Packet> ();
+  message->AddHeader (header);
+  NS_TEST_EXPECT_MSG_EQ (message->GetSize (), header.GetSerializedSize (), "Wrong serialized size");
+
+  Ptr<Packet> reassembled = Create<Packet> ();
+  for (uint32_t offset = 0; offset < message->GetSize (); offset += fragmentSize)
+    {
+      MmWaveRemoteFragmentHeader fragmentHeader;
+      fragmentHeader.m_index = offset / fragmentSize;
+      Ptr<Packet> fragment = message->CreateFragment (offset, std::min (fragmentSize, message->GetSize () - offset));
+      fragment->AddHeader (fragmentHeader);
+      fragment->RemoveHeader (fragmentHeader);
+      NS_TEST_EXPECT_MSG_EQ (fragmentHeader.m_index, offset / fragmentSize, "Wrong fragment index");
+      reassembled->AddAtEnd (fragment);
+    }
+
+  MmWaveRemoteSignalHeader received;
+  reassembled->RemoveHeader (received);
+  NS_TEST_EXPECT_MSG_EQ (reassembled->GetSize (), 0, "Bytes left after the header");
+  return received;
+}
+
+void
+MmWaveRemoteSignalTestCase::DoRun (void)
+{
+  // an array with two layers and a digital combining matrix
+  Ptr<AntennaArrayModel> antenna = CreateObject<AntennaArrayModel> ();
+  antenna->SetCurrNumLayers (2);
+  AntennaArrayBasicModel::complexVector_t weights0 (16), weights1 (16);
+  for (uint32_t k = 0; k < 16; k++)
+    {
+      weights0[k] = std::polar (0.25, 0.1 * k);
+      weights1[k] = std::polar (0.25, -0.3 * k);
+    }
+  antenna->SetBeamformingVectorMultilayers (weights0, 7, 0, 0);
+  antenna->SetBeamformingVectorMultilayers (weights1, 42, 0, 1);
+  AntennaArrayModel::complex3DVector_t combining (5, AntennaArrayModel::complex2DVector_t (2, AntennaArrayBasicModel::complexVector_t (2)));
+  for (uint32_t b = 0; b < combining.size (); b++)
+    {
+      combining[b][0][0] = std::complex<double> (1.0, 0.1 * b);
+      combining[b][0][1] = std::complex<double> (-0.2, 0.3);
+      combining[b][1][0] = std::complex<double> (0.4, -0.5 * b);
+      combining[b][1][1] = std::complex<double> (0.9, 0.0);
+    }
+  antenna->ToggleDigitalCombining (true);
+  antenna->SetDigitalCombining (combining);
+
+  MmWaveRemoteSignalHeader header;
+  header.m_channelId = 3;
+  header.m_txPhyId = 12345;
+  header.m_duration = NanoSeconds (249998);
+  header.m_cellId = 17;
+  header.m_slotInd = 5;
+  header.m_layerInd = 1;
+  header.m_txIsEnb = true;
+  header.m_position = Vector (100.5, -20.25, 25.0);
+  header.m_velocity = Vector (0.0, 1.5, 0.0);
+  for (uint32_t k = 0; k < 275; k++)
+    {
+      header.m_psd.push_back (1e-12 * (k + 1));
+    }
+  header.m_hasAntenna = true;
+  header.m_antenna.Take (antenna);
+
+  // fragments smaller than the header, and a single fragment
+  for (uint32_t fragmentSize : {100u, 1400u, 100000u})
+    {
+      MmWaveRemoteSignalHeader received = Forward (header, fragmentSize);
+      NS_TEST_ASSERT_MSG_EQ (received.m_channelId, header.m_channelId, "Wrong channel");
+      NS_TEST_ASSERT_MSG_EQ (received.m_txPhyId, header.m_txPhyId, "Wrong transmitter");
+      NS_TEST_ASSERT_MSG_EQ (received.m_duration, header.m_duration, "Wrong duration");
+      NS_TEST_ASSERT_MSG_EQ (received.m_cellId, header.m_cellId, "Wrong cell");
+      NS_TEST_ASSERT_MSG_EQ (received.m_slotInd, header.m_slotInd, "Wrong slot");
+      NS_TEST_ASSERT_MSG_EQ (received.m_layerInd, header.m_layerInd, "Wrong layer");
+      NS_TEST_ASSERT_MSG_EQ (received.m_txIsEnb, header.m_txIsEnb, "Wrong transmitter type");
+      NS_TEST_ASSERT_MSG_EQ (received.m_position.x, header.m_position.x, "Wrong position");
+      NS_TEST_ASSERT_MSG_EQ (received.m_position.y, header.m_position.y, "Wrong position");
+      NS_TEST_ASSERT_MSG_EQ (received.m_velocity.y, header.m_velocity.y, "Wrong velocity");
+      NS_TEST_ASSERT_MSG_EQ ((received.m_psd == header.m_psd), true, "Wrong PSD");
+      NS_TEST_ASSERT_MSG_EQ (received.m_hasAntenna, true, "Missing array configuration");
+
+      // the replica is configured as the original array
+      Ptr<AntennaArrayModel> replica = CreateObject<AntennaArrayModel> ();
+      replica->ChangeToOmniTx ();
+      uint64_t configurationId = replica->GetConfigurationId ();
+      received.m_antenna.Apply (replica);
+      NS_TEST_ASSERT_MSG_NE (replica->GetConfigurationId (), configurationId, "The configuration id must change");
+      NS_TEST_ASSERT_MSG_EQ (replica->IsOmniTx (), false, "Wrong omni mode");
+      NS_TEST_ASSERT_MSG_EQ ((uint32_t) replica->GetCurrNumLayers (), 2, "Wrong number of layers");
+      NS_TEST_ASSERT_MSG_EQ (replica->GetBeamformingLayers ().size (), 2, "Wrong number of beamforming vectors");
+      NS_TEST_ASSERT_MSG_EQ (replica->GetCurrentBeamformingVectorMultilayers (0).second, 7, "Wrong beam id");
+      NS_TEST_ASSERT_MSG_EQ (replica->GetCurrentBeamformingVectorMultilayers (1).second, 42, "Wrong beam id");
+      NS_TEST_ASSERT_MSG_EQ ((replica->GetCurrentBeamformingVectorMultilayers (0).first == weights0), true, "Wrong weights");
+      NS_TEST_ASSERT_MSG_EQ ((replica->GetCurrentBeamformingVectorMultilayers (1).first == weights1), true, "Wrong weights");
+      NS_TEST_ASSERT_MSG_EQ (replica->isDigitalCombiningOn (), true, "Wrong digital combining");
+      NS_TEST_ASSERT_MSG_EQ ((replica->GetDigitalCombining () == combining), true, "Wrong digital combining matrix");
+    }
+
+  // an omni array, and a header without the array configuration
+  antenna->ChangeToOmniTx ();
+  header.m_antenna.Take (antenna);
+  MmWaveRemoteSignalHeader received = Forward (header, 1400);
+  Ptr<AntennaArrayModel> replica = CreateObject<AntennaArrayModel> ();
+  received.m_antenna.Apply (replica);
+  NS_TEST_ASSERT_MSG_EQ (replica->IsOmniTx (), true, "Wrong omni mode");
+
+  header.m_hasAntenna = false;
+  received = Forward (header, 1400);
+  NS_TEST_ASSERT_MSG_EQ (received.m_hasAntenna, false, "Unexpected array configuration");
+  NS_TEST_ASSERT_MSG_EQ ((received.m_psd == header.m_psd), true, "Wrong PSD");
+}
+
+/**
+* This suite tests the forwarding of the signals across the MPI ranks
+*/
+class MmWaveDistributedSpectrumChannelTest : public TestSuite
+{
+public:
+  MmWaveDistributedSpectrumChannelTest ();
+};
+
+MmWaveDistributedSpectrumChannelTest::MmWaveDistributedSpectrumChannelTest ()
+  : TestSuite ("mmwave-distributed-spectrum-channel", UNIT)
+{
+  AddTestCase (new MmWaveRemoteSignalTestCase, TestCase::QUICK);
+}
+
+// Do not forget to allocate an instance of this TestSuite
+static MmWaveDistributedSpectrumChannelTest mmwaveDistributedSpectrumChannelTestSuite;
@@ -0,0 +1,147 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "ns3/mmwave-mmse-batch-solver.h"
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include <cmath>
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveMmseBatchSolverTest");
+
+using namespace ns3;
+using namespace mmwave;
+
+/**
+* This test case checks that the MmWaveMmseBatchSolver computes the MMSE
+* combiner X = (H^H H + No I)^-1 H^H of each batch
+*/
+class MmWaveMmseBatchSolverTestCase : public TestCase
+{
+public:
+  /**
+  * Constructor
+  */
+  MmWaveMmseBatchSolverTestCase ();
+
+  /**
+  * Destructor
+  */
+  virtual ~MmWaveMmseBatchSolverTestCase ();
+
+private:
+  /**
+  * Run the test
+  */
+  virtual void DoRun (void);
+
+  /**
+  * Fill the channels of the solver and check the computed combiners
+  * \param solver the solver
+  * \param numBatches the number of batches
+  * \param numLayers the number of layers
+  * \param noise the noise power spectral density
+  */
+  void CheckSolver (MmWaveMmseBatchSolver &solver, uint32_t numBatches, uint16_t numLayers, double noise);
+};
+
+MmWaveMmseBatchSolverTestCase::MmWaveMmseBatchSolverTestCase ()
+  : TestCase ("Checks the combiners computed by the MmWaveMmseBatchSolver")
+{
+}
+
+MmWaveMmseBatchSolverTestCase::~MmWaveMmseBatchSolverTestCase ()
+{
+}
+
+void
+MmWaveMmseBatchSolverTestCase::CheckSolver (MmWaveMmseBatchSolver &solver, uint32_t numBatches, uint16_t numLayers, double noise)
+{
+  solver.Resize (numBatches, numLayers);
+  NS_TEST_ASSERT_MSG_EQ (solver.GetNumBatches (), numBatches, "Wrong number of batches");
+  NS_TEST_ASSERT_MSG_EQ (solver.GetNumLayers (), numLayers, "Wrong number of layers");
+
+  // strong diagonal and weaker cross-interference terms, changing with the batch
+  for (uint32_t batch = 0; batch < numBatches; batch++)
+    {
+      std::complex<double> *h = solver.GetChannel (batch);
+      for (uint16_t row = 0; row < numLayers; row++)
+        {
+          for (uint16_t col = 0; col < numLayers; col++)
+            {
+              double phase = 0.7 * row + 1.3 * col + 0.1 * batch;
+              double amplitude = (row == col) ? 1.0 : 0.2 / (1 + row + col);
+              h[row * numLayers + col] = std::polar (amplitude, phase);
+            }
+        }
+    }
+  solver.SolveAll (noise);
+
+  // (H^H H + No I) X must be equal to H^H
+  for (uint32_t batch = 0; batch < numBatches; batch++)
+    {
+      const std::complex<double> *h = solver.GetChannel (batch);
+      const std::complex<double> *x = solver.GetCombiner (batch);
+      for (uint16_t row = 0; row < numLayers; row++)
+        {
+          for (uint16_t col = 0; col < numLayers; col++)
+            {
+              std::complex<double> lhs = noise * x[row * numLayers + col];
+              for (uint16_t k = 0; k < numLayers; k++)
+                {
+                  std::complex<double> m = 0;
+                  for (uint16_t i = 0; i < numLayers; i++)
+                    {
+                      m += std::conj (h[i * numLayers + row]) * h[i * numLayers + k];
+                    }
+                  lhs += m * x[k * numLayers + col];
+                }
+              std::complex<double> rhs = std::conj (h[col * numLayers + row]);
+              NS_TEST_ASSERT_MSG_EQ_TOL (lhs.real (), rhs.real (), 1e-9, "Wrong combiner in batch " << batch);
+              NS_TEST_ASSERT_MSG_EQ_TOL (lhs.imag (), rhs.imag (), 1e-9, "Wrong combiner in batch " << batch);
+            }
+        }
+    }
+}
+
+void
+MmWaveMmseBatchSolverTestCase::DoRun (void)
+{
+  MmWaveMmseBatchSolver solver;
+  CheckSolver (solver, 275, 4, 0.1);
+  // the storage is reused with fewer batches and a different number of layers
+  CheckSolver (solver, 10, 2, 0.01);
+  CheckSolver (solver, 1, 1, 0.5);
+  CheckSolver (solver, 3, MmWaveMmseBatchSolver::MAX_LAYERS, 1e-3);
+}
+
+/**
+* This suite tests the MMSE solver of the hybrid beamforming
+*/
+class MmWaveMmseBatchSolverTest : public TestSuite
+{
+public:
+  MmWaveMmseBatchSolverTest ();
+};
+
+MmWaveMmseBatchSolverTest::MmWaveMmseBatchSolverTest ()
+  : TestSuite ("mmwave-mmse-batch-solver", UNIT)
+{
+  AddTestCase (new MmWaveMmseBatchSolverTestCase, TestCase::QUICK);
+}
+
+// Do not forget to allocate an instance of this TestSuite
+static MmWaveMmseBatchSolverTest mmwaveMmseBatchSolverTestSuite;
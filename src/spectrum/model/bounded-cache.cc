@@ -0,0 +1,181 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 SIGNET Lab, Department of Information Engineering,
+ * University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "bounded-cache.h"
+#include <ns3/uinteger.h>
+#include <ns3/simulator.h>
+#include <ns3/trace-source-accessor.h>
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (BoundedCacheStatistics);
+
+BoundedCacheStatistics::BoundedCacheStatistics ()
+  : m_hits (0),
+    m_misses (0),
+    m_evictions (0),
+    m_bytes (0),
+    m_entries (0)
+{
+}
+
+BoundedCacheStatistics::~BoundedCacheStatistics ()
+{
+}
+
+TypeId
+BoundedCacheStatistics::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::BoundedCacheStatistics")
+    .SetParent<Object> ()
+    .SetGroupName ("Spectrum")
+    .AddConstructor<BoundedCacheStatistics> ()
+    .AddAttribute ("Hits",
+                   "The number of lookups that found an entry",
+                   TypeId::ATTR_GET,
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&BoundedCacheStatistics::GetHits),
+                   MakeUintegerChecker<uint64_t> ())
+    .AddAttribute ("Misses",
+                   "The number of lookups that did not find an entry",
+                   TypeId::ATTR_GET,
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&BoundedCacheStatistics::GetMisses),
+                   MakeUintegerChecker<uint64_t> ())
+    .AddAttribute ("Evictions",
+                   "The number of entries removed to enforce the capacity or the generation limit",
+                   TypeId::ATTR_GET,
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&BoundedCacheStatistics::GetEvictions),
+                   MakeUintegerChecker<uint64_t> ())
+    .AddAttribute ("Bytes",
+                   "The estimated memory occupied by the entries, in bytes",
+                   TypeId::ATTR_GET,
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&BoundedCacheStatistics::GetBytes),
+                   MakeUintegerChecker<uint64_t> ())
+    .AddAttribute ("Entries",
+                   "The number of entries currently stored",
+                   TypeId::ATTR_GET,
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&BoundedCacheStatistics::GetEntries),
+                   MakeUintegerChecker<uint64_t> ())
+    .AddTraceSource ("Hits",
+                     "The number of lookups that found an entry",
+                     MakeTraceSourceAccessor (&BoundedCacheStatistics::m_hits),
+                     "ns3::BoundedCacheStatistics::CounterTracedCallback")
+    .AddTraceSource ("Misses",
+                     "The number of lookups that did not find an entry",
+                     MakeTraceSourceAccessor (&BoundedCacheStatistics::m_misses),
+                     "ns3::BoundedCacheStatistics::CounterTracedCallback")
+    .AddTraceSource ("Evictions",
+                     "The number of entries removed to enforce the capacity or the generation limit",
+                     MakeTraceSourceAccessor (&BoundedCacheStatistics::m_evictions),
+                     "ns3::BoundedCacheStatistics::CounterTracedCallback")
+    .AddTraceSource ("Bytes",
+                     "The estimated memory occupied by the entries, in bytes",
+                     MakeTraceSourceAccessor (&BoundedCacheStatistics::m_bytes),
+                     "ns3::BoundedCacheStatistics::CounterTracedCallback")
+    .AddTraceSource ("Entries",
+                     "The number of entries currently stored",
+                     MakeTraceSourceAccessor (&BoundedCacheStatistics::m_entries),
+                     "ns3::BoundedCacheStatistics::CounterTracedCallback")
+    ;
+  return tid;
+}
+
+uint64_t
+BoundedCacheStatistics::GetHits () const
+{
+  return m_hits;
+}
+
+uint64_t
+BoundedCacheStatistics::GetMisses () const
+{
+  return m_misses;
+}
+
+uint64_t
+BoundedCacheStatistics::GetEvictions () const
+{
+  return m_evictions;
+}
+
+uint64_t
+BoundedCacheStatistics::GetBytes () const
+{
+  return m_bytes;
+}
+
+uint64_t
+BoundedCacheStatistics::GetEntries () const
+{
+  return m_entries;
+}
+
+BoundedCacheBase::BoundedCacheBase ()
+  : m_capacity (0),
+    m_policy (LRU),
+    m_generation (0),
+    m_stats (CreateObject<BoundedCacheStatistics> ())
+{
+}
+
+void
+BoundedCacheBase::SetCapacity (uint32_t capacity)
+{
+  m_capacity = capacity;
+}
+
+uint32_t
+BoundedCacheBase::GetCapacity () const
+{
+  return m_capacity;
+}
+
+void
+BoundedCacheBase::SetEvictionPolicy (EvictionPolicy policy)
+{
+  m_policy = policy;
+}
+
+BoundedCacheBase::EvictionPolicy
+BoundedCacheBase::GetEvictionPolicy () const
+{
+  return m_policy;
+}
+
+Ptr<BoundedCacheStatistics>
+BoundedCacheBase::GetStatistics () const
+{
+  return m_stats;
+}
+
+uint64_t
+BoundedCacheBase::GetGenerationAt (Time period)
+{
+  if (period.IsZero ())
+    {
+      return 0;
+    }
+  return Simulator::Now ().GetTimeStep () / period.GetTimeStep ();
+}
+
+} // namespace ns3
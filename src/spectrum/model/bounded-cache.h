@@ -0,0 +1,492 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 SIGNET Lab, Department of Information Engineering,
+ * University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BOUNDED_CACHE_H
+#define BOUNDED_CACHE_H
+
+#include <ns3/object.h>
+#include <ns3/traced-value.h>
+#include <ns3/nstime.h>
+#include <ns3/open-addressing-hash-table.h>
+#include <functional>
+#include <list>
+
+namespace ns3 {
+
+/**
+ * \ingroup spectrum
+ *
+ * Counters of a BoundedCache. They can be read through the attributes of
+ * this object, or monitored by connecting to its trace sources.
+ * The owner of a cache usually exposes this object through a read-only
+ * PointerValue attribute, so that the counters are reachable from the
+ * configuration namespace.
+ */
+class BoundedCacheStatistics : public Object
+{
+public:
+  /**
+   * Constructor
+   */
+  BoundedCacheStatistics ();
+
+  /**
+   * Destructor
+   */
+  virtual ~BoundedCacheStatistics ();
+
+  /**
+   * Get the type ID
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId ();
+
+  /**
+   * \return the number of lookups that found a valid entry
+   */
+  uint64_t GetHits () const;
+
+  /**
+   * \return the number of lookups that did not find an entry
+   */
+  uint64_t GetMisses () const;
+
+  /**
+   * \return the number of entries removed to enforce the capacity or the
+   *         generation limit
+   */
+  uint64_t GetEvictions () const;
+
+  /**
+   * \return the estimated memory occupied by the entries, in bytes
+   */
+  uint64_t GetBytes () const;
+
+  /**
+   * \return the number of entries currently stored
+   */
+  uint64_t GetEntries () const;
+
+  /**
+   * TracedValue signature for the counters.
+   *
+   * \param [in] oldValue the previous value of the counter
+   * \param [in] newValue the current value of the counter
+   */
+  typedef void (* CounterTracedCallback)(uint64_t oldValue, uint64_t newValue);
+
+  TracedValue<uint64_t> m_hits; //!< number of hits
+  TracedValue<uint64_t> m_misses; //!< number of misses
+  TracedValue<uint64_t> m_evictions; //!< number of evictions
+  TracedValue<uint64_t> m_bytes; //!< estimated size of the stored entries
+  TracedValue<uint64_t> m_entries; //!< number of stored entries
+};
+
+/**
+ * \ingroup spectrum
+ *
+ * Configuration shared by all the BoundedCache instances, independent of
+ * the key and value types.
+ */
+class BoundedCacheBase
+{
+public:
+  /**
+   * The eviction policies
+   */
+  enum EvictionPolicy
+  {
+    LRU, //!< only evict the least recently used entry when the cache is full
+    GENERATION //!< also evict the entries not used in the current or previous generation
+  };
+
+  /**
+   * Constructor
+   */
+  BoundedCacheBase ();
+
+  /**
+   * Set the maximum number of entries. A reduced capacity is enforced at the
+   * next insertion.
+   * \param capacity the maximum number of entries, 0 means unbounded
+   */
+  void SetCapacity (uint32_t capacity);
+
+  /**
+   * \return the maximum number of entries, 0 means unbounded
+   */
+  uint32_t GetCapacity () const;
+
+  /**
+   * Set the eviction policy
+   * \param policy the eviction policy
+   */
+  void SetEvictionPolicy (EvictionPolicy policy);
+
+  /**
+   * \return the eviction policy
+   */
+  EvictionPolicy GetEvictionPolicy () const;
+
+  /**
+   * \return the object holding the counters of this cache
+   */
+  Ptr<BoundedCacheStatistics> GetStatistics () const;
+
+  /**
+   * Compute the generation of the current simulation time, i.e., the number
+   * of periods elapsed since the beginning of the simulation
+   * \param period the duration of a generation, if zero the generation is
+   *        always 0
+   * \return the current generation
+   */
+  static uint64_t GetGenerationAt (Time period);
+
+protected:
+  uint32_t m_capacity; //!< maximum number of entries, 0 means unbounded
+  EvictionPolicy m_policy; //!< the eviction policy
+  uint64_t m_generation; //!< the current generation
+  Ptr<BoundedCacheStatistics> m_stats; //!< the counters
+};
+
+/**
+ * \ingroup spectrum
+ *
+ * Key-value store with a bounded number of entries.
+ *
+ * The entries are kept in least recently used order. When an insertion
+ * exceeds the capacity the least recently used entry is evicted. With the
+ * GENERATION eviction policy, the owner advances the generation (e.g., at
+ * each channel update period) by calling SetGeneration and the entries which
+ * have not been accessed during the current or the previous generation are
+ * dropped.
+ *
+ * The entries are indexed by an OpenAddressingHashTable, and the most
+ * recently used entry is checked before probing the table, since the same
+ * key is usually looked up several times in a row (e.g., once per layer).
+ *
+ * Hits, misses, evictions and the estimated memory footprint are collected
+ * in a BoundedCacheStatistics object.
+ */
+template <class Key, class Value, class Hash = OpenAddressingHash<Key> >
+class BoundedCache : public BoundedCacheBase
+{
+public:
+  /**
+   * Function returning the size in bytes of the heap memory owned by a value
+   */
+  typedef std::function<uint64_t (const Value &)> SizeFunction;
+
+  /**
+   * Constructor
+   */
+  BoundedCache ()
+  {
+  }
+
+  /**
+   * Set the function used to estimate the heap memory owned by a value.
+   * If not set, only the size of the entry itself is accounted for.
+   * \param sizeFunction the function
+   */
+  void SetSizeFunction (SizeFunction sizeFunction)
+  {
+    m_sizeFunction = sizeFunction;
+  }
+
+  /**
+   * Look for an entry. If found, the entry becomes the most recently used.
+   * Updates the hit and miss counters.
+   * \param key the key
+   * \return a pointer to the stored value, or 0 if not found. The pointer is
+   *         valid until the entry is removed from the cache.
+   */
+  Value* Find (const Key &key)
+  {
+    EntryIterator entry;
+    if (!Lookup (key, entry))
+      {
+        m_stats->m_misses++;
+        return 0;
+      }
+    m_stats->m_hits++;
+    Touch (entry);
+    return &entry->m_value;
+  }
+
+  /**
+   * Look for an entry without updating the counters or the order of the
+   * entries
+   * \param key the key
+   * \return a pointer to the stored value, or 0 if not found
+   */
+  Value* Peek (const Key &key)
+  {
+    EntryIterator entry;
+    return Lookup (key, entry) ? &entry->m_value : 0;
+  }
+
+  /**
+   * Check if an entry is present, without updating the counters or the
+   * order of the entries
+   * \param key the key
+   * \return true if the entry is present
+   */
+  bool Contains (const Key &key) const
+  {
+    return (!m_entries.empty () && m_entries.front ().m_key == key)
+           || m_index.Find (key) != 0;
+  }
+
+  /**
+   * Insert an entry, or replace the value of an existing one. The entry
+   * becomes the most recently used, and the least recently used entries are
+   * evicted if the capacity is exceeded.
+   * \param key the key
+   * \param value the value
+   * \return a pointer to the stored value
+   */
+  Value* Insert (const Key &key, const Value &value)
+  {
+    EntryIterator entry;
+    if (Lookup (key, entry))
+      {
+        m_stats->m_bytes -= entry->m_bytes;
+        entry->m_value = value;
+        entry->m_bytes = GetEntrySize (value);
+        m_stats->m_bytes += entry->m_bytes;
+        Touch (entry);
+        return &entry->m_value;
+      }
+
+    m_entries.push_front (Entry (key, value, m_generation, GetEntrySize (value)));
+    m_index.Insert (key, m_entries.begin ());
+    m_stats->m_bytes += m_entries.front ().m_bytes;
+    m_stats->m_entries = m_entries.size ();
+
+    while (m_capacity > 0 && m_entries.size () > m_capacity)
+      {
+        EvictLeastRecentlyUsed ();
+      }
+    return &m_entries.front ().m_value;
+  }
+
+  /**
+   * Replace the value of an existing entry, without updating the counters,
+   * the order of the entries or the generation of their last access
+   * \param key the key
+   * \param value the value
+   * \return true if the entry was present
+   */
+  bool Replace (const Key &key, const Value &value)
+  {
+    EntryIterator entry;
+    if (!Lookup (key, entry))
+      {
+        return false;
+      }
+    m_stats->m_bytes -= entry->m_bytes;
+    entry->m_value = value;
+    entry->m_bytes = GetEntrySize (value);
+    m_stats->m_bytes += entry->m_bytes;
+    return true;
+  }
+
+  /**
+   * Call a function on all the entries, from the most to the least recently
+   * used, without updating the counters or the order of the entries
+   * \param function the function, called with the key, the value and the
+   *        generation of the last access of each entry
+   */
+  template <class Function>
+  void ForEach (Function function) const
+  {
+    for (const Entry &entry : m_entries)
+      {
+        function (entry.m_key, entry.m_value, entry.m_generation);
+      }
+  }
+
+  /**
+   * Remove an entry. This is not accounted as an eviction.
+   * \param key the key
+   * \return true if the entry was present
+   */
+  bool Erase (const Key &key)
+  {
+    EntryIterator entry;
+    if (!Lookup (key, entry))
+      {
+        return false;
+      }
+    Remove (entry);
+    return true;
+  }
+
+  /**
+   * Set the current generation. If the generation changes and the
+   * eviction policy is GENERATION, the entries not accessed during the
+   * current or the previous generation are evicted.
+   * \param generation the current generation
+   */
+  void SetGeneration (uint64_t generation)
+  {
+    if (generation == m_generation)
+      {
+        return;
+      }
+    m_generation = generation;
+    if (m_policy == GENERATION)
+      {
+        // the entries are sorted by last access, hence the oldest
+        // generations are at the back of the list
+        while (!m_entries.empty () && m_entries.back ().m_generation + 1 < m_generation)
+          {
+            EvictLeastRecentlyUsed ();
+          }
+      }
+  }
+
+  /**
+   * \return the number of stored entries
+   */
+  std::size_t GetSize () const
+  {
+    return m_entries.size ();
+  }
+
+  /**
+   * Remove all the entries. This is not accounted as an eviction.
+   */
+  void Clear ()
+  {
+    m_index.Clear ();
+    m_entries.clear ();
+    m_stats->m_bytes = 0;
+    m_stats->m_entries = 0;
+  }
+
+private:
+  /**
+   * An entry of the cache
+   */
+  struct Entry
+  {
+    /**
+     * Constructor
+     * \param key the key
+     * \param value the value
+     * \param generation the generation of the last access
+     * \param bytes the estimated size of the entry
+     */
+    Entry (const Key &key, const Value &value, uint64_t generation, uint64_t bytes)
+      : m_key (key),
+        m_value (value),
+        m_generation (generation),
+        m_bytes (bytes)
+    {
+    }
+
+    Key m_key; //!< the key
+    Value m_value; //!< the value
+    uint64_t m_generation; //!< the generation of the last access
+    uint64_t m_bytes; //!< the estimated size of the entry
+  };
+
+  typedef typename std::list<Entry>::iterator EntryIterator; //!< iterator of the entry list
+  typedef OpenAddressingHashTable<Key, EntryIterator, Hash> Index; //!< type of the index
+
+  /**
+   * Look for an entry, starting from the most recently used one
+   * \param key the key
+   * \param [out] entry the position of the entry in m_entries, if found
+   * \return true if the entry was found
+   */
+  bool Lookup (const Key &key, EntryIterator &entry)
+  {
+    if (!m_entries.empty () && m_entries.front ().m_key == key)
+      {
+        entry = m_entries.begin ();
+        return true;
+      }
+    EntryIterator *indexed = m_index.Find (key);
+    if (indexed == 0)
+      {
+        return false;
+      }
+    entry = *indexed;
+    return true;
+  }
+
+  /**
+   * Mark an entry as the most recently used
+   * \param entry the entry
+   */
+  void Touch (EntryIterator entry)
+  {
+    entry->m_generation = m_generation;
+    m_entries.splice (m_entries.begin (), m_entries, entry);
+  }
+
+  /**
+   * Evict the least recently used entry
+   */
+  void EvictLeastRecentlyUsed ()
+  {
+    Remove (--m_entries.end ());
+    m_stats->m_evictions++;
+  }
+
+  /**
+   * Remove an entry
+   * \param entry the position of the entry in m_entries
+   */
+  void Remove (EntryIterator entry)
+  {
+    m_stats->m_bytes -= entry->m_bytes;
+    m_index.Erase (entry->m_key);
+    m_entries.erase (entry);
+    m_stats->m_entries = m_entries.size ();
+  }
+
+  /**
+   * Estimate the memory occupied by an entry
+   * \param value the value of the entry
+   * \return the size in bytes
+   */
+  uint64_t GetEntrySize (const Value &value) const
+  {
+    // list node, index slots (the index is at most half full) and heap
+    // memory owned by the value
+    uint64_t size = sizeof (Entry) + 2 * sizeof (void*) + 2 * Index::GetSlotSize ();
+    if (m_sizeFunction)
+      {
+        size += m_sizeFunction (value);
+      }
+    return size;
+  }
+
+  std::list<Entry> m_entries; //!< the entries, from the most to the least recently used
+  Index m_index; //!< the position of each entry in m_entries
+  SizeFunction m_sizeFunction; //!< estimates the memory owned by a value
+};
+
+} // namespace ns3
+
+#endif /* BOUNDED_CACHE_H */
@@ -20,12 +20,14 @@
 
 #include <ns3/object.h>
 #include <ns3/simulator.h>
+#include <ns3/parallel-event-impl.h>
 #include <ns3/log.h>
 #include <ns3/packet.h>
 #include <ns3/packet-burst.h>
 #include <ns3/net-device.h>
 #include <ns3/node.h>
 #include <ns3/double.h>
+#include <ns3/boolean.h>
 #include <ns3/mobility-model.h>
 #include <ns3/spectrum-phy.h>
 #include <ns3/spectrum-converter.h>
@@ -36,6 +38,8 @@
 #include <ns3/angles.h>
 #include <iostream>
 #include <utility>
+#include <algorithm>
+#include <cmath>
 #include "multi-model-spectrum-channel.h"
 
 
@@ -43,6 +47,50 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("MultiModelSpectrumChannel");
 
+/**
+ * \ingroup spectrum
+ * The reception of a signal scheduled as a parallel event: the job
+ * returned by SpectrumPhy::PrepareRx runs in the prepare step, and the
+ * signal is passed to the receiver in the commit step.
+ */
+class MultiModelSpectrumChannel::StartRxEvent : public ParallelEventImpl
+{
+public:
+  /**
+   * Constructor
+   * \param channel the channel
+   * \param params the signal parameters
+   * \param receiver the receiver
+   * \param job the job prepared by the receiver, or 0
+   */
+  StartRxEvent (MultiModelSpectrumChannel *channel, Ptr<SpectrumSignalParameters> params,
+                Ptr<SpectrumPhy> receiver, Ptr<SpectrumRxJob> job)
+    : m_channel (channel),
+      m_params (params),
+      m_receiver (receiver),
+      m_job (job)
+  {
+  }
+
+private:
+  virtual void DoPrepare (void)
+  {
+    if (m_job)
+      {
+        m_job->Run ();
+      }
+  }
+  virtual void DoCommit (void)
+  {
+    m_channel->StartRx (m_params, m_receiver);
+  }
+
+  MultiModelSpectrumChannel *m_channel; //!< the channel
+  Ptr<SpectrumSignalParameters> m_params; //!< the signal parameters
+  Ptr<SpectrumPhy> m_receiver; //!< the receiver
+  Ptr<SpectrumRxJob> m_job; //!< the job prepared by the receiver, or 0
+};
+
 NS_OBJECT_ENSURE_REGISTERED (MultiModelSpectrumChannel);
 
 
@@ -82,6 +130,7 @@ RxSpectrumModelInfo::RxSpectrumModelInfo (Ptr<const SpectrumModel> rxSpectrumMod
 
 
 MultiModelSpectrumChannel::MultiModelSpectrumChannel ()
+  : m_prunedDeliveries (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -102,7 +151,43 @@ MultiModelSpectrumChannel::GetTypeId (void)
     .SetParent<SpectrumChannel> ()
     .SetGroupName ("Spectrum")
     .AddConstructor<MultiModelSpectrumChannel> ()
-
+    .AddAttribute ("EnablePruning",
+                   "If true, a transmission is not delivered to the receivers whose "
+                   "best-case received power is negligible. The best case is computed "
+                   "with the pathloss of the PropagationLossModel and the maximum gain "
+                   "of the SpectrumPropagationLossModel (e.g., the array gain). "
+                   "Pruning is never applied if the SpectrumPropagationLossModel "
+                   "does not provide a bound of its gain.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MultiModelSpectrumChannel::m_enablePruning),
+                   MakeBooleanChecker ())
+    .AddAttribute ("PruningThreshold",
+                   "A delivery is skipped if the best-case received PSD is more than "
+                   "this value (in dB) below the thermal noise PSD. The value should "
+                   "include a margin for the small scale fading.",
+                   DoubleValue (30.0),
+                   MakeDoubleAccessor (&MultiModelSpectrumChannel::m_pruningThresholdDb),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("PruningNoiseFigure",
+                   "The noise figure (in dB) used to compute the thermal noise PSD "
+                   "against which the pruning threshold is applied. It should not "
+                   "exceed the noise figure of any receiver.",
+                   DoubleValue (5.0),
+                   MakeDoubleAccessor (&MultiModelSpectrumChannel::m_pruningNoiseFigureDb),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("ParallelRx",
+                   "If true, the receptions are scheduled as parallel events, whose prepare "
+                   "step runs the job returned by SpectrumPhy::PrepareRx. The jobs of the "
+                   "receptions with the same timestamp run in parallel if the ParallelThreads "
+                   "attribute of DefaultSimulatorImpl is greater than 1.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MultiModelSpectrumChannel::m_parallelRx),
+                   MakeBooleanChecker ())
+    .AddTraceSource ("PrunedDeliveries",
+                     "The number of deliveries skipped because the best-case "
+                     "received power was negligible.",
+                     MakeTraceSourceAccessor (&MultiModelSpectrumChannel::m_prunedDeliveries),
+                     "ns3::TracedValueCallback::Uint64")
   ;
   return tid;
 }
@@ -326,6 +411,13 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
                   double pathGainLinear = std::pow (10.0, (-pathLossDb) / 10.0);
                   *(rxParams->psd) *= pathGainLinear;              
 
+                  if (m_enablePruning && IsNegligible (rxParams->psd, txMobility, receiverMobility))
+                    {
+                      NS_LOG_LOGIC ("negligible received power, skipping " << *rxPhyIterator);
+                      m_prunedDeliveries++;
+                      continue;
+                    }
+
                   if (m_spectrumPropagationLoss)
                     {
                       rxParams->psd = m_spectrumPropagationLoss->CalcRxPowerSpectralDensity (rxParams->psd, txMobility, receiverMobility);
@@ -338,7 +430,20 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
                 }
 
               Ptr<NetDevice> netDev = (*rxPhyIterator)->GetDevice ();
-              if (netDev)
+              if (m_parallelRx)
+                {
+                  Ptr<SpectrumRxJob> job = (*rxPhyIterator)->PrepareRx (rxParams, delay);
+                  EventImpl *event = new StartRxEvent (this, rxParams, *rxPhyIterator, job);
+                  if (netDev)
+                    {
+                      Simulator::ScheduleWithContext (netDev->GetNode ()->GetId (), delay, event);
+                    }
+                  else
+                    {
+                      Simulator::Schedule (delay, Ptr<EventImpl> (event, false));
+                    }
+                }
+              else if (netDev)
                 {
                   // the receiver has a NetDevice, so we expect that it is attached to a Node
                   uint32_t dstNode =  netDev->GetNode ()->GetId ();
@@ -358,6 +463,36 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
 
 }
 
+bool
+MultiModelSpectrumChannel::IsNegligible (Ptr<const SpectrumValue> psd, Ptr<MobilityModel> txMobility,
+                                         Ptr<MobilityModel> rxMobility) const
+{
+  if (!m_spectrumPropagationLoss)
+    {
+      return false;
+    }
+  double maxGainDb = m_spectrumPropagationLoss->GetMaxGainDb (txMobility, rxMobility);
+  if (std::isinf (maxGainDb))
+    {
+      return false;
+    }
+
+  double maxPsd = *std::max_element (psd->ConstValuesBegin (), psd->ConstValuesEnd ());
+  double maxPsdDb = 10 * std::log10 (maxPsd) + maxGainDb;
+
+  // the PSD is in W/Hz
+  const double kT_dBm_Hz = -174.0;  // dBm/Hz
+  double noisePsdDb = kT_dBm_Hz - 30 + m_pruningNoiseFigureDb;
+  NS_LOG_LOGIC ("best-case rx PSD " << maxPsdDb << " dBW/Hz, noise PSD " << noisePsdDb << " dBW/Hz");
+  return maxPsdDb < noisePsdDb - m_pruningThresholdDb;
+}
+
+uint64_t
+MultiModelSpectrumChannel::GetPrunedDeliveries (void) const
+{
+  return m_prunedDeliveries;
+}
+
 void
 MultiModelSpectrumChannel::StartRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver)
 {
@@ -27,6 +27,7 @@
 #include <ns3/spectrum-channel.h>
 #include <ns3/spectrum-propagation-loss-model.h>
 #include <ns3/propagation-delay-model.h>
+#include <ns3/traced-value.h>
 #include <map>
 #include <set>
 
@@ -123,10 +124,24 @@ public:
   virtual std::size_t GetNDevices (void) const;
   virtual Ptr<NetDevice> GetDevice (std::size_t i) const;
 
+  /**
+   * \return the number of deliveries skipped because the best-case received
+   *         power was below the pruning threshold
+   */
+  uint64_t GetPrunedDeliveries (void) const;
+
 
 protected:
   void DoDispose ();
 
+  /**
+   * Used internally to reschedule transmission after the propagation delay.
+   *
+   * \param params The signal parameters.
+   * \param receiver A pointer to the receiver SpectrumPhy.
+   */
+  virtual void StartRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver);
+
 private:
   /**
    * This method checks if m_rxSpectrumModelInfoMap contains an entry
@@ -140,13 +155,7 @@ private:
    */
   TxSpectrumModelInfoMap_t::const_iterator FindAndEventuallyAddTxSpectrumModel (Ptr<const SpectrumModel> txSpectrumModel);
 
-  /**
-   * Used internally to reschedule transmission after the propagation delay.
-   *
-   * \param params The signal parameters.
-   * \param receiver A pointer to the receiver SpectrumPhy.
-   */
-  virtual void StartRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver);
+  class StartRxEvent;
 
   /**
    * Data structure holding, for each TX SpectrumModel,  all the
@@ -168,6 +177,26 @@ private:
    */
   std::size_t m_numDevices;
 
+  /**
+   * Check if the best-case received power of a link is negligible, i.e., if
+   * the maximum over the bands of the received PSD, computed with the
+   * maximum gain of the SpectrumPropagationLossModel, is more than
+   * m_pruningThresholdDb below the thermal noise PSD.
+   *
+   * \param psd the received PSD, before the SpectrumPropagationLossModel
+   * \param txMobility the mobility of the transmitter
+   * \param rxMobility the mobility of the receiver
+   * \return true if the delivery can be skipped
+   */
+  bool IsNegligible (Ptr<const SpectrumValue> psd, Ptr<MobilityModel> txMobility,
+                     Ptr<MobilityModel> rxMobility) const;
+
+  bool m_enablePruning;        //!< if true, the negligible deliveries are skipped
+  double m_pruningThresholdDb; //!< the pruning threshold, in dB below the noise PSD
+  double m_pruningNoiseFigureDb; //!< the noise figure used to compute the noise PSD, in dB
+  TracedValue<uint64_t> m_prunedDeliveries; //!< the number of skipped deliveries
+  bool m_parallelRx;           //!< if true, the receptions are scheduled as parallel events
+
 };
 
 
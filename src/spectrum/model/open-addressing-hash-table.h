@@ -0,0 +1,318 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 SIGNET Lab, Department of Information Engineering,
+ * University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef OPEN_ADDRESSING_HASH_TABLE_H
+#define OPEN_ADDRESSING_HASH_TABLE_H
+
+#include <ns3/assert.h>
+#include <functional>
+#include <vector>
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup spectrum
+ *
+ * Scramble the bits of a hash value, so that keys differing only in a few
+ * bits (e.g., consecutive ids) are spread over the whole table.
+ * This is the finalizer of the splitmix64 generator.
+ * \param x the value to scramble
+ * \return the scrambled value
+ */
+inline uint64_t
+MixHash (uint64_t x)
+{
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return x;
+}
+
+/**
+ * \ingroup spectrum
+ *
+ * Default hash function of the OpenAddressingHashTable, which scrambles the
+ * output of std::hash
+ */
+template <class Key>
+struct OpenAddressingHash
+{
+  /**
+   * \param key the key
+   * \return the hash of the key
+   */
+  uint64_t operator() (const Key &key) const
+  {
+    return MixHash (std::hash<Key> () (key));
+  }
+};
+
+/**
+ * \ingroup spectrum
+ *
+ * Hash table with open addressing and linear probing.
+ *
+ * The entries are stored in a single array whose size is a power of two and
+ * which is kept at most half full, so that a lookup usually inspects one or
+ * two contiguous slots. Entries are removed with backward shift deletion,
+ * hence lookups never have to skip deleted slots.
+ *
+ * The pointers returned by Find and Insert are invalidated by any following
+ * insertion or deletion.
+ */
+template <class Key, class Value, class Hash = OpenAddressingHash<Key>, class KeyEqual = std::equal_to<Key> >
+class OpenAddressingHashTable
+{
+public:
+  /**
+   * Constructor
+   */
+  OpenAddressingHashTable ()
+    : m_size (0),
+      m_mask (0)
+  {
+  }
+
+  /**
+   * Look for an entry
+   * \param key the key
+   * \return a pointer to the stored value, or 0 if not found
+   */
+  Value* Find (const Key &key)
+  {
+    std::size_t index = FindSlot (key, m_hash (key));
+    return index == NOT_FOUND ? 0 : &m_slots[index].m_value;
+  }
+
+  /**
+   * Look for an entry
+   * \param key the key
+   * \return a pointer to the stored value, or 0 if not found
+   */
+  const Value* Find (const Key &key) const
+  {
+    std::size_t index = FindSlot (key, m_hash (key));
+    return index == NOT_FOUND ? 0 : &m_slots[index].m_value;
+  }
+
+  /**
+   * Insert an entry, or replace the value of an existing one
+   * \param key the key
+   * \param value the value
+   * \return a pointer to the stored value
+   */
+  Value* Insert (const Key &key, const Value &value)
+  {
+    uint64_t hash = m_hash (key);
+    std::size_t index = FindSlot (key, hash);
+    if (index != NOT_FOUND)
+      {
+        m_slots[index].m_value = value;
+        return &m_slots[index].m_value;
+      }
+
+    if (2 * (m_size + 1) > m_slots.size ())
+      {
+        if (m_slots.empty ())
+          {
+            Rehash (MIN_SLOTS);
+          }
+        else
+          {
+            Rehash (2 * m_slots.size ());
+          }
+      }
+    index = InsertNew (key, value, hash);
+    m_size++;
+    return &m_slots[index].m_value;
+  }
+
+  /**
+   * Remove an entry
+   * \param key the key
+   * \return true if the entry was present
+   */
+  bool Erase (const Key &key)
+  {
+    std::size_t hole = FindSlot (key, m_hash (key));
+    if (hole == NOT_FOUND)
+      {
+        return false;
+      }
+
+    // shift back the following entries of the cluster which are not in
+    // their home slot, so that no lookup stops at the hole
+    std::size_t index = (hole + 1) & m_mask;
+    while (m_slots[index].m_used)
+      {
+        std::size_t home = m_slots[index].m_hash & m_mask;
+        // the entry can fill the hole only if its home slot does not lie
+        // cyclically in (hole, index]
+        if (((index - home) & m_mask) >= ((index - hole) & m_mask))
+          {
+            m_slots[hole] = m_slots[index];
+            hole = index;
+          }
+        index = (index + 1) & m_mask;
+      }
+    m_slots[hole] = Slot ();
+    m_size--;
+    return true;
+  }
+
+  /**
+   * Remove all the entries, keeping the allocated slots
+   */
+  void Clear ()
+  {
+    for (Slot &slot : m_slots)
+      {
+        slot = Slot ();
+      }
+    m_size = 0;
+  }
+
+  /**
+   * \return the number of stored entries
+   */
+  std::size_t GetSize () const
+  {
+    return m_size;
+  }
+
+  /**
+   * \return the number of allocated slots
+   */
+  std::size_t GetNumSlots () const
+  {
+    return m_slots.size ();
+  }
+
+  /**
+   * \return the memory occupied by a slot, in bytes
+   */
+  static std::size_t GetSlotSize ()
+  {
+    return sizeof (Slot);
+  }
+
+private:
+  /**
+   * A slot of the table
+   */
+  struct Slot
+  {
+    /**
+     * Constructor, creates an empty slot
+     */
+    Slot ()
+      : m_hash (0),
+        m_used (false),
+        m_key (),
+        m_value ()
+    {
+    }
+
+    uint64_t m_hash; //!< the hash of the key
+    bool m_used; //!< true if the slot contains an entry
+    Key m_key; //!< the key
+    Value m_value; //!< the value
+  };
+
+  static const std::size_t NOT_FOUND = static_cast<std::size_t> (-1); //!< returned by FindSlot
+  static const std::size_t MIN_SLOTS = 16; //!< the number of slots allocated at the first insertion
+
+  /**
+   * Look for the slot containing a key
+   * \param key the key
+   * \param hash the hash of the key
+   * \return the index of the slot, or NOT_FOUND
+   */
+  std::size_t FindSlot (const Key &key, uint64_t hash) const
+  {
+    if (m_size == 0)
+      {
+        return NOT_FOUND;
+      }
+    std::size_t index = hash & m_mask;
+    while (m_slots[index].m_used)
+      {
+        if (m_slots[index].m_hash == hash && m_equal (m_slots[index].m_key, key))
+          {
+            return index;
+          }
+        index = (index + 1) & m_mask;
+      }
+    return NOT_FOUND;
+  }
+
+  /**
+   * Store a key which is not in the table. There must be a free slot.
+   * \param key the key
+   * \param value the value
+   * \param hash the hash of the key
+   * \return the index of the slot
+   */
+  std::size_t InsertNew (const Key &key, const Value &value, uint64_t hash)
+  {
+    std::size_t index = hash & m_mask;
+    while (m_slots[index].m_used)
+      {
+        index = (index + 1) & m_mask;
+      }
+    Slot &slot = m_slots[index];
+    slot.m_hash = hash;
+    slot.m_used = true;
+    slot.m_key = key;
+    slot.m_value = value;
+    return index;
+  }
+
+  /**
+   * Move the entries to a new array of slots
+   * \param numSlots the number of slots, must be a power of two
+   */
+  void Rehash (std::size_t numSlots)
+  {
+    NS_ASSERT_MSG ((numSlots & (numSlots - 1)) == 0, "The number of slots must be a power of two");
+    std::vector<Slot> oldSlots (numSlots);
+    oldSlots.swap (m_slots);
+    m_mask = numSlots - 1;
+    for (const Slot &slot : oldSlots)
+      {
+        if (slot.m_used)
+          {
+            InsertNew (slot.m_key, slot.m_value, slot.m_hash);
+          }
+      }
+  }
+
+  std::vector<Slot> m_slots; //!< the slots
+  std::size_t m_size; //!< the number of stored entries
+  std::size_t m_mask; //!< the number of slots minus one
+  Hash m_hash; //!< the hash function
+  KeyEqual m_equal; //!< the key comparison function
+};
+
+} // namespace ns3
+
+#endif /* OPEN_ADDRESSING_HASH_TABLE_H */
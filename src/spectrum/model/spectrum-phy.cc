@@ -52,5 +52,15 @@ SpectrumPhy::~SpectrumPhy ()
   NS_LOG_FUNCTION (this);
 }
 
+Ptr<SpectrumRxJob>
+SpectrumPhy::PrepareRx (Ptr<SpectrumSignalParameters> params, Time delay)
+{
+  return 0;
+}
+
+SpectrumRxJob::~SpectrumRxJob ()
+{
+}
+
 
 } // namespace
@@ -36,6 +36,25 @@ class SpectrumModel;
 class NetDevice;
 struct SpectrumSignalParameters;
 
+/**
+ * \ingroup spectrum
+ *
+ * The computations of the reception of a signal prepared by
+ * SpectrumPhy::PrepareRx, which may run on a worker thread before the
+ * signal is passed to SpectrumPhy::StartRx
+ */
+class SpectrumRxJob : public SimpleRefCount<SpectrumRxJob>
+{
+public:
+  virtual ~SpectrumRxJob ();
+
+  /**
+   * Run the computations. The method must follow the rules of the prepare
+   * step of a ParallelEventImpl.
+   */
+  virtual void Run (void) = 0;
+};
+
 /**
  * \ingroup spectrum
  *
@@ -112,6 +131,20 @@ public:
    */
   virtual void StartRx (Ptr<SpectrumSignalParameters> params) = 0;
 
+  /**
+   * Prepare the reception of a signal. Called on the simulation thread when
+   * the signal is scheduled for reception by a channel which runs the
+   * receptions as parallel events. The returned job is run before StartRx
+   * is called with the same parameters, possibly on a worker thread and
+   * concurrently with the jobs of other receptions.
+   * The default implementation returns 0, i.e., nothing is prepared.
+   *
+   * @param params the parameters of the signal which will be received
+   * @param delay the time after which StartRx will be called
+   * @return the job, or 0
+   */
+  virtual Ptr<SpectrumRxJob> PrepareRx (Ptr<SpectrumSignalParameters> params, Time delay);
+
 private:
   /**
    * \brief Copy constructor
@@ -21,6 +21,7 @@
 
 #include "spectrum-propagation-loss-model.h"
 #include <ns3/log.h>
+#include <limits>
 
 namespace ns3 {
 
@@ -73,4 +74,24 @@ SpectrumPropagationLossModel::CalcRxPowerSpectralDensity (Ptr<const SpectrumValu
   return rxPsd;
 }
 
+double
+SpectrumPropagationLossModel::GetMaxGainDb (Ptr<const MobilityModel> a,
+                                            Ptr<const MobilityModel> b) const
+{
+  double maxGainDb = DoGetMaxGainDb (a, b);
+  if (m_next != 0)
+    {
+      maxGainDb += m_next->GetMaxGainDb (a, b);
+    }
+  return maxGainDb;
+}
+
+double
+SpectrumPropagationLossModel::DoGetMaxGainDb (Ptr<const MobilityModel> a,
+                                              Ptr<const MobilityModel> b) const
+{
+  // no bound is known
+  return std::numeric_limits<double>::infinity ();
+}
+
 } // namespace ns3
@@ -77,6 +77,21 @@ public:
   Ptr<SpectrumValue> CalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPsd,
                                                    Ptr<const MobilityModel> a,
                                                    Ptr<const MobilityModel> b) const;
+
+  /**
+   * Get an upper bound of the gain applied by this model, and by the ones
+   * chained to it, to the power spectral density of a link. The bound is
+   * used by the channel to skip the receivers which cannot receive a
+   * relevant amount of power.
+   *
+   * @param a sender mobility
+   * @param b receiver mobility
+   *
+   * @return the maximum gain in dB, +infinity if no bound is known
+   */
+  double GetMaxGainDb (Ptr<const MobilityModel> a,
+                       Ptr<const MobilityModel> b) const;
+
   //This new method is intended to work as the above for legacy models, but be replaced by models that need more info than the mobility model from the spectrum phy in the future
 //  Ptr<SpectrumValue> CalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPsd,
 //                                                 Ptr<const SpectrumPhy> a,
@@ -103,6 +118,18 @@ private:
                                                            Ptr<const MobilityModel> a,
                                                            Ptr<const MobilityModel> b) const = 0;
 
+  /**
+   * Compute an upper bound of the gain applied by this model. The default
+   * implementation returns +infinity, i.e., no bound is known.
+   *
+   * @param a sender mobility
+   * @param b receiver mobility
+   *
+   * @return the maximum gain in dB
+   */
+  virtual double DoGetMaxGainDb (Ptr<const MobilityModel> a,
+                                 Ptr<const MobilityModel> b) const;
+
   Ptr<SpectrumPropagationLossModel> m_next; //!< SpectrumPropagationLossModel chained to this one.
 };
 
@@ -22,11 +22,124 @@
 #include <ns3/spectrum-value.h>
 #include <ns3/math.h>
 #include <ns3/log.h>
+#include <new>
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("SpectrumValue");
 
+namespace {
+
+/**
+ * The free lists of the SpectrumValuePool of a thread
+ */
+class SpectrumValueFreeLists
+{
+public:
+  /// the maximum number of blocks kept in each free list
+  static const std::size_t MAX_FREE_BLOCKS = 1024;
+
+  SpectrumValueFreeLists ();
+  ~SpectrumValueFreeLists ();
+  /**
+   * \param size the number of bytes of the blocks
+   * \return the free list of the blocks of the given size
+   */
+  std::vector<void*>& GetFreeList (std::size_t size);
+
+  /// whether the free lists of the thread exist, i.e., the thread is not exiting
+  static thread_local bool m_alive;
+
+private:
+  /// the free lists, with the size of their blocks; a thread uses few sizes
+  std::vector<std::pair<std::size_t, std::vector<void*> > > m_freeLists;
+};
+
+thread_local bool SpectrumValueFreeLists::m_alive = false;
+
+SpectrumValueFreeLists::SpectrumValueFreeLists ()
+{
+  m_alive = true;
+}
+
+SpectrumValueFreeLists::~SpectrumValueFreeLists ()
+{
+  // the blocks released from now on, e.g., by static SpectrumValues, go
+  // directly back to the heap
+  m_alive = false;
+  for (std::size_t i = 0; i < m_freeLists.size (); i++)
+    {
+      for (std::size_t j = 0; j < m_freeLists[i].second.size (); j++)
+        {
+          ::operator delete (m_freeLists[i].second[j]);
+        }
+    }
+}
+
+std::vector<void*>&
+SpectrumValueFreeLists::GetFreeList (std::size_t size)
+{
+  for (std::size_t i = 0; i < m_freeLists.size (); i++)
+    {
+      if (m_freeLists[i].first == size)
+        {
+          return m_freeLists[i].second;
+        }
+    }
+  m_freeLists.push_back (std::make_pair (size, std::vector<void*> ()));
+  m_freeLists.back ().second.reserve (MAX_FREE_BLOCKS);
+  return m_freeLists.back ().second;
+}
+
+/**
+ * \return the free lists of the calling thread, or 0 if they were destroyed
+ */
+SpectrumValueFreeLists*
+GetSpectrumValueFreeLists (void)
+{
+  static thread_local SpectrumValueFreeLists freeLists;
+  return SpectrumValueFreeLists::m_alive ? &freeLists : 0;
+}
+
+} // unnamed namespace
+
+void*
+SpectrumValuePool::Allocate (std::size_t size)
+{
+  SpectrumValueFreeLists* freeLists = GetSpectrumValueFreeLists ();
+  if (freeLists != 0)
+    {
+      std::vector<void*>& freeList = freeLists->GetFreeList (size);
+      if (!freeList.empty ())
+        {
+          void* p = freeList.back ();
+          freeList.pop_back ();
+          return p;
+        }
+    }
+  return ::operator new (size);
+}
+
+void
+SpectrumValuePool::Deallocate (void* p, std::size_t size)
+{
+  if (p == 0)
+    {
+      return;
+    }
+  SpectrumValueFreeLists* freeLists = GetSpectrumValueFreeLists ();
+  if (freeLists != 0)
+    {
+      std::vector<void*>& freeList = freeLists->GetFreeList (size);
+      if (freeList.size () < SpectrumValueFreeLists::MAX_FREE_BLOCKS)
+        {
+          freeList.push_back (p);
+          return;
+        }
+    }
+  ::operator delete (p);
+}
+
 SpectrumValue::SpectrumValue ()
 {
 }
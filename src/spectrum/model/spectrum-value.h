@@ -26,12 +26,104 @@
 #include <ns3/spectrum-model.h>
 #include <ostream>
 #include <vector>
+#include <cstddef>
 
 namespace ns3 {
 
+/**
+ * \ingroup spectrum
+ *
+ * \brief Pool of the memory blocks holding the values of the SpectrumValues
+ *
+ * The values of a SpectrumValue are as many as the bands of its
+ * SpectrumModel, hence the blocks released by a SpectrumValue can be reused
+ * as they are by the next SpectrumValue of any SpectrumModel with the same
+ * number of bands. The released blocks are kept in a free list for each
+ * block size, so that the temporary SpectrumValues created for each signal
+ * do not allocate memory from the heap. Each thread has its own pool.
+ */
+class SpectrumValuePool
+{
+public:
+  /**
+   * Get a block from the pool of the calling thread
+   * \param size the number of bytes of the block
+   * \return the block
+   */
+  static void* Allocate (std::size_t size);
+  /**
+   * Release a block obtained with Allocate
+   * \param p the block
+   * \param size the number of bytes of the block
+   */
+  static void Deallocate (void* p, std::size_t size);
+};
+
+/**
+ * \ingroup spectrum
+ *
+ * \brief Allocator of the values of the SpectrumValues, which recycles the
+ * blocks through the SpectrumValuePool
+ */
+template <class T>
+class SpectrumValueAllocator
+{
+public:
+  typedef T value_type; //!< the type of the allocated elements
+
+  SpectrumValueAllocator ()
+  {
+  }
+  /**
+   * Copy constructor from an allocator of another type
+   */
+  template <class U>
+  SpectrumValueAllocator (const SpectrumValueAllocator<U>&)
+  {
+  }
+  /**
+   * Allocate an array
+   * \param n the number of elements
+   * \return the array
+   */
+  T* allocate (std::size_t n)
+  {
+    return static_cast<T*> (SpectrumValuePool::Allocate (n * sizeof (T)));
+  }
+  /**
+   * Release an array
+   * \param p the array
+   * \param n the number of elements
+   */
+  void deallocate (T* p, std::size_t n)
+  {
+    SpectrumValuePool::Deallocate (p, n * sizeof (T));
+  }
+};
+
+/**
+ * \return true, all the SpectrumValueAllocators share the same pool
+ */
+template <class T, class U>
+bool
+operator== (const SpectrumValueAllocator<T>&, const SpectrumValueAllocator<U>&)
+{
+  return true;
+}
+
+/**
+ * \return false, all the SpectrumValueAllocators share the same pool
+ */
+template <class T, class U>
+bool
+operator!= (const SpectrumValueAllocator<T>&, const SpectrumValueAllocator<U>&)
+{
+  return false;
+}
+
 
 /// Container for element values
-typedef std::vector<double> Values;
+typedef std::vector<double, SpectrumValueAllocator<double> > Values;
 
 /**
  * \ingroup spectrum
@@ -0,0 +1,147 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 SIGNET Lab, Department of Information Engineering,
+ * University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "three-gpp-channel-tensor.h"
+
+#if defined (__AVX__)
+#include <immintrin.h>
+#elif defined (__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace ns3 {
+
+ThreeGppChannelTensor::ThreeGppChannelTensor ()
+  : m_numRows (0),
+    m_numCols (0),
+    m_numClusters (0)
+{
+}
+
+ThreeGppChannelTensor::ThreeGppChannelTensor (uint32_t numRows, uint32_t numCols, uint32_t numClusters)
+{
+  Resize (numRows, numCols, numClusters);
+}
+
+void
+ThreeGppChannelTensor::Resize (uint32_t numRows, uint32_t numCols, uint32_t numClusters)
+{
+  m_numRows = numRows;
+  m_numCols = numCols;
+  m_numClusters = numClusters;
+  m_data.assign (static_cast<std::size_t> (numRows) * numCols * numClusters, value_type (0.0, 0.0));
+}
+
+ThreeGppChannelTensor::value_type
+ThreeGppChannelTensor::DotProduct (const value_type* a, const value_type* b, std::size_t size)
+{
+  // std::complex<double> is laid out as {re, im}, hence the arrays can be
+  // processed as interleaved doubles.
+  // For each pair of elements two accumulators are updated:
+  // accRe += (aRe, aIm) * (bRe, bRe) and accIm += (aRe, aIm) * (bIm, bIm),
+  // so that the result is (accRe[0] - accIm[1], accRe[1] + accIm[0]).
+  const double *pa = reinterpret_cast<const double*> (a);
+  const double *pb = reinterpret_cast<const double*> (b);
+  std::size_t i = 0;
+  double re = 0.0;
+  double im = 0.0;
+
+#if defined (__AVX__)
+  __m256d accRe = _mm256_setzero_pd ();
+  __m256d accIm = _mm256_setzero_pd ();
+  for (; i + 2 <= size; i += 2)
+    {
+      __m256d va = _mm256_loadu_pd (pa + 2 * i);
+      __m256d vb = _mm256_loadu_pd (pb + 2 * i);
+      __m256d vbRe = _mm256_movedup_pd (vb);
+      __m256d vbIm = _mm256_permute_pd (vb, 0xF);
+      accRe = _mm256_add_pd (accRe, _mm256_mul_pd (va, vbRe));
+      accIm = _mm256_add_pd (accIm, _mm256_mul_pd (va, vbIm));
+    }
+  double tmpRe[4];
+  double tmpIm[4];
+  _mm256_storeu_pd (tmpRe, accRe);
+  _mm256_storeu_pd (tmpIm, accIm);
+  re = (tmpRe[0] + tmpRe[2]) - (tmpIm[1] + tmpIm[3]);
+  im = (tmpRe[1] + tmpRe[3]) + (tmpIm[0] + tmpIm[2]);
+#elif defined (__SSE2__)
+  __m128d accRe = _mm_setzero_pd ();
+  __m128d accIm = _mm_setzero_pd ();
+  for (; i < size; i++)
+    {
+      __m128d va = _mm_loadu_pd (pa + 2 * i);
+      __m128d vbRe = _mm_set1_pd (pb[2 * i]);
+      __m128d vbIm = _mm_set1_pd (pb[2 * i + 1]);
+      accRe = _mm_add_pd (accRe, _mm_mul_pd (va, vbRe));
+      accIm = _mm_add_pd (accIm, _mm_mul_pd (va, vbIm));
+    }
+  double tmpRe[2];
+  double tmpIm[2];
+  _mm_storeu_pd (tmpRe, accRe);
+  _mm_storeu_pd (tmpIm, accIm);
+  re = tmpRe[0] - tmpIm[1];
+  im = tmpRe[1] + tmpIm[0];
+#endif
+
+  // scalar loop, handles the tail of the vectorized loops
+  for (; i < size; i++)
+    {
+      double aRe = pa[2 * i];
+      double aIm = pa[2 * i + 1];
+      double bRe = pb[2 * i];
+      double bIm = pb[2 * i + 1];
+      re += aRe * bRe - aIm * bIm;
+      im += aRe * bIm + aIm * bRe;
+    }
+  return value_type (re, im);
+}
+
+std::vector<ThreeGppChannelTensor::value_type>
+ThreeGppChannelTensor::Contract (const std::vector<value_type> &rxW,
+                                 const std::vector<value_type> &txW) const
+{
+  NS_ASSERT_MSG (rxW.size () <= m_numRows, "The rx vector is longer than the number of rows of H");
+  NS_ASSERT_MSG (txW.size () <= m_numCols, "The tx vector is longer than the number of columns of H");
+
+  std::vector<value_type> result (m_numClusters);
+  std::size_t numRx = rxW.size ();
+  std::size_t numTx = txW.size ();
+  for (uint32_t nIndex = 0; nIndex < m_numClusters; nIndex++)
+    {
+      const value_type *hn = GetClusterData (nIndex);
+      value_type sum (0.0, 0.0);
+      for (std::size_t uIndex = 0; uIndex < numRx; uIndex++)
+        {
+          sum += rxW[uIndex] * DotProduct (hn + uIndex * m_numCols, txW.data (), numTx);
+        }
+      result[nIndex] = sum;
+    }
+  return result;
+}
+
+bool
+ThreeGppChannelTensor::operator== (const ThreeGppChannelTensor &other) const
+{
+  return m_numRows == other.m_numRows
+         && m_numCols == other.m_numCols
+         && m_numClusters == other.m_numClusters
+         && m_data == other.m_data;
+}
+
+} // namespace ns3
@@ -0,0 +1,233 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 SIGNET Lab, Department of Information Engineering,
+ * University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef THREE_GPP_CHANNEL_TENSOR_H
+#define THREE_GPP_CHANNEL_TENSOR_H
+
+#include <complex>
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
+#include <ns3/assert.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup spectrum
+ *
+ * Minimal allocator returning storage aligned to ALIGNMENT bytes, used to
+ * keep the coefficients of ThreeGppChannelTensor on SIMD register and cache
+ * line boundaries.
+ */
+template <typename T, std::size_t ALIGNMENT>
+struct ThreeGppAlignedAllocator
+{
+  typedef T value_type;
+
+  template <typename U>
+  struct rebind
+  {
+    typedef ThreeGppAlignedAllocator<U, ALIGNMENT> other;
+  };
+
+  ThreeGppAlignedAllocator ()
+  {
+  }
+  template <typename U>
+  ThreeGppAlignedAllocator (const ThreeGppAlignedAllocator<U, ALIGNMENT> &)
+  {
+  }
+
+  T* allocate (std::size_t n)
+  {
+    // over-allocate and store the pointer returned by operator new right
+    // before the aligned block
+    std::size_t bytes = n * sizeof (T) + ALIGNMENT + sizeof (void*);
+    char *raw = static_cast<char*> (::operator new (bytes));
+    std::size_t offset = reinterpret_cast<std::size_t> (raw + sizeof (void*)) % ALIGNMENT;
+    char *aligned = raw + sizeof (void*) + (offset ? ALIGNMENT - offset : 0);
+    reinterpret_cast<void**> (aligned)[-1] = raw;
+    return reinterpret_cast<T*> (aligned);
+  }
+
+  void deallocate (T* p, std::size_t)
+  {
+    if (p != 0)
+      {
+        ::operator delete (reinterpret_cast<void**> (p)[-1]);
+      }
+  }
+};
+
+template <typename T, typename U, std::size_t A>
+bool operator== (const ThreeGppAlignedAllocator<T, A> &, const ThreeGppAlignedAllocator<U, A> &)
+{
+  return true;
+}
+
+template <typename T, typename U, std::size_t A>
+bool operator!= (const ThreeGppAlignedAllocator<T, A> &, const ThreeGppAlignedAllocator<U, A> &)
+{
+  return false;
+}
+
+/**
+ * \ingroup spectrum
+ *
+ * Contiguous storage for the channel coefficients H[u][s][n] of a
+ * ThreeGppChannelMatrix, where u is the rx antenna element, s is the tx
+ * antenna element and n is the cluster index.
+ *
+ * The coefficients are kept in a single aligned allocation with a
+ * cluster-major layout, i.e., for each cluster n the U x S matrix H_n is
+ * stored row by row. This allows the long term computation
+ * rxW^T H_n txW to run as U contiguous dot products of length S.
+ */
+class ThreeGppChannelTensor
+{
+public:
+  typedef std::complex<double> value_type; //!< type of a channel coefficient
+  static const std::size_t ALIGNMENT = 32; //!< alignment of the storage in bytes
+
+  /**
+   * Create an empty tensor
+   */
+  ThreeGppChannelTensor ();
+
+  /**
+   * Create a tensor with the given dimensions, initialized with zeros
+   * \param numRows number of rx antenna elements (U)
+   * \param numCols number of tx antenna elements (S)
+   * \param numClusters number of clusters (N)
+   */
+  ThreeGppChannelTensor (uint32_t numRows, uint32_t numCols, uint32_t numClusters);
+
+  /**
+   * Resize the tensor and set all the coefficients to zero
+   * \param numRows number of rx antenna elements (U)
+   * \param numCols number of tx antenna elements (S)
+   * \param numClusters number of clusters (N)
+   */
+  void Resize (uint32_t numRows, uint32_t numCols, uint32_t numClusters);
+
+  /**
+   * \return the number of rx antenna elements (U)
+   */
+  uint32_t GetNumRows () const
+  {
+    return m_numRows;
+  }
+
+  /**
+   * \return the number of tx antenna elements (S)
+   */
+  uint32_t GetNumCols () const
+  {
+    return m_numCols;
+  }
+
+  /**
+   * \return the number of clusters (N)
+   */
+  uint32_t GetNumClusters () const
+  {
+    return m_numClusters;
+  }
+
+  /**
+   * \return true if the tensor does not contain any coefficient
+   */
+  bool IsEmpty () const
+  {
+    return m_data.empty ();
+  }
+
+  /**
+   * Access the coefficient H[u][s][n]
+   * \param u the rx antenna element
+   * \param s the tx antenna element
+   * \param n the cluster
+   * \return a reference to the coefficient
+   */
+  value_type& operator() (uint32_t u, uint32_t s, uint32_t n)
+  {
+    NS_ASSERT_MSG (u < m_numRows && s < m_numCols && n < m_numClusters, "Index out of range");
+    return m_data[(static_cast<std::size_t> (n) * m_numRows + u) * m_numCols + s];
+  }
+
+  /**
+   * Access the coefficient H[u][s][n]
+   * \param u the rx antenna element
+   * \param s the tx antenna element
+   * \param n the cluster
+   * \return a const reference to the coefficient
+   */
+  const value_type& operator() (uint32_t u, uint32_t s, uint32_t n) const
+  {
+    NS_ASSERT_MSG (u < m_numRows && s < m_numCols && n < m_numClusters, "Index out of range");
+    return m_data[(static_cast<std::size_t> (n) * m_numRows + u) * m_numCols + s];
+  }
+
+  /**
+   * Get the U x S matrix of a cluster, stored row by row
+   * \param n the cluster
+   * \return a pointer to the first coefficient of the cluster slice
+   */
+  const value_type* GetClusterData (uint32_t n) const
+  {
+    NS_ASSERT_MSG (n < m_numClusters, "Cluster index out of range");
+    return m_data.data () + static_cast<std::size_t> (n) * m_numRows * m_numCols;
+  }
+
+  /**
+   * Computes the bilinear form rxW^T H_n txW for every cluster n
+   * \param rxW the vector combining the rows of H (length U)
+   * \param txW the vector combining the columns of H (length S)
+   * \return vector containing one complex coefficient for each cluster
+   */
+  std::vector<value_type> Contract (const std::vector<value_type> &rxW,
+                                    const std::vector<value_type> &txW) const;
+
+  /**
+   * Computes sum_i a[i] * b[i] (no conjugation). Uses AVX or SSE2 when the
+   * compiler targets these instruction sets and falls back to a scalar loop
+   * otherwise.
+   * \param a pointer to the first vector
+   * \param b pointer to the second vector
+   * \param size the number of elements
+   * \return the dot product
+   */
+  static value_type DotProduct (const value_type* a, const value_type* b, std::size_t size);
+
+  /**
+   * \param other the tensor to compare with
+   * \return true if the dimensions and all the coefficients are equal
+   */
+  bool operator== (const ThreeGppChannelTensor &other) const;
+
+private:
+  uint32_t m_numRows; //!< number of rx antenna elements (U)
+  uint32_t m_numCols; //!< number of tx antenna elements (S)
+  uint32_t m_numClusters; //!< number of clusters (N)
+  std::vector<value_type, ThreeGppAlignedAllocator<value_type, ALIGNMENT> > m_data; //!< the coefficients, cluster-major
+};
+
+} // namespace ns3
+
+#endif /* THREE_GPP_CHANNEL_TENSOR_H */
@@ -28,7 +28,14 @@
 #include "ns3/double.h"
 #include "ns3/string.h"
 #include "ns3/integer.h"
+#include "ns3/uinteger.h"
+#include "ns3/enum.h"
+#include "ns3/pointer.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/system-thread.h"
+#include "ns3/open-addressing-hash-table.h"
 #include <algorithm>
+#include <thread>
 #include <random>
 #include "ns3/log.h"
 #include <ns3/simulator.h>
@@ -150,9 +157,86 @@ static const double sqrtC_office_NLOS[6][6] = {
   {-0.1, -0.173205, 0.315691, -0.134243, 0.283816, 0.872792},
 };
 
+/**
+ * Estimates the memory owned by a channel matrix
+ * \param channel the channel matrix
+ * \return the size in bytes
+ */
+static uint64_t
+GetChannelMatrixSize (const Ptr<ThreeGppChannelMatrix> &channel)
+{
+  uint64_t size = sizeof (ThreeGppChannelMatrix);
+  size += static_cast<uint64_t> (channel->m_channel.GetNumRows ()) * channel->m_channel.GetNumCols ()
+    * channel->m_channel.GetNumClusters () * sizeof (std::complex<double>);
+  size += channel->m_delayResponse.capacity () * sizeof (std::complex<double>);
+  size += channel->m_delay.capacity () * sizeof (double);
+  for (const doubleVector_t &angle : channel->m_angle)
+    {
+      size += angle.capacity () * sizeof (double);
+    }
+  return size;
+}
+
+ThreeGppChannel::ChannelRng::ChannelRng (Ptr<UniformRandomVariable> uniformRv, Ptr<NormalRandomVariable> normalRv)
+  : m_uniformRv (uniformRv),
+    m_normalRv (normalRv),
+    m_stream (1, 0, 0),
+    m_nextValid (false),
+    m_next (0)
+{
+}
+
+ThreeGppChannel::ChannelRng::ChannelRng (uint32_t seed, uint64_t stream, uint64_t substream)
+  : m_stream (seed, stream, substream),
+    m_nextValid (false),
+    m_next (0)
+{
+}
+
+double
+ThreeGppChannel::ChannelRng::GetUniform (double min, double max)
+{
+  if (m_uniformRv != 0)
+    {
+      return m_uniformRv->GetValue (min, max);
+    }
+  return min + m_stream.RandU01 () * (max - min);
+}
+
+double
+ThreeGppChannel::ChannelRng::GetNormal ()
+{
+  if (m_normalRv != 0)
+    {
+      return m_normalRv->GetValue ();
+    }
+  // polar method, as in NormalRandomVariable
+  if (m_nextValid)
+    {
+      m_nextValid = false;
+      return m_next;
+    }
+  while (true)
+    {
+      double v1 = 2 * m_stream.RandU01 () - 1;
+      double v2 = 2 * m_stream.RandU01 () - 1;
+      double w = v1 * v1 + v2 * v2;
+      if (w <= 1.0 && w > 0)
+        {
+          double y = sqrt ((-2 * log (w)) / w);
+          m_next = v2 * y;
+          m_nextValid = true;
+          return v1 * y;
+        }
+    }
+}
+
 ThreeGppChannel::ThreeGppChannel ()
+  : m_parallelUpdate (false),
+    m_updateThreads (0)
 {
   NS_LOG_FUNCTION (this);
+  m_channelMap.SetSizeFunction (&GetChannelMatrixSize);
   m_uniformRv = CreateObject<UniformRandomVariable> ();
 
   m_normalRv = CreateObject<NormalRandomVariable> ();
@@ -165,6 +249,16 @@ ThreeGppChannel::~ThreeGppChannel ()
   NS_LOG_FUNCTION (this);
 }
 
+void
+ThreeGppChannel::DoDispose ()
+{
+  NS_LOG_FUNCTION (this);
+  m_updateEvent.Cancel ();
+  // the matrices may hold the mobility models and the antennas of the nodes
+  m_channelMap.Clear ();
+  Object::DoDispose ();
+}
+
 TypeId
 ThreeGppChannel::GetTypeId (void)
 {
@@ -208,10 +302,104 @@ ThreeGppChannel::GetTypeId (void)
                    DoubleValue (1),
                    MakeDoubleAccessor (&ThreeGppChannel::m_blockerSpeed),
                    MakeDoubleChecker<double> ())
+    .AddAttribute ("ChannelCacheCapacity",
+                   "The maximum number of channel matrices stored in the cache, 0 means unbounded. "
+                   "When full, the least recently used matrix is evicted, and a new realization "
+                   "is generated the next time the link is evaluated.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&ThreeGppChannel::SetChannelCacheCapacity,
+                                         &ThreeGppChannel::GetChannelCacheCapacity),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("ChannelCacheEvictionPolicy",
+                   "The eviction policy of the channel cache. With Generation, the matrices not "
+                   "used during the current or the previous update period, which would be "
+                   "regenerated anyway, are evicted.",
+                   EnumValue (BoundedCacheBase::LRU),
+                   MakeEnumAccessor (&ThreeGppChannel::SetChannelCacheEvictionPolicy,
+                                     &ThreeGppChannel::GetChannelCacheEvictionPolicy),
+                   MakeEnumChecker (BoundedCacheBase::LRU, "Lru",
+                                    BoundedCacheBase::GENERATION, "Generation"))
+    .AddAttribute ("ChannelCacheStatistics",
+                   "The counters of the channel cache",
+                   TypeId::ATTR_GET,
+                   PointerValue (),
+                   MakePointerAccessor (&ThreeGppChannel::GetChannelCacheStatistics),
+                   MakePointerChecker<BoundedCacheStatistics> ())
+    .AddAttribute ("ParallelUpdate",
+                   "If true, the channel matrices are regenerated at the multiples of the "
+                   "UpdatePeriod by a pool of worker threads, instead of when they are first "
+                   "used after the end of the period. Only the matrices used during the last "
+                   "period are regenerated in parallel, the other ones are regenerated when used. "
+                   "Each generation draws from a random substream determined by the link and "
+                   "the generation time, hence the realizations do not depend on the number of "
+                   "threads, but differ from the ones obtained with this option disabled.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&ThreeGppChannel::m_parallelUpdate),
+                   MakeBooleanChecker ())
+    .AddAttribute ("UpdateThreads",
+                   "The number of worker threads of the parallel update, 0 means one per core",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&ThreeGppChannel::m_updateThreads),
+                   MakeUintegerChecker<uint32_t> ())
     ;
   return tid;
 }
 
+Time
+ThreeGppChannel::GetUpdatePeriod () const
+{
+  return m_updatePeriod;
+}
+
+void
+ThreeGppChannel::SetChannelCacheCapacity (uint32_t capacity)
+{
+  m_channelMap.SetCapacity (capacity);
+}
+
+uint32_t
+ThreeGppChannel::GetChannelCacheCapacity () const
+{
+  return m_channelMap.GetCapacity ();
+}
+
+void
+ThreeGppChannel::SetChannelCacheEvictionPolicy (BoundedCacheBase::EvictionPolicy policy)
+{
+  m_channelMap.SetEvictionPolicy (policy);
+}
+
+BoundedCacheBase::EvictionPolicy
+ThreeGppChannel::GetChannelCacheEvictionPolicy () const
+{
+  return m_channelMap.GetEvictionPolicy ();
+}
+
+Ptr<BoundedCacheStatistics>
+ThreeGppChannel::GetChannelCacheStatistics () const
+{
+  return m_channelMap.GetStatistics ();
+}
+
+int64_t
+ThreeGppChannel::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_uniformRv->SetStream (stream);
+  m_normalRv->SetStream (stream + 1);
+  return 2;
+}
+
+uint32_t
+ThreeGppChannel::GetNumUpdateThreads () const
+{
+  if (m_updateThreads != 0)
+    {
+      return m_updateThreads;
+    }
+  return std::max (std::thread::hardware_concurrency (), 1u);
+}
+
 Ptr<ParamsTable>
 ThreeGppChannel::Get3gppTable (bool los, bool o2i, double hBS, double hUT, double distance2D) const
 {
@@ -607,8 +795,17 @@ ThreeGppChannel::ChannelMatrixNeedsUpdate (Ptr<ThreeGppChannelMatrix> channelMat
     update = true;
   }
 
-  // if the coherence time is over the channel has to be updated
-  if (m_updatePeriod.GetNanoSeconds () != 0.0 && Simulator::Now().GetNanoSeconds () - channelMatrix->m_generatedTime.GetNanoSeconds () >= m_updatePeriod.GetNanoSeconds ())
+  // if the coherence time is over the channel has to be updated. With the
+  // parallel update, the periods are aligned to the multiples of m_updatePeriod
+  if (m_parallelUpdate && m_updatePeriod.GetNanoSeconds () != 0.0)
+  {
+    if (static_cast<uint64_t> (channelMatrix->m_generatedTime.GetTimeStep () / m_updatePeriod.GetTimeStep ()) < BoundedCacheBase::GetGenerationAt (m_updatePeriod))
+    {
+      NS_LOG_DEBUG ("Update triggered: Generation time " << channelMatrix->m_generatedTime.GetNanoSeconds () << " now " << Simulator::Now ().GetNanoSeconds ());
+      update = true;
+    }
+  }
+  else if (m_updatePeriod.GetNanoSeconds () != 0.0 && Simulator::Now().GetNanoSeconds () - channelMatrix->m_generatedTime.GetNanoSeconds () >= m_updatePeriod.GetNanoSeconds ())
   {
     NS_LOG_DEBUG ("Update triggered: Generation time " << channelMatrix->m_generatedTime.GetNanoSeconds () << " now " << Simulator::Now ().GetNanoSeconds ());
     update = true;
@@ -630,11 +827,19 @@ ThreeGppChannel::GetChannel (Ptr<const MobilityModel> a, Ptr<const MobilityModel
   bool update = false;
   bool notFound = false;
   Ptr<ThreeGppChannelMatrix> channelMatrix;
-  if (m_channelMap.find (channelId) != m_channelMap.end ())
+
+  // the channel matrices which were not used during the last update period
+  // would be updated anyway, hence they can be evicted
+  m_channelMap.SetGeneration (BoundedCacheBase::GetGenerationAt (m_updatePeriod));
+
+  // look for the matrix generated for this link, or for the reverse link
+  bool isReverse = !m_channelMap.Contains (channelId);
+  Ptr<ThreeGppChannelMatrix> *cachedMatrix = m_channelMap.Find (isReverse ? channelIdReverse : channelId);
+  if (cachedMatrix != 0 && !isReverse)
   {
     // channel matrix present in the map
     NS_LOG_DEBUG ("channel matrix with ID "<<channelId<<" is present in the map");
-    channelMatrix = m_channelMap.at (channelId);
+    channelMatrix = *cachedMatrix;
 
     // the channel matrix was generated for this link
     channelMatrix->m_isReverse = false;
@@ -642,11 +847,11 @@ ThreeGppChannel::GetChannel (Ptr<const MobilityModel> a, Ptr<const MobilityModel
     // check if it has to be updated
     update = ChannelMatrixNeedsUpdate (channelMatrix, los);
   }
-  else if (m_channelMap.find (channelIdReverse) != m_channelMap.end ())
+  else if (cachedMatrix != 0)
   {
     // channel matrix for the reverse link present in the map
     NS_LOG_DEBUG ("channel matrix with ID "<<channelId<<" for the reverse link  with ID "<<channelIdReverse<<" present in the map");
-    channelMatrix = m_channelMap.at (channelIdReverse);
+    channelMatrix = *cachedMatrix;
 
     // the channel matrix was generated for the reverse link
     channelMatrix->m_isReverse = true;
@@ -664,45 +869,263 @@ ThreeGppChannel::GetChannel (Ptr<const MobilityModel> a, Ptr<const MobilityModel
   // generate a new channel
   if (notFound || update)
   {
-    // channel matrix not found, generate a new one
-    Angles txAngle (b->GetPosition (), a->GetPosition ());
-    Angles rxAngle (a->GetPosition (), b->GetPosition ());
+    ChannelGenerationJob job = PrepareChannelGeneration (a, b, txAntenna, rxAntenna, los, o2i);
+    RunChannelGeneration (job);
+    channelMatrix = job.m_result;
 
-    double x = a->GetPosition ().x - b->GetPosition ().x;
-    double y = a->GetPosition ().y - b->GetPosition ().y;
-    double distance2D = sqrt (x * x + y * y);
+    if (m_parallelUpdate)
+    {
+      // store the link, so that the matrix can be regenerated at the
+      // next update boundary
+      channelMatrix->m_txMobility = a;
+      channelMatrix->m_rxMobility = b;
+      channelMatrix->m_txAntenna = txAntenna;
+      channelMatrix->m_rxAntenna = rxAntenna;
+    }
 
-    // TODO I need to know hUT. I assume hUT = min (height(a), hieght(b))
-    double hUt = std::min (a->GetPosition ().z, b->GetPosition ().z);
-    double hBs = std::max (a->GetPosition ().z, b->GetPosition ().z);
+    // store the channel matrix in the channel map
+    m_channelMap.Insert (channelId, channelMatrix);
+    //if we arrive to an update scenario from an "expired" matrix that was generated in reverse form, we must delete the old reversed data in the map
+    m_channelMap.Erase (channelIdReverse);
+  }
 
-    // TODO this is not currently used, it is needed for the computation of the
-    // additional blockage in case of spatial consistent update
-    // I do not know who is the UT, I can use the relative distance between
-    // tx and rx instead
-    Vector locUt = Vector (0.0, 0.0, 0.0);
+  if (m_parallelUpdate && !m_updatePeriod.IsZero () && !m_updateEvent.IsRunning ())
+  {
+    ScheduleChannelUpdate ();
+  }
 
-    channelMatrix = GetNewChannel (locUt, los, o2i, txAntenna, rxAntenna, rxAngle, txAngle, distance2D, hBs, hUt);
+  return channelMatrix;
+}
 
-    // initialize the m_isReverse indicator
-    channelMatrix->m_isReverse = false;
+Ptr<ThreeGppChannelMatrix>
+ThreeGppChannel::PeekChannel (Ptr<const MobilityModel> a, Ptr<const MobilityModel> b, bool &isReverse)
+{
+  uint32_t channelId = GetKey (a->GetObject<Node> ()->GetId (), b->GetObject<Node> ()->GetId ());
+  uint32_t channelIdReverse = GetKey (b->GetObject<Node> ()->GetId (), a->GetObject<Node> ()->GetId ());
 
-    // store the channel matrix in the channel map
-    m_channelMap[channelId] = channelMatrix;
-    if ( m_channelMap .find (channelIdReverse) != m_channelMap .end () )
-      { //if we arrive to an update scenario from an "expired" matrix that was generated in reverse form, we must delete the old reversed data in the map
-        m_channelMap .erase ( channelIdReverse ) ;
+  // same lookup as GetChannel
+  isReverse = !m_channelMap.Contains (channelId);
+  Ptr<ThreeGppChannelMatrix> *cachedMatrix = m_channelMap.Peek (isReverse ? channelIdReverse : channelId);
+  if (cachedMatrix == 0 || ChannelMatrixNeedsUpdate (*cachedMatrix, (*cachedMatrix)->m_los))
+    {
+      return 0;
+    }
+  return *cachedMatrix;
+}
+
+ThreeGppChannel::ChannelGenerationJob
+ThreeGppChannel::PrepareChannelGeneration (Ptr<const MobilityModel> a, Ptr<const MobilityModel> b,
+                                           Ptr<AntennaArrayBasicModel> txAntenna, Ptr<AntennaArrayBasicModel> rxAntenna,
+                                           bool los, bool o2i) const
+{
+  uint32_t channelId = GetKey (a->GetObject<Node> ()->GetId (), b->GetObject<Node> ()->GetId ());
+
+  ChannelRng rng (m_uniformRv, m_normalRv);
+  if (m_parallelUpdate)
+    {
+      // draw from a substream identified by the run, the link and the
+      // generation time, so that the realization does not depend on the
+      // order of the generations nor on the thread running them. The stream
+      // of m_uniformRv is not used otherwise in this case. There are 2^51
+      // substreams in a stream.
+      uint64_t substream = MixHash (MixHash (MixHash (RngSeedManager::GetRun ()) ^ channelId)
+                                    ^ static_cast<uint64_t> (Simulator::Now ().GetTimeStep ()));
+      rng = ChannelRng (RngSeedManager::GetSeed (), m_uniformRv->GetStream (), substream & ((1ULL << 51) - 1));
+    }
+
+  Angles txAngle (b->GetPosition (), a->GetPosition ());
+  Angles rxAngle (a->GetPosition (), b->GetPosition ());
+
+  double x = a->GetPosition ().x - b->GetPosition ().x;
+  double y = a->GetPosition ().y - b->GetPosition ().y;
+  double distance2D = sqrt (x * x + y * y);
+
+  // TODO I need to know hUT. I assume hUT = min (height(a), hieght(b))
+  double hUt = std::min (a->GetPosition ().z, b->GetPosition ().z);
+  double hBs = std::max (a->GetPosition ().z, b->GetPosition ().z);
+
+  ChannelGenerationJob job = {channelId, los, o2i, txAntenna, rxAntenna, rxAngle, txAngle,
+                              distance2D, hBs, hUt, rng, 0};
+  return job;
+}
+
+void
+ThreeGppChannel::RunChannelGeneration (ChannelGenerationJob &job) const
+{
+  // TODO this is not currently used, it is needed for the computation of the
+  // additional blockage in case of spatial consistent update
+  // I do not know who is the UT, I can use the relative distance between
+  // tx and rx instead
+  Vector locUt = Vector (0.0, 0.0, 0.0);
+
+  job.m_result = GetNewChannel (locUt, job.m_los, job.m_o2i, job.m_txAntenna, job.m_rxAntenna,
+                                job.m_rxAngle, job.m_txAngle, job.m_dis2D, job.m_hBs, job.m_hUt, job.m_rng);
+
+  // initialize the m_isReverse indicator
+  job.m_result->m_isReverse = false;
+}
+
+void
+ThreeGppChannel::ChannelGenerationWorker::Run ()
+{
+  for (std::size_t i = m_first; i < m_jobs->size (); i += m_step)
+    {
+      m_channel->RunChannelGeneration ((*m_jobs)[i]);
+    }
+}
+
+void
+ThreeGppChannel::ScheduleChannelUpdate ()
+{
+  uint64_t nextGeneration = BoundedCacheBase::GetGenerationAt (m_updatePeriod) + 1;
+  Time delay = TimeStep (nextGeneration * m_updatePeriod.GetTimeStep ()) - Simulator::Now ();
+  m_updateEvent = Simulator::Schedule (delay, &ThreeGppChannel::UpdateChannels, this);
+}
+
+void
+ThreeGppChannel::UpdateChannels ()
+{
+  NS_LOG_FUNCTION (this);
+
+  // evict the matrices which are too old, if the policy requires it
+  uint64_t generation = BoundedCacheBase::GetGenerationAt (m_updatePeriod);
+  m_channelMap.SetGeneration (generation);
+
+  // the links are read on the simulation thread, the mobility models may
+  // update their state when queried
+  std::vector<ChannelGenerationJob> jobs;
+  m_channelMap.ForEach ([this, generation, &jobs] (uint32_t channelId, const Ptr<ThreeGppChannelMatrix> &matrix, uint64_t lastAccess)
+  {
+    if (lastAccess + 1 >= generation && matrix->m_txMobility != 0 && ChannelMatrixNeedsUpdate (matrix, matrix->m_los))
+      {
+        jobs.push_back (PrepareChannelGeneration (matrix->m_txMobility, matrix->m_rxMobility,
+                                                  matrix->m_txAntenna, matrix->m_rxAntenna,
+                                                  matrix->m_los, matrix->m_o2i));
       }
-  }
+  });
+  NS_LOG_DEBUG ("Regenerating " << jobs.size () << " channel matrices");
+
+  // the simulation thread waits for the workers, which only read the
+  // configuration of this object and the jobs they are assigned
+  uint32_t numThreads = std::max<std::size_t> (std::min<std::size_t> (GetNumUpdateThreads (), jobs.size ()), 1);
+  std::vector<ChannelGenerationWorker> workers (numThreads);
+  for (uint32_t i = 0; i < numThreads; i++)
+    {
+      workers[i].m_channel = this;
+      workers[i].m_jobs = &jobs;
+      workers[i].m_first = i;
+      workers[i].m_step = numThreads;
+    }
+  if (numThreads > 1)
+    {
+      std::vector<Ptr<SystemThread> > threads;
+      for (ChannelGenerationWorker &worker : workers)
+        {
+          threads.push_back (Create<SystemThread> (MakeCallback (&ChannelGenerationWorker::Run, &worker)));
+          threads.back ()->Start ();
+        }
+      for (Ptr<SystemThread> thread : threads)
+        {
+          thread->Join ();
+        }
+    }
+  else
+    {
+      workers[0].Run ();
+    }
 
-  return channelMatrix;
+  // store the new matrices, without marking them as used
+  for (ChannelGenerationJob &job : jobs)
+    {
+      Ptr<ThreeGppChannelMatrix> *oldMatrix = m_channelMap.Peek (job.m_channelId);
+      job.m_result->m_txMobility = (*oldMatrix)->m_txMobility;
+      job.m_result->m_rxMobility = (*oldMatrix)->m_rxMobility;
+      job.m_result->m_txAntenna = (*oldMatrix)->m_txAntenna;
+      job.m_result->m_rxAntenna = (*oldMatrix)->m_rxAntenna;
+      m_channelMap.Replace (job.m_channelId, job.m_result);
+    }
+
+  if (m_channelMap.GetSize () > 0)
+    {
+      ScheduleChannelUpdate ();
+    }
+}
+
+/**
+ * Compute the steering vector of an antenna array for a given direction,
+ * i.e., gain * exp (j (phase + 2 pi r . loc)) for each antenna element, where
+ * r is the unit vector pointing in the direction (theta, phi)
+ * \param steering the vector where the result is stored, its size must be
+ *        equal to the number of antenna elements
+ * \param loc the location of the antenna elements, normalized to the wavelength
+ * \param theta the zenith angle in radians
+ * \param phi the azimuth angle in radians
+ * \param gain the radiation pattern of the antenna element in this direction
+ * \param phase a phase offset common to all the antenna elements
+ */
+static void
+ComputeSteeringVector (complexVector_t &steering, const std::vector<Vector> &loc,
+                       double theta, double phi, double gain, double phase)
+{
+  double rx = sin (theta) * cos (phi);
+  double ry = sin (theta) * sin (phi);
+  double rz = cos (theta);
+  for (std::size_t i = 0; i < loc.size (); i++)
+    {
+      double phaseDiff = phase + 2 * M_PI * (rx * loc[i].x + ry * loc[i].y + rz * loc[i].z);
+      steering[i] = std::complex<double> (gain * cos (phaseDiff), gain * sin (phaseDiff));
+    }
+}
+
+/**
+ * Accumulate the outer product rxSteering txSteering^T in the slice of a
+ * cluster of the channel tensor
+ * \param h the channel tensor
+ * \param nIndex the cluster index
+ * \param rxSteering the rx steering vector (one entry for each row of h)
+ * \param txSteering the tx steering vector (one entry for each column of h)
+ */
+static void
+AddOuterProduct (ThreeGppChannelTensor &h, uint32_t nIndex,
+                 const complexVector_t &rxSteering, const complexVector_t &txSteering)
+{
+  uint32_t numCols = h.GetNumCols ();
+  for (uint32_t uIndex = 0; uIndex < h.GetNumRows (); uIndex++)
+    {
+      std::complex<double> rxCoeff = rxSteering[uIndex];
+      std::complex<double> *row = &h (uIndex, 0, nIndex);
+      for (uint32_t sIndex = 0; sIndex < numCols; sIndex++)
+        {
+          row[sIndex] += rxCoeff * txSteering[sIndex];
+        }
+    }
+}
+
+/**
+ * Multiply all the coefficients of a cluster of the channel tensor by a
+ * scalar
+ * \param h the channel tensor
+ * \param nIndex the cluster index
+ * \param scale the scaling factor
+ */
+static void
+ScaleCluster (ThreeGppChannelTensor &h, uint32_t nIndex, double scale)
+{
+  for (uint32_t uIndex = 0; uIndex < h.GetNumRows (); uIndex++)
+    {
+      std::complex<double> *row = &h (uIndex, 0, nIndex);
+      for (uint32_t sIndex = 0; sIndex < h.GetNumCols (); sIndex++)
+        {
+          row[sIndex] *= scale;
+        }
+    }
 }
 
 Ptr<ThreeGppChannelMatrix>
 ThreeGppChannel::GetNewChannel (Vector locUT, bool los, bool o2i,
-                                Ptr<AntennaArrayBasicModel> txAntenna, Ptr<AntennaArrayBasicModel> rxAntenna,
+                                const Ptr<AntennaArrayBasicModel> &txAntenna, const Ptr<AntennaArrayBasicModel> &rxAntenna,
                                 Angles &rxAngle, Angles &txAngle,
-                                double dis2D, double hBS, double hUT) const
+                                double dis2D, double hBS, double hUT, ChannelRng &rng) const
 {
   NS_ASSERT_MSG (m_frequency != 0, "Set the operating frequency first!");
 
@@ -737,7 +1160,7 @@ ThreeGppChannel::GetNewChannel (Vector locUT, bool los, bool o2i,
   //Generate paramNum independent LSPs.
   for (uint8_t iter = 0; iter < paramNum; iter++)
     {
-      LSPsIndep.push_back (m_normalRv->GetValue ());
+      LSPsIndep.push_back (rng.GetNormal ());
     }
   for (uint8_t row = 0; row < paramNum; row++)
     {
@@ -785,7 +1208,7 @@ ThreeGppChannel::GetNewChannel (Vector locUT, bool los, bool o2i,
   double minTau = 100.0;
   for (uint8_t cIndex = 0; cIndex < numOfCluster; cIndex++)
     {
-      double tau = -1*table3gpp->m_rTau*DS*log (m_uniformRv->GetValue (0,1)); //(7.5-1)
+      double tau = -1*table3gpp->m_rTau*DS*log (rng.GetUniform (0,1)); //(7.5-1)
       if (minTau > tau)
         {
           minTau = tau;
@@ -808,7 +1231,7 @@ ThreeGppChannel::GetNewChannel (Vector locUT, bool los, bool o2i,
   for (uint8_t cIndex = 0; cIndex < numOfCluster; cIndex++)
     {
       double power = exp (-1 * clusterDelay.at (cIndex) * (table3gpp->m_rTau - 1) / table3gpp->m_rTau / DS) *
-        pow (10,-1 * m_normalRv->GetValue () * table3gpp->m_shadowingStd / 10);                       //(7.5-5)
+        pow (10,-1 * rng.GetNormal () * table3gpp->m_shadowingStd / 10);                       //(7.5-5)
       powerSum += power;
       clusterPower.push_back (power);
     }
@@ -982,21 +1405,21 @@ ThreeGppChannel::GetNewChannel (Vector locUT, bool los, bool o2i,
   for (uint8_t cIndex = 0; cIndex < numReducedCluster; cIndex++)
     {
       int Xn = 1;
-      if (m_uniformRv->GetValue (0,1) < 0.5)
+      if (rng.GetUniform (0,1) < 0.5)
         {
           Xn = -1;
         }
-      clusterAoa.at (cIndex) = clusterAoa.at (cIndex) * Xn + (m_normalRv->GetValue () * ASA / 7) + rxAngle.phi * 180 / M_PI;        //(7.5-11)
-      clusterAod.at (cIndex) = clusterAod.at (cIndex) * Xn + (m_normalRv->GetValue () * ASD / 7) + txAngle.phi * 180 / M_PI;
+      clusterAoa.at (cIndex) = clusterAoa.at (cIndex) * Xn + (rng.GetNormal () * ASA / 7) + rxAngle.phi * 180 / M_PI;        //(7.5-11)
+      clusterAod.at (cIndex) = clusterAod.at (cIndex) * Xn + (rng.GetNormal () * ASD / 7) + txAngle.phi * 180 / M_PI;
       if (o2i)
         {
-          clusterZoa.at (cIndex) = clusterZoa.at (cIndex) * Xn + (m_normalRv->GetValue () * ZSA / 7) + 90;            //(7.5-16)
+          clusterZoa.at (cIndex) = clusterZoa.at (cIndex) * Xn + (rng.GetNormal () * ZSA / 7) + 90;            //(7.5-16)
         }
       else
         {
-          clusterZoa.at (cIndex) = clusterZoa.at (cIndex) * Xn + (m_normalRv->GetValue () * ZSA / 7) + rxAngle.theta * 180 / M_PI;            //(7.5-16)
+          clusterZoa.at (cIndex) = clusterZoa.at (cIndex) * Xn + (rng.GetNormal () * ZSA / 7) + rxAngle.theta * 180 / M_PI;            //(7.5-16)
         }
-      clusterZod.at (cIndex) = clusterZod.at (cIndex) * Xn + (m_normalRv->GetValue () * ZSD / 7) + txAngle.theta * 180 / M_PI + table3gpp->m_offsetZOD;        //(7.5-19)
+      clusterZod.at (cIndex) = clusterZod.at (cIndex) * Xn + (rng.GetNormal () * ZSD / 7) + txAngle.theta * 180 / M_PI + table3gpp->m_offsetZOD;        //(7.5-19)
 
     }
 
@@ -1158,7 +1581,7 @@ ThreeGppChannel::GetNewChannel (Vector locUT, bool los, bool o2i,
   doubleVector_t attenuation_dB;
   if (m_blockage)
     {
-      attenuation_dB = CalAttenuationOfBlockage (channelParams, clusterAoa, clusterZoa);
+      attenuation_dB = CalAttenuationOfBlockage (channelParams, clusterAoa, clusterZoa, rng);
       for (uint8_t cInd = 0; cInd < numReducedCluster; cInd++)
         {
           clusterPower.at (cInd) = clusterPower.at (cInd) / pow (10,attenuation_dB.at (cInd) / 10);
@@ -1189,11 +1612,11 @@ ThreeGppChannel::GetNewChannel (Vector locUT, bool los, bool o2i,
       doubleVector_t temp;
       for (uint8_t mInd = 0; mInd < raysPerCluster; mInd++)
         {
-          temp.push_back (m_uniformRv->GetValue (-1 * M_PI, M_PI));
+          temp.push_back (rng.GetUniform (-1 * M_PI, M_PI));
         }
       clusterPhase.push_back (temp);
     }
-  double losPhase = m_uniformRv->GetValue (-1 * M_PI, M_PI);
+  double losPhase = rng.GetUniform (-1 * M_PI, M_PI);
   channelParams->m_clusterPhase = clusterPhase;
   channelParams->m_losPhase = losPhase;
 
@@ -1227,166 +1650,105 @@ ThreeGppChannel::GetNewChannel (Vector locUT, bool los, bool o2i,
 
   NS_LOG_INFO ("1st strongest cluster:" << (int)cluster1st << ", 2nd strongest cluster:" << (int)cluster2nd);
 
-  complex3DVector_t H_usn;  //channel coffecient H_usn[u][s][n];
   // NOTE Since each of the strongest 2 clusters are divided into 3 sub-clusters,
-  // the total cluster will be numReducedCLuster + 4.
-
-  H_usn.resize (uSize);
+  // the total cluster will be numReducedCLuster + 4 (or numReducedCluster + 2
+  // if a single strong cluster exists).
+  // The sub-clusters are stored after the numReducedCluster clusters, in the
+  // same order in which their delays and angles are appended below.
+  uint8_t numTotalCluster = numReducedCluster + (cluster1st == cluster2nd ? 2 : 4);
+  ThreeGppChannelTensor &H_usn = channelParams->m_channel;  //channel coffecient H_usn[u][s][n];
+  H_usn.Resize (uSize, sSize, numTotalCluster);
+
+  // The contribution of each ray to H_usn factorizes in the product of a
+  // term which depends on the rx antenna element only and a term which
+  // depends on the tx antenna element only (7.5-22), (7.5-28). Hence, for
+  // each ray we compute the rx and tx steering vectors (including the
+  // radiation pattern and the initial phase) and we accumulate their outer
+  // product in H_usn. This way the trigonometric functions are evaluated
+  // O((U+S)NM) times instead of O(USNM).
+  std::vector<Vector> uLoc (uSize);
   for (uint64_t uIndex = 0; uIndex < uSize; uIndex++)
     {
-      H_usn.at (uIndex).resize (sSize);
-      for (uint64_t sIndex = 0; sIndex < sSize; sIndex++)
-        {
-          H_usn.at (uIndex).at (sIndex).resize (numReducedCluster);
-        }
+      uLoc[uIndex] = rxAntenna->GetAntennaLocation (uIndex);
     }
-
-  // The following for loops computes the channel coefficients
-  for (uint64_t uIndex = 0; uIndex < uSize; uIndex++)
+  std::vector<Vector> sLoc (sSize);
+  for (uint64_t sIndex = 0; sIndex < sSize; sIndex++)
     {
-      Vector uLoc = rxAntenna->GetAntennaLocation (uIndex);
+      sLoc[sIndex] = txAntenna->GetAntennaLocation (sIndex);
+    }
 
-      for (uint64_t sIndex = 0; sIndex < sSize; sIndex++)
+  complexVector_t rxSteering (uSize); // rx steering vector of the current ray
+  complexVector_t txSteering (sSize); // tx steering vector of the current ray
+  uint8_t subClusterIndex = numReducedCluster; // position of the next sub-cluster
+  for (uint8_t nIndex = 0; nIndex < numReducedCluster; nIndex++)
+    {
+      bool isStrongCluster = (nIndex == cluster1st || nIndex == cluster2nd);
+      for (uint8_t mIndex = 0; mIndex < raysPerCluster; mIndex++)
         {
-
-          Vector sLoc = txAntenna->GetAntennaLocation (sIndex);
-
-          for (uint8_t nIndex = 0; nIndex < numReducedCluster; nIndex++)
+          //lambda_0 is accounted in the antenna spacing uLoc and sLoc.
+          //Doppler is computed in the CalBeamformingGain function and is simplified to only account for the center anngle of each cluster.
+          ComputeSteeringVector (rxSteering, uLoc, rayZoa_radian[nIndex][mIndex], rayAoa_radian[nIndex][mIndex],
+                                 rxAntenna->GetRadiationPattern (rayZoa_radian[nIndex][mIndex], rayAoa_radian[nIndex][mIndex]), 0.0);
+          ComputeSteeringVector (txSteering, sLoc, rayZod_radian[nIndex][mIndex], rayAod_radian[nIndex][mIndex],
+                                 txAntenna->GetRadiationPattern (rayZod_radian[nIndex][mIndex], rayAod_radian[nIndex][mIndex]),
+                                 clusterPhase.at (nIndex).at (mIndex));
+
+          // for the 2 strongest clusters, select the sub-cluster of this ray (7.5-28)
+          uint8_t targetIndex = nIndex;
+          if (isStrongCluster)
             {
-              //Compute the N-2 weakest cluster, only vertical polarization. (7.5-22)
-              if (nIndex != cluster1st && nIndex != cluster2nd)
+              switch (mIndex)
                 {
-                  std::complex<double> rays (0,0);
-                  for (uint8_t mIndex = 0; mIndex < raysPerCluster; mIndex++)
-                    {
-                      double initialPhase = clusterPhase.at (nIndex).at (mIndex);
-                      //lambda_0 is accounted in the antenna spacing uLoc and sLoc.
-                      double rxPhaseDiff = 2 * M_PI * (sin (rayZoa_radian[nIndex][mIndex]) * cos (rayAoa_radian[nIndex][mIndex]) * uLoc.x
-                                                       + sin (rayZoa_radian[nIndex][mIndex]) * sin (rayAoa_radian[nIndex][mIndex]) * uLoc.y
-                                                       + cos (rayZoa_radian[nIndex][mIndex]) * uLoc.z);
-
-                      double txPhaseDiff = 2 * M_PI * (sin (rayZod_radian[nIndex][mIndex]) * cos (rayAod_radian[nIndex][mIndex]) * sLoc.x
-                                                       + sin (rayZod_radian[nIndex][mIndex]) * sin (rayAod_radian[nIndex][mIndex]) * sLoc.y
-                                                       + cos (rayZod_radian[nIndex][mIndex]) * sLoc.z);
-                      //Doppler is computed in the CalBeamformingGain function and is simplified to only account for the center anngle of each cluster.
-                      //double doppler = 2*M_PI*(sin(rayZoa_radian[nIndex][mIndex])*cos(rayAoa_radian[nIndex][mIndex])*relativeSpeed.x
-                      //		+ sin(rayZoa_radian[nIndex][mIndex])*sin(rayAoa_radian[nIndex][mIndex])*relativeSpeed.y
-                      //		+ cos(rayZoa_radian[nIndex][mIndex])*relativeSpeed.z)*slotTime*m_frequency/3e8;
-                      rays += exp (std::complex<double> (0, initialPhase))
-                        * (rxAntenna->GetRadiationPattern (rayZoa_radian[nIndex][mIndex],rayAoa_radian[nIndex][mIndex])
-                           * txAntenna->GetRadiationPattern (rayZod_radian[nIndex][mIndex],rayAod_radian[nIndex][mIndex]))
-                        * exp (std::complex<double> (0, rxPhaseDiff))
-                        * exp (std::complex<double> (0, txPhaseDiff));
-                      //*exp(std::complex<double>(0, doppler));
-                      //rays += 1;
-                    }
-                  //rays *= sqrt(clusterPower.at(nIndex))/raysPerCluster;
-                  rays *= sqrt (clusterPower.at (nIndex) / raysPerCluster);
-                  H_usn.at (uIndex).at (sIndex).at (nIndex) = rays;
+                case 9:
+                case 10:
+                case 11:
+                case 12:
+                case 17:
+                case 18:
+                  targetIndex = subClusterIndex;
+                  break;
+                case 13:
+                case 14:
+                case 15:
+                case 16:
+                  targetIndex = subClusterIndex + 1;
+                  break;
+                default:                        //case 1,2,3,4,5,6,7,8,19,20
+                  break;
                 }
-              else  //(7.5-28)
-                {
-                  std::complex<double> raysSub1 (0,0);
-                  std::complex<double> raysSub2 (0,0);
-                  std::complex<double> raysSub3 (0,0);
-
-                  for (uint8_t mIndex = 0; mIndex < raysPerCluster; mIndex++)
-                    {
+            }
+          AddOuterProduct (H_usn, targetIndex, rxSteering, txSteering);
+        }
 
-                      //ZML:Just remind me that the angle offsets for the 3 subclusters were not generated correctly.
-
-                      double initialPhase = clusterPhase.at (nIndex).at (mIndex);
-                      double rxPhaseDiff = 2 * M_PI * (sin (rayZoa_radian[nIndex][mIndex]) * cos (rayAoa_radian[nIndex][mIndex]) * uLoc.x
-                                                       + sin (rayZoa_radian[nIndex][mIndex]) * sin (rayAoa_radian[nIndex][mIndex]) * uLoc.y
-                                                       + cos (rayZoa_radian[nIndex][mIndex]) * uLoc.z);
-                      double txPhaseDiff = 2 * M_PI * (sin (rayZod_radian[nIndex][mIndex]) * cos (rayAod_radian[nIndex][mIndex]) * sLoc.x
-                                                       + sin (rayZod_radian[nIndex][mIndex]) * sin (rayAod_radian[nIndex][mIndex]) * sLoc.y
-                                                       + cos (rayZod_radian[nIndex][mIndex]) * sLoc.z);
-                      //double doppler = 2*M_PI*(sin(rayZoa_radian[nIndex][mIndex])*cos(rayAoa_radian[nIndex][mIndex])*relativeSpeed.x
-                      //		+ sin(rayZoa_radian[nIndex][mIndex])*sin(rayAoa_radian[nIndex][mIndex])*relativeSpeed.y
-                      //		+ cos(rayZoa_radian[nIndex][mIndex])*relativeSpeed.z)*slotTime*m_frequency/3e8;
-                      //double delaySpread;
-                      switch (mIndex)
-                        {
-                        case 9:
-                        case 10:
-                        case 11:
-                        case 12:
-                        case 17:
-                        case 18:
-                          //delaySpread= -2*M_PI*(clusterDelay.at(nIndex)+1.28*c_DS)*m_frequency;
-                          raysSub2 += exp (std::complex<double> (0, initialPhase))
-                            * (rxAntenna->GetRadiationPattern (rayZoa_radian[nIndex][mIndex],rayAoa_radian[nIndex][mIndex])
-                               * txAntenna->GetRadiationPattern (rayZod_radian[nIndex][mIndex],rayAod_radian[nIndex][mIndex]))
-                            * exp (std::complex<double> (0, rxPhaseDiff))
-                            * exp (std::complex<double> (0, txPhaseDiff));
-                          //*exp(std::complex<double>(0, doppler));
-                          //raysSub2 +=1;
-                          break;
-                        case 13:
-                        case 14:
-                        case 15:
-                        case 16:
-                          //delaySpread = -2*M_PI*(clusterDelay.at(nIndex)+2.56*c_DS)*m_frequency;
-                          raysSub3 += exp (std::complex<double> (0, initialPhase))
-                            * (rxAntenna->GetRadiationPattern (rayZoa_radian[nIndex][mIndex],rayAoa_radian[nIndex][mIndex])
-                               * txAntenna->GetRadiationPattern (rayZod_radian[nIndex][mIndex],rayAod_radian[nIndex][mIndex]))
-                            * exp (std::complex<double> (0, rxPhaseDiff))
-                            * exp (std::complex<double> (0, txPhaseDiff));
-                          //*exp(std::complex<double>(0, doppler));
-                          //raysSub3 +=1;
-                          break;
-                        default:                        //case 1,2,3,4,5,6,7,8,19,20
-                                                        //delaySpread = -2*M_PI*clusterDelay.at(nIndex)*m_frequency;
-                          raysSub1 += exp (std::complex<double> (0, initialPhase))
-                            * (rxAntenna->GetRadiationPattern (rayZoa_radian[nIndex][mIndex],rayAoa_radian[nIndex][mIndex])
-                               * txAntenna->GetRadiationPattern (rayZod_radian[nIndex][mIndex],rayAod_radian[nIndex][mIndex]))
-                            * exp (std::complex<double> (0, rxPhaseDiff))
-                            * exp (std::complex<double> (0, txPhaseDiff));
-                          //*exp(std::complex<double>(0, doppler));
-                          //raysSub1 +=1;
-                          break;
-                        }
-                    }
-                  raysSub1 *= sqrt (clusterPower.at (nIndex) / raysPerCluster);
-                  raysSub2 *= sqrt (clusterPower.at (nIndex) / raysPerCluster);
-                  raysSub3 *= sqrt (clusterPower.at (nIndex) / raysPerCluster);
-                  H_usn.at (uIndex).at (sIndex).at (nIndex) = raysSub1;
-                  H_usn.at (uIndex).at (sIndex).push_back (raysSub2);
-                  H_usn.at (uIndex).at (sIndex).push_back (raysSub3);
+      // normalize the cluster, only vertical polarization (7.5-22), (7.5-28)
+      double scale = sqrt (clusterPower.at (nIndex) / raysPerCluster);
+      ScaleCluster (H_usn, nIndex, scale);
+      if (isStrongCluster)
+        {
+          ScaleCluster (H_usn, subClusterIndex++, scale);
+          ScaleCluster (H_usn, subClusterIndex++, scale);
+        }
+    }
 
-                }
-            }
-          if (los) //(7.5-29) && (7.5-30)
-            {
-              std::complex<double> ray (0,0);
-              double rxPhaseDiff = 2 * M_PI * (sin (rxAngle.theta) * cos (rxAngle.phi) * uLoc.x
-                                               + sin (rxAngle.theta) * sin (rxAngle.phi) * uLoc.y
-                                               + cos (rxAngle.theta) * uLoc.z);
-              double txPhaseDiff = 2 * M_PI * (sin (txAngle.theta) * cos (txAngle.phi) * sLoc.x
-                                               + sin (txAngle.theta) * sin (txAngle.phi) * sLoc.y
-                                               + cos (txAngle.theta) * sLoc.z);
-              //double doppler = 2*M_PI*(sin(rxAngle.theta)*cos(rxAngle.phi)*relativeSpeed.x
-              //		+ sin(rxAngle.theta)*sin(rxAngle.phi)*relativeSpeed.y
-              //		+ cos(rxAngle.theta)*relativeSpeed.z)*slotTime*m_frequency/3e8;
-
-              ray = exp (std::complex<double> (0, losPhase))
-                * (rxAntenna->GetRadiationPattern (rxAngle.theta,rxAngle.phi)
-                   * txAntenna->GetRadiationPattern (txAngle.theta,rxAngle.phi))
-                * exp (std::complex<double> (0, rxPhaseDiff))
-                * exp (std::complex<double> (0, txPhaseDiff));
-              //*exp(std::complex<double>(0, doppler));
-
-              double K_linear = pow (10,K_factor / 10);
-              // the LOS path should be attenuated if blockage is enabled.
-              H_usn.at (uIndex).at (sIndex).at (0) = sqrt (1 / (K_linear + 1)) * H_usn.at (uIndex).at (sIndex).at (0) + sqrt (K_linear / (1 + K_linear)) * ray / pow (10,attenuation_dB.at (0) / 10);           //(7.5-30) for tau = tau1
-              double tempSize = H_usn.at (uIndex).at (sIndex).size ();
-              for (uint8_t nIndex = 1; nIndex < tempSize; nIndex++)
-                {
-                  H_usn.at (uIndex).at (sIndex).at (nIndex) *= sqrt (1 / (K_linear + 1)); //(7.5-30) for tau = tau2...taunN
-                }
+  if (los) //(7.5-29) && (7.5-30)
+    {
+      ComputeSteeringVector (rxSteering, uLoc, rxAngle.theta, rxAngle.phi,
+                             rxAntenna->GetRadiationPattern (rxAngle.theta,rxAngle.phi), 0.0);
+      ComputeSteeringVector (txSteering, sLoc, txAngle.theta, txAngle.phi,
+                             txAntenna->GetRadiationPattern (txAngle.theta,rxAngle.phi), losPhase);
 
-            }
+      double K_linear = pow (10,K_factor / 10);
+      // the LOS path should be attenuated if blockage is enabled.
+      ScaleCluster (H_usn, 0, sqrt (1 / (K_linear + 1)));
+      double losScale = sqrt (K_linear / (1 + K_linear)) / pow (10,attenuation_dB.at (0) / 10);
+      for (uint64_t sIndex = 0; sIndex < sSize; sIndex++)
+        {
+          txSteering[sIndex] *= losScale;
+        }
+      AddOuterProduct (H_usn, 0, rxSteering, txSteering); //(7.5-30) for tau = tau1
+      for (uint8_t nIndex = 1; nIndex < numTotalCluster; nIndex++)
+        {
+          ScaleCluster (H_usn, nIndex, sqrt (1 / (K_linear + 1))); //(7.5-30) for tau = tau2...taunN
         }
     }
 
@@ -1449,9 +1811,8 @@ ThreeGppChannel::GetNewChannel (Vector locUT, bool los, bool o2i,
 
     }
 
-  NS_LOG_INFO ("size of coefficient matrix =[" << H_usn.size () << "][" << H_usn.at (0).size () << "][" << H_usn.at (0).at (0).size () << "]");
+  NS_LOG_INFO ("size of coefficient matrix =[" << H_usn.GetNumRows () << "][" << H_usn.GetNumCols () << "][" << H_usn.GetNumClusters () << "]");
 
-  channelParams->m_channel = H_usn;
   channelParams->m_delay = clusterDelay;
 
   channelParams->m_angle.clear ();
@@ -1465,7 +1826,8 @@ ThreeGppChannel::GetNewChannel (Vector locUT, bool los, bool o2i,
 
 doubleVector_t
 ThreeGppChannel::CalAttenuationOfBlockage (Ptr<ThreeGppChannelMatrix> params,
-                                           doubleVector_t clusterAOA, doubleVector_t clusterZOA) const
+                                           doubleVector_t clusterAOA, doubleVector_t clusterZOA,
+                                           ChannelRng &rng) const
 {
   doubleVector_t powerAttenuation;
   uint8_t clusterNum = clusterAOA.size ();
@@ -1501,17 +1863,17 @@ ThreeGppChannel::CalAttenuationOfBlockage (Ptr<ThreeGppChannelMatrix> params,
         {
           //draw value from table 7.6.4.1-2 Blocking region parameters
           doubleVector_t table;
-          table.push_back (m_normalRv->GetValue ()); //phi_k: store the normal RV that will be mapped to uniform (0,360) later.
+          table.push_back (rng.GetNormal ()); //phi_k: store the normal RV that will be mapped to uniform (0,360) later.
           if (m_scenario == "InH-OfficeMixed" || m_scenario == "InH-OfficeOpen")
             {
-              table.push_back (m_uniformRv->GetValue (15, 45)); //x_k
+              table.push_back (rng.GetUniform (15, 45)); //x_k
               table.push_back (90);  //Theta_k
-              table.push_back (m_uniformRv->GetValue (5, 15)); //y_k
+              table.push_back (rng.GetUniform (5, 15)); //y_k
               table.push_back (2);  //r
             }
           else
             {
-              table.push_back (m_uniformRv->GetValue (5, 15)); //x_k
+              table.push_back (rng.GetUniform (5, 15)); //x_k
               table.push_back (90);  //Theta_k
               table.push_back (5);  //y_k
               table.push_back (10);  //r
@@ -1574,7 +1936,7 @@ ThreeGppChannel::CalAttenuationOfBlockage (Ptr<ThreeGppChannelMatrix> params,
 
               //Generate a new correlated normal RV with the following formula
               params->m_nonSelfBlocking.at (blockInd).at (PHI_INDEX) =
-                R * params->m_nonSelfBlocking.at (blockInd).at (PHI_INDEX) + sqrt (1 - R * R) * m_normalRv->GetValue ();
+                R * params->m_nonSelfBlocking.at (blockInd).at (PHI_INDEX) + sqrt (1 - R * R) * rng.GetNormal ();
             }
         }
 
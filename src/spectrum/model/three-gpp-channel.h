@@ -24,10 +24,16 @@
 
 #include  <complex.h>
 #include "ns3/angles.h"
+#include "ns3/three-gpp-channel-tensor.h"
 #include <ns3/object.h>
 #include <ns3/nstime.h>
 #include <ns3/random-variable-stream.h>
+#include <ns3/rng-stream.h>
+#include <ns3/event-id.h>
+#include <ns3/mobility-model.h>
+#include <ns3/antenna-array-basic-model.h>
 #include <ns3/boolean.h>
+#include <ns3/bounded-cache.h>
 #include <map>
 
 namespace ns3 {
@@ -46,12 +52,16 @@ class MobilityModel;
  */
 struct ThreeGppChannelMatrix : public SimpleRefCount<ThreeGppChannelMatrix>
 {
-  complex3DVector_t               m_channel; //!< channel matrix H[u][s][n].
+  ThreeGppChannelTensor           m_channel; //!< channel matrix H[u][s][n].
   doubleVector_t                  m_delay; //!< cluster delay.
   double2DVector_t                m_angle; //!< cluster angle angle[direction][n], where direction = 0(aoa), 1(zoa), 2(aod), 3(zod) in degree.
   double2DVector_t                m_nonSelfBlocking; //!< store the blockages
   bool                            m_isReverse; //!< true if the channel matrix was generated for the reverse link
 
+  /*The following parameters cache the frequency response of the clusters, they are set by ThreeGppSpectrumPropagationLossModel*/
+  uint32_t m_delayResponseModelUid = 0; //!< uid of the SpectrumModel used to compute m_delayResponse, 0 if not computed yet
+  complexVector_t m_delayResponse; //!< delay response exp(-j2*pi*f_k*tau_n) of the clusters, stored in m_delayResponse[k * N + n]
+
   // TODO these are not currently used, they have to be correctly set when including the spatial consistent update procedure
   /*The following parameters are stored for spatial consistent updating*/
   Vector m_preLocUT; //!< location of UT when generating the previous channel
@@ -68,6 +78,12 @@ struct ThreeGppChannelMatrix : public SimpleRefCount<ThreeGppChannelMatrix>
   Vector m_speed; //!< velocity
   double m_dis2D; //!< 2D distance between tx and rx
   double m_dis3D; //!< 3D distance between tx and rx
+
+  /*The following parameters are set if the parallel update is enabled, they are used to regenerate the matrix at the update boundaries*/
+  Ptr<const MobilityModel> m_txMobility; //!< mobility model of the tx node of the link the matrix was generated for
+  Ptr<const MobilityModel> m_rxMobility; //!< mobility model of the rx node of the link the matrix was generated for
+  Ptr<AntennaArrayBasicModel> m_txAntenna; //!< antenna array of the tx node
+  Ptr<AntennaArrayBasicModel> m_rxAntenna; //!< antenna array of the rx node
 };
 
 /**
@@ -150,6 +166,64 @@ public:
    */
   Ptr<ThreeGppChannelMatrix> GetChannel (Ptr<const MobilityModel> a, Ptr<const MobilityModel> b, Ptr<AntennaArrayBasicModel> txAntenna, Ptr<AntennaArrayBasicModel> rxAntenna, bool los, bool o2i);
 
+  /**
+   * Looks for the channel matrix associated to the a,b pair in m_channelMap,
+   * without marking it as used and without generating or updating it.
+   * The matrix is assumed to be still valid if the los condition it was
+   * generated with did not change.
+   * \param a mobility model of the tx device
+   * \param b mobility model of the rx device
+   * \param isReverse set to true if the matrix was generated for the b,a pair
+   * \return the channel matrix, or 0 if it has to be generated or updated
+   */
+  Ptr<ThreeGppChannelMatrix> PeekChannel (Ptr<const MobilityModel> a, Ptr<const MobilityModel> b, bool &isReverse);
+
+  /**
+   * \return the channel update period
+   */
+  Time GetUpdatePeriod () const;
+
+  /**
+   * Set the maximum number of channel matrices stored in the cache
+   * \param capacity the maximum number of entries, 0 means unbounded
+   */
+  void SetChannelCacheCapacity (uint32_t capacity);
+
+  /**
+   * \return the maximum number of channel matrices stored in the cache
+   */
+  uint32_t GetChannelCacheCapacity () const;
+
+  /**
+   * Set the eviction policy of the channel cache
+   * \param policy the eviction policy
+   */
+  void SetChannelCacheEvictionPolicy (BoundedCacheBase::EvictionPolicy policy);
+
+  /**
+   * \return the eviction policy of the channel cache
+   */
+  BoundedCacheBase::EvictionPolicy GetChannelCacheEvictionPolicy () const;
+
+  /**
+   * \return the number of worker threads used by the parallel update
+   */
+  uint32_t GetNumUpdateThreads () const;
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
+  /**
+   * \return the counters of the channel cache
+   */
+  Ptr<BoundedCacheStatistics> GetChannelCacheStatistics () const;
+
   static const uint8_t AOA_INDEX = 0; //!< index of the AOA value in the m_angle array
   static const uint8_t ZOA_INDEX = 1; //!< index of the ZOA value in the m_angle array
   static const uint8_t AOD_INDEX = 2; //!< index of the AOD value in the m_angle array
@@ -172,7 +246,124 @@ public:
    return (((x1 + x2) * (x1 + x2 + 1)) / 2) + x2;
  }
 
+protected:
+  virtual void DoDispose ();
+
 private:
+  /**
+   * Source of the random variables used to generate a channel matrix. It
+   * draws either from the random variables of the ThreeGppChannel, or from a
+   * substream reserved to a single generation of a link, which can be used
+   * on a worker thread and does not depend on the order of the generations.
+   */
+  class ChannelRng
+  {
+  public:
+    /**
+     * Constructor, draws from the given random variables
+     * \param uniformRv the uniform random variable
+     * \param normalRv the standard normal random variable
+     */
+    ChannelRng (Ptr<UniformRandomVariable> uniformRv, Ptr<NormalRandomVariable> normalRv);
+
+    /**
+     * Constructor, draws from a substream of the MRG32k3a generator
+     * \param seed the seed
+     * \param stream the stream index
+     * \param substream the substream index
+     */
+    ChannelRng (uint32_t seed, uint64_t stream, uint64_t substream);
+
+    /**
+     * \param min the lower bound
+     * \param max the upper bound
+     * \return a value uniformly distributed in [min, max)
+     */
+    double GetUniform (double min, double max);
+
+    /**
+     * \return a value with standard normal distribution
+     */
+    double GetNormal ();
+
+  private:
+    Ptr<UniformRandomVariable> m_uniformRv; //!< the uniform random variable, 0 if the substream is used
+    Ptr<NormalRandomVariable> m_normalRv; //!< the normal random variable, 0 if the substream is used
+    RngStream m_stream; //!< the substream
+    bool m_nextValid; //!< true if m_next holds a normal value
+    double m_next; //!< the second normal value generated by the polar method
+  };
+
+  /**
+   * The inputs of the generation of a channel matrix. They are computed on
+   * the simulation thread, so that the generation can run on a worker thread.
+   */
+  struct ChannelGenerationJob
+  {
+    uint32_t m_channelId; //!< the key of the channel matrix
+    bool m_los; //!< the LOS/NLOS condition
+    bool m_o2i; //!< whether if it is an outdoor to indoor transmission
+    Ptr<AntennaArrayBasicModel> m_txAntenna; //!< the tx antenna array
+    Ptr<AntennaArrayBasicModel> m_rxAntenna; //!< the rx antenna array
+    Angles m_rxAngle; //!< the receiving angle
+    Angles m_txAngle; //!< the transmitting angle
+    double m_dis2D; //!< the 2D distance between tx and rx
+    double m_hBs; //!< the height of the BS
+    double m_hUt; //!< the height of the UT
+    ChannelRng m_rng; //!< the source of the random variables
+    Ptr<ThreeGppChannelMatrix> m_result; //!< the generated channel matrix
+  };
+
+  /**
+   * Compute the inputs of the generation of the channel matrix of a link
+   * \param a tx mobility model
+   * \param b rx mobility model
+   * \param txAntenna the tx antenna array
+   * \param rxAntenna the rx antenna array
+   * \param los the LOS/NLOS condition
+   * \param o2i whether if it is an outdoor to indoor transmission
+   * \return the generation job
+   */
+  ChannelGenerationJob PrepareChannelGeneration (Ptr<const MobilityModel> a, Ptr<const MobilityModel> b,
+                                                 Ptr<AntennaArrayBasicModel> txAntenna, Ptr<AntennaArrayBasicModel> rxAntenna,
+                                                 bool los, bool o2i) const;
+
+  /**
+   * Generate the channel matrix of a job and store it in the job. Does not
+   * access the state of the ThreeGppChannel other than its configuration,
+   * hence jobs with a dedicated ChannelRng can run in parallel.
+   * \param job the job
+   */
+  void RunChannelGeneration (ChannelGenerationJob &job) const;
+
+  /**
+   * A worker thread of the parallel update, which runs the jobs with indices
+   * m_first, m_first + m_step, m_first + 2 * m_step, ...
+   */
+  struct ChannelGenerationWorker
+  {
+    /**
+     * Run the jobs of this worker
+     */
+    void Run ();
+
+    const ThreeGppChannel *m_channel; //!< the channel model
+    std::vector<ChannelGenerationJob> *m_jobs; //!< the jobs
+    uint32_t m_first; //!< the index of the first job
+    uint32_t m_step; //!< the distance between the indices of the jobs
+  };
+
+  /**
+   * Schedule the parallel update at the next multiple of the update period
+   */
+  void ScheduleChannelUpdate ();
+
+  /**
+   * Regenerate in parallel the channel matrices used during the last update
+   * period. Each worker thread runs a subset of the generations.
+   */
+  void UpdateChannels ();
+
   /**
    * Get the channel matrix between a and b using the procedure described in
    * 3GPP TR 38.901
@@ -186,22 +377,25 @@ private:
    * \param dis2D the 2D distance between tx and rx
    * \param hBS the height of the BS
    * \param hUT the height of the UT
+   * \param rng the source of the random variables
    * \return the channel realization
    */
   Ptr<ThreeGppChannelMatrix> GetNewChannel (Vector locUT, bool los, bool o2i,
-                                            Ptr<AntennaArrayBasicModel> txAntenna, Ptr<AntennaArrayBasicModel> rxAntenna,
+                                            const Ptr<AntennaArrayBasicModel> &txAntenna, const Ptr<AntennaArrayBasicModel> &rxAntenna,
                                             Angles &rxAngle, Angles &txAngle,
-                                            double dis2D, double hBS, double hUT) const;
+                                            double dis2D, double hBS, double hUT, ChannelRng &rng) const;
 
   /**
    * Applies the blockage model A described in 3GPP TR 38.901
    * \param params the channel matrix
    * \param clusterAOA vector containing the azimuth angle of arrival for each cluster
    * \param clusterZOA vector containing the zenith angle of arrival for each cluster
+   * \param rng the source of the random variables
    * \return vector containing the power attenuation for each cluster
    */
   doubleVector_t CalAttenuationOfBlockage (Ptr<ThreeGppChannelMatrix> params,
-                                           doubleVector_t clusterAOA, doubleVector_t clusterZOA) const;
+                                           doubleVector_t clusterAOA, doubleVector_t clusterZOA,
+                                           ChannelRng &rng) const;
 
  /**
   * Check if the channel matrix has to be updated
@@ -211,13 +405,18 @@ private:
   */
  bool ChannelMatrixNeedsUpdate (Ptr<ThreeGppChannelMatrix> channelMatrix, bool los) const;
 
-  std::map<uint32_t, Ptr<ThreeGppChannelMatrix>> m_channelMap; //!< map containing the channel realizations
+  BoundedCache<uint32_t, Ptr<ThreeGppChannelMatrix> > m_channelMap; //!< cache containing the channel realizations
   Time m_updatePeriod; //!< the channel update period
   double m_frequency; //!< the operating frequency
   std::string m_scenario; //!< the 3GPP scenario
   Ptr<UniformRandomVariable> m_uniformRv; //!< uniform random variable
   Ptr<NormalRandomVariable> m_normalRv; //!< normal random variable
 
+  // parameters for the parallel update
+  bool m_parallelUpdate; //!< if true, the matrices are regenerated in parallel at the update boundaries
+  uint32_t m_updateThreads; //!< the number of worker threads, 0 means one per core
+  EventId m_updateEvent; //!< the next parallel update
+
   // parameters for the blockage model
   bool m_blockage; //!< enables the blockage model A
   uint16_t m_numNonSelfBloking; //!< number of non-self-blocking regions
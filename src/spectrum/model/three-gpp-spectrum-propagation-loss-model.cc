@@ -31,7 +31,12 @@
 #include "ns3/string.h"
 #include "ns3/simulator.h"
 #include "ns3/pointer.h"
+#include "ns3/uinteger.h"
+#include "ns3/enum.h"
+#include "ns3/trace-source-accessor.h"
 #include <map>
+#include <limits>
+#include <functional>
 
 namespace ns3 {
 
@@ -39,20 +44,43 @@ NS_LOG_COMPONENT_DEFINE ("ThreeGppSpectrumPropagationLossModel");
 
 NS_OBJECT_ENSURE_REGISTERED (ThreeGppSpectrumPropagationLossModel);
 
-//TODO is this the best place to define this operator? it can be made "inline" in the .h file
-bool operator<(Key3DLongTerm const & lhs, Key3DLongTerm const & rhs) {
-    if (lhs.a < rhs.a) return true;
-    if (rhs.a < lhs.a) return false;
-    if (lhs.b < rhs.b) return true;
-    if (rhs.b < lhs.b) return false;
-    if (lhs.c < rhs.c) return true;
-    return false;
-};
+/**
+ * Estimates the memory owned by a LongTerm object
+ * \param longTerm the long term
+ * \return the size in bytes
+ */
+static uint64_t
+GetLongTermSize (const Ptr<LongTerm> &longTerm)
+{
+  return sizeof (LongTerm)
+         + (longTerm->m_longTerm.capacity () + longTerm->m_txW.capacity () + longTerm->m_rxW.capacity ())
+         * sizeof (std::complex<double>);
+}
+
+/**
+ * \param a the first velocity
+ * \param b the second velocity
+ * \return true if the velocities are equal
+ */
+static bool
+IsSameVelocity (const Vector &a, const Vector &b)
+{
+  return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+void
+ThreeGppBeamformingGainJob::Run (void)
+{
+  std::call_once (m_once, &ThreeGppSpectrumPropagationLossModel::RunBeamformingGainJob, m_lossModel, std::ref (*this));
+}
 
 ThreeGppSpectrumPropagationLossModel::ThreeGppSpectrumPropagationLossModel ()
+  : m_bfGainTraceSamplingPeriod (1),
+    m_bfGainTraceCounter (0)
 {
   NS_LOG_FUNCTION (this);
   m_channelModel = CreateObject<ThreeGppChannel> ();
+  m_longTermMap.SetSizeFunction (&GetLongTermSize);
 }
 
 ThreeGppSpectrumPropagationLossModel::~ThreeGppSpectrumPropagationLossModel ()
@@ -85,6 +113,38 @@ ThreeGppSpectrumPropagationLossModel::GetTypeId (void)
                    MakePointerAccessor (&ThreeGppSpectrumPropagationLossModel::SetChannelConditionModel,
                                         &ThreeGppSpectrumPropagationLossModel::GetChannelConditionModel),
                    MakePointerChecker<ChannelConditionModel> ())
+    .AddAttribute ("LongTermCacheCapacity",
+                   "The maximum number of long term components stored in the cache, "
+                   "0 means unbounded. When full, the least recently used entry is evicted.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&ThreeGppSpectrumPropagationLossModel::SetLongTermCacheCapacity,
+                                         &ThreeGppSpectrumPropagationLossModel::GetLongTermCacheCapacity),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("LongTermCacheEvictionPolicy",
+                   "The eviction policy of the long term cache. With Generation, the entries "
+                   "not used during the current or the previous channel update period are evicted.",
+                   EnumValue (BoundedCacheBase::LRU),
+                   MakeEnumAccessor (&ThreeGppSpectrumPropagationLossModel::SetLongTermCacheEvictionPolicy,
+                                     &ThreeGppSpectrumPropagationLossModel::GetLongTermCacheEvictionPolicy),
+                   MakeEnumChecker (BoundedCacheBase::LRU, "Lru",
+                                    BoundedCacheBase::GENERATION, "Generation"))
+    .AddAttribute ("LongTermCacheStatistics",
+                   "The counters of the long term cache",
+                   TypeId::ATTR_GET,
+                   PointerValue (),
+                   MakePointerAccessor (&ThreeGppSpectrumPropagationLossModel::GetLongTermCacheStatistics),
+                   MakePointerChecker<BoundedCacheStatistics> ())
+    .AddAttribute ("BeamformingGainSamplingPeriod",
+                   "Report one every BeamformingGainSamplingPeriod beamforming gains "
+                   "to the BeamformingGain trace source, 1 reports all of them.",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&ThreeGppSpectrumPropagationLossModel::m_bfGainTraceSamplingPeriod),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddTraceSource ("BeamformingGain",
+                     "The beamforming gain applied to a received PSD, averaged over the bands. "
+                     "The gains are only computed for the report when the trace source is connected.",
+                     MakeTraceSourceAccessor (&ThreeGppSpectrumPropagationLossModel::m_bfGainTrace),
+                     "ns3::ThreeGppSpectrumPropagationLossModel::BeamformingGainTracedCallback")
     ;
   return tid;
 }
@@ -136,8 +196,38 @@ ThreeGppSpectrumPropagationLossModel::GetScenario () const
   return scenario.Get ();
 }
 
+void
+ThreeGppSpectrumPropagationLossModel::SetLongTermCacheCapacity (uint32_t capacity)
+{
+  m_longTermMap.SetCapacity (capacity);
+}
+
+uint32_t
+ThreeGppSpectrumPropagationLossModel::GetLongTermCacheCapacity () const
+{
+  return m_longTermMap.GetCapacity ();
+}
+
+void
+ThreeGppSpectrumPropagationLossModel::SetLongTermCacheEvictionPolicy (BoundedCacheBase::EvictionPolicy policy)
+{
+  m_longTermMap.SetEvictionPolicy (policy);
+}
+
+BoundedCacheBase::EvictionPolicy
+ThreeGppSpectrumPropagationLossModel::GetLongTermCacheEvictionPolicy () const
+{
+  return m_longTermMap.GetEvictionPolicy ();
+}
+
+Ptr<BoundedCacheStatistics>
+ThreeGppSpectrumPropagationLossModel::GetLongTermCacheStatistics () const
+{
+  return m_longTermMap.GetStatistics ();
+}
+
 complexVector_t
-ThreeGppSpectrumPropagationLossModel::CalLongTerm (Ptr<ThreeGppChannelMatrix> params, complexVector_t aW, complexVector_t bW) const
+ThreeGppSpectrumPropagationLossModel::CalLongTerm (const Ptr<ThreeGppChannelMatrix> &params, const complexVector_t &aW, const complexVector_t &bW, bool isReverse) const
 {
   // NOTE We assume channel reciprocity between each tx-rx pair, hence the
   // channel matrix H is generated once for each pair.
@@ -147,7 +237,7 @@ ThreeGppSpectrumPropagationLossModel::CalLongTerm (Ptr<ThreeGppChannelMatrix> pa
   // i.e., rxW^T H^T txW = (rxW^T H^T txW)^T = txW^T H rxW
 
   complexVector_t txW, rxW;
-  if (params->m_isReverse)
+  if (isReverse)
   {
     // TODO we should never enter in this branch because we should have already
     // computed the long term for the direct link. Consider to remove it (NOTE: Fgomez this point can be reached in the HBF extension when more than one bf vector is evaluated for the same channel matrix)
@@ -167,28 +257,13 @@ ThreeGppSpectrumPropagationLossModel::CalLongTerm (Ptr<ThreeGppChannelMatrix> pa
 
   uint16_t txAntenna = txW.size ();
   uint16_t rxAntenna = rxW.size ();
-  uint16_t txChSize = params->m_channel.at (0).size ();
-  uint16_t rxChSize = params->m_channel.size ();
+  uint16_t txChSize = params->m_channel.GetNumCols ();
+  uint16_t rxChSize = params->m_channel.GetNumRows ();
 
   NS_LOG_DEBUG ("CalLongTerm with txAntenna " << (uint16_t)txAntenna << " rxAntenna " << (uint16_t)rxAntenna<<" txChSize " << (uint16_t)txChSize << " rxChSize " << (uint16_t)rxChSize);
   //store the long term part to reduce computation load
   //only the small scale fading needs to be updated if the large scale parameters and antenna weights remain unchanged.
-  complexVector_t longTerm;
-  uint8_t numCluster = params->m_channel.at (0).at (0).size ();
-  for (uint8_t cIndex = 0; cIndex < numCluster; cIndex++)
-    {
-      std::complex<double> txSum (0,0);
-      for (uint16_t txIndex = 0; txIndex < txAntenna; txIndex++)
-        {
-          std::complex<double> rxSum (0,0);
-          for (uint16_t rxIndex = 0; rxIndex < rxAntenna; rxIndex++)
-            {
-              rxSum = rxSum + rxW.at (rxIndex) * params->m_channel.at (rxIndex).at (txIndex).at (cIndex);
-            }
-          txSum = txSum + txW.at (txIndex) * rxSum;
-        }
-      longTerm.push_back (txSum);
-    }
+  complexVector_t longTerm = params->m_channel.Contract (rxW, txW);
   return longTerm;
 }
 
@@ -199,7 +274,7 @@ ThreeGppSpectrumPropagationLossModel::CalBeamformingGain (Ptr<SpectrumValue> txP
 
   Ptr<SpectrumValue> tempPsd = Copy (txPsd);
 
-  complexVector_t tempComplexCoef = CalBeamformingComplexCoef ( tempPsd, longTerm, params, txSpeed, rxSpeed);
+  complexVector_t tempComplexCoef = CalBeamformingComplexCoef (tempPsd->GetSpectrumModel (), longTerm, params, txSpeed, rxSpeed, GetFrequency ());
 
 
 //  //channel[rx][tx][cluster]
@@ -250,12 +325,12 @@ ThreeGppSpectrumPropagationLossModel::CalBeamformingGain (Ptr<SpectrumValue> txP
 }
 
 complexVector_t
-ThreeGppSpectrumPropagationLossModel::CalBeamformingComplexCoef (Ptr<SpectrumValue> refPsd, complexVector_t longTerm, Ptr<ThreeGppChannelMatrix> params, Vector txSpeed, Vector rxSpeed) const
+ThreeGppSpectrumPropagationLossModel::CalBeamformingComplexCoef (const Ptr<const SpectrumModel> &model, const complexVector_t &longTerm, const Ptr<ThreeGppChannelMatrix> &params, const Vector &txSpeed, const Vector &rxSpeed, double frequency) const
 {
   NS_LOG_FUNCTION (this);
 
   //channel[rx][tx][cluster]
-  uint8_t numCluster = params->m_channel.at (0).at (0).size ();
+  uint8_t numCluster = params->m_channel.GetNumClusters ();
   complexVector_t tempComplexSpectrum;
 
   double slotTime = Simulator::Now ().GetSeconds ();
@@ -270,25 +345,90 @@ ThreeGppSpectrumPropagationLossModel::CalBeamformingComplexCoef (Ptr<SpectrumVal
                                         + (sin (params->m_angle.at (ThreeGppChannel::ZOD_INDEX).at (cIndex) * M_PI / 180) * cos (params->m_angle.at (ThreeGppChannel::AOD_INDEX).at (cIndex) * M_PI / 180) * txSpeed.x
                                         + sin (params->m_angle.at (ThreeGppChannel::ZOD_INDEX).at (cIndex) * M_PI / 180) * sin (params->m_angle.at (ThreeGppChannel::AOD_INDEX).at (cIndex) * M_PI / 180) * txSpeed.y
                                         + cos (params->m_angle.at (ThreeGppChannel::ZOD_INDEX).at (cIndex) * M_PI / 180) * txSpeed.z))
-                                        * slotTime * GetFrequency () / 3e8;
+                                        * slotTime * frequency / 3e8;
       doppler.push_back (exp (std::complex<double> (0, temp_doppler)));
     }
 
-  for (Bands::const_iterator sbit = refPsd->ConstBandsBegin(); sbit != refPsd->ConstBandsEnd (); sbit++)
+  // combine the long term and the Doppler term of each cluster, they are the
+  // same for all the subbands
+  complexVector_t clusterCoef (numCluster);
+  for (uint8_t cIndex = 0; cIndex < numCluster; cIndex++)
     {
-      std::complex<double> subsbandGain (0.0,0.0);
+      clusterCoef[cIndex] = longTerm.at (cIndex) * doppler.at (cIndex);
+    }
 
-      double fsb = (*sbit).fc;
+  const complexVector_t &delayResponse = GetDelayResponse (params, model);
+  std::size_t numBands = model->GetNumBands ();
+  tempComplexSpectrum.resize (numBands);
+  for (std::size_t bIndex = 0; bIndex < numBands; bIndex++)
+    {
+      std::complex<double> subsbandGain (0.0,0.0);
+      const std::complex<double> *bandResponse = &delayResponse[bIndex * numCluster];
       for (uint8_t cIndex = 0; cIndex < numCluster; cIndex++)
         {
-          double delay = -2 * M_PI * fsb * (params->m_delay.at (cIndex));
-          subsbandGain = subsbandGain + longTerm.at (cIndex) * doppler.at (cIndex) * exp (std::complex<double> (0, delay));
+          subsbandGain += clusterCoef[cIndex] * bandResponse[cIndex];
         }
-      tempComplexSpectrum.push_back(subsbandGain);
+      tempComplexSpectrum[bIndex] = subsbandGain;
     }
   return tempComplexSpectrum;
 }
 
+const complexVector_t&
+ThreeGppSpectrumPropagationLossModel::GetDelayResponse (const Ptr<ThreeGppChannelMatrix> &params, const Ptr<const SpectrumModel> &model) const
+{
+  NS_LOG_FUNCTION (this);
+
+  if (params->m_delayResponseModelUid == model->GetUid ())
+    {
+      return params->m_delayResponse;
+    }
+
+  uint8_t numCluster = params->m_channel.GetNumClusters ();
+  std::size_t numBands = model->GetNumBands ();
+  params->m_delayResponse.resize (numBands * numCluster);
+  params->m_delayResponseModelUid = model->GetUid ();
+
+  // check if the bands are uniformly spaced
+  bool uniform = (numBands > 1);
+  double spacing = 0.0;
+  if (uniform)
+    {
+      spacing = (model->Begin () + 1)->fc - model->Begin ()->fc;
+      for (Bands::const_iterator bit = model->Begin () + 1; bit != model->End (); bit++)
+        {
+          if (std::abs ((bit->fc - (bit - 1)->fc) - spacing) > 1e-6 * std::abs (spacing))
+            {
+              uniform = false;
+              break;
+            }
+        }
+    }
+
+  // the phasor is recomputed from scratch every phasorRefreshPeriod bands to
+  // prevent the accumulation of rounding errors
+  const std::size_t phasorRefreshPeriod = 64;
+  for (uint8_t cIndex = 0; cIndex < numCluster; cIndex++)
+    {
+      double delay = params->m_delay.at (cIndex);
+      std::complex<double> step = std::polar (1.0, -2 * M_PI * spacing * delay);
+      std::complex<double> phasor;
+      std::size_t bIndex = 0;
+      for (Bands::const_iterator bit = model->Begin (); bit != model->End (); bit++, bIndex++)
+        {
+          if (!uniform || bIndex % phasorRefreshPeriod == 0)
+            {
+              phasor = std::polar (1.0, -2 * M_PI * bit->fc * delay);
+            }
+          else
+            {
+              phasor *= step;
+            }
+          params->m_delayResponse[bIndex * numCluster + cIndex] = phasor;
+        }
+    }
+  return params->m_delayResponse;
+}
+
 
 complexVector_t
 ThreeGppSpectrumPropagationLossModel::GetLongTerm (Ptr<const MobilityModel> aMob, Ptr<const MobilityModel> bMob, Ptr<ThreeGppChannelMatrix> channelMatrix, AntennaArrayBasicModel::BeamformingVector aBF, AntennaArrayBasicModel::BeamformingVector bBF) const
@@ -319,28 +459,34 @@ ThreeGppSpectrumPropagationLossModel::GetLongTerm (Ptr<const MobilityModel> aMob
   bool update = false; // indicates whether the long term has to be updated
   bool notFound = false; // indicates if the long term has not been computed yet
 
+  // the entries which were not used during the last channel update period
+  // refer to an outdated channel matrix, hence they can be evicted
+  m_longTermMap.SetGeneration (BoundedCacheBase::GetGenerationAt (m_channelModel->GetUpdatePeriod ()));
+
   // look for the long term in the map and check if it is valid
-  if (m_longTermMap.find (longTerm3Key) != m_longTermMap.end ())
+  Ptr<LongTerm> *cachedLongTerm = m_longTermMap.Find (longTerm3Key);
+  if (cachedLongTerm != 0)
   {
     NS_LOG_DEBUG ("found the long term component in the map");
-    longTerm = m_longTermMap.at (longTerm3Key)->m_longTerm;
+    Ptr<LongTerm> item = *cachedLongTerm;
+    longTerm = item->m_longTerm;
 
     // check if the channel matrix has been updated
     // or the tx beam has been changed
     // or the rx beam has been changed
-    if (m_longTermMap.at (longTerm3Key)->m_channel->m_isReverse)
+    if (item->m_channel->m_isReverse)
     {
       // the long term was computed considering device b as tx and device a as rx
-      update = (m_longTermMap.at (longTerm3Key)->m_channel->m_generatedTime != channelMatrix->m_generatedTime
-                || m_longTermMap.at (longTerm3Key)->m_txW != bW
-                || m_longTermMap.at (longTerm3Key)->m_rxW != aW);
+      update = (item->m_channel->m_generatedTime != channelMatrix->m_generatedTime
+                || item->m_txW != bW
+                || item->m_rxW != aW);
     }
     else
     {
       // the long term was computed considering device a as tx and device b as rx
-      update = (m_longTermMap.at (longTerm3Key)->m_channel->m_generatedTime != channelMatrix->m_generatedTime
-                || m_longTermMap.at (longTerm3Key)->m_txW != aW
-                || m_longTermMap.at (longTerm3Key)->m_rxW != bW);
+      update = (item->m_channel->m_generatedTime != channelMatrix->m_generatedTime
+                || item->m_txW != aW
+                || item->m_rxW != bW);
     }
   }
   else
@@ -355,7 +501,7 @@ ThreeGppSpectrumPropagationLossModel::GetLongTerm (Ptr<const MobilityModel> aMob
   {
     NS_LOG_DEBUG ("compute the long term for channel ID "<<longTermId<<" using tx bf Id "<<AntennaArrayBasicModel::GetBeamId(aBF)<<" and rx bf Id "<<AntennaArrayBasicModel::GetBeamId(bBF));
     // compute the long term component
-    longTerm = CalLongTerm (channelMatrix, aW, bW);
+    longTerm = CalLongTerm (channelMatrix, aW, bW, channelMatrix->m_isReverse);
 
     //TODO uncomment the following if we change our mind and decide to disable the interference caching implementation
 //    if ( ! interference)
@@ -367,7 +513,7 @@ ThreeGppSpectrumPropagationLossModel::GetLongTerm (Ptr<const MobilityModel> aMob
       longTermItem->m_txW = aW;
       longTermItem->m_rxW = bW;
 
-      m_longTermMap[longTerm3Key] = longTermItem;
+      m_longTermMap.Insert (longTerm3Key, longTermItem);
 //      }
   }
 
@@ -408,19 +554,19 @@ ThreeGppSpectrumPropagationLossModel::GetFrequencyFlatChannelMatrixAtDeltaFreque
   Ptr<ThreeGppChannelMatrix> channelMatrix = m_channelModel->GetChannel (a, b, txAntennaArray, rxAntennaArray, los, o2i);
 
   //channel[rx][tx][cluster]
-  uint8_t numCluster = channelMatrix->m_channel.at (0).at (0).size ();
+  uint8_t numCluster = channelMatrix->m_channel.GetNumClusters ();
 
   uint16_t numTxAntenna = txAntennaArray->GetAntennaNumDim1 () * txAntennaArray->GetAntennaNumDim2 ();
   uint16_t numRxAntenna = rxAntennaArray->GetAntennaNumDim1 () * rxAntennaArray->GetAntennaNumDim2 ();
   if ( channelMatrix->m_isReverse )
     {
-      NS_ASSERT_MSG (channelMatrix->m_channel.size() == numTxAntenna,"matrix dimensions mismatch tx array");
-      NS_ASSERT_MSG (channelMatrix->m_channel.at(0).size() == numRxAntenna,"matrix dimensions mismatch rx array");
+      NS_ASSERT_MSG (channelMatrix->m_channel.GetNumRows () == numTxAntenna,"matrix dimensions mismatch tx array");
+      NS_ASSERT_MSG (channelMatrix->m_channel.GetNumCols () == numRxAntenna,"matrix dimensions mismatch rx array");
     }
   else
     {
-      NS_ASSERT_MSG (channelMatrix->m_channel.size() == numRxAntenna,"matrix dimensions mismatch tx array");
-      NS_ASSERT_MSG (channelMatrix->m_channel.at(0).size() == numTxAntenna,"matrix dimensions mismatch rx array");
+      NS_ASSERT_MSG (channelMatrix->m_channel.GetNumRows () == numRxAntenna,"matrix dimensions mismatch tx array");
+      NS_ASSERT_MSG (channelMatrix->m_channel.GetNumCols () == numTxAntenna,"matrix dimensions mismatch rx array");
     }
 
   //precompute delay and doppler to accelerate next loop
@@ -446,40 +592,26 @@ ThreeGppSpectrumPropagationLossModel::GetFrequencyFlatChannelMatrixAtDeltaFreque
       delay_doppler.push_back ( exp (std::complex<double> (0, delay ) ) );
     }
 
-  complex2DVector_t resultMatrix; //this starts with empty matrix
-  for (uint16_t rxIndex = 0; rxIndex < numRxAntenna; rxIndex++)
-    {
-      complexVector_t resultRow;//this starts adding an empty row to the matrix
-      for (uint16_t txIndex = 0; txIndex < numTxAntenna; txIndex++)
-	{
-	  std::complex<double> resultElement (0,0);//this adds a zero element to the new row of the matrix
-	  for (uint8_t cIndex = 0; cIndex < numCluster; cIndex++)
-	    {
-	      if ( channelMatrix->m_isReverse )
-		{//we read from the ChannelMatrix in reverse but store in the current order, effectively conjugating the result
-
-		  resultElement +=   channelMatrix->m_channel.at (txIndex).at (rxIndex).at (cIndex) * doppler.at (cIndex) * delay_doppler.at(cIndex);
-//		  NS_LOG_DEBUG ("REVERSE Computing step ["<< rxIndex <<","<< txIndex <<","<< (int )cIndex <<
-//				"] Array size = ["<<  channelMatrix->m_channel.at(0).size() <<","<< channelMatrix->m_channel.size() <<","<< channelMatrix->m_channel.at(0).at(0).size() <<
-//				"] loop limits ["<< numRxAntenna <<","<< numTxAntenna<<","<<(int )numCluster<<
-//				"] gain "<< channelMatrix->m_channel.at (txIndex).at (rxIndex).at (cIndex) <<
-//				" doppler "<< doppler.at (cIndex)<<
-//				" delay doppler "<< delay_doppler.at(cIndex));
-		}
-	      else
-		{
-		   resultElement +=  channelMatrix->m_channel.at (rxIndex).at (txIndex).at (cIndex) * doppler.at (cIndex) * delay_doppler.at(cIndex);
-//		   NS_LOG_DEBUG ("Computing reverse step ["<< rxIndex <<","<< txIndex <<","<< (int )cIndex <<
-//				 "] Array size = ["<<  channelMatrix->m_channel.size() <<","<< channelMatrix->m_channel.at(0).size() <<","<< channelMatrix->m_channel.at(0).at(0).size() <<
-//				 "] loop limits "<< numRxAntenna <<","<< numTxAntenna<<","<<(int )numCluster<<
-//				 "]  gain "<< channelMatrix->m_channel.at (rxIndex).at (txIndex).at (cIndex) <<
-//				" doppler "<< doppler.at (cIndex)<<
-//				" delay doppler "<< delay_doppler.at(cIndex));
-		}
-	    }
-	  resultRow.push_back(resultElement);
-	}
-      resultMatrix.push_back (resultRow);
+  // the channel tensor is stored cluster by cluster, hence the cluster loop
+  // is the outermost one in order to scan the coefficients contiguously
+  complex2DVector_t resultMatrix (numRxAntenna, complexVector_t (numTxAntenna, std::complex<double> (0,0)));
+  for (uint8_t cIndex = 0; cIndex < numCluster; cIndex++)
+    {
+      for (uint16_t rxIndex = 0; rxIndex < numRxAntenna; rxIndex++)
+        {
+          complexVector_t &resultRow = resultMatrix[rxIndex];
+          for (uint16_t txIndex = 0; txIndex < numTxAntenna; txIndex++)
+            {
+              if ( channelMatrix->m_isReverse )
+                {//we read from the ChannelMatrix in reverse but store in the current order, effectively conjugating the result
+                  resultRow[txIndex] += channelMatrix->m_channel (txIndex, rxIndex, cIndex) * doppler[cIndex] * delay_doppler[cIndex];
+                }
+              else
+                {
+                  resultRow[txIndex] += channelMatrix->m_channel (rxIndex, txIndex, cIndex) * doppler[cIndex] * delay_doppler[cIndex];
+                }
+            }
+        }
     }
   return (resultMatrix);
 }
@@ -500,14 +632,155 @@ ThreeGppSpectrumPropagationLossModel::DoCalcRxPowerSpectralDensity ( Ptr<const S
   return retPsd;
 }
 
+double
+ThreeGppSpectrumPropagationLossModel::DoGetMaxGainDb (Ptr<const MobilityModel> a,
+                                                      Ptr<const MobilityModel> b) const
+{
+  NS_LOG_FUNCTION (this);
+
+  Ptr<NetDevice> txDevice = a->GetObject<Node> ()->GetDevice (0);
+  Ptr<NetDevice> rxDevice = b->GetObject<Node> ()->GetDevice (0);
+  std::map<Ptr<NetDevice>, Ptr<AntennaArrayBasicModel> >::const_iterator txIt = m_deviceAntennaMap.find (txDevice);
+  std::map<Ptr<NetDevice>, Ptr<AntennaArrayBasicModel> >::const_iterator rxIt = m_deviceAntennaMap.find (rxDevice);
+  if (txIt == m_deviceAntennaMap.end () || rxIt == m_deviceAntennaMap.end ())
+    {
+      return std::numeric_limits<double>::infinity ();
+    }
+
+  // the radiation pattern scales the field, hence it is squared
+  double maxGain = 1.0;
+  for (const Ptr<AntennaArrayBasicModel> &array : {txIt->second, rxIt->second})
+    {
+      double maxPattern = array->GetMaxRadiationPattern ();
+      maxGain *= array->GetAntennaNumDim1 () * array->GetAntennaNumDim2 () * maxPattern * maxPattern;
+    }
+  return 10 * std::log10 (maxGain);
+}
+
 Ptr<SpectrumValue>
 ThreeGppSpectrumPropagationLossModel::CalcRxPowerSpectralDensityMultiLayers (Ptr<const SpectrumValue> txPsd,
                                                          Ptr<const MobilityModel> a,
                                                          Ptr<const MobilityModel> b,
 		                                            uint8_t txLayerInd,
-							    uint8_t rxLayerInd) const
+							    uint8_t rxLayerInd,
+                                                            Ptr<const ThreeGppBeamformingGainJob> job) const
+{
+  return DoCalcRxPowerSpectralDensityMultilayers (txPsd, a, b, txLayerInd, rxLayerInd, job);
+}
+
+Ptr<ThreeGppBeamformingGainJob>
+ThreeGppSpectrumPropagationLossModel::PrepareBeamformingGainJob (Ptr<const SpectrumModel> model,
+                                                                 Ptr<const MobilityModel> a,
+                                                                 Ptr<const MobilityModel> b,
+                                                                 uint8_t txLayerInd,
+                                                                 uint8_t rxLayerInd,
+                                                                 Time rxTime) const
 {
-  return DoCalcRxPowerSpectralDensityMultilayers (txPsd, a, b, txLayerInd, rxLayerInd);
+  NS_LOG_FUNCTION (this << rxTime);
+
+  // the job is validated when the gain is computed, hence it may be
+  // prepared in advance
+  std::map<Ptr<NetDevice>, Ptr<AntennaArrayBasicModel> >::const_iterator txIt = m_deviceAntennaMap.find (a->GetObject<Node> ()->GetDevice (0));
+  std::map<Ptr<NetDevice>, Ptr<AntennaArrayBasicModel> >::const_iterator rxIt = m_deviceAntennaMap.find (b->GetObject<Node> ()->GetDevice (0));
+  if (txIt == m_deviceAntennaMap.end () || rxIt == m_deviceAntennaMap.end ()
+      || txIt->second->IsOmniTx () || rxIt->second->IsOmniTx ())
+    {
+      return 0;
+    }
+  Ptr<AntennaArrayModel> castTxArray = DynamicCast<AntennaArrayModel> (txIt->second);
+  Ptr<AntennaArrayModel> castRxArray = DynamicCast<AntennaArrayModel> (rxIt->second);
+  if (castTxArray == 0 || castRxArray == 0)
+    {
+      return 0;
+    }
+
+  bool isReverse = false;
+  Ptr<ThreeGppChannelMatrix> channelMatrix = m_channelModel->PeekChannel (a, b, isReverse);
+  if (channelMatrix == 0)
+    {
+      NS_LOG_LOGIC ("the channel matrix has to be generated, the gain is not prepared");
+      return 0;
+    }
+
+  // the components of the gain of all the layers of a receiver with digital
+  // combining are the same
+  bool rxDigitalCombining = !castTxArray->isDigitalCombiningOn () && castRxArray->isDigitalCombiningOn ();
+  if (Simulator::Now () != m_bfGainJobTime)
+    {
+      m_bfGainJobMap.clear ();
+      m_bfGainJobTime = Simulator::Now ();
+    }
+  Ptr<ThreeGppBeamformingGainJob> &job = m_bfGainJobMap[BeamformingGainJobKey (a, b, txLayerInd, rxDigitalCombining ? 0 : rxLayerInd)];
+  if (job != 0
+      && job->m_channelMatrix == channelMatrix
+      && job->m_txConfigurationId == castTxArray->GetConfigurationId ()
+      && job->m_rxConfigurationId == castRxArray->GetConfigurationId ()
+      && job->m_spectrumModel->GetUid () == model->GetUid ()
+      && job->m_time == rxTime)
+    {
+      return job;
+    }
+
+  job = Create<ThreeGppBeamformingGainJob> ();
+  job->m_lossModel = this;
+  job->m_channelMatrix = channelMatrix;
+  job->m_isReverse = isReverse;
+  job->m_spectrumModel = model;
+  job->m_txConfigurationId = castTxArray->GetConfigurationId ();
+  job->m_rxConfigurationId = castRxArray->GetConfigurationId ();
+  job->m_time = rxTime;
+  job->m_txSpeed = a->GetVelocity ();
+  job->m_rxSpeed = b->GetVelocity ();
+  job->m_frequency = GetFrequency ();
+
+  // the components are listed in the order in which GetRxLayerBeamformingGain
+  // combines them
+  complexVector_t txW = AntennaArrayBasicModel::GetVector (castTxArray->GetCurrentBeamformingVectorMultilayers (txLayerInd));
+  complexVector_t rxW = AntennaArrayBasicModel::GetVector (castRxArray->GetCurrentBeamformingVectorMultilayers (rxLayerInd));
+  if (castTxArray->isDigitalCombiningOn ())
+    {
+      uint8_t numDcLayers = castTxArray->GetDigitalCombining ().at (0).size ();
+      for (uint8_t txLayerCtr = 0; numDcLayers > txLayerInd && txLayerCtr < numDcLayers; txLayerCtr++)
+        {
+          job->m_weights.push_back (std::make_pair (AntennaArrayBasicModel::GetVector (castTxArray->GetCurrentBeamformingVectorMultilayers (txLayerCtr)), rxW));
+        }
+    }
+  else if (rxDigitalCombining)
+    {
+      uint8_t numDcLayers = castRxArray->GetDigitalCombining ().at (0).size ();
+      for (uint8_t rxLayerCtr = 0; rxLayerCtr < numDcLayers; rxLayerCtr++)
+        {
+          job->m_weights.push_back (std::make_pair (txW, AntennaArrayBasicModel::GetVector (castRxArray->GetCurrentBeamformingVectorMultilayers (rxLayerCtr))));
+        }
+    }
+  else
+    {
+      job->m_weights.push_back (std::make_pair (txW, rxW));
+    }
+
+  // the delay response is stored in the channel matrix, the job only reads it
+  GetDelayResponse (channelMatrix, model);
+  return job;
+}
+
+void
+ThreeGppSpectrumPropagationLossModel::RunBeamformingGainJob (ThreeGppBeamformingGainJob &job) const
+{
+  // the delay response may have been computed for another SpectrumModel in
+  // the meantime, in which case the job is discarded. The Doppler terms are
+  // computed for the current time, which must be the reception time.
+  if (job.m_channelMatrix->m_delayResponseModelUid != job.m_spectrumModel->GetUid ()
+      || Simulator::Now () != job.m_time)
+    {
+      return;
+    }
+  job.m_components.reserve (job.m_weights.size ());
+  for (const std::pair<complexVector_t, complexVector_t> &weights : job.m_weights)
+    {
+      complexVector_t longTerm = CalLongTerm (job.m_channelMatrix, weights.first, weights.second, job.m_isReverse);
+      job.m_components.push_back (CalBeamformingComplexCoef (job.m_spectrumModel, longTerm, job.m_channelMatrix,
+                                                             job.m_txSpeed, job.m_rxSpeed, job.m_frequency));
+    }
 }
 
 Ptr<SpectrumValue>
@@ -515,7 +788,8 @@ ThreeGppSpectrumPropagationLossModel::DoCalcRxPowerSpectralDensityMultilayers (P
                                                                     Ptr<const MobilityModel> a,
                                                                     Ptr<const MobilityModel> b,
 			                                            uint8_t txLayerInd,
-								    uint8_t rxLayerInd) const
+								    uint8_t rxLayerInd,
+                                                                    Ptr<const ThreeGppBeamformingGainJob> job) const
 {
   NS_LOG_FUNCTION (this);
 
@@ -543,27 +817,131 @@ ThreeGppSpectrumPropagationLossModel::DoCalcRxPowerSpectralDensityMultilayers (P
 
   NS_ASSERT_MSG (a->GetDistanceFrom (b) != 0, "The position of tx and rx devices cannot be the same");
 
-  // retrieve the channel condition
-  Ptr<ChannelCondition> condition = m_channelConditionModel->GetChannelCondition (a, b);
+  // the gains of all the rx layers are computed together and shared by the
+  // calls for the other layers of the same link in this time step
+  Ptr<const SpectrumValue> bfGainPsd = GetRxLayerBeamformingGain (rxPsd->GetSpectrumModel (), a, b, txAntennaArray, rxAntennaArray, txLayerInd, rxLayerInd, job);
 
-  // compute the channel matrix between a and b
-  bool los = (condition->GetLosCondition () == ChannelCondition::LosConditionValue::LOS);
-  bool o2i = false; // TODO include the o2i condition in the channel condition model
-  Ptr<ThreeGppChannelMatrix> channelMatrix = m_channelModel->GetChannel (a, b, txAntennaArray, rxAntennaArray, los, o2i);
+  (*rxPsd) *= (*bfGainPsd);
+
+  if (!m_bfGainTrace.IsEmpty () && ++m_bfGainTraceCounter >= m_bfGainTraceSamplingPeriod)
+    {
+      m_bfGainTraceCounter = 0;
+      // the precoding and combining vectors are only used to report the beams
+      Ptr<AntennaArrayModel> castTxArray = DynamicCast<AntennaArrayModel> (txAntennaArray);
+      Ptr<AntennaArrayModel> castRxArray = DynamicCast<AntennaArrayModel> (rxAntennaArray);
+
+      ThreeGppBeamformingGainParams params;
+      params.m_txNodeId = a->GetObject<Node> ()->GetId ();
+      params.m_rxNodeId = b->GetObject<Node> ()->GetId ();
+      params.m_txBeamId = AntennaArrayBasicModel::GetBeamId (castTxArray->GetCurrentBeamformingVectorMultilayers (txLayerInd));
+      params.m_rxBeamId = AntennaArrayBasicModel::GetBeamId (castRxArray->GetCurrentBeamformingVectorMultilayers (rxLayerInd));
+      params.m_txLayerInd = txLayerInd;
+      params.m_rxLayerInd = rxLayerInd;
+      params.m_gain = Sum (*bfGainPsd) / bfGainPsd->GetSpectrumModel ()->GetNumBands ();
+      m_bfGainTrace (params);
+    }
+  return rxPsd;
+}
+
+std::vector<Ptr<SpectrumValue> >
+ThreeGppSpectrumPropagationLossModel::CalcRxPowerSpectralDensityAllRxLayers (Ptr<const SpectrumValue> txPsd,
+                                                                           Ptr<const MobilityModel> a,
+                                                                           Ptr<const MobilityModel> b,
+                                                                           uint8_t txLayerInd,
+                                                                           uint8_t numRxLayers) const
+{
+  NS_LOG_FUNCTION (this);
+
+  std::vector<Ptr<SpectrumValue> > rxPsdList;
+  for (uint8_t rxLayerInd = 0; rxLayerInd < numRxLayers; rxLayerInd++)
+    {
+      // the first call computes the gains of all the layers, the following
+      // ones retrieve them
+      rxPsdList.push_back (DoCalcRxPowerSpectralDensityMultilayers (txPsd, a, b, txLayerInd, rxLayerInd));
+    }
+  return rxPsdList;
+}
+
+Ptr<const SpectrumValue>
+ThreeGppSpectrumPropagationLossModel::GetRxLayerBeamformingGain (Ptr<const SpectrumModel> model,
+                                                                 Ptr<const MobilityModel> a,
+                                                                 Ptr<const MobilityModel> b,
+                                                                 Ptr<AntennaArrayBasicModel> txAntennaArray,
+                                                                 Ptr<AntennaArrayBasicModel> rxAntennaArray,
+                                                                 uint8_t txLayerInd,
+                                                                 uint8_t rxLayerInd,
+                                                                 Ptr<const ThreeGppBeamformingGainJob> job) const
+{
+  NS_LOG_FUNCTION (this);
+
+  // the gains are shared only within a time step, i.e., among the layers
+  // receiving the same transmission
+  if (Simulator::Now () != m_rxLayersBfGainTime)
+    {
+      m_rxLayersBfGainMap.clear ();
+      m_rxLayersBfGainTime = Simulator::Now ();
+    }
 
-  // get the precoding and combining vectors
   Ptr<AntennaArrayModel> castTxArray=DynamicCast<AntennaArrayModel>(txAntennaArray);
   Ptr<AntennaArrayModel> castRxArray=DynamicCast<AntennaArrayModel>(rxAntennaArray);
 
+  RxLayersBfGain &batch = m_rxLayersBfGainMap[RxLayersBfGainKey (a, b, txLayerInd)];
+  if (batch.m_channelMatrix == 0
+      || batch.m_txConfigurationId != castTxArray->GetConfigurationId ()
+      || batch.m_rxConfigurationId != castRxArray->GetConfigurationId ()
+      || batch.m_spectrumModelUid != model->GetUid ())
+    {
+      NS_LOG_DEBUG ("compute the rx layer gains from scratch");
+
+      // retrieve the channel condition
+      Ptr<ChannelCondition> condition = m_channelConditionModel->GetChannelCondition (a, b);
+
+      // compute the channel matrix between a and b
+      bool los = (condition->GetLosCondition () == ChannelCondition::LosConditionValue::LOS);
+      bool o2i = false; // TODO include the o2i condition in the channel condition model
+      batch.m_channelMatrix = m_channelModel->GetChannel (a, b, txAntennaArray, rxAntennaArray, los, o2i);
+      batch.m_txConfigurationId = castTxArray->GetConfigurationId ();
+      batch.m_rxConfigurationId = castRxArray->GetConfigurationId ();
+      batch.m_spectrumModelUid = model->GetUid ();
+      batch.m_bfGain.clear ();
+    }
+
+  if (rxLayerInd < batch.m_bfGain.size () && batch.m_bfGain.at (rxLayerInd) != 0)
+    {
+      return batch.m_bfGain.at (rxLayerInd);
+    }
+  if (batch.m_bfGain.size () <= rxLayerInd)
+    {
+      batch.m_bfGain.resize (rxLayerInd + 1);
+    }
+
+  Ptr<ThreeGppChannelMatrix> channelMatrix = batch.m_channelMatrix;
+  // CalBeamformingComplexCoef only reads the SpectrumModel of the reference PSD
+  Ptr<SpectrumValue> refPsd = Create<SpectrumValue> (model);
+
   AntennaArrayBasicModel::BeamformingVector txW = castTxArray->GetCurrentBeamformingVectorMultilayers (txLayerInd);
   AntennaArrayBasicModel::BeamformingVector rxW = castRxArray->GetCurrentBeamformingVectorMultilayers (rxLayerInd);
 
-  Ptr<SpectrumValue>  bfGainPsd = Create<SpectrumValue>( rxPsd->GetSpectrumModel () );
+  Ptr<SpectrumValue>  bfGainPsd = Create<SpectrumValue>( model );
+
+  // the components computed by the job are used if its inputs are still
+  // valid, the result is the same as if they were computed here
+  bool useJob = (job != 0
+                 && job->m_channelMatrix == channelMatrix
+                 && job->m_isReverse == channelMatrix->m_isReverse
+                 && job->m_components.size () == job->m_weights.size ()
+                 && job->m_txConfigurationId == castTxArray->GetConfigurationId ()
+                 && job->m_rxConfigurationId == castRxArray->GetConfigurationId ()
+                 && job->m_spectrumModel->GetUid () == model->GetUid ()
+                 && job->m_time == Simulator::Now ()
+                 && IsSameVelocity (job->m_txSpeed, a->GetVelocity ())
+                 && IsSameVelocity (job->m_rxSpeed, b->GetVelocity ()));
+  NS_LOG_DEBUG ("prepared gain " << (job == 0 ? "not available" : (useJob ? "used" : "discarded")));
 
   if (castTxArray->isDigitalCombiningOn())
     {
       NS_ASSERT_MSG ( ! castRxArray->isDigitalCombiningOn() , "Digital combining at both transmitter and receiver is impossible if one is a UE");
-      AntennaArrayModel::complex3DVector_t mmseWDCmatrix = castTxArray->GetDigitalCombining();
+      const AntennaArrayModel::complex3DVector_t &mmseWDCmatrix = castTxArray->GetDigitalCombining();
       if ( mmseWDCmatrix.at(0).size()<=txLayerInd )
         {//when we are called with a value of txLayerInd greater than the number of active layers
          //for example if a mmwave-phy calls startTx for all its layers indiscriminately, including those that are not allocated
@@ -573,11 +951,20 @@ ThreeGppSpectrumPropagationLossModel::DoCalcRxPowerSpectralDensityMultilayers (P
       else
         {
           complexVector_t bfComplexSpectrum ( mmseWDCmatrix.size() , 0.0) ;
+          useJob = useJob && job->m_components.size () == mmseWDCmatrix.at(0).size();
           for (uint8_t txLayerCtr = 0; txLayerCtr< mmseWDCmatrix.at(0).size(); txLayerCtr++ )
             {
-              AntennaArrayBasicModel::BeamformingVector txWaux = castTxArray->GetCurrentBeamformingVectorMultilayers ( txLayerCtr );
-              complexVector_t longTerm = GetLongTerm (a, b, channelMatrix, txWaux, rxW);
-              complexVector_t bfComplexNewComponent = CalBeamformingComplexCoef (rxPsd, longTerm, channelMatrix, a->GetVelocity (), b->GetVelocity ());          ;
+              complexVector_t bfComplexNewComponent;
+              if (useJob)
+                {
+                  bfComplexNewComponent = job->m_components.at (txLayerCtr);
+                }
+              else
+                {
+                  AntennaArrayBasicModel::BeamformingVector txWaux = castTxArray->GetCurrentBeamformingVectorMultilayers ( txLayerCtr );
+                  complexVector_t longTerm = GetLongTerm (a, b, channelMatrix, txWaux, rxW);
+                  bfComplexNewComponent = CalBeamformingComplexCoef (model, longTerm, channelMatrix, a->GetVelocity (), b->GetVelocity (), GetFrequency ());
+                }
               for ( size_t sBandCtr = 0; sBandCtr < mmseWDCmatrix.size(); sBandCtr++)
                 {//if there are no bugs dimensions always match
                   bfComplexSpectrum.at( sBandCtr ) += mmseWDCmatrix.at( sBandCtr ).at( txLayerInd ).at( txLayerCtr ) * bfComplexNewComponent.at( sBandCtr );
@@ -588,51 +975,73 @@ ThreeGppSpectrumPropagationLossModel::DoCalcRxPowerSpectralDensityMultilayers (P
               (*bfGainPsd)[sBandCtr] = std::norm( bfComplexSpectrum.at( sBandCtr ) );
             }
         }
+      batch.m_bfGain.at (rxLayerInd) = bfGainPsd;
     }
   else if(castRxArray->isDigitalCombiningOn())
     {
-      AntennaArrayModel::complex3DVector_t mmseWDCmatrix = castRxArray->GetDigitalCombining();
-      if ( mmseWDCmatrix.at(0).size()<=rxLayerInd )
-        {//when we are called with a value of rxLayerInd greater than the number of active layers
-         //for example, for example if a mmwave-phy  is always trying to receive in all its layers, entering this segment of code for the layers it has not allocated
-          //by convention we assume unallocated layers receive 0 power and thus do not capture unnecessary noise and interference
-          (*bfGainPsd)=0;
+      // the combined signal of each rx layer is a mix of the analog signals
+      // of all the rx layers, hence the analog components are computed once
+      // and then mixed for all the layers of the batch
+      const AntennaArrayModel::complex3DVector_t &mmseWDCmatrix = castRxArray->GetDigitalCombining();
+      uint8_t numDcLayers = mmseWDCmatrix.at(0).size();
+      std::vector<complexVector_t> bfComplexComponents;
+      useJob = useJob && job->m_components.size () == numDcLayers;
+      for (uint8_t rxLayerCtr = 0; rxLayerCtr< numDcLayers; rxLayerCtr++ )
+        {
+          if (useJob)
+            {
+              bfComplexComponents.push_back (job->m_components.at (rxLayerCtr));
+              continue;
+            }
+          AntennaArrayBasicModel::BeamformingVector rxWaux = castRxArray->GetCurrentBeamformingVectorMultilayers ( rxLayerCtr );
+          complexVector_t longTerm = GetLongTerm (a, b, channelMatrix, txW, rxWaux);
+          bfComplexComponents.push_back (CalBeamformingComplexCoef (model, longTerm, channelMatrix, a->GetVelocity (), b->GetVelocity (), GetFrequency ()));
         }
-      else
+      if (batch.m_bfGain.size () < numDcLayers)
+        {
+          batch.m_bfGain.resize (numDcLayers);
+        }
+      for (uint8_t layerInd = 0; layerInd < batch.m_bfGain.size (); layerInd++)
         {
-          complexVector_t bfComplexSpectrum ( mmseWDCmatrix.size() , 0.0 ) ;
-          for (uint8_t rxLayerCtr = 0; rxLayerCtr< mmseWDCmatrix.at(0).size(); rxLayerCtr++ )
+          Ptr<SpectrumValue> layerGainPsd = Create<SpectrumValue>( model );
+          if ( numDcLayers<=layerInd )
+            {//when we are called with a value of rxLayerInd greater than the number of active layers
+             //for example, for example if a mmwave-phy  is always trying to receive in all its layers, entering this segment of code for the layers it has not allocated
+              //by convention we assume unallocated layers receive 0 power and thus do not capture unnecessary noise and interference
+              (*layerGainPsd)=0;
+            }
+          else
             {
-              AntennaArrayBasicModel::BeamformingVector rxWaux = castRxArray->GetCurrentBeamformingVectorMultilayers ( rxLayerCtr );
-              complexVector_t longTerm = GetLongTerm (a, b, channelMatrix, txW, rxWaux);
-              complexVector_t bfComplexNewComponent = CalBeamformingComplexCoef (rxPsd, longTerm, channelMatrix, a->GetVelocity (), b->GetVelocity ());
               for ( size_t sBandCtr = 0; sBandCtr < mmseWDCmatrix.size(); sBandCtr++)
                 {//if there are no bugs dimensions always match
-                  bfComplexSpectrum.at( sBandCtr ) += mmseWDCmatrix.at( sBandCtr ).at( rxLayerInd ).at( rxLayerCtr ) * bfComplexNewComponent.at( sBandCtr );
+                  std::complex<double> bfComplexCoef = 0.0;
+                  for (uint8_t rxLayerCtr = 0; rxLayerCtr< numDcLayers; rxLayerCtr++ )
+                    {
+                      bfComplexCoef += mmseWDCmatrix.at( sBandCtr ).at( layerInd ).at( rxLayerCtr ) * bfComplexComponents.at( rxLayerCtr ).at( sBandCtr );
+                    }
+                  (*layerGainPsd)[sBandCtr] = std::norm( bfComplexCoef );
                 }
             }
-          for ( size_t sBandCtr = 0; sBandCtr < mmseWDCmatrix.size(); sBandCtr++)
-            {
-              (*bfGainPsd)[sBandCtr] = std::norm( bfComplexSpectrum.at( sBandCtr ) );
-            }
+          batch.m_bfGain.at (layerInd) = layerGainPsd;
         }
     }
+  else if (useJob && job->m_components.size () == 1)
+    {
+      const complexVector_t &bfComplexCoef = job->m_components.at (0);
+      for (size_t sBandCtr = 0; sBandCtr < bfComplexCoef.size (); sBandCtr++)
+        {
+          (*bfGainPsd)[sBandCtr] = std::norm (bfComplexCoef[sBandCtr]);
+        }
+      batch.m_bfGain.at (rxLayerInd) = bfGainPsd;
+    }
   else
     {
-      //  NS_LOG_DEBUG ("In this calcPSDmultilayer call layerInd: "<<(int ) txLayerInd<<"->"<< (int ) rxLayerInd<< " tx vect size " << txW.first.size() << " rx vect size " << rxW.first.size());
-      //  NS_LOG_DEBUG ("Tx MAC: "<< txDevice->GetAddress() <<" -> Rx MAC:"<< rxDevice->GetAddress() << " at distance " << a->GetDistanceFrom (b));
       // retrieve the long term component
       complexVector_t longTerm = GetLongTerm (a, b, channelMatrix, txW, rxW);
-      //  for (uint16_t cIndex = 0; cIndex < txW.first.size(); cIndex++)
-      //    {
-      //      NS_LOG_DEBUG ("    txbfcoef " << (int) cIndex << " = " << txW.first.at(cIndex));
-      //    }
       // apply the beamforming gain
-      bfGainPsd = CalBeamformingGain (rxPsd, longTerm, channelMatrix, a->GetVelocity (), b->GetVelocity ());
+      batch.m_bfGain.at (rxLayerInd) = CalBeamformingGain (refPsd, longTerm, channelMatrix, a->GetVelocity (), b->GetVelocity ());
     }
-  (*rxPsd) *= (*bfGainPsd);
-  NS_LOG_UNCOND("BF Gain TxId " << a->GetObject<Node>()->GetId () << " RxId " << b->GetObject<Node>()->GetId () << " TxBeam " << AntennaArrayBasicModel::GetBeamId(txW) << " RxBeam " << AntennaArrayBasicModel::GetBeamId(rxW) << " g= " << Sum(*bfGainPsd) / bfGainPsd->GetSpectrumModel()->GetNumBands() );
-  return rxPsd;
+  return batch.m_bfGain.at (rxLayerInd);
 }
 
 complexVector_t
@@ -672,7 +1081,7 @@ ThreeGppSpectrumPropagationLossModel::DoCalcRxComplexSpectrum (Ptr<SpectrumValue
     // retrieve the long term component
     complexVector_t longTerm = GetLongTerm (a, b, channelMatrix, txW, rxW);
 
-    return CalBeamformingComplexCoef (refPsd, longTerm, channelMatrix, a->GetVelocity (), b->GetVelocity ());
+    return CalBeamformingComplexCoef (refPsd->GetSpectrumModel (), longTerm, channelMatrix, a->GetVelocity (), b->GetVelocity (), GetFrequency ());
 }
 
 
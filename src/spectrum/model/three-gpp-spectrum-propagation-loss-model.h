@@ -27,12 +27,19 @@
 #include "ns3/angles.h"
 #include "ns3/three-gpp-channel.h"
 #include "ns3/antenna-array-basic-model.h"
+#include "ns3/bounded-cache.h"
+#include "ns3/traced-callback.h"
+#include "ns3/spectrum-phy.h"
+#include <map>
+#include <mutex>
+#include <tuple>
 
 namespace ns3 {
 
 class NetDevice;
 class ChannelConditionModel;
 class ChannelCondition;
+class ThreeGppSpectrumPropagationLossModel;
 
 /**
  * Data structure that stores the long term component for a tx-rx pair
@@ -55,9 +62,107 @@ struct Key3DLongTerm {
   uint32_t c;
 }; //TODO we can make this into a template for better reuse, perhaps even find an existing stl/ns3 template that does this (stl tuple in C++ new versions)
 
+/**
+ * Lexicographic order of the Key3DLongTerm keys
+ * \param lhs the first key
+ * \param rhs the second key
+ * \return true if lhs precedes rhs
+ */
+inline bool
+operator< (Key3DLongTerm const &lhs, Key3DLongTerm const &rhs)
+{
+  if (lhs.a != rhs.a)
+    {
+      return lhs.a < rhs.a;
+    }
+  if (lhs.b != rhs.b)
+    {
+      return lhs.b < rhs.b;
+    }
+  return lhs.c < rhs.c;
+}
+
+/**
+ * \param lhs the first key
+ * \param rhs the second key
+ * \return true if the keys are equal
+ */
+inline bool
+operator== (Key3DLongTerm const &lhs, Key3DLongTerm const &rhs)
+{
+  return lhs.a == rhs.a && lhs.b == rhs.b && lhs.c == rhs.c;
+}
+
+/**
+ * Hash function of the Key3DLongTerm keys, used to index the long term cache
+ */
+struct Key3DLongTermHash
+{
+  /**
+   * \param key the key
+   * \return the hash of the key
+   */
+  uint64_t operator() (Key3DLongTerm const &key) const
+  {
+    return MixHash (MixHash ((static_cast<uint64_t> (key.a) << 32) | key.b) ^ key.c);
+  }
+};
+
 typedef std::vector< std::complex<double> > complexVector_t; //!< type definition for complex vectors
 typedef std::vector<complexVector_t> complex2DVector_t; //!< type definition for complex matrices
 
+/**
+ * \ingroup spectrum
+ *
+ * The beamforming gain applied to a received PSD, reported by the
+ * BeamformingGain trace source of ThreeGppSpectrumPropagationLossModel
+ */
+struct ThreeGppBeamformingGainParams
+{
+  uint32_t m_txNodeId; //!< the id of the tx node
+  uint32_t m_rxNodeId; //!< the id of the rx node
+  AntennaArrayBasicModel::BeamId m_txBeamId; //!< the id of the tx beam
+  AntennaArrayBasicModel::BeamId m_rxBeamId; //!< the id of the rx beam
+  uint8_t m_txLayerInd; //!< the tx layer
+  uint8_t m_rxLayerInd; //!< the rx layer
+  double m_gain; //!< the gain averaged over the bands, in linear units
+};
+
+/**
+ * \ingroup spectrum
+ *
+ * The computation of the beamforming gain of a link, prepared by
+ * ThreeGppSpectrumPropagationLossModel::PrepareBeamformingGainJob with the
+ * channel matrix and the beamforming vectors of the current time step, and
+ * run on a worker thread. The result is used by
+ * ThreeGppSpectrumPropagationLossModel::CalcRxPowerSpectralDensityMultiLayers
+ * only if the inputs of the job did not change in the meantime.
+ * The job may be shared by the receptions of the layers of the same link,
+ * it is run only once.
+ */
+class ThreeGppBeamformingGainJob : public SpectrumRxJob
+{
+public:
+  virtual void Run (void);
+
+private:
+  friend class ThreeGppSpectrumPropagationLossModel;
+
+  const ThreeGppSpectrumPropagationLossModel *m_lossModel; //!< the model which prepared the job
+  Ptr<ThreeGppChannelMatrix> m_channelMatrix; //!< the channel matrix of the link
+  bool m_isReverse; //!< true if the channel matrix was generated for the reverse link
+  Ptr<const SpectrumModel> m_spectrumModel; //!< the SpectrumModel of the gain
+  uint64_t m_txConfigurationId; //!< configuration of the tx array
+  uint64_t m_rxConfigurationId; //!< configuration of the rx array
+  Time m_time; //!< the time of the reception
+  Vector m_txSpeed; //!< the velocity of the tx device
+  Vector m_rxSpeed; //!< the velocity of the rx device
+  double m_frequency; //!< the operating frequency
+  std::vector<std::pair<complexVector_t, complexVector_t> > m_weights; //!< the tx and rx beamforming vectors of each component of the gain
+  std::vector<complexVector_t> m_components; //!< the complex gain of each component in each band, computed by Run
+  std::once_flag m_once; //!< runs the job once
+};
+
 /**
  * \ingroup spectrum
  *
@@ -81,6 +186,13 @@ public:
    */
   static TypeId GetTypeId ();
 
+  /**
+   * TracedCallback signature for the beamforming gain of a received PSD.
+   *
+   * \param [in] params the beamforming gain and the link it refers to
+   */
+  typedef void (* BeamformingGainTracedCallback)(const ThreeGppBeamformingGainParams &params);
+
   /**
    * Add a device-antenna pair
    * \param a pointer to the NetDevice
@@ -148,11 +260,58 @@ public:
                                                            Ptr<const MobilityModel> a,
                                                            Ptr<const MobilityModel> b) const;
 
+  /**
+   * Computes the array gain obtained with unit norm beamforming vectors
+   * matched to a channel matrix with the average power, i.e., the product of
+   * the number of elements and of the maximum element gain of both arrays.
+   * The small scale fading may exceed this value, hence the users of the
+   * bound should account for a margin.
+   * \param a tx mobility model
+   * \param b rx mobility model
+   * \return the maximum gain in dB, +infinity if an antenna is not known
+   */
+  virtual double DoGetMaxGainDb (Ptr<const MobilityModel> a,
+                                 Ptr<const MobilityModel> b) const;
+
+  /**
+   * Computes the received PSD
+   * \param txPsd tx PSD
+   * \param a tx mobility model
+   * \param b rx mobility model
+   * \param txLayerInd the hbf layer used by the tx antenna array
+   * \param rxLayerInd the hbf layer used by the rx antenna array
+   * \param job the job prepared for this reception, or 0
+   * \return the received PSD
+   */
   Ptr<SpectrumValue> CalcRxPowerSpectralDensityMultiLayers (Ptr<const SpectrumValue> txPsd,
                                                            Ptr<const MobilityModel> a,
                                                            Ptr<const MobilityModel> b,
 		                                           uint8_t txLayerInd,
-							   uint8_t rxLayerInd) const;
+							   uint8_t rxLayerInd,
+                                                           Ptr<const ThreeGppBeamformingGainJob> job = 0) const;
+
+  /**
+   * Prepares the computation of the beamforming gain of the rx layer
+   * rxLayerInd of device b, for the signal transmitted by device a in layer
+   * txLayerInd, which can then run on a worker thread. The job uses the
+   * channel matrix currently stored by the channel model, hence it is not
+   * prepared if the matrix has to be generated or updated. The jobs for the
+   * layers of the same link which require the same computations are
+   * shared within a time step.
+   * \param model the SpectrumModel of the gain
+   * \param a tx mobility model
+   * \param b rx mobility model
+   * \param txLayerInd the hbf layer used by the tx antenna array
+   * \param rxLayerInd the hbf layer used by the rx antenna array
+   * \param rxTime the time at which the gain will be computed
+   * \return the job, or 0 if there is nothing to prepare
+   */
+  Ptr<ThreeGppBeamformingGainJob> PrepareBeamformingGainJob (Ptr<const SpectrumModel> model,
+                                                             Ptr<const MobilityModel> a,
+                                                             Ptr<const MobilityModel> b,
+                                                             uint8_t txLayerInd,
+                                                             uint8_t rxLayerInd,
+                                                             Time rxTime) const;
   /**
    * Computes the received PSD
    * \param tx PSD
@@ -166,7 +325,29 @@ public:
                                                            Ptr<const MobilityModel> a,
                                                            Ptr<const MobilityModel> b,
 		                                           uint8_t txLayerInd,
-							   uint8_t rxLayerInd) const;
+							   uint8_t rxLayerInd,
+                                                           Ptr<const ThreeGppBeamformingGainJob> job = 0) const;
+
+  /**
+   * Computes the received PSD of each receive layer of device b, for the
+   * signal transmitted by device a in layer txLayerInd.
+   * The channel matrix and the long term components are retrieved once for
+   * all the layers, and the resulting beamforming gains are shared with the
+   * calls to CalcRxPowerSpectralDensityMultiLayers for the same link in the
+   * current time step, so that each layer-specific receiver gets its slice
+   * without repeating the computation.
+   * \param txPsd tx PSD
+   * \param a tx mobility model
+   * \param b rx mobility model
+   * \param txLayerInd the hbf layer used by the tx antenna array
+   * \param numRxLayers the number of layers of the rx antenna array
+   * \return the received PSD of each rx layer
+   */
+  std::vector<Ptr<SpectrumValue> > CalcRxPowerSpectralDensityAllRxLayers (Ptr<const SpectrumValue> txPsd,
+                                                                          Ptr<const MobilityModel> a,
+                                                                          Ptr<const MobilityModel> b,
+                                                                          uint8_t txLayerInd,
+                                                                          uint8_t numRxLayers) const;
 
   complexVector_t DoCalcRxComplexSpectrum (Ptr<SpectrumValue> refPsd,
                                                                       Ptr<const MobilityModel> a,
@@ -175,8 +356,37 @@ public:
                                                                       AntennaArrayBasicModel::BeamformingVector rxW
                                                                   ) const;
 
+  /**
+   * Set the maximum number of long term components stored in the cache
+   * \param capacity the maximum number of entries, 0 means unbounded
+   */
+  void SetLongTermCacheCapacity (uint32_t capacity);
+
+  /**
+   * \return the maximum number of long term components stored in the cache
+   */
+  uint32_t GetLongTermCacheCapacity () const;
+
+  /**
+   * Set the eviction policy of the long term cache
+   * \param policy the eviction policy
+   */
+  void SetLongTermCacheEvictionPolicy (BoundedCacheBase::EvictionPolicy policy);
+
+  /**
+   * \return the eviction policy of the long term cache
+   */
+  BoundedCacheBase::EvictionPolicy GetLongTermCacheEvictionPolicy () const;
+
+  /**
+   * \return the counters of the long term cache
+   */
+  Ptr<BoundedCacheStatistics> GetLongTermCacheStatistics () const;
+
 protected:
 private:
+  friend class ThreeGppBeamformingGainJob;
+
   /**
    * Looks for the long term component in m_longTermMap. If found, checks
    * whether it has to be updated. If not found or if it has to be updated,
@@ -189,14 +399,50 @@ private:
    * \return vector containing the long term compoenent for each cluster
    */
   complexVector_t GetLongTerm (Ptr<const MobilityModel> aMob, Ptr<const MobilityModel> bMob, Ptr<ThreeGppChannelMatrix> channelMatrix, AntennaArrayBasicModel::BeamformingVector aBF, AntennaArrayBasicModel::BeamformingVector bBF) const;
+  /**
+   * Returns the beamforming gain of a rx layer of device b, for the signal
+   * transmitted by device a in layer txLayerInd.
+   * The gains are computed for a batch of rx layers and stored in
+   * m_rxLayersBfGainMap until the end of the current time step, or until
+   * the configuration of one of the antenna arrays changes. When the rx
+   * array uses digital combining, the gains of all its layers are obtained
+   * from the same analog components, hence they are computed together.
+   * \param model the SpectrumModel of the gain
+   * \param a tx mobility model
+   * \param b rx mobility model
+   * \param txAntennaArray the antenna array of the tx device
+   * \param rxAntennaArray the antenna array of the rx device
+   * \param txLayerInd the hbf layer used by the tx antenna array
+   * \param rxLayerInd the hbf layer used by the rx antenna array
+   * \param job the job prepared for this reception, or 0
+   * \return the beamforming gain PSD
+   */
+  Ptr<const SpectrumValue> GetRxLayerBeamformingGain (Ptr<const SpectrumModel> model,
+                                                      Ptr<const MobilityModel> a,
+                                                      Ptr<const MobilityModel> b,
+                                                      Ptr<AntennaArrayBasicModel> txAntennaArray,
+                                                      Ptr<AntennaArrayBasicModel> rxAntennaArray,
+                                                      uint8_t txLayerInd,
+                                                      uint8_t rxLayerInd,
+                                                      Ptr<const ThreeGppBeamformingGainJob> job) const;
+
+  /**
+   * Computes the components of the beamforming gain of a job. Only the job
+   * is modified and no Ptr is copied, since this may run on a worker thread
+   * concurrently with other jobs.
+   * \param job the job
+   */
+  void RunBeamformingGainJob (ThreeGppBeamformingGainJob &job) const;
+
   /**
    * Computes the long term component
    * \param the channel matrix H
    * \param the tx beamforming vector
    * \param the rx beamforming vector
+   * \param isReverse true if H was generated for the reverse link
    * \return the long term component
    */
-  complexVector_t CalLongTerm (Ptr<ThreeGppChannelMatrix> channelMatrix, complexVector_t txW, complexVector_t rxW) const;
+  complexVector_t CalLongTerm (const Ptr<ThreeGppChannelMatrix> &channelMatrix, const complexVector_t &txW, const complexVector_t &rxW, bool isReverse) const;
 
   /**
    * Computes the beamforming gain. The gain can be multiplied by the tx PSD to compute the rx PSD
@@ -208,18 +454,55 @@ private:
 
   /**
    * Computes the beamforming complex coefficients. The norm of this vector can be used to compute the Gain
-   * \param the tx PSD to copy its SpectrumModel
+   * \param the SpectrumModel of the coefficients
    * \param the long term component
+   * \param frequency the operating frequency
    * \return the bf gain PSD
    */
-  complexVector_t CalBeamformingComplexCoef (Ptr<SpectrumValue> refPsd, complexVector_t longTerm, Ptr<ThreeGppChannelMatrix> params, Vector txSpeed, Vector rxSpeed) const;
+  complexVector_t CalBeamformingComplexCoef (const Ptr<const SpectrumModel> &model, const complexVector_t &longTerm, const Ptr<ThreeGppChannelMatrix> &params, const Vector &txSpeed, const Vector &rxSpeed, double frequency) const;
+
+  /**
+   * Returns the delay response exp(-j2*pi*f_k*tau_n) of each cluster n at the
+   * center frequency f_k of each band of a SpectrumModel. The response is
+   * computed once per channel realization and stored in the channel matrix.
+   * If the bands are uniformly spaced, it is obtained by rotating the phasor
+   * of the previous band, which avoids evaluating a complex exponential for
+   * each band and cluster.
+   * \param params the channel matrix
+   * \param model the SpectrumModel
+   * \return the delay response, stored in [k * N + n]
+   */
+  const complexVector_t& GetDelayResponse (const Ptr<ThreeGppChannelMatrix> &params, const Ptr<const SpectrumModel> &model) const;
 
   std::map < Ptr<NetDevice>, Ptr<AntennaArrayBasicModel> > m_deviceAntennaMap; //!< map containig the <device, antenna> associations
   //TODO remove this commented line if the change below is adopted, or uncommment and remove the next line if we change our mind and decide to disable the interference caching implementation
 //  mutable std::map < uint32_t, Ptr<LongTerm> > m_longTermMap; //!< map containing the long term components
-  mutable std::map < Key3DLongTerm, Ptr<LongTerm> > m_longTermMap; //!< map containing the long term components for txBeamID chanID rxBeamID triplets.
+  mutable BoundedCache < Key3DLongTerm, Ptr<LongTerm>, Key3DLongTermHash > m_longTermMap;
+
+  /**
+   * The beamforming gains of the rx layers of a link, computed in the
+   * current time step
+   */
+  struct RxLayersBfGain
+  {
+    uint64_t m_txConfigurationId = 0; //!< configuration of the tx array used to compute the gains
+    uint64_t m_rxConfigurationId = 0; //!< configuration of the rx array used to compute the gains
+    uint32_t m_spectrumModelUid = 0; //!< uid of the SpectrumModel of the gains
+    Ptr<ThreeGppChannelMatrix> m_channelMatrix; //!< the channel matrix of the link
+    std::vector<Ptr<const SpectrumValue> > m_bfGain; //!< the gain of each rx layer, 0 if not computed yet
+  };
+  typedef std::tuple<Ptr<const MobilityModel>, Ptr<const MobilityModel>, uint8_t> RxLayersBfGainKey; //!< tx mobility, rx mobility and tx layer
+  mutable std::map<RxLayersBfGainKey, RxLayersBfGain> m_rxLayersBfGainMap; //!< the gains of the rx layers of each link
+  mutable Time m_rxLayersBfGainTime; //!< the time step of the gains stored in m_rxLayersBfGainMap //!< cache containing the long term components for txBeamID chanID rxBeamID triplets.
+  typedef std::tuple<Ptr<const MobilityModel>, Ptr<const MobilityModel>, uint8_t, uint8_t> BeamformingGainJobKey; //!< tx mobility, rx mobility, tx layer and rx layer, if the job depends on it
+  mutable std::map<BeamformingGainJobKey, Ptr<ThreeGppBeamformingGainJob> > m_bfGainJobMap; //!< the jobs prepared in the current time step
+  mutable Time m_bfGainJobTime; //!< the time step of the jobs stored in m_bfGainJobMap
   Ptr<ChannelConditionModel> m_channelConditionModel; //!< the channel condition model
   Ptr<ThreeGppChannel> m_channelModel; //!< the model to generate the channel matrix
+
+  TracedCallback<const ThreeGppBeamformingGainParams &> m_bfGainTrace; //!< trace of the beamforming gains
+  uint32_t m_bfGainTraceSamplingPeriod; //!< one every m_bfGainTraceSamplingPeriod gains is reported
+  mutable uint32_t m_bfGainTraceCounter; //!< the number of gains computed since the last one reported
 };
 } // namespace ns3
 
@@ -78,7 +78,55 @@ SpectrumValueTestCase::DoRun (void)
 
 
 
+/**
+ * Test that the blocks of the values recycled by the SpectrumValuePool are
+ * reused, also by SpectrumValues of other SpectrumModels with the same
+ * number of bands, and that the reused values are initialized
+ */
+class SpectrumValuePoolTestCase : public TestCase
+{
+public:
+  SpectrumValuePoolTestCase ();
+  virtual ~SpectrumValuePoolTestCase ();
+  virtual void DoRun (void);
+};
 
+SpectrumValuePoolTestCase::SpectrumValuePoolTestCase ()
+  : TestCase ("SpectrumValue pooled values")
+{
+}
+
+SpectrumValuePoolTestCase::~SpectrumValuePoolTestCase ()
+{
+}
+
+void
+SpectrumValuePoolTestCase::DoRun (void)
+{
+  std::vector<double> freqs1;
+  std::vector<double> freqs2;
+  for (int i = 0; i < 275; i++)
+    {
+      freqs1.push_back (28e9 + i * 1.44e6);
+      freqs2.push_back (73e9 + i * 1.44e6);
+    }
+  Ptr<SpectrumModel> sm1 = Create<SpectrumModel> (freqs1);
+  Ptr<SpectrumModel> sm2 = Create<SpectrumModel> (freqs2);
+
+  Ptr<SpectrumValue> v1 = Create<SpectrumValue> (sm1);
+  (*v1) = 1.0;
+  const double* block = &(*v1->ConstValuesBegin ());
+  v1 = 0;
+
+  Ptr<SpectrumValue> v2 = Create<SpectrumValue> (sm2);
+  NS_TEST_ASSERT_MSG_EQ (&(*v2->ConstValuesBegin ()), block, "the released block was not reused");
+  NS_TEST_ASSERT_MSG_EQ (Sum (*v2), 0.0, "the reused block was not initialized");
+
+  // the temporaries of the arithmetic operators recycle the blocks as well
+  (*v2) = 2.0;
+  SpectrumValue v3 = (*v2) * (*v2) + (*v2);
+  NS_TEST_ASSERT_MSG_EQ_TOL (Sum (v3), 275 * 6.0, TOLERANCE, "wrong result of the operators");
+}
 
 
 
@@ -241,6 +289,8 @@ SpectrumValueTestSuite::SpectrumValueTestSuite ()
   tv1rs3 = v1 >> 3;
   AddTestCase (new SpectrumValueTestCase (tv1rs3, v1rs3, "tv1rs3 = v1 >> 3"), TestCase::QUICK);
 
+  AddTestCase (new SpectrumValuePoolTestCase, TestCase::QUICK);
+
 
 }
 
@@ -21,12 +21,17 @@
 #include "ns3/test.h"
 #include "ns3/config.h"
 #include "ns3/double.h"
+#include "ns3/integer.h"
 #include "ns3/string.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
 #include "ns3/angles.h"
 #include "ns3/node-container.h"
 #include "ns3/constant-position-mobility-model.h"
 #include "ns3/antenna-array-model.h"
 #include "ns3/three-gpp-channel.h"
+#include "ns3/bounded-cache.h"
+#include "ns3/open-addressing-hash-table.h"
 #include "ns3/simple-net-device.h"
 #include "ns3/simulator.h"
 #include "ns3/channel-condition-model.h"
@@ -121,11 +126,11 @@ ThreeGppChannelTest::CheckChannelMatrix (Ptr<ThreeGppChannel> channelModel, Ptr<
   Ptr<ThreeGppChannelMatrix> channelMatrix = channelModel->GetChannel (txMob, rxMob, txAntenna, rxAntenna, true, false);
 
   // check the channel matrix dimensions
-  NS_TEST_ASSERT_MSG_EQ (channelMatrix->m_channel.at (0).size (), txAntennaElements[0] * txAntennaElements[1], "The second dimension of H should be equal to the number of tx antenna elements");
-  NS_TEST_ASSERT_MSG_EQ (channelMatrix->m_channel.size (), rxAntennaElements[0] * rxAntennaElements[1], "The first dimension of H should be equal to the number of rx antenna elements");
+  NS_TEST_ASSERT_MSG_EQ (channelMatrix->m_channel.GetNumCols (), txAntennaElements[0] * txAntennaElements[1], "The second dimension of H should be equal to the number of tx antenna elements");
+  NS_TEST_ASSERT_MSG_EQ (channelMatrix->m_channel.GetNumRows (), rxAntennaElements[0] * rxAntennaElements[1], "The first dimension of H should be equal to the number of rx antenna elements");
 
   // check the matrix norm
-  uint8_t numCluster = channelMatrix->m_channel.at (0).at (0).size ();
+  uint8_t numCluster = channelMatrix->m_channel.GetNumClusters ();
 
   double norm = 0;
   for (uint32_t uIndex = 0; uIndex < rxAntennaElements[0] * rxAntennaElements[1]; uIndex++)
@@ -135,7 +140,7 @@ ThreeGppChannelTest::CheckChannelMatrix (Ptr<ThreeGppChannel> channelModel, Ptr<
       std::complex<double> h_tot;
       for (uint8_t cIndex = 0; cIndex < numCluster; cIndex++)
       {
-        h_tot += channelMatrix->m_channel.at (uIndex).at (sIndex).at (cIndex);
+        h_tot += channelMatrix->m_channel (uIndex, sIndex, cIndex);
       }
       norm += std::abs (h_tot);
     }
@@ -155,7 +160,7 @@ ThreeGppChannelTest::CheckChannelMatrix (Ptr<ThreeGppChannel> channelModel, Ptr<
       std::complex<double> h_tot;
       for (uint8_t cIndex = 0; cIndex < numCluster; cIndex++)
       {
-        check = (channelMatrix->m_channel.at (uIndex).at (sIndex).at (cIndex) == channelMatrixReverse->m_channel.at (uIndex).at (sIndex).at (cIndex));
+        check = (channelMatrix->m_channel (uIndex, sIndex, cIndex) == channelMatrixReverse->m_channel (uIndex, sIndex, cIndex));
       }
     }
   }
@@ -492,6 +497,559 @@ ThreeGppSpectrumPropagationLossModelTest::DoRun ()
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup spectrum
+ *
+ * Test case for the ThreeGppChannelTensor class.
+ * 1) checks if the vectorized DotProduct matches a scalar reference for
+ *    even and odd vector lengths
+ * 2) checks if Contract matches the element-wise computation of
+ *    rxW^T H_n txW for each cluster
+ */
+class ThreeGppChannelTensorTest : public TestCase
+{
+public:
+  /**
+   * Constructor
+   */
+  ThreeGppChannelTensorTest ();
+
+  /**
+   * Destructor
+   */
+  virtual ~ThreeGppChannelTensorTest ();
+
+private:
+  /**
+   * Build the test scenario
+   */
+  virtual void DoRun (void);
+};
+
+ThreeGppChannelTensorTest::ThreeGppChannelTensorTest ()
+  : TestCase ("Test case for the ThreeGppChannelTensor class")
+{
+}
+
+ThreeGppChannelTensorTest::~ThreeGppChannelTensorTest ()
+{
+}
+
+void
+ThreeGppChannelTensorTest::DoRun ()
+{
+  // use a fixed stream, so that the streams automatically assigned to the
+  // random variables of the other test cases are not affected
+  Ptr<UniformRandomVariable> rv = CreateObjectWithAttributes<UniformRandomVariable> ("Stream", IntegerValue (0),
+                                                                                     "Min", DoubleValue (-1.0),
+                                                                                     "Max", DoubleValue (1.0));
+
+  // 1) check the dot product kernel
+  for (uint32_t size = 1; size <= 17; size++)
+    {
+      complexVector_t a, b;
+      std::complex<double> expected (0.0, 0.0);
+      for (uint32_t i = 0; i < size; i++)
+        {
+          a.push_back (std::complex<double> (rv->GetValue (), rv->GetValue ()));
+          b.push_back (std::complex<double> (rv->GetValue (), rv->GetValue ()));
+          expected += a.back () * b.back ();
+        }
+      std::complex<double> result = ThreeGppChannelTensor::DotProduct (a.data (), b.data (), size);
+      NS_TEST_ASSERT_MSG_EQ_TOL (result.real (), expected.real (), 1e-12, "Wrong real part of the dot product for size " << size);
+      NS_TEST_ASSERT_MSG_EQ_TOL (result.imag (), expected.imag (), 1e-12, "Wrong imaginary part of the dot product for size " << size);
+    }
+
+  // 2) check the contraction with the beamforming vectors
+  uint32_t numRows = 16;
+  uint32_t numCols = 7;
+  uint32_t numClusters = 5;
+  ThreeGppChannelTensor h (numRows, numCols, numClusters);
+  for (uint32_t uIndex = 0; uIndex < numRows; uIndex++)
+    {
+      for (uint32_t sIndex = 0; sIndex < numCols; sIndex++)
+        {
+          for (uint32_t nIndex = 0; nIndex < numClusters; nIndex++)
+            {
+              h (uIndex, sIndex, nIndex) = std::complex<double> (rv->GetValue (), rv->GetValue ());
+            }
+        }
+    }
+  complexVector_t rxW, txW;
+  for (uint32_t uIndex = 0; uIndex < numRows; uIndex++)
+    {
+      rxW.push_back (std::complex<double> (rv->GetValue (), rv->GetValue ()));
+    }
+  for (uint32_t sIndex = 0; sIndex < numCols; sIndex++)
+    {
+      txW.push_back (std::complex<double> (rv->GetValue (), rv->GetValue ()));
+    }
+
+  complexVector_t longTerm = h.Contract (rxW, txW);
+  NS_TEST_ASSERT_MSG_EQ (longTerm.size (), numClusters, "The long term should contain one value for each cluster");
+  for (uint32_t nIndex = 0; nIndex < numClusters; nIndex++)
+    {
+      std::complex<double> expected (0.0, 0.0);
+      for (uint32_t sIndex = 0; sIndex < numCols; sIndex++)
+        {
+          std::complex<double> rxSum (0.0, 0.0);
+          for (uint32_t uIndex = 0; uIndex < numRows; uIndex++)
+            {
+              rxSum += rxW.at (uIndex) * h (uIndex, sIndex, nIndex);
+            }
+          expected += txW.at (sIndex) * rxSum;
+        }
+      NS_TEST_ASSERT_MSG_EQ_TOL (longTerm.at (nIndex).real (), expected.real (), 1e-9, "Wrong real part of the long term for cluster " << nIndex);
+      NS_TEST_ASSERT_MSG_EQ_TOL (longTerm.at (nIndex).imag (), expected.imag (), 1e-9, "Wrong imaginary part of the long term for cluster " << nIndex);
+    }
+}
+
+/**
+ * \ingroup spectrum
+ *
+ * Test case for the frequency response computed by the
+ * ThreeGppSpectrumPropagationLossModel class.
+ * Checks if the response obtained with the phasor recurrence, used when the
+ * bands are uniformly spaced, matches the one obtained by evaluating the
+ * delay terms of each band directly, used for non-uniform bands.
+ */
+class ThreeGppFrequencyResponseTest : public TestCase
+{
+public:
+  /**
+   * Constructor
+   */
+  ThreeGppFrequencyResponseTest ();
+
+  /**
+   * Destructor
+   */
+  virtual ~ThreeGppFrequencyResponseTest ();
+
+private:
+  /**
+   * Build the test scenario
+   */
+  virtual void DoRun (void);
+};
+
+ThreeGppFrequencyResponseTest::ThreeGppFrequencyResponseTest ()
+  : TestCase ("Test case for the frequency response of the ThreeGppSpectrumPropagationLossModel class")
+{
+}
+
+ThreeGppFrequencyResponseTest::~ThreeGppFrequencyResponseTest ()
+{
+}
+
+void
+ThreeGppFrequencyResponseTest::DoRun ()
+{
+  // Build the scenario for the test
+  double frequency = 28e9;
+
+  Ptr<ChannelConditionModel> condModel = CreateObject<ThreeGppUmaChannelConditionModel> ();
+  Ptr<ThreeGppSpectrumPropagationLossModel> lossModel = CreateObject<ThreeGppSpectrumPropagationLossModel> ();
+  lossModel->SetFrequency (frequency);
+  lossModel->SetScenario ("UMa");
+  lossModel->SetChannelConditionModel (condModel);
+
+  // create the tx and rx nodes and devices
+  NodeContainer nodes;
+  nodes.Create (2);
+  Ptr<SimpleNetDevice> txDev = CreateObject<SimpleNetDevice> ();
+  Ptr<SimpleNetDevice> rxDev = CreateObject<SimpleNetDevice> ();
+  nodes.Get (0)->AddDevice (txDev);
+  txDev->SetNode (nodes.Get (0));
+  nodes.Get (1)->AddDevice (rxDev);
+  rxDev->SetNode (nodes.Get (1));
+
+  // create the tx and rx mobility models and set their positions
+  Ptr<MobilityModel> txMob = CreateObject<ConstantPositionMobilityModel> ();
+  txMob->SetPosition (Vector (0.0,0.0,10.0));
+  Ptr<MobilityModel> rxMob = CreateObject<ConstantPositionMobilityModel> ();
+  rxMob->SetPosition (Vector (80.0,30.0,1.6));
+  nodes.Get (0)->AggregateObject (txMob);
+  nodes.Get (1)->AggregateObject (rxMob);
+
+  // create the tx and rx antennas
+  Ptr<AntennaArrayModel> txAntenna = CreateObject<AntennaArrayModel> ();
+  txAntenna->SetAntennaNumDim1 (4);
+  txAntenna->SetAntennaNumDim2 (4);
+  Ptr<AntennaArrayModel> rxAntenna = CreateObject<AntennaArrayModel> ();
+  rxAntenna->SetAntennaNumDim1 (2);
+  rxAntenna->SetAntennaNumDim2 (2);
+  lossModel->AddDevice (txDev, txAntenna);
+  lossModel->AddDevice (rxDev, rxAntenna);
+
+  // use fixed beamforming vectors
+  complexVector_t txWeights (16, std::complex<double> (0.25, 0.0));
+  complexVector_t rxWeights (4, std::complex<double> (0.5, 0.0));
+  txAntenna->SetBeamformingVector (txWeights, 0, rxDev);
+  rxAntenna->SetBeamformingVector (rxWeights, 0, txDev);
+  AntennaArrayBasicModel::BeamformingVector txBfVector = txAntenna->GetBeamformingVector (rxDev);
+  AntennaArrayBasicModel::BeamformingVector rxBfVector = rxAntenna->GetBeamformingVector (txDev);
+
+  // uniformly spaced bands, 275 resource blocks of 1.44 MHz
+  uint32_t numBands = 275;
+  double bandWidth = 1.44e6;
+  std::vector<double> centerFreqs;
+  for (uint32_t i = 0; i < numBands; i++)
+    {
+      centerFreqs.push_back (frequency + (i - numBands / 2.0) * bandWidth);
+    }
+  Ptr<SpectrumValue> uniformPsd = Create<SpectrumValue> (Create<SpectrumModel> (centerFreqs));
+
+  // same bands, plus an additional one which breaks the uniform spacing
+  centerFreqs.push_back (centerFreqs.back () + 0.5 * bandWidth);
+  Ptr<SpectrumValue> nonUniformPsd = Create<SpectrumValue> (Create<SpectrumModel> (centerFreqs));
+
+  complexVector_t uniformResponse = lossModel->DoCalcRxComplexSpectrum (uniformPsd, txMob, rxMob, txBfVector, rxBfVector);
+  complexVector_t nonUniformResponse = lossModel->DoCalcRxComplexSpectrum (nonUniformPsd, txMob, rxMob, txBfVector, rxBfVector);
+
+  NS_TEST_ASSERT_MSG_EQ (uniformResponse.size (), numBands, "Wrong number of subbands");
+  for (uint32_t i = 0; i < numBands; i++)
+    {
+      double tol = 1e-9 * std::abs (nonUniformResponse.at (i)) + 1e-15;
+      NS_TEST_ASSERT_MSG_EQ_TOL (uniformResponse.at (i).real (), nonUniformResponse.at (i).real (), tol, "Wrong real part of the response for band " << i);
+      NS_TEST_ASSERT_MSG_EQ_TOL (uniformResponse.at (i).imag (), nonUniformResponse.at (i).imag (), tol, "Wrong imaginary part of the response for band " << i);
+    }
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup spectrum
+ *
+ * Test case for the parallel update of the ThreeGppChannel class.
+ * Checks if the channel matrices used during an update period are
+ * regenerated at the update boundary, and if the realizations are the same
+ * with one and with several worker threads.
+ */
+class ThreeGppChannelParallelUpdateTest : public TestCase
+{
+public:
+  /**
+   * Constructor
+   */
+  ThreeGppChannelParallelUpdateTest ();
+
+  /**
+   * Destructor
+   */
+  virtual ~ThreeGppChannelParallelUpdateTest ();
+
+private:
+  /**
+   * Build the test scenario
+   */
+  virtual void DoRun (void);
+
+  /**
+   * Generate the channel matrices of a set of links with the parallel update
+   * \param numThreads the number of worker threads
+   * \return the channel matrices of the links after the update
+   */
+  std::vector<Ptr<ThreeGppChannelMatrix> > GetUpdatedChannels (uint32_t numThreads);
+
+  /**
+   * Get the channel matrices of the links and check their generation time
+   * \param channelModel the channel model
+   * \param links the tx and rx mobility models of the links
+   * \param antennas the tx and rx antennas of the links
+   * \param generatedTime the expected generation time
+   * \param matrices the vector where the matrices are stored
+   */
+  void GetChannels (Ptr<ThreeGppChannel> channelModel,
+                    std::vector<std::pair<Ptr<MobilityModel>, Ptr<MobilityModel> > > links,
+                    std::vector<std::pair<Ptr<AntennaArrayModel>, Ptr<AntennaArrayModel> > > antennas,
+                    Time generatedTime, std::vector<Ptr<ThreeGppChannelMatrix> > *matrices);
+};
+
+ThreeGppChannelParallelUpdateTest::ThreeGppChannelParallelUpdateTest ()
+  : TestCase ("Test case for the parallel update of the ThreeGppChannel class")
+{
+}
+
+ThreeGppChannelParallelUpdateTest::~ThreeGppChannelParallelUpdateTest ()
+{
+}
+
+void
+ThreeGppChannelParallelUpdateTest::GetChannels (Ptr<ThreeGppChannel> channelModel,
+                                                std::vector<std::pair<Ptr<MobilityModel>, Ptr<MobilityModel> > > links,
+                                                std::vector<std::pair<Ptr<AntennaArrayModel>, Ptr<AntennaArrayModel> > > antennas,
+                                                Time generatedTime, std::vector<Ptr<ThreeGppChannelMatrix> > *matrices)
+{
+  matrices->clear ();
+  for (uint32_t i = 0; i < links.size (); i++)
+    {
+      Ptr<ThreeGppChannelMatrix> matrix = channelModel->GetChannel (links[i].first, links[i].second,
+                                                                    antennas[i].first, antennas[i].second, i % 2, false);
+      NS_TEST_ASSERT_MSG_EQ (matrix->m_generatedTime, generatedTime, "Wrong generation time of the channel matrix of link " << i);
+      matrices->push_back (matrix);
+    }
+}
+
+std::vector<Ptr<ThreeGppChannelMatrix> >
+ThreeGppChannelParallelUpdateTest::GetUpdatedChannels (uint32_t numThreads)
+{
+  Ptr<ThreeGppChannel> channelModel = CreateObject<ThreeGppChannel> ();
+  channelModel->SetAttribute ("Frequency", DoubleValue (28.0e9));
+  channelModel->SetAttribute ("Scenario", StringValue ("UMa"));
+  channelModel->SetAttribute ("UpdatePeriod", TimeValue (MilliSeconds (1)));
+  channelModel->SetAttribute ("ParallelUpdate", BooleanValue (true));
+  channelModel->SetAttribute ("UpdateThreads", UintegerValue (numThreads));
+  channelModel->AssignStreams (1);
+
+  // a base station and several users
+  uint32_t numUsers = 6;
+  NodeContainer nodes;
+  nodes.Create (numUsers + 1);
+  std::vector<Ptr<MobilityModel> > mobility;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<SimpleNetDevice> dev = CreateObject<SimpleNetDevice> ();
+      nodes.Get (i)->AddDevice (dev);
+      dev->SetNode (nodes.Get (i));
+      Ptr<MobilityModel> mob = CreateObject<ConstantPositionMobilityModel> ();
+      mob->SetPosition (i == 0 ? Vector (0.0, 0.0, 25.0) : Vector (20.0 * i, 10.0 * i, 1.5));
+      nodes.Get (i)->AggregateObject (mob);
+      mobility.push_back (mob);
+    }
+  Ptr<AntennaArrayModel> bsAntenna = CreateObject<AntennaArrayModel> ();
+  bsAntenna->SetAntennaNumDim1 (4);
+  bsAntenna->SetAntennaNumDim2 (4);
+
+  // links in both directions
+  std::vector<std::pair<Ptr<MobilityModel>, Ptr<MobilityModel> > > links;
+  std::vector<std::pair<Ptr<AntennaArrayModel>, Ptr<AntennaArrayModel> > > antennas;
+  for (uint32_t i = 1; i <= numUsers; i++)
+    {
+      Ptr<AntennaArrayModel> ueAntenna = CreateObject<AntennaArrayModel> ();
+      ueAntenna->SetAntennaNumDim1 (2);
+      ueAntenna->SetAntennaNumDim2 (2);
+      if (i % 2)
+        {
+          links.push_back (std::make_pair (mobility[0], mobility[i]));
+          antennas.push_back (std::make_pair (bsAntenna, ueAntenna));
+        }
+      else
+        {
+          links.push_back (std::make_pair (mobility[i], mobility[0]));
+          antennas.push_back (std::make_pair (ueAntenna, bsAntenna));
+        }
+    }
+
+  // the matrices are generated when first used, then they are regenerated
+  // at the boundary of the update period
+  std::vector<Ptr<ThreeGppChannelMatrix> > first;
+  std::vector<Ptr<ThreeGppChannelMatrix> > updated;
+  Simulator::Schedule (MicroSeconds (500), &ThreeGppChannelParallelUpdateTest::GetChannels, this,
+                       channelModel, links, antennas, MicroSeconds (500), &first);
+  Simulator::Schedule (MicroSeconds (1500), &ThreeGppChannelParallelUpdateTest::GetChannels, this,
+                       channelModel, links, antennas, MilliSeconds (1), &updated);
+  Simulator::Stop (MilliSeconds (2));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (updated.size (), links.size (), "Missing channel matrices");
+  return updated;
+}
+
+void
+ThreeGppChannelParallelUpdateTest::DoRun ()
+{
+  std::vector<Ptr<ThreeGppChannelMatrix> > serial = GetUpdatedChannels (1);
+  std::vector<Ptr<ThreeGppChannelMatrix> > parallel = GetUpdatedChannels (4);
+
+  NS_TEST_ASSERT_MSG_EQ (serial.size (), parallel.size (), "Different number of links");
+  for (uint32_t i = 0; i < serial.size (); i++)
+    {
+      const ThreeGppChannelTensor &h = serial[i]->m_channel;
+      const ThreeGppChannelTensor &hParallel = parallel[i]->m_channel;
+      NS_TEST_ASSERT_MSG_EQ (h.GetNumClusters (), hParallel.GetNumClusters (), "Different number of clusters for link " << i);
+      for (uint32_t n = 0; n < h.GetNumClusters (); n++)
+        {
+          for (uint32_t u = 0; u < h.GetNumRows (); u++)
+            {
+              for (uint32_t s = 0; s < h.GetNumCols (); s++)
+                {
+                  NS_TEST_ASSERT_MSG_EQ (h (u, s, n), hParallel (u, s, n), "Different coefficient for link " << i);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * \ingroup spectrum
+ *
+ * Test case for the BoundedCache class used to store the channel matrices
+ * and the long term components.
+ * Checks the least recently used eviction, the generation based eviction and
+ * the counters.
+ */
+class BoundedCacheTest : public TestCase
+{
+public:
+  /**
+   * Constructor
+   */
+  BoundedCacheTest ();
+
+  /**
+   * Destructor
+   */
+  virtual ~BoundedCacheTest ();
+
+private:
+  /**
+   * Build the test scenario
+   */
+  virtual void DoRun (void);
+};
+
+BoundedCacheTest::BoundedCacheTest ()
+  : TestCase ("Test case for the BoundedCache class")
+{
+}
+
+BoundedCacheTest::~BoundedCacheTest ()
+{
+}
+
+void
+BoundedCacheTest::DoRun ()
+{
+  BoundedCache<uint32_t, double> cache;
+  cache.SetCapacity (3);
+  Ptr<BoundedCacheStatistics> stats = cache.GetStatistics ();
+
+  cache.Insert (1, 1.0);
+  cache.Insert (2, 2.0);
+  cache.Insert (3, 3.0);
+  NS_TEST_ASSERT_MSG_EQ (cache.GetSize (), 3, "The cache should store 3 entries");
+
+  // access 1, so that 2 becomes the least recently used entry
+  double *value = cache.Find (1);
+  NS_TEST_ASSERT_MSG_EQ ((value != 0), true, "Entry 1 should be found");
+  NS_TEST_ASSERT_MSG_EQ (*value, 1.0, "Wrong value for entry 1");
+  NS_TEST_ASSERT_MSG_EQ ((cache.Find (4) == 0), true, "Entry 4 should not be found");
+
+  cache.Insert (4, 4.0);
+  NS_TEST_ASSERT_MSG_EQ (cache.GetSize (), 3, "The capacity is not enforced");
+  NS_TEST_ASSERT_MSG_EQ (cache.Contains (2), false, "The least recently used entry was not evicted");
+  NS_TEST_ASSERT_MSG_EQ (cache.Contains (1), true, "The most recently used entry was evicted");
+
+  // replacing a value does not change the number of entries
+  cache.Insert (3, 30.0);
+  NS_TEST_ASSERT_MSG_EQ (*cache.Peek (3), 30.0, "The value of entry 3 was not replaced");
+
+  NS_TEST_ASSERT_MSG_EQ (stats->GetHits (), 1, "Wrong number of hits");
+  NS_TEST_ASSERT_MSG_EQ (stats->GetMisses (), 1, "Wrong number of misses");
+  NS_TEST_ASSERT_MSG_EQ (stats->GetEvictions (), 1, "Wrong number of evictions");
+  NS_TEST_ASSERT_MSG_EQ (stats->GetEntries (), 3, "Wrong number of entries");
+  NS_TEST_ASSERT_MSG_GT (stats->GetBytes (), 3 * sizeof (double), "Wrong estimated size");
+
+  // with the generation policy, the entries not accessed during the current
+  // or the previous generation are evicted
+  cache.SetCapacity (0);
+  cache.SetEvictionPolicy (BoundedCacheBase::GENERATION);
+  cache.SetGeneration (1);
+  NS_TEST_ASSERT_MSG_EQ (cache.GetSize (), 3, "No entry should be evicted");
+  cache.Find (1);
+  cache.SetGeneration (2);
+  NS_TEST_ASSERT_MSG_EQ (cache.GetSize (), 1, "The entries of generation 0 were not evicted");
+  NS_TEST_ASSERT_MSG_EQ (cache.Contains (1), true, "Entry 1 was accessed in generation 1");
+  NS_TEST_ASSERT_MSG_EQ (stats->GetEvictions (), 3, "Wrong number of evictions");
+
+  cache.Erase (1);
+  NS_TEST_ASSERT_MSG_EQ (stats->GetEntries (), 0, "The cache should be empty");
+  NS_TEST_ASSERT_MSG_EQ (stats->GetBytes (), 0, "The cache should not occupy memory");
+  NS_TEST_ASSERT_MSG_EQ (stats->GetEvictions (), 3, "Erase should not be accounted as an eviction");
+}
+
+/**
+ * \ingroup spectrum
+ *
+ * Test case for the OpenAddressingHashTable class used to index the long
+ * term cache.
+ * Inserts and removes a set of keys which collide in the table, and checks
+ * that the remaining keys are still found after the backward shift deletion.
+ */
+class OpenAddressingHashTableTest : public TestCase
+{
+public:
+  /**
+   * Constructor
+   */
+  OpenAddressingHashTableTest ();
+
+  /**
+   * Destructor
+   */
+  virtual ~OpenAddressingHashTableTest ();
+
+private:
+  /**
+   * Build the test scenario
+   */
+  virtual void DoRun (void);
+};
+
+OpenAddressingHashTableTest::OpenAddressingHashTableTest ()
+  : TestCase ("Test case for the OpenAddressingHashTable class")
+{
+}
+
+OpenAddressingHashTableTest::~OpenAddressingHashTableTest ()
+{
+}
+
+void
+OpenAddressingHashTableTest::DoRun ()
+{
+  OpenAddressingHashTable<Key3DLongTerm, uint32_t, Key3DLongTermHash> table;
+  const uint32_t numKeys = 1000;
+  for (uint32_t i = 0; i < numKeys; i++)
+    {
+      Key3DLongTerm key = {i % 7, i, numKeys - i};
+      table.Insert (key, i);
+    }
+  NS_TEST_ASSERT_MSG_EQ (table.GetSize (), numKeys, "Wrong number of entries");
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (table.GetNumSlots (), 2 * numKeys, "The table is more than half full");
+
+  // remove the even keys
+  for (uint32_t i = 0; i < numKeys; i += 2)
+    {
+      Key3DLongTerm key = {i % 7, i, numKeys - i};
+      NS_TEST_ASSERT_MSG_EQ (table.Erase (key), true, "Key " << i << " was not found");
+    }
+  NS_TEST_ASSERT_MSG_EQ (table.GetSize (), numKeys / 2, "Wrong number of entries");
+
+  for (uint32_t i = 0; i < numKeys; i++)
+    {
+      Key3DLongTerm key = {i % 7, i, numKeys - i};
+      uint32_t *value = table.Find (key);
+      if (i % 2 == 0)
+        {
+          NS_TEST_ASSERT_MSG_EQ ((value == 0), true, "Key " << i << " was not removed");
+        }
+      else
+        {
+          NS_TEST_ASSERT_MSG_EQ ((value != 0), true, "Key " << i << " was lost");
+          NS_TEST_ASSERT_MSG_EQ (*value, i, "Wrong value for key " << i);
+        }
+    }
+
+  // reinserting a key replaces its value
+  Key3DLongTerm key = {1 % 7, 1, numKeys - 1};
+  table.Insert (key, 0);
+  NS_TEST_ASSERT_MSG_EQ (*table.Find (key), 0, "The value was not replaced");
+  NS_TEST_ASSERT_MSG_EQ (table.GetSize (), numKeys / 2, "Wrong number of entries");
+}
+
 /**
  * \ingroup spectrum
  *
@@ -509,7 +1067,12 @@ public:
 ThreeGppChannelTestSuite::ThreeGppChannelTestSuite ()
   : TestSuite ("three-gpp-channel", UNIT)
 {
+  AddTestCase (new BoundedCacheTest, TestCase::QUICK);
+  AddTestCase (new OpenAddressingHashTableTest, TestCase::QUICK);
+  AddTestCase (new ThreeGppChannelTensorTest, TestCase::QUICK);
   AddTestCase (new ThreeGppChannelTest, TestCase::QUICK);
+  AddTestCase (new ThreeGppChannelParallelUpdateTest, TestCase::QUICK);
+  AddTestCase (new ThreeGppFrequencyResponseTest, TestCase::QUICK);
   AddTestCase (new ThreeGppSpectrumPropagationLossModelTest, TestCase::QUICK);
 }
 
@@ -0,0 +1,187 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 SIGNET Lab, Department of Information Engineering,
+ * University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the lookups in the long term cache of
+// the ThreeGppSpectrumPropagationLossModel, comparing the ordered map which
+// was used before with the OpenAddressingHashTable and the BoundedCache.
+// Two access patterns are evaluated: lookups of random keys, and lookups
+// where each key is repeated 'layers' times in a row, as done when the
+// received PSD of the layers of a link is computed.
+// Sample usage:  ./waf --run 'bench-long-term-cache --n=1000000'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/abort.h"
+#include "ns3/three-gpp-spectrum-propagation-loss-model.h"
+#include "ns3/open-addressing-hash-table.h"
+#include "ns3/bounded-cache.h"
+#include <iostream>
+#include <limits>
+#include <algorithm>
+#include <map>
+#include <vector>
+
+using namespace ns3;
+
+/// Ordered map, as used by the long term cache before the hash table
+typedef std::map<Key3DLongTerm, Ptr<LongTerm> > OrderedMap;
+/// Hash table indexing the long term cache
+typedef OpenAddressingHashTable<Key3DLongTerm, Ptr<LongTerm>, Key3DLongTermHash> HashTable;
+/// The long term cache
+typedef BoundedCache<Key3DLongTerm, Ptr<LongTerm>, Key3DLongTermHash> Cache;
+
+/**
+ * Generate the keys of a scenario with the given number of entries
+ * \param n the number of keys
+ * \return the keys
+ */
+static std::vector<Key3DLongTerm>
+MakeKeys (uint32_t n)
+{
+  // 64 beams per side, the remaining entropy goes in the channel id
+  std::vector<Key3DLongTerm> keys (n);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      keys[i].a = i % 64;
+      keys[i].b = i / 4096;
+      keys[i].c = (i / 64) % 64;
+    }
+  return keys;
+}
+
+/**
+ * Generate the sequence of the looked up keys
+ * \param n the number of keys
+ * \param lookups the number of lookups
+ * \param repeat the number of consecutive lookups of each key
+ * \return the indices of the looked up keys
+ */
+static std::vector<uint32_t>
+MakeSequence (uint32_t n, uint32_t lookups, uint32_t repeat)
+{
+  std::vector<uint32_t> sequence (lookups);
+  uint64_t state = 12345;
+  uint32_t index = 0;
+  for (uint32_t i = 0; i < lookups; i++)
+    {
+      if (i % repeat == 0)
+        {
+          // linear congruential generator, the standard library is not
+          // used to keep the sequence independent of the platform
+          state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+          index = (state >> 33) % n;
+        }
+      sequence[i] = index;
+    }
+  return sequence;
+}
+
+/**
+ * Run the lookups on a container and measure the lookup rate
+ * \param name the name of the container
+ * \param find the function looking up a key, returning true if found
+ * \param keys the keys
+ * \param sequence the indices of the looked up keys
+ * \param minIterations the number of iterations, the fastest is reported
+ */
+template <class Find>
+static void
+RunBench (const char *name, Find find, const std::vector<Key3DLongTerm> &keys,
+          const std::vector<uint32_t> &sequence, uint32_t minIterations)
+{
+  uint64_t minDelay = std::numeric_limits<uint64_t>::max ();
+  uint32_t found = 0;
+  for (uint32_t iteration = 0; iteration < minIterations; iteration++)
+    {
+      SystemWallClockMs time;
+      time.Start ();
+      found = 0;
+      for (uint32_t index : sequence)
+        {
+          found += find (keys[index]);
+        }
+      minDelay = std::min (minDelay, static_cast<uint64_t> (time.End ()));
+    }
+  NS_ABORT_MSG_IF (found != sequence.size (), "Some keys were not found");
+  double rate = sequence.size () * 1000.0 / std::max<uint64_t> (minDelay, 1);
+  std::cout << rate << " lookups/s"
+            << " (" << minDelay << " ms elapsed)\t"
+            << name
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 100000;
+  uint32_t lookups = 10000000;
+  uint32_t layers = 4;
+  uint32_t minIterations = 3;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the lookups in the long term cache");
+  cmd.AddValue ("n", "number of entries", n);
+  cmd.AddValue ("lookups", "number of lookups", lookups);
+  cmd.AddValue ("layers", "number of consecutive lookups of the same key in the layered pattern", layers);
+  cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_IF (n == 0 || layers == 0, "The number of entries and of layers must be positive");
+
+  std::vector<Key3DLongTerm> keys = MakeKeys (n);
+  Ptr<LongTerm> longTerm = Create<LongTerm> ();
+
+  OrderedMap orderedMap;
+  HashTable hashTable;
+  Cache cache;
+  for (const Key3DLongTerm &key : keys)
+    {
+      orderedMap[key] = longTerm;
+      hashTable.Insert (key, longTerm);
+      cache.Insert (key, longTerm);
+    }
+
+  std::cout << "Running bench-long-term-cache with n=" << n
+            << " lookups=" << lookups << std::endl;
+
+  // the previous implementation performed a find followed by an at
+  auto findOrderedMap = [&orderedMap] (const Key3DLongTerm &key)
+  {
+    return orderedMap.find (key) != orderedMap.end () && orderedMap.at (key) != 0;
+  };
+  auto findHashTable = [&hashTable] (const Key3DLongTerm &key)
+  {
+    return hashTable.Find (key) != 0;
+  };
+  auto findCache = [&cache] (const Key3DLongTerm &key)
+  {
+    return cache.Find (key) != 0;
+  };
+
+  const uint32_t repeats[2] = {1, layers};
+  for (uint32_t repeat : repeats)
+    {
+      std::cout << "Each key looked up " << repeat << " time(s) in a row" << std::endl;
+      std::vector<uint32_t> sequence = MakeSequence (n, lookups, repeat);
+      RunBench ("std::map find and at", findOrderedMap, keys, sequence, minIterations);
+      RunBench ("OpenAddressingHashTable", findHashTable, keys, sequence, minIterations);
+      RunBench ("BoundedCache", findCache, keys, sequence, minIterations);
+    }
+
+  return 0;
+}
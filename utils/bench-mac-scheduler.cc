@@ -0,0 +1,449 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 SIGNET Lab, Department of Information Engineering,
+ * University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the mmWave MAC schedulers in
+// isolation. The scheduler is driven through its SAP interfaces as done by
+// MmWaveEnbMac, without PHY and channel: each subframe the RLC buffer status,
+// the DL and UL CQIs, the BSRs and the HARQ feedback of the previous
+// allocations of N UEs are scripted, then the scheduler is triggered.
+// The DL and UL queues of the UEs grow at a constant rate and are emptied by
+// the new transmissions, the CQIs change every 10 subframes and one HARQ
+// feedback out of nack-period is negative.
+// The number of scheduling decisions per second and the number of data
+// allocations per decision are reported for each scheduler.
+// Sample usage:  ./waf --run 'bench-mac-scheduler --ues=8 --layers=2'
+//     or, to print the allocations of a single scheduler:
+//   ./waf --run 'bench-mac-scheduler --scheduler=ns3::MmWaveAsyncHbfMacScheduler --verbose'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/abort.h"
+#include "ns3/object-factory.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/simulator.h"
+#include "ns3/mmwave-phy-mac-common.h"
+#include "ns3/mmwave-mac-sched-sap.h"
+#include "ns3/mmwave-mac-csched-sap.h"
+#include "ns3/mmwave-mac-scheduler.h"
+#include "ns3/lte-common.h"
+#include <iostream>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+using namespace mmwave;
+
+/**
+ * MmWaveMacSchedSapUser keeping the last scheduling decision
+ */
+class BenchSchedSapUser : public MmWaveMacSchedSapUser
+{
+public:
+  BenchSchedSapUser ()
+    : m_numIndications (0)
+  {
+  }
+
+  virtual void SchedConfigInd (const struct SchedConfigIndParameters& params)
+  {
+    m_last = params;
+    m_numIndications++;
+  }
+
+  SchedConfigIndParameters m_last; ///< the last scheduling decision
+  uint32_t m_numIndications;       ///< the number of scheduling decisions received
+};
+
+/**
+ * MmWaveMacCschedSapUser ignoring the confirmations of the scheduler
+ */
+class BenchCschedSapUser : public MmWaveMacCschedSapUser
+{
+public:
+  virtual void CschedCellConfigCnf (const struct CschedCellConfigCnfParameters& params)
+  {
+  }
+  virtual void CschedUeConfigCnf (const struct CschedUeConfigCnfParameters& params)
+  {
+  }
+  virtual void CschedLcConfigCnf (const struct CschedLcConfigCnfParameters& params)
+  {
+  }
+  virtual void CschedLcReleaseCnf (const struct CschedLcReleaseCnfParameters& params)
+  {
+  }
+  virtual void CschedUeReleaseCnf (const struct CschedUeReleaseCnfParameters& params)
+  {
+  }
+  virtual void CschedUeConfigUpdateInd (const struct CschedUeConfigUpdateIndParameters& params)
+  {
+  }
+  virtual void CschedCellConfigUpdateInd (const struct CschedCellConfigUpdateIndParameters& params)
+  {
+  }
+};
+
+/**
+ * Parameters of the scripted traffic and channel
+ */
+struct BenchConfig
+{
+  uint16_t numUes;          ///< the number of UEs
+  uint8_t numLayers;        ///< the number of layers of the eNB
+  uint32_t numSubframes;    ///< the number of scheduling decisions per iteration
+  uint32_t dlArrivals;      ///< the DL bytes queued for each UE per subframe
+  uint32_t ulArrivals;      ///< the UL bytes queued by each UE per subframe
+  uint32_t maxQueue;        ///< the maximum size of each queue, in bytes
+  uint32_t packetSize;      ///< the size of the DL packets, in bytes
+  bool harq;                ///< enable the HARQ retransmissions
+  uint32_t nackPeriod;      ///< one HARQ feedback out of nackPeriod is negative
+  bool verbose;             ///< print the allocations
+};
+
+/**
+ * \param a the first value
+ * \param b the second value
+ * \return a pseudo-random hash of the two values, independent of the platform
+ */
+static uint32_t
+Scramble (uint32_t a, uint32_t b)
+{
+  uint64_t state = (static_cast<uint64_t> (a) << 32) | b;
+  state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+  return static_cast<uint32_t> (state >> 33);
+}
+
+/**
+ * Drive a scheduler for the configured number of subframes
+ * \param sched the scheduler, already configured
+ * \param schedUser the SAP user connected to the scheduler
+ * \param phyMacConfig the PHY and MAC configuration of the scheduler
+ * \param config the parameters of the traffic and channel
+ * \return the number of data allocations
+ */
+static uint64_t
+RunScheduler (Ptr<MmWaveMacScheduler> sched, BenchSchedSapUser &schedUser,
+              Ptr<MmWavePhyMacCommon> phyMacConfig, const BenchConfig &config)
+{
+  MmWaveMacSchedSapProvider *sap = sched->GetMacSchedSapProvider ();
+  uint32_t subframesPerFrame = phyMacConfig->GetSubframesPerFrame ();
+  uint32_t latency = phyMacConfig->GetL1L2CtrlLatency ();
+  uint32_t numChunks = phyMacConfig->GetTotalNumChunk ();
+
+  std::list<uint16_t> ueList;
+  for (uint16_t rnti = 1; rnti <= config.numUes; rnti++)
+    {
+      ueList.push_back (rnti);
+    }
+
+  // the RLC queues of the UEs, filled at a constant rate and emptied by the
+  // new transmissions
+  std::vector<uint32_t> dlQueue (config.numUes + 1, 0);
+  std::vector<uint32_t> ulQueue (config.numUes + 1, 0);
+
+  uint64_t allocations = 0;
+  for (uint32_t n = 0; n < config.numSubframes; n++)
+    {
+      SfnSf sfnSf ((n / subframesPerFrame) % 1024, n % subframesPerFrame, 0);
+      MmWaveMacSchedSapUser::SchedConfigIndParameters &last = schedUser.m_last;
+      for (uint16_t rnti = 1; rnti <= config.numUes; rnti++)
+        {
+          dlQueue[rnti] = std::min (dlQueue[rnti] + config.dlArrivals, config.maxQueue);
+          ulQueue[rnti] = std::min (ulQueue[rnti] + config.ulArrivals, config.maxQueue);
+        }
+
+      MmWaveMacSchedSapProvider::SchedDlCqiInfoReqParameters dlCqiReq;
+      dlCqiReq.m_sfnsf = sfnSf;
+      for (uint16_t rnti = 1; rnti <= config.numUes; rnti++)
+        {
+          DlCqiInfo cqi;
+          cqi.m_rnti = rnti;
+          cqi.m_ri = 1;
+          cqi.m_cqiType = DlCqiInfo::WB;
+          cqi.m_wbCqi = 4 + Scramble (rnti, n / 10) % 12;
+          cqi.m_wbPmi = 0;
+          dlCqiReq.m_cqiList.push_back (cqi);
+        }
+      sap->SchedDlCqiInfoReq (dlCqiReq);
+
+      MmWaveMacSchedSapProvider::SchedTriggerReqParameters trigger;
+      // UL CQIs and HARQ feedback of the data slots of the previous decision
+      for (const SlotAllocInfo &slot : last.m_sfAllocInfo.m_slotAllocInfo)
+        {
+          if (slot.m_slotType == SlotAllocInfo::CTRL || slot.m_rnti == 0)
+            {
+              continue;
+            }
+          const DciInfoElementTdma &dci = slot.m_dci;
+          bool ok = Scramble (dci.m_rnti, n * 32 + dci.m_harqProcess) % config.nackPeriod != 0;
+          if (slot.m_tddMode == SlotAllocInfo::DL_slotAllocInfo)
+            {
+              DlHarqInfo harq;
+              harq.m_rnti = dci.m_rnti;
+              harq.m_harqProcessId = dci.m_harqProcess;
+              harq.m_harqStatus = ok ? DlHarqInfo::ACK : DlHarqInfo::NACK;
+              harq.m_numRetx = dci.m_rv;
+              trigger.m_dlHarqInfoList.push_back (harq);
+            }
+          else if (slot.m_tddMode == SlotAllocInfo::UL_slotAllocInfo)
+            {
+              MmWaveMacSchedSapProvider::SchedUlCqiInfoReqParameters ulCqi;
+              // as done by MmWaveEnbPhy::GenerateDataCqiReport
+              ulCqi.m_sfnSf = SfnSf (last.m_sfAllocInfo.m_sfnSf.m_frameNum, last.m_sfAllocInfo.m_sfnSf.m_sfNum,
+                                     dci.m_symStart * config.numLayers + dci.m_layerInd);
+              ulCqi.m_ulCqi.m_type = UlCqiInfo::PUSCH;
+              double sinrDb = 2.0 + Scramble (dci.m_rnti, n / 10) % 20;
+              ulCqi.m_ulCqi.m_sinr.assign (numChunks, std::pow (10.0, sinrDb / 10));
+              sap->SchedUlCqiInfoReq (ulCqi);
+
+              UlHarqInfo harq;
+              harq.m_rnti = dci.m_rnti;
+              harq.m_harqProcessId = dci.m_harqProcess;
+              harq.m_receptionStatus = ok ? UlHarqInfo::Ok : UlHarqInfo::NotOk;
+              harq.m_tpc = 0;
+              harq.m_numRetx = dci.m_rv;
+              trigger.m_ulHarqInfoList.push_back (harq);
+            }
+        }
+      // the feedback of each decision is sent only once
+      last.m_sfAllocInfo.m_slotAllocInfo.clear ();
+
+      MmWaveMacSchedSapProvider::SchedUlMacCtrlInfoReqParameters ulMacReq;
+      ulMacReq.m_sfnSf = sfnSf;
+      for (uint16_t rnti = 1; rnti <= config.numUes; rnti++)
+        {
+          MacCeElement bsr;
+          bsr.m_rnti = rnti;
+          bsr.m_macCeType = MacCeElement::BSR;
+          bsr.m_macCeValue.m_phr = 0;
+          bsr.m_macCeValue.m_crnti = 0;
+          bsr.m_macCeValue.m_bufferStatus.assign (4, 0);
+          bsr.m_macCeValue.m_bufferStatus.at (1) = BufferSizeLevelBsr::BufferSize2BsrId (ulQueue[rnti]);
+          ulMacReq.m_macCeList.push_back (bsr);
+        }
+      sap->SchedUlMacCtrlInfoReq (ulMacReq);
+
+      for (uint16_t rnti = 1; rnti <= config.numUes; rnti++)
+        {
+          MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters rlc;
+          rlc.m_rnti = rnti;
+          rlc.m_logicalChannelIdentity = 3;
+          rlc.m_rlcTransmissionQueueSize = dlQueue[rnti];
+          // the queue is reported packet by packet, as done by LteRlcAm
+          for (uint32_t queued = 0; queued < dlQueue[rnti]; queued += config.packetSize)
+            {
+              rlc.m_txPacketSizes.push_back (std::min (config.packetSize, dlQueue[rnti] - queued));
+              rlc.m_txPacketDelays.push_back (0);
+            }
+          rlc.m_rlcTransmissionQueueHolDelay = 0;
+          rlc.m_rlcRetransmissionQueueSize = 0;
+          rlc.m_rlcRetransmissionHolDelay = 0;
+          rlc.m_rlcStatusPduSize = 0;
+          rlc.m_arrivalRate = 0;
+          sap->SchedDlRlcBufferReq (rlc);
+        }
+
+      // the decision is taken for a future subframe, as done by MmWaveEnbMac
+      uint32_t schedSubframe = n + latency;
+      trigger.m_snfSf = SfnSf ((schedSubframe / subframesPerFrame) % 1024, schedSubframe % subframesPerFrame, 0);
+      trigger.m_ueList = ueList;
+      uint32_t numIndications = schedUser.m_numIndications;
+      sap->SchedTriggerReq (trigger);
+      if (schedUser.m_numIndications == numIndications)
+        {
+          continue;
+        }
+
+      for (const SlotAllocInfo &slot : last.m_sfAllocInfo.m_slotAllocInfo)
+        {
+          if (slot.m_slotType == SlotAllocInfo::CTRL || slot.m_rnti == 0)
+            {
+              continue;
+            }
+          allocations++;
+          const DciInfoElementTdma &dci = slot.m_dci;
+          if (dci.m_rv == 0)
+            {
+              if (slot.m_tddMode == SlotAllocInfo::DL_slotAllocInfo)
+                {
+                  for (const RlcPduInfo &pdu : slot.m_rlcPduInfo)
+                    {
+                      dlQueue[dci.m_rnti] -= std::min (dlQueue[dci.m_rnti], pdu.m_size);
+                    }
+                }
+              else
+                {
+                  ulQueue[dci.m_rnti] -= std::min (ulQueue[dci.m_rnti], dci.m_tbSize);
+                }
+            }
+          if (config.verbose)
+            {
+              std::cout << "Fr " << last.m_sfnSf.m_frameNum
+                        << " Sf " << (uint32_t) last.m_sfnSf.m_sfNum
+                        << " RNTI " << dci.m_rnti
+                        << (slot.m_tddMode == SlotAllocInfo::DL_slotAllocInfo ? " DL" : " UL")
+                        << " layer " << (uint32_t) dci.m_layerInd
+                        << " sym " << (uint32_t) dci.m_symStart << "+" << (uint32_t) dci.m_numSym
+                        << " MCS " << (uint32_t) dci.m_mcs
+                        << " TBS " << dci.m_tbSize
+                        << " HARQ " << (uint32_t) dci.m_harqProcess
+                        << " RV " << (uint32_t) dci.m_rv
+                        << std::endl;
+            }
+        }
+    }
+  return allocations;
+}
+
+/**
+ * Run a scheduler and measure its decision rate
+ * \param type the TypeId name of the scheduler
+ * \param config the parameters of the traffic and channel
+ * \param minIterations the number of iterations, the fastest is reported
+ */
+static void
+RunBench (const std::string &type, const BenchConfig &config, uint32_t minIterations)
+{
+  uint64_t minDelay = std::numeric_limits<uint64_t>::max ();
+  uint64_t allocations = 0;
+  for (uint32_t iteration = 0; iteration < minIterations; iteration++)
+    {
+      Ptr<MmWavePhyMacCommon> phyMacConfig = CreateObject<MmWavePhyMacCommon> ();
+      phyMacConfig->SetAttribute ("NumEnbLayers", UintegerValue (config.numLayers));
+
+      ObjectFactory factory;
+      factory.SetTypeId (type);
+      factory.Set ("HarqEnabled", BooleanValue (config.harq));
+      Ptr<MmWaveMacScheduler> sched = factory.Create<MmWaveMacScheduler> ();
+      sched->ConfigureCommonParameters (phyMacConfig);
+      BenchSchedSapUser schedUser;
+      BenchCschedSapUser cschedUser;
+      sched->SetMacSchedSapUser (&schedUser);
+      sched->SetMacCschedSapUser (&cschedUser);
+
+      for (uint16_t rnti = 1; rnti <= config.numUes; rnti++)
+        {
+          MmWaveMacCschedSapProvider::CschedUeConfigReqParameters ueConfig;
+          ueConfig.m_rnti = rnti;
+          ueConfig.m_transmissionMode = 0;
+          ueConfig.m_reconfigureFlag = false;
+          sched->GetMacCschedSapProvider ()->CschedUeConfigReq (ueConfig);
+
+          // a data radio bearer, configured as done by MmWaveEnbMac::DoAddLc
+          MmWaveMacCschedSapProvider::CschedLcConfigReqParameters lcConfig;
+          lcConfig.m_rnti = rnti;
+          lcConfig.m_reconfigureFlag = false;
+          LogicalChannelConfigListElement_s lccle;
+          lccle.m_logicalChannelIdentity = 3;
+          lccle.m_logicalChannelGroup = 1;
+          lccle.m_direction = LogicalChannelConfigListElement_s::DIR_BOTH;
+          lccle.m_qosBearerType = LogicalChannelConfigListElement_s::QBT_NON_GBR;
+          lccle.m_qci = 9;
+          lccle.m_eRabMaximulBitrateUl = 0;
+          lccle.m_eRabMaximulBitrateDl = 0;
+          lccle.m_eRabGuaranteedBitrateUl = 0;
+          lccle.m_eRabGuaranteedBitrateDl = 0;
+          lcConfig.m_logicalChannelConfigList.push_back (lccle);
+          sched->GetMacCschedSapProvider ()->CschedLcConfigReq (lcConfig);
+        }
+
+      SystemWallClockMs time;
+      time.Start ();
+      allocations = RunScheduler (sched, schedUser, phyMacConfig, config);
+      minDelay = std::min (minDelay, static_cast<uint64_t> (time.End ()));
+
+      sched->Dispose ();
+      Simulator::Destroy ();
+    }
+  std::cout << config.numSubframes * 1000.0 / std::max<uint64_t> (minDelay, 1) << " decisions/s, "
+            << static_cast<double> (allocations) / config.numSubframes << " allocations/call"
+            << " (" << minDelay << " ms elapsed)\t"
+            << type
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  BenchConfig config;
+  config.numUes = 8;
+  config.numLayers = 2;
+  config.numSubframes = 1000;
+  config.dlArrivals = 10000;
+  config.ulArrivals = 5000;
+  config.maxQueue = 100000;
+  config.packetSize = 1500;
+  config.harq = true;
+  config.nackPeriod = 10;
+  config.verbose = false;
+  uint32_t numLayers = config.numLayers;
+  uint32_t minIterations = 3;
+  std::string scheduler = "";
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the mmWave MAC schedulers driven through their SAP interfaces");
+  cmd.AddValue ("ues", "number of UEs", config.numUes);
+  cmd.AddValue ("layers", "number of layers of the eNB", numLayers);
+  cmd.AddValue ("subframes", "number of scheduling decisions per iteration", config.numSubframes);
+  cmd.AddValue ("dl-arrivals", "DL bytes queued for each UE per subframe", config.dlArrivals);
+  cmd.AddValue ("ul-arrivals", "UL bytes queued by each UE per subframe", config.ulArrivals);
+  cmd.AddValue ("max-queue", "maximum size of each queue, in bytes", config.maxQueue);
+  cmd.AddValue ("packet-size", "size of the DL packets, in bytes", config.packetSize);
+  cmd.AddValue ("harq", "enable the HARQ retransmissions", config.harq);
+  cmd.AddValue ("nack-period", "one HARQ feedback out of nack-period is negative", config.nackPeriod);
+  cmd.AddValue ("scheduler", "TypeId of the scheduler to run, all of them if empty", scheduler);
+  cmd.AddValue ("verbose", "print the allocations", config.verbose);
+  cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_IF (config.numUes == 0 || config.numSubframes == 0, "The number of UEs and of subframes must be positive");
+  NS_ABORT_MSG_IF (numLayers == 0 || numLayers > 255, "Invalid number of layers");
+  NS_ABORT_MSG_IF (config.nackPeriod == 0, "The NACK period must be positive");
+  NS_ABORT_MSG_IF (config.packetSize == 0, "The packet size must be positive");
+  config.numLayers = numLayers;
+
+  std::vector<std::string> schedulers;
+  if (scheduler.empty ())
+    {
+      schedulers.push_back ("ns3::MmWaveFlexTtiMacScheduler");
+      schedulers.push_back ("ns3::MmWaveFlexTtiPfMacScheduler");
+      schedulers.push_back ("ns3::MmWaveFlexTtiMaxRateMacScheduler");
+      schedulers.push_back ("ns3::MmWaveFlexTtiMaxWeightMacScheduler");
+      schedulers.push_back ("ns3::MmWaveAsyncHbfMacScheduler");
+      schedulers.push_back ("ns3::MmWavePaddedHbfMacScheduler");
+    }
+  else
+    {
+      schedulers.push_back (scheduler);
+    }
+
+  std::cout << "Running bench-mac-scheduler with ues=" << config.numUes
+            << " layers=" << numLayers
+            << " subframes=" << config.numSubframes << std::endl;
+
+  for (const std::string &type : schedulers)
+    {
+      RunBench (type, config, config.verbose ? 1 : minIterations);
+    }
+
+  return 0;
+}
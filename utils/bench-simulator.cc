@@ -207,6 +207,7 @@ int main (int argc, char *argv[])
   bool schedHeap = false;
   bool schedList = false;
   bool schedMap  = true;
+  bool schedWheel = false;
 
   uint32_t pop   =  100000;
   uint32_t total = 1000000;
@@ -221,11 +222,17 @@ int main (int argc, char *argv[])
              "  an ascii file, given by the --file=\"<filename>\" argument,\n"
              "  or standard input, by the argument --file=\"-\"\n"
              "In the case of either --file form, the input is expected\n"
-             "to be ascii, giving the relative event times in ns.");
+             "to be ascii, giving the relative event times in s.\n"
+             "The event delays of a simulation can be extracted from the\n"
+             "function logs of DefaultSimulatorImpl::Schedule, e.g.:\n"
+             "  NS_LOG=DefaultSimulatorImpl=level_function ./waf --run mmwave-hbf 2>&1\n"
+             "  | sed -n 's/.*Schedule(0x[0-9a-f]*, \\([0-9]*\\), 0x.*/\\1e-9/p'\n"
+             "where the delays in ns are converted to s.");
   cmd.AddValue ("cal",   "use CalendarSheduler",          schedCal);
   cmd.AddValue ("heap",  "use HeapScheduler",             schedHeap);
   cmd.AddValue ("list",  "use ListSheduler",              schedList);
   cmd.AddValue ("map",   "use MapScheduler (default)",    schedMap);
+  cmd.AddValue ("wheel", "use TimingWheelScheduler",      schedWheel);
   cmd.AddValue ("debug", "enable debugging output",       g_debug);
   cmd.AddValue ("pop",   "event population size (default 1E5)",         pop);
   cmd.AddValue ("total", "total number of events to run (default 1E6)", total);
@@ -249,6 +256,10 @@ int main (int argc, char *argv[])
     {
       factory.SetTypeId ("ns3::ListScheduler");
     }
+  if (schedWheel)
+    {
+      factory.SetTypeId ("ns3::TimingWheelScheduler");
+    }
   Simulator::SetScheduler (factory);
 
   LOGME (std::setprecision (g_fwidth - 6));